@@ -29,7 +29,9 @@ if(NOT com_github_opentelemtry_proto_POPULATED)
                                 ${CMAKE_CURRENT_SOURCE_DIR}/trpc/telemetry/opentelemetry/logging/logs_service.trpc.pb.h
                                 ${CMAKE_CURRENT_SOURCE_DIR}/trpc/telemetry/opentelemetry/logging/logs_service.trpc.pb.cc
                                 ${CMAKE_CURRENT_SOURCE_DIR}/trpc/telemetry/opentelemetry/tracing/trace_service.trpc.pb.h
-                                ${CMAKE_CURRENT_SOURCE_DIR}/trpc/telemetry/opentelemetry/tracing/trace_service.trpc.pb.cc)
+                                ${CMAKE_CURRENT_SOURCE_DIR}/trpc/telemetry/opentelemetry/tracing/trace_service.trpc.pb.cc
+                                ${CMAKE_CURRENT_SOURCE_DIR}/trpc/telemetry/opentelemetry/metrics/metrics_service.trpc.pb.h
+                                ${CMAKE_CURRENT_SOURCE_DIR}/trpc/telemetry/opentelemetry/metrics/metrics_service.trpc.pb.cc)
     add_custom_command(
         OUTPUT ${OUT_OPENTELEMETRY_PROTO_TRPC_PB_PROTO_FILES}
         WORKING_DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR}
@@ -43,8 +45,14 @@ if(NOT com_github_opentelemtry_proto_POPULATED)
             --trpc_out=generate_trpc_stub_path=trpc/telemetry/opentelemetry/tracing/trace_service:.
             -I. -Icmake_third_party/com_github_opentelemetry_proto
             cmake_third_party/com_github_opentelemetry_proto/opentelemetry/proto/collector/trace/v1/trace_service.proto
+        COMMAND ${PROTOBUF_PROTOC_EXECUTABLE} --proto_path=cmake_third_party/com_github_opentelemetry_proto
+            --plugin=protoc-gen-trpc=${TRPC_TO_CPP_PLUGIN}
+            --trpc_out=generate_trpc_stub_path=trpc/telemetry/opentelemetry/metrics/metrics_service:.
+            -I. -Icmake_third_party/com_github_opentelemetry_proto
+            cmake_third_party/com_github_opentelemetry_proto/opentelemetry/proto/collector/metrics/v1/metrics_service.proto
         DEPENDS ${com_github_opentelemtry_proto_SOURCE_DIR}/opentelemetry/proto/collector/logs/v1/logs_service.proto
             ${com_github_opentelemtry_proto_SOURCE_DIR}/opentelemetry/proto/collector/trace/v1/trace_service.proto
+            ${com_github_opentelemtry_proto_SOURCE_DIR}/opentelemetry/proto/collector/metrics/v1/metrics_service.proto
             trpc_cpp_plugin
     )
 endif()
\ No newline at end of file
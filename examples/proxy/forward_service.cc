@@ -43,8 +43,14 @@ ForwardServiceImpl::ForwardServiceImpl() {
     span->AddEvent("eventkey", {{"int value", 8888}, {"string value", "test"}});
   }
   // 1.2 gets the trace id and span id
-  TRPC_FMT_INFO("the OpenTelemetry trace id is {}", ::trpc::opentelemetry::GetTraceID(context));
-  TRPC_FMT_INFO("the OpenTelemetry span id is {}", ::trpc::opentelemetry::GetSpanID(context));
+  TRPC_FMT_INFO("the OpenTelemetry trace id is {}", ::trpc::opentelemetry::GetTraceIDHex(context));
+  TRPC_FMT_INFO("the OpenTelemetry span id is {}", ::trpc::opentelemetry::GetSpanIDHex(context));
+  // 1.3 traces a section of the handler by a child span, which is ended when it goes out of scope
+  {
+    ::trpc::opentelemetry::ScopedSpan child_span(context, "prepare_route",
+                                                 {{"route.msg_size", static_cast<int64_t>(request->msg().size())}});
+    child_span.AddEvent("prepared");
+  }
 
   // 2 uses the metrics interface.
 #ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
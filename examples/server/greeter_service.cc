@@ -33,8 +33,8 @@ namespace helloworld {
     span->AddEvent("eventkey", {{"int value", 8888}, {"string value", "test"}});
   }
   // gets the trace id and span id
-  TRPC_FMT_INFO("the OpenTelemetry trace id is {}", ::trpc::opentelemetry::GetTraceID(context));
-  TRPC_FMT_INFO("the OpenTelemetry span id is {}", ::trpc::opentelemetry::GetSpanID(context));
+  TRPC_FMT_INFO("the OpenTelemetry trace id is {}", ::trpc::opentelemetry::GetTraceIDHex(context));
+  TRPC_FMT_INFO("the OpenTelemetry span id is {}", ::trpc::opentelemetry::GetSpanIDHex(context));
 
   std::string response = "Hello, " + request->msg();
   reply->set_msg(response);
@@ -19,6 +19,10 @@ namespace trpc::opentelemetry {
 constexpr char kLogServerName[] = "server";
 constexpr char kLogServiceName[] = "service.name";
 constexpr char kLogEnvName[] = "env";
+constexpr char kLogLineName[] = "line";
+constexpr char kLogFunctionName[] = "function";
+constexpr char kLogSuppressedName[] = "suppressed";
+constexpr char kLogExampleTraceIdsName[] = "example_trace_ids";
 
 /// @brief The service name of the internal log exporter
 constexpr char kGrpcLogExporterServiceName[] = "trpc.opentelemetry.log.grpc_exporter";
@@ -0,0 +1,91 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#include "trpc/telemetry/opentelemetry/logging/log_call_site.h"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace trpc::opentelemetry {
+
+namespace {
+
+struct CallSiteKey {
+  const char* filename;
+  int line;
+  const char* funcname;
+
+  bool operator==(const CallSiteKey& other) const {
+    return filename == other.filename && line == other.line && funcname == other.funcname;
+  }
+};
+
+struct CallSiteKeyHash {
+  size_t operator()(const CallSiteKey& key) const {
+    size_t hash = std::hash<const char*>()(key.filename);
+    hash = hash * 31 + std::hash<int>()(key.line);
+    hash = hash * 31 + std::hash<const char*>()(key.funcname);
+    return hash;
+  }
+};
+
+// The sites are never removed, so the registry is not destroyed at exit for the threads still logging.
+struct CallSiteRegistry {
+  std::mutex mutex;
+  std::unordered_map<CallSiteKey, std::unique_ptr<LogCallSite>, CallSiteKeyHash> sites;
+};
+
+CallSiteRegistry& GetRegistry() {
+  static CallSiteRegistry* registry = new CallSiteRegistry();
+  return *registry;
+}
+
+const LogCallSite& InternLogCallSite(const CallSiteKey& key) {
+  auto& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  auto& site = registry.sites[key];
+  if (!site) {
+    site = std::make_unique<LogCallSite>();
+    site->location = std::string(key.filename ? key.filename : "") + ":" + std::to_string(key.line);
+    site->function = key.funcname ? key.funcname : "";
+  }
+  return *site;
+}
+
+}  // namespace
+
+const LogCallSite& GetLogCallSite(const char* filename, int line, const char* funcname) {
+  thread_local std::unordered_map<CallSiteKey, const LogCallSite*, CallSiteKeyHash> cache;
+
+  CallSiteKey key{filename, line, funcname};
+  auto it = cache.find(key);
+  if (it != cache.end()) {
+    return *it->second;
+  }
+  const LogCallSite& site = InternLogCallSite(key);
+  cache.emplace(key, &site);
+  return site;
+}
+
+void ForEachLogCallSite(const std::function<void(const LogCallSite& call_site)>& visitor) {
+  auto& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (const auto& [key, site] : registry.sites) {
+    visitor(*site);
+  }
+}
+
+}  // namespace trpc::opentelemetry
@@ -0,0 +1,47 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#pragma once
+
+#include <functional>
+#include <string>
+
+#include "trpc/telemetry/opentelemetry/logging/log_rate_limiter.h"
+
+namespace trpc::opentelemetry {
+
+/// @brief The attributes of a log macro site, which are formatted once and shared by all the records of the site.
+struct LogCallSite {
+  /// "filename:line"
+  std::string location;
+  std::string function;
+  /// The rate limiting state of the site, which is shared by all the logging threads
+  mutable LogRateLimiter::SiteState rate_limit_state;
+};
+
+/// @brief Gets the interned attributes of a log macro site. The first call of a site formats the attributes into a
+///        process-wide registry, and the later calls of the thread find them in a thread local cache without locking.
+/// @param filename the file name of the site, such as __FILE__
+/// @param line the line of the site
+/// @param funcname the function name of the site, such as __FUNCTION__, nullptr is treated as empty
+/// @return Return the attributes, which live until the process exits.
+/// @note The sites are identified by the addresses of filename and funcname rather than their contents, so they must
+///       be string literals, as the log macros of the framework pass. A buffer reused for another name would get the
+///       attributes of the first name.
+const LogCallSite& GetLogCallSite(const char* filename, int line, const char* funcname);
+
+/// @brief Visits all the interned sites, which blocks interning new sites during the visit.
+/// @param visitor the function called with each site
+void ForEachLogCallSite(const std::function<void(const LogCallSite& call_site)>& visitor);
+
+}  // namespace trpc::opentelemetry
@@ -0,0 +1,69 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#include "trpc/telemetry/opentelemetry/logging/log_call_site.h"
+
+#include <thread>
+
+#include "gtest/gtest.h"
+
+namespace trpc::testing {
+
+using trpc::opentelemetry::GetLogCallSite;
+using trpc::opentelemetry::LogCallSite;
+
+TEST(LogCallSiteTest, Intern) {
+  // the sites are identified by the addresses of the names, which are the same literals here
+  static constexpr char kFilename[] = "file.cc";
+  static constexpr char kFuncname[] = "Func";
+  const LogCallSite& site = GetLogCallSite(kFilename, 10, kFuncname);
+  ASSERT_EQ("file.cc:10", site.location);
+  ASSERT_EQ("Func", site.function);
+
+  // the same site gets the same attributes
+  ASSERT_EQ(&site, &GetLogCallSite(kFilename, 10, kFuncname));
+  // the other line of the file is another site
+  ASSERT_NE(&site, &GetLogCallSite(kFilename, 11, kFuncname));
+  ASSERT_EQ("file.cc:11", GetLogCallSite(kFilename, 11, kFuncname).location);
+
+  const LogCallSite& no_function_site = GetLogCallSite(kFilename, 12, nullptr);
+  ASSERT_EQ("file.cc:12", no_function_site.location);
+  ASSERT_EQ("", no_function_site.function);
+}
+
+TEST(LogCallSiteTest, InternInOtherThread) {
+  static constexpr char kFilename[] = "thread_file.cc";
+  static constexpr char kFuncname[] = "ThreadFunc";
+  const LogCallSite* site = &GetLogCallSite(kFilename, 20, kFuncname);
+  const LogCallSite* other_thread_site = nullptr;
+  std::thread thread([&other_thread_site]() {
+    // finds the site interned by the main thread, which is not in the cache of this thread
+    other_thread_site = &GetLogCallSite(kFilename, 20, kFuncname);
+  });
+  thread.join();
+  ASSERT_EQ(site, other_thread_site);
+}
+
+TEST(LogCallSiteTest, ForEach) {
+  static constexpr char kFilename[] = "for_each_file.cc";
+  const LogCallSite* site = &GetLogCallSite(kFilename, 30, nullptr);
+  bool found = false;
+  trpc::opentelemetry::ForEachLogCallSite([site, &found](const LogCallSite& call_site) {
+    if (&call_site == site) {
+      found = true;
+    }
+  });
+  ASSERT_TRUE(found);
+}
+
+}  // namespace trpc::testing
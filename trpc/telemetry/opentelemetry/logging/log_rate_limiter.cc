@@ -0,0 +1,82 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#include "trpc/telemetry/opentelemetry/logging/log_rate_limiter.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace trpc::opentelemetry {
+
+namespace {
+
+constexpr int64_t kNanoSecondsPerSecond = 1000000000;
+
+}  // namespace
+
+LogRateLimiter::LogRateLimiter(Options options) {
+  uint32_t rate = std::max(options.rate, 1u);
+  uint32_t burst = std::max(options.burst, 1u);
+  interval_ns_ = kNanoSecondsPerSecond / rate;
+  tolerance_ns_ = interval_ns_ * (burst - 1);
+}
+
+bool LogRateLimiter::Allow(SiteState& state, uint8_t severity, const uint8_t (&trace_id)[16], int64_t now_ns) {
+  int64_t tat = state.tat_ns_.load(std::memory_order_relaxed);
+  while (true) {
+    int64_t base = std::max(tat, now_ns);
+    if (base - now_ns > tolerance_ns_) {
+      break;
+    }
+    if (state.tat_ns_.compare_exchange_weak(tat, base + interval_ns_, std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+
+  // folds the log into the summary of the call site
+  state.suppressed_.fetch_add(1, std::memory_order_relaxed);
+  uint8_t max_severity = state.severity_.load(std::memory_order_relaxed);
+  while (severity > max_severity &&
+         !state.severity_.compare_exchange_weak(max_severity, severity, std::memory_order_relaxed)) {
+  }
+
+  uint64_t halves[2];
+  std::memcpy(halves, trace_id, sizeof(halves));
+  // only the valid trace ids are kept as examples
+  if ((halves[0] != 0 || halves[1] != 0) && state.example_num_.load(std::memory_order_relaxed) < kMaxExamples) {
+    uint64_t index = state.example_num_.fetch_add(1, std::memory_order_relaxed);
+    if (index < kMaxExamples) {
+      state.examples_[index][0].store(halves[0], std::memory_order_relaxed);
+      state.examples_[index][1].store(halves[1], std::memory_order_relaxed);
+    }
+  }
+  return false;
+}
+
+bool LogRateLimiter::TakeSummary(SiteState& state, Summary& summary) {
+  uint64_t suppressed = state.suppressed_.exchange(0, std::memory_order_relaxed);
+  if (suppressed == 0) {
+    return false;
+  }
+  summary.suppressed = suppressed;
+  summary.severity = state.severity_.exchange(0, std::memory_order_relaxed);
+  summary.example_num = std::min<uint64_t>(state.example_num_.exchange(0, std::memory_order_relaxed), kMaxExamples);
+  for (size_t i = 0; i < summary.example_num; ++i) {
+    uint64_t halves[2] = {state.examples_[i][0].load(std::memory_order_relaxed),
+                          state.examples_[i][1].load(std::memory_order_relaxed)};
+    std::memcpy(summary.example_trace_ids[i].data(), halves, sizeof(halves));
+  }
+  return true;
+}
+
+}  // namespace trpc::opentelemetry
@@ -0,0 +1,89 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace trpc::opentelemetry {
+
+/// @brief Limits the rate of the logs of each call site by a token bucket, and folds the suppressed logs of a call site
+///        into a summary. Both are lock-free, as the state of a call site is updated by all the logging threads.
+class LogRateLimiter {
+ public:
+  struct Options {
+    /// the logs allowed per second of a call site
+    uint32_t rate = 100;
+    /// the logs allowed in a burst of a call site
+    uint32_t burst = 100;
+  };
+
+  /// the maximum number of example trace ids kept in a summary
+  static constexpr size_t kMaxExamples = 3;
+
+  /// @brief The state of a call site.
+  class SiteState {
+   private:
+    friend class LogRateLimiter;
+
+    // the theoretical arrival time of the next log, in nanoseconds of the steady clock, see GCRA
+    std::atomic<int64_t> tat_ns_{0};
+    // the number of logs suppressed since the last summary
+    std::atomic<uint64_t> suppressed_{0};
+    // the highest severity of the logs suppressed since the last summary
+    std::atomic<uint8_t> severity_{0};
+    // the number of the suppressed logs with valid trace ids since the last summary, which is not counted any more
+    // once the examples are full
+    std::atomic<uint64_t> example_num_{0};
+    // the valid trace ids of the first suppressed logs since the last summary, in two halves
+    std::array<std::array<std::atomic<uint64_t>, 2>, kMaxExamples> examples_{};
+  };
+
+  /// @brief The summary of the suppressed logs of a call site.
+  struct Summary {
+    uint64_t suppressed = 0;
+    /// the highest severity of the suppressed logs
+    uint8_t severity = 0;
+    /// the number of the example trace ids, which is 0 if none of the suppressed logs has a valid trace id
+    size_t example_num = 0;
+    std::array<std::array<uint8_t, 16>, kMaxExamples> example_trace_ids{};
+  };
+
+  explicit LogRateLimiter(Options options);
+
+  /// @brief Checks whether a log of a call site is allowed, and records it in the summary of the call site if not.
+  /// @param state the state of the call site
+  /// @param severity the severity of the log
+  /// @param trace_id the trace id of the log, which is all zeros if the log has no span and is not kept as an example
+  /// @param now_ns the time of the steady clock, in nanoseconds
+  /// @return Return true if the log is allowed.
+  bool Allow(SiteState& state, uint8_t severity, const uint8_t (&trace_id)[16], int64_t now_ns);
+
+  /// @brief Takes the summary of the logs suppressed since the last summary.
+  /// @param state the state of the call site
+  /// @param[out] summary the summary
+  /// @return Return false if no log is suppressed.
+  /// @note The examples are best effort, an example written while it is taken may be missed or mixed up.
+  static bool TakeSummary(SiteState& state, Summary& summary);
+
+ private:
+  // the interval between two logs at the rate
+  int64_t interval_ns_;
+  // how far the theoretical arrival time may be ahead of now, which allows the burst
+  int64_t tolerance_ns_;
+};
+
+}  // namespace trpc::opentelemetry
@@ -0,0 +1,156 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#include "trpc/telemetry/opentelemetry/logging/log_rate_limiter.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace trpc::testing {
+
+using trpc::opentelemetry::LogRateLimiter;
+
+constexpr int64_t kSecond = 1000000000;
+
+TEST(LogRateLimiterTest, Burst) {
+  LogRateLimiter::Options options;
+  options.rate = 10;
+  options.burst = 5;
+  LogRateLimiter limiter(options);
+  LogRateLimiter::SiteState state;
+  uint8_t trace_id[16] = {1};
+
+  int64_t now = 100 * kSecond;
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_TRUE(limiter.Allow(state, 9, trace_id, now));
+  }
+  ASSERT_FALSE(limiter.Allow(state, 9, trace_id, now));
+
+  // one token is refilled every 100ms
+  ASSERT_FALSE(limiter.Allow(state, 9, trace_id, now + kSecond / 20));
+  ASSERT_TRUE(limiter.Allow(state, 9, trace_id, now + kSecond / 10));
+  ASSERT_FALSE(limiter.Allow(state, 9, trace_id, now + kSecond / 10));
+
+  // the burst is refilled after a while
+  now += 10 * kSecond;
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_TRUE(limiter.Allow(state, 9, trace_id, now));
+  }
+}
+
+TEST(LogRateLimiterTest, Summary) {
+  LogRateLimiter::Options options;
+  options.rate = 1;
+  options.burst = 1;
+  LogRateLimiter limiter(options);
+  LogRateLimiter::SiteState state;
+
+  LogRateLimiter::Summary summary;
+  ASSERT_FALSE(LogRateLimiter::TakeSummary(state, summary));
+
+  int64_t now = 100 * kSecond;
+  uint8_t trace_id[16] = {};
+  ASSERT_TRUE(limiter.Allow(state, 9, trace_id, now));
+  for (uint8_t i = 1; i <= 5; ++i) {
+    trace_id[0] = i;
+    ASSERT_FALSE(limiter.Allow(state, 17, trace_id, now));
+  }
+
+  ASSERT_TRUE(LogRateLimiter::TakeSummary(state, summary));
+  ASSERT_EQ(5, summary.suppressed);
+  ASSERT_EQ(17, summary.severity);
+  ASSERT_EQ(LogRateLimiter::kMaxExamples, summary.example_num);
+  // the examples are the first suppressed logs
+  ASSERT_EQ(1, summary.example_trace_ids[0][0]);
+  ASSERT_EQ(2, summary.example_trace_ids[1][0]);
+  ASSERT_EQ(3, summary.example_trace_ids[2][0]);
+
+  // the summary is reset once taken
+  ASSERT_FALSE(LogRateLimiter::TakeSummary(state, summary));
+  ASSERT_FALSE(limiter.Allow(state, 9, trace_id, now));
+  ASSERT_TRUE(LogRateLimiter::TakeSummary(state, summary));
+  ASSERT_EQ(1, summary.suppressed);
+  ASSERT_EQ(9, summary.severity);
+  ASSERT_EQ(1, summary.example_num);
+  ASSERT_EQ(5, summary.example_trace_ids[0][0]);
+}
+
+TEST(LogRateLimiterTest, SummaryExamplesAndSeverity) {
+  LogRateLimiter::Options options;
+  options.rate = 1;
+  options.burst = 1;
+  LogRateLimiter limiter(options);
+  LogRateLimiter::SiteState state;
+
+  int64_t now = 100 * kSecond;
+  uint8_t invalid_trace_id[16] = {};
+  uint8_t trace_id[16] = {};
+  trace_id[15] = 1;
+  ASSERT_TRUE(limiter.Allow(state, 9, invalid_trace_id, now));
+
+  // the logs without span are not kept as examples, and the highest severity is kept
+  ASSERT_FALSE(limiter.Allow(state, 17, invalid_trace_id, now));
+  ASSERT_FALSE(limiter.Allow(state, 9, invalid_trace_id, now));
+  LogRateLimiter::Summary summary;
+  ASSERT_TRUE(LogRateLimiter::TakeSummary(state, summary));
+  ASSERT_EQ(2, summary.suppressed);
+  ASSERT_EQ(17, summary.severity);
+  ASSERT_EQ(0, summary.example_num);
+
+  // the examples skip the logs without span
+  ASSERT_FALSE(limiter.Allow(state, 9, invalid_trace_id, now));
+  ASSERT_FALSE(limiter.Allow(state, 13, trace_id, now));
+  ASSERT_TRUE(LogRateLimiter::TakeSummary(state, summary));
+  ASSERT_EQ(2, summary.suppressed);
+  ASSERT_EQ(13, summary.severity);
+  ASSERT_EQ(1, summary.example_num);
+  ASSERT_EQ(1, summary.example_trace_ids[0][15]);
+}
+
+TEST(LogRateLimiterTest, MultiThread) {
+  constexpr int kThreadNum = 4;
+  constexpr int kLogNum = 10000;
+
+  LogRateLimiter::Options options;
+  options.rate = 1;
+  options.burst = 100;
+  LogRateLimiter limiter(options);
+  LogRateLimiter::SiteState state;
+
+  std::atomic<int> allowed{0};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadNum; ++i) {
+    threads.emplace_back([&]() {
+      uint8_t trace_id[16] = {};
+      for (int j = 0; j < kLogNum; ++j) {
+        if (limiter.Allow(state, 9, trace_id, 100 * kSecond)) {
+          allowed.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // exactly the burst is allowed at the same time, and the others are summarized
+  ASSERT_EQ(100, allowed.load());
+  LogRateLimiter::Summary summary;
+  ASSERT_TRUE(LogRateLimiter::TakeSummary(state, summary));
+  ASSERT_EQ(kThreadNum * kLogNum - 100, summary.suppressed);
+}
+
+}  // namespace trpc::testing
@@ -0,0 +1,172 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#include "trpc/telemetry/opentelemetry/logging/log_staging.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "trpc/util/log/logging.h"
+
+namespace trpc::opentelemetry {
+
+namespace {
+
+size_t RoundUpToPowerOf2(size_t n) {
+  size_t result = 1;
+  while (result < n) {
+    result <<= 1;
+  }
+  return result;
+}
+
+uint64_t GetNextStagingId() {
+  static std::atomic<uint64_t> next_id{1};
+  return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+// The rings of the calling thread, keyed by the id of the staging. The entries of the destroyed stagings are never
+// matched again as the ids are not reused.
+struct ThreadRingCache {
+  uint64_t last_id = 0;
+  void* last_ring = nullptr;
+  std::vector<std::pair<uint64_t, void*>> rings;
+};
+
+thread_local ThreadRingCache thread_ring_cache;
+
+}  // namespace
+
+LogStagingRing::LogStagingRing(size_t capacity)
+    : slots_(RoundUpToPowerOf2(capacity > 0 ? capacity : 1)), mask_(slots_.size() - 1) {}
+
+size_t LogStagingRing::Drain(const std::function<void(StagedLogRecord& record)>& visitor, size_t max_num) {
+  size_t head = head_.load(std::memory_order_relaxed);
+  size_t tail = tail_.load(std::memory_order_acquire);
+  size_t num = std::min(tail - head, max_num);
+  for (size_t i = 0; i < num; ++i) {
+    visitor(slots_[(head + i) & mask_]);
+  }
+  head_.store(head + num, std::memory_order_release);
+  return num;
+}
+
+LogStaging::LogStaging(Options options, EmitFunc emit_func)
+    : options_(std::move(options)), emit_func_(std::move(emit_func)), id_(GetNextStagingId()) {}
+
+LogStaging::~LogStaging() { Stop(); }
+
+void LogStaging::Start() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (thread_.joinable()) {
+    return;
+  }
+  stopped_ = false;
+  thread_ = std::thread([this]() { Run(); });
+}
+
+void LogStaging::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (thread_.joinable()) {
+      stopped_ = true;
+    }
+  }
+  if (thread_.joinable()) {
+    cond_.notify_all();
+    thread_.join();
+  }
+  // the records staged after the last drain of the drainer are emitted here
+  Drain();
+}
+
+LogStaging::ThreadRing* LogStaging::GetThreadRing() {
+  auto& cache = thread_ring_cache;
+  if (cache.last_id == id_) {
+    return static_cast<ThreadRing*>(cache.last_ring);
+  }
+  ThreadRing* ring = nullptr;
+  for (const auto& [id, cached_ring] : cache.rings) {
+    if (id == id_) {
+      ring = static_cast<ThreadRing*>(cached_ring);
+      break;
+    }
+  }
+  if (ring == nullptr) {
+    ring = CreateThreadRing();
+    cache.rings.emplace_back(id_, ring);
+  }
+  cache.last_id = id_;
+  cache.last_ring = ring;
+  return ring;
+}
+
+LogStaging::ThreadRing* LogStaging::CreateThreadRing() {
+  auto ring = std::make_unique<ThreadRing>(options_.ring_size);
+  ThreadRing* result = ring.get();
+  std::lock_guard<std::mutex> lock(rings_mutex_);
+  rings_.push_back(std::move(ring));
+  return result;
+}
+
+size_t LogStaging::Drain() {
+  std::lock_guard<std::mutex> drain_lock(drain_mutex_);
+  {
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    drain_rings_.clear();
+    for (const auto& ring : rings_) {
+      drain_rings_.push_back(ring.get());
+    }
+  }
+
+  size_t num = 0;
+  uint64_t dropped = 0;
+  for (ThreadRing* ring : drain_rings_) {
+    // drains no more than a ring of records at a time, so a busy thread does not hold up the other threads
+    num += ring->ring.Drain(emit_func_, ring->ring.Capacity());
+    dropped += ring->dropped.load(std::memory_order_relaxed);
+  }
+
+  if (dropped > reported_dropped_) {
+    TRPC_FMT_WARN("{} opentelemetry log records are dropped as the staging rings are full, total dropped: {}",
+                  dropped - reported_dropped_, dropped);
+    reported_dropped_ = dropped;
+  }
+  return num;
+}
+
+LogStaging::Stats LogStaging::GetStats() const {
+  Stats stats;
+  std::lock_guard<std::mutex> lock(rings_mutex_);
+  for (const auto& ring : rings_) {
+    stats.staged += ring->staged.load(std::memory_order_relaxed);
+    stats.dropped += ring->dropped.load(std::memory_order_relaxed);
+    stats.sampled_out += ring->sampled_out.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+void LogStaging::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopped_) {
+    cond_.wait_for(lock, std::chrono::milliseconds(options_.drain_interval_ms), [this]() {
+      return stopped_ || drain_requested_.exchange(false, std::memory_order_relaxed);
+    });
+    // drains without holding the lock, so the producers waking the drainer are not blocked
+    lock.unlock();
+    Drain();
+    lock.lock();
+  }
+}
+
+}  // namespace trpc::opentelemetry
@@ -0,0 +1,222 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace trpc::opentelemetry {
+
+/// @brief A log record staged by the logging thread, which is emitted by the drainer later.
+struct StagedLogRecord {
+  /// The opentelemetry severity
+  uint8_t severity = 0;
+  /// The file name of the call site, which is not copied as it is a string literal such as __FILE__
+  const char* filename = nullptr;
+  int line = 0;
+  /// The function name of the call site, which is not copied as it is a string literal such as __FUNCTION__
+  const char* funcname = nullptr;
+  std::string msg;
+  uint8_t trace_id[16] = {};
+  uint8_t span_id[8] = {};
+  uint8_t trace_flags = 0;
+  std::chrono::system_clock::time_point timestamp;
+};
+
+/// @brief A bounded single-producer single-consumer ring of log records. The records are filled in place, so the
+///        buffers of the messages are reused and staging a record does not allocate once the ring is warmed up.
+class LogStagingRing {
+ public:
+  /// @param capacity the capacity, which is rounded up to a power of 2
+  explicit LogStagingRing(size_t capacity);
+
+  /// @brief Fills a record at the tail of the ring, which is called by the producer.
+  /// @param fill the function which fills the record, whose fields keep the values of a drained record
+  /// @return Return false if the ring is full.
+  template <typename FillFunc>
+  bool TryPush(FillFunc&& fill) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - cached_head_ >= slots_.size()) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      if (tail - cached_head_ >= slots_.size()) {
+        return false;
+      }
+    }
+    fill(slots_[tail & mask_]);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// @brief Drains the records at the head of the ring, which is called by the consumer.
+  /// @param visitor the function called with each record
+  /// @param max_num the maximum number of records to drain
+  /// @return Return the number of drained records.
+  size_t Drain(const std::function<void(StagedLogRecord& record)>& visitor, size_t max_num);
+
+  /// @brief Gets the number of records in the ring, which may be stale when called by the consumer.
+  size_t Size() const {
+    return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+  }
+
+  size_t Capacity() const { return slots_.size(); }
+
+ private:
+  std::vector<StagedLogRecord> slots_;
+  size_t mask_;
+
+  // the position of the next record to drain, written by the consumer
+  alignas(64) std::atomic<size_t> head_{0};
+  // the position of the next record to fill, written by the producer
+  alignas(64) std::atomic<size_t> tail_{0};
+  // the head last seen by the producer, which saves loading head_ on every push
+  size_t cached_head_ = 0;
+};
+
+/// @brief What to do with the records of a thread whose ring is filling up faster than it is drained.
+enum class LogOverflowPolicy {
+  /// stages the records until the ring is full, and drops the records when it is full
+  kDrop,
+  /// stages one of every sample_interval records once the ring is half full, and drops the records when it is full
+  kSample,
+};
+
+/// @brief Stages the log records in the rings of the logging threads, and emits them from a drainer thread in batches.
+///        The logging threads never contend with each other, and only the drainer pushes into the exporting pipeline.
+class LogStaging {
+ public:
+  /// @brief The function which emits a drained record, which is only called by one thread at a time.
+  using EmitFunc = std::function<void(StagedLogRecord& record)>;
+
+  struct Options {
+    /// the capacity of the ring of each thread
+    size_t ring_size = 4096;
+    /// the interval between two drains, in milliseconds. A ring which becomes half full wakes the drainer earlier
+    uint32_t drain_interval_ms = 100;
+    LogOverflowPolicy overflow_policy = LogOverflowPolicy::kDrop;
+    /// one of every sample_interval records is staged under the kSample policy
+    uint32_t sample_interval = 10;
+  };
+
+  struct Stats {
+    /// the number of staged records
+    uint64_t staged = 0;
+    /// the number of records dropped because the rings were full
+    uint64_t dropped = 0;
+    /// the number of records not staged by the kSample policy
+    uint64_t sampled_out = 0;
+  };
+
+  LogStaging(Options options, EmitFunc emit_func);
+
+  ~LogStaging();
+
+  /// @brief Starts the drainer thread.
+  void Start();
+
+  /// @brief Stops the drainer thread, and emits the staged records for the last time.
+  void Stop();
+
+  /// @brief Stages a record into the ring of the calling thread.
+  /// @param fill the function which fills the record in place, the fields keep the values of a drained record
+  /// @return Return true if the record is staged, false if it is dropped by the overflow policy.
+  /// @note The ring of a thread is created on its first call, and the call must not switch the thread in between,
+  ///       which holds for fibers as nothing here yields.
+  template <typename FillFunc>
+  bool Stage(FillFunc&& fill) {
+    ThreadRing* ring = GetThreadRing();
+    if (options_.overflow_policy == LogOverflowPolicy::kSample) {
+      size_t size = ring->ring.Size();
+      if (size >= ring->ring.Capacity() / 2 && ++ring->sample_count % options_.sample_interval != 0) {
+        AddCount(ring->sampled_out);
+        return false;
+      }
+    }
+    if (!ring->ring.TryPush(std::forward<FillFunc>(fill))) {
+      AddCount(ring->dropped);
+      return false;
+    }
+    AddCount(ring->staged);
+    if (ring->ring.Size() == ring->ring.Capacity() / 2) {
+      // wakes the drainer without the lock, which may be missed and then the drainer wakes on its interval
+      drain_requested_.store(true, std::memory_order_relaxed);
+      cond_.notify_one();
+    }
+    return true;
+  }
+
+  /// @brief Emits the staged records of all the threads once in the calling thread.
+  /// @return Return the number of emitted records.
+  size_t Drain();
+
+  Stats GetStats() const;
+
+ private:
+  // The ring of a thread, whose counters are only written by the thread
+  struct ThreadRing {
+    explicit ThreadRing(size_t capacity) : ring(capacity) {}
+
+    LogStagingRing ring;
+    uint32_t sample_count = 0;
+    std::atomic<uint64_t> staged{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> sampled_out{0};
+  };
+
+  // Only the owning thread writes the counter, so it does not need an atomic read-modify-write
+  static void AddCount(std::atomic<uint64_t>& count) {
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  ThreadRing* GetThreadRing();
+
+  ThreadRing* CreateThreadRing();
+
+  void Run();
+
+ private:
+  const Options options_;
+
+  EmitFunc emit_func_;
+
+  // unique in the process, which identifies the rings of this instance in the thread local caches
+  const uint64_t id_;
+
+  mutable std::mutex rings_mutex_;
+  std::vector<std::unique_ptr<ThreadRing>> rings_;
+
+  // serializes the drains of the drainer thread and the callers of Drain
+  std::mutex drain_mutex_;
+  // the rings to drain, reused by the drains
+  std::vector<ThreadRing*> drain_rings_;
+  // the dropped records last reported
+  uint64_t reported_dropped_ = 0;
+
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  bool stopped_ = false;
+  // set by the producers whose rings become half full
+  std::atomic<bool> drain_requested_{false};
+  std::thread thread_;
+};
+
+}  // namespace trpc::opentelemetry
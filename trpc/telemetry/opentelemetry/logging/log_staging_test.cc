@@ -0,0 +1,127 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#include "trpc/telemetry/opentelemetry/logging/log_staging.h"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace trpc::testing {
+
+using trpc::opentelemetry::LogOverflowPolicy;
+using trpc::opentelemetry::LogStaging;
+using trpc::opentelemetry::LogStagingRing;
+using trpc::opentelemetry::StagedLogRecord;
+
+TEST(LogStagingRingTest, PushAndDrain) {
+  LogStagingRing ring(3);
+  ASSERT_EQ(4, ring.Capacity());
+
+  std::vector<int> lines;
+  auto visitor = [&lines](StagedLogRecord& record) { lines.push_back(record.line); };
+  // wraps around the ring several times
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < 4; ++i) {
+      ASSERT_TRUE(ring.TryPush([i](StagedLogRecord& record) { record.line = i; }));
+    }
+    ASSERT_FALSE(ring.TryPush([](StagedLogRecord& record) {}));
+    ASSERT_EQ(4, ring.Size());
+
+    ASSERT_EQ(2, ring.Drain(visitor, 2));
+    ASSERT_EQ(2, ring.Drain(visitor, 10));
+    ASSERT_EQ(0, ring.Size());
+  }
+  ASSERT_EQ(12, lines.size());
+  ASSERT_EQ(3, lines[11]);
+}
+
+TEST(LogStagingTest, Drop) {
+  std::vector<std::string> msgs;
+  LogStaging::Options options;
+  options.ring_size = 4;
+  LogStaging staging(options, [&msgs](StagedLogRecord& record) { msgs.push_back(record.msg); });
+
+  for (int i = 0; i < 6; ++i) {
+    bool staged = staging.Stage([i](StagedLogRecord& record) { record.msg = std::to_string(i); });
+    ASSERT_EQ(i < 4, staged);
+  }
+  ASSERT_EQ(4, staging.Drain());
+  ASSERT_EQ((std::vector<std::string>{"0", "1", "2", "3"}), msgs);
+
+  auto stats = staging.GetStats();
+  ASSERT_EQ(4, stats.staged);
+  ASSERT_EQ(2, stats.dropped);
+  ASSERT_EQ(0, stats.sampled_out);
+}
+
+TEST(LogStagingTest, Sample) {
+  LogStaging::Options options;
+  options.ring_size = 8;
+  options.overflow_policy = LogOverflowPolicy::kSample;
+  options.sample_interval = 2;
+  LogStaging staging(options, [](StagedLogRecord& record) {});
+
+  for (int i = 0; i < 8; ++i) {
+    staging.Stage([](StagedLogRecord& record) {});
+  }
+  // the first 4 records fill the ring to half, then one of every 2 records is staged
+  auto stats = staging.GetStats();
+  ASSERT_EQ(6, stats.staged);
+  ASSERT_EQ(0, stats.dropped);
+  ASSERT_EQ(2, stats.sampled_out);
+  ASSERT_EQ(6, staging.Drain());
+}
+
+TEST(LogStagingTest, MultiThread) {
+  constexpr int kThreadNum = 4;
+  constexpr int kRecordNum = 10000;
+
+  std::atomic<int> emitted{0};
+  LogStaging::Options options;
+  options.ring_size = 256;
+  options.drain_interval_ms = 1;
+  LogStaging staging(options, [&emitted](StagedLogRecord& record) {
+    ASSERT_EQ(record.line, std::stoi(record.msg));
+    emitted.fetch_add(1, std::memory_order_relaxed);
+  });
+  staging.Start();
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadNum; ++i) {
+    threads.emplace_back([&staging]() {
+      for (int j = 0; j < kRecordNum; ++j) {
+        while (!staging.Stage([j](StagedLogRecord& record) {
+          record.line = j;
+          record.msg = std::to_string(j);
+        })) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  staging.Stop();
+
+  // the records staged after the last drain are emitted by Stop
+  ASSERT_EQ(kThreadNum * kRecordNum, emitted.load());
+  ASSERT_EQ(kThreadNum * kRecordNum, staging.GetStats().staged);
+}
+
+}  // namespace trpc::testing
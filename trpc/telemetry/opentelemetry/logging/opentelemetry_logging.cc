@@ -14,19 +14,69 @@
 #ifdef ENABLE_LOGS_PREVIEW
 #include "trpc/telemetry/opentelemetry/logging/opentelemetry_logging.h"
 
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "fmt/format.h"
 #include "opentelemetry/exporters/otlp/otlp_http_log_record_exporter.h"
 #include "opentelemetry/logs/provider.h"
 #include "opentelemetry/sdk/logs/batch_log_record_processor.h"
 #include "opentelemetry/sdk/logs/logger_provider_factory.h"
 #include "trpc/common/config/trpc_config.h"
+#include "trpc/runtime/common/periphery_task_scheduler.h"
 
 #include "trpc/telemetry/opentelemetry/logging/common.h"
 #include "trpc/telemetry/opentelemetry/logging/grpc_log_exporter.h"
+#include "trpc/telemetry/opentelemetry/logging/log_call_site.h"
 #include "trpc/telemetry/opentelemetry/opentelemetry_telemetry_conf_parser.h"
+#include "trpc/telemetry/opentelemetry/tracing/hex_id.h"
 #include "trpc/telemetry/opentelemetry/tracing/opentelemetry_tracing_api.h"
 
 namespace trpc {
 
+namespace {
+
+// The opentelemetry log levels indexed by the framework log levels
+constexpr std::array<::opentelemetry::logs::Severity, Log::Level::critical + 1> kLevelSeverities = [] {
+  std::array<::opentelemetry::logs::Severity, Log::Level::critical + 1> severities{};
+  severities[Log::Level::trace] = ::opentelemetry::logs::Severity::kTrace;
+  severities[Log::Level::debug] = ::opentelemetry::logs::Severity::kDebug;
+  severities[Log::Level::info] = ::opentelemetry::logs::Severity::kInfo;
+  severities[Log::Level::warn] = ::opentelemetry::logs::Severity::kWarn;
+  severities[Log::Level::error] = ::opentelemetry::logs::Severity::kError;
+  severities[Log::Level::critical] = ::opentelemetry::logs::Severity::kFatal;
+  return severities;
+}();
+
+// Gets the key of the logs buffered for a trace, which are decided together by its local root span. The last 8 bytes
+// are taken, as the first 4 bytes may be the time prefix of the trace id
+uint64_t GetTailBufferKey(const ::opentelemetry::trace::TraceId& trace_id) {
+  uint64_t key = 0;
+  std::memcpy(&key, trace_id.Id().data() + ::opentelemetry::trace::TraceId::kSize - sizeof(key), sizeof(key));
+  return key;
+}
+
+// The interval of discarding the expired requests of the tail buffer, in milliseconds
+constexpr uint32_t kTailBufferEvictIntervalMs = 1000;
+
+uint64_t GetSteadyMilliseconds() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Views a trace id kept in a summary of the suppressed logs
+::opentelemetry::nostd::span<const uint8_t, ::opentelemetry::trace::TraceId::kSize> ToTraceIdSpan(
+    const std::array<uint8_t, ::opentelemetry::trace::TraceId::kSize>& trace_id) {
+  return ::opentelemetry::nostd::span<const uint8_t, ::opentelemetry::trace::TraceId::kSize>(trace_id.data(),
+                                                                                            trace_id.size());
+}
+
+}  // namespace
+
 int OpenTelemetryLogging::Init() noexcept {
   bool ret = TrpcConfig::GetInstance()->GetPluginConfig("telemetry", trpc::opentelemetry::kOpenTelemetryTelemetryName,
                                                         config_);
@@ -40,11 +90,85 @@ int OpenTelemetryLogging::Init() noexcept {
     return -1;
   }
 
-  InitLogLevelMapping();
+  InitStaging();
+
+  InitTailBuffer();
+
+  InitRateLimiter();
 
   return 0;
 }
 
+void OpenTelemetryLogging::Start() noexcept {
+  if (staging_) {
+    staging_->Start();
+  }
+  if (rate_limiter_ && summary_task_id_ == 0) {
+    summary_task_id_ = PeripheryTaskScheduler::GetInstance()->SubmitPeriodicalTask(
+        [this]() { EmitRateLimitSummaries(); }, config_.logs_config.rate_limit_summary_interval,
+        "OpenTelemetryEmitLogSummaries");
+  }
+  if (tail_buffer_ && tail_evict_task_id_ == 0) {
+    tail_evict_task_id_ = PeripheryTaskScheduler::GetInstance()->SubmitPeriodicalTask(
+        [this]() { tail_buffer_->EvictExpired(GetSteadyMilliseconds()); }, kTailBufferEvictIntervalMs,
+        "OpenTelemetryEvictTailLogs");
+  }
+}
+
+void OpenTelemetryLogging::Stop() noexcept {
+  if (summary_task_id_ != 0) {
+    PeripheryTaskScheduler::GetInstance()->RemoveTask(summary_task_id_);
+    summary_task_id_ = 0;
+    // reports the log records suppressed since the last summary
+    EmitRateLimitSummaries();
+  }
+  if (tail_evict_task_id_ != 0) {
+    PeripheryTaskScheduler::GetInstance()->RemoveTask(tail_evict_task_id_);
+    tail_evict_task_id_ = 0;
+  }
+  if (staging_) {
+    staging_->Stop();
+  }
+}
+
+void OpenTelemetryLogging::InitStaging() {
+  const auto& logs_config = config_.logs_config;
+  if (!logs_config.staging_enabled) {
+    return;
+  }
+
+  trpc::opentelemetry::LogStaging::Options options;
+  options.ring_size = logs_config.staging_ring_size;
+  options.drain_interval_ms = logs_config.staging_drain_interval;
+  options.sample_interval = logs_config.staging_sample_interval > 0 ? logs_config.staging_sample_interval : 1;
+  if (logs_config.staging_overflow_policy == "sample") {
+    options.overflow_policy = trpc::opentelemetry::LogOverflowPolicy::kSample;
+  } else if (logs_config.staging_overflow_policy != "drop") {
+    TRPC_FMT_WARN("unknown staging_overflow_policy: {}, use drop instead", logs_config.staging_overflow_policy);
+  }
+  staging_ = std::make_unique<trpc::opentelemetry::LogStaging>(
+      options, [this](trpc::opentelemetry::StagedLogRecord& record) { EmitStagedLogRecord(record); });
+}
+
+trpc::opentelemetry::LogStaging::Stats OpenTelemetryLogging::GetStagingStats() const {
+  if (staging_) {
+    return staging_->GetStats();
+  }
+  return trpc::opentelemetry::LogStaging::Stats();
+}
+
+void OpenTelemetryLogging::EmitStagedLogRecord(trpc::opentelemetry::StagedLogRecord& record) {
+  const auto& call_site = trpc::opentelemetry::GetLogCallSite(record.filename, record.line, record.funcname);
+  // the attributes refer to the interned strings of the call site instead of copying them
+  logger_->EmitLogRecord(static_cast<::opentelemetry::logs::Severity>(record.severity), record.msg.c_str(),
+                         ::opentelemetry::common::MakeAttributes(
+                             {{trpc::opentelemetry::kLogLineName, call_site.location.c_str()},
+                              {trpc::opentelemetry::kLogFunctionName, call_site.function.c_str()}}),
+                         ::opentelemetry::trace::TraceId(record.trace_id),
+                         ::opentelemetry::trace::SpanId(record.span_id),
+                         ::opentelemetry::trace::TraceFlags(record.trace_flags), record.timestamp);
+}
+
 bool OpenTelemetryLogging::InitOpenTelemetry() {
   // initializes exporter
   auto exporter = GetExporter();
@@ -78,6 +202,108 @@ bool OpenTelemetryLogging::InitOpenTelemetry() {
   return true;
 }
 
+void OpenTelemetryLogging::InitTailBuffer() {
+  const auto& logs_config = config_.logs_config;
+  if (!logs_config.tail_buffer_enabled) {
+    return;
+  }
+  if (!logs_config.enable_sampler || !config_.traces_config.enable_deferred_sample) {
+    TRPC_FMT_WARN("tail_buffer_enabled only works when enable_sampler and enable_deferred_sample are true");
+    return;
+  }
+
+  trpc::opentelemetry::TailLogBuffer::Options options;
+  options.max_bytes_per_request = logs_config.tail_buffer_max_bytes;
+  options.max_requests = logs_config.tail_buffer_max_requests;
+  options.ttl_ms = logs_config.tail_buffer_ttl;
+  tail_buffer_ = std::make_unique<trpc::opentelemetry::TailLogBuffer>(options);
+}
+
+void OpenTelemetryLogging::OnDeferredSampled(const ::opentelemetry::trace::TraceId& trace_id,
+                                             const ::opentelemetry::trace::SpanId& span_id, bool sampled) {
+  if (!tail_buffer_) {
+    return;
+  }
+
+  // the logs of the child spans, such as the scoped spans and the client spans, are buffered with the trace, so they
+  // are decided together when the local root span ends
+  uint64_t key = GetTailBufferKey(trace_id);
+  if (!sampled) {
+    tail_buffer_->Discard(key);
+    return;
+  }
+
+  // the logs are reported as sampled ones, as the span is kept
+  ::opentelemetry::trace::TraceFlags trace_flags(::opentelemetry::trace::TraceFlags::kIsSampled);
+  tail_buffer_->Flush(key, [&](const trpc::opentelemetry::TailLogRecord& record, std::string_view msg) {
+    const auto& call_site = trpc::opentelemetry::GetLogCallSite(record.filename, record.line, record.funcname);
+    logger_->EmitLogRecord(static_cast<::opentelemetry::logs::Severity>(record.severity),
+                           ::opentelemetry::nostd::string_view(msg.data(), msg.size()),
+                           ::opentelemetry::common::MakeAttributes(
+                               {{trpc::opentelemetry::kLogLineName, call_site.location.c_str()},
+                                {trpc::opentelemetry::kLogFunctionName, call_site.function.c_str()}}),
+                           trace_id, ::opentelemetry::trace::SpanId(record.span_id), trace_flags, record.timestamp);
+  });
+}
+
+trpc::opentelemetry::TailLogBuffer::Stats OpenTelemetryLogging::GetTailBufferStats() const {
+  if (tail_buffer_) {
+    return tail_buffer_->GetStats();
+  }
+  return trpc::opentelemetry::TailLogBuffer::Stats();
+}
+
+void OpenTelemetryLogging::InitRateLimiter() {
+  const auto& logs_config = config_.logs_config;
+  if (!logs_config.rate_limit_enabled) {
+    return;
+  }
+
+  trpc::opentelemetry::LogRateLimiter::Options options;
+  options.rate = logs_config.rate_limit_per_second;
+  options.burst = logs_config.rate_limit_burst;
+  rate_limiter_ = std::make_unique<trpc::opentelemetry::LogRateLimiter>(options);
+}
+
+void OpenTelemetryLogging::EmitRateLimitSummaries() {
+  // collects the summaries first, so that no site is locked while emitting
+  std::vector<std::pair<const trpc::opentelemetry::LogCallSite*, trpc::opentelemetry::LogRateLimiter::Summary>>
+      summaries;
+  trpc::opentelemetry::ForEachLogCallSite([&summaries](const trpc::opentelemetry::LogCallSite& call_site) {
+    trpc::opentelemetry::LogRateLimiter::Summary summary;
+    if (trpc::opentelemetry::LogRateLimiter::TakeSummary(call_site.rate_limit_state, summary)) {
+      summaries.emplace_back(&call_site, summary);
+    }
+  });
+
+  for (const auto& [call_site, summary] : summaries) {
+    // the summary is linked to the trace of the first example, and to no trace if none of the suppressed logs has a
+    // span
+    ::opentelemetry::trace::TraceId trace_id;
+    ::opentelemetry::trace::TraceFlags trace_flags;
+    if (summary.example_num > 0) {
+      trace_id = ::opentelemetry::trace::TraceId(ToTraceIdSpan(summary.example_trace_ids[0]));
+      trace_flags = ::opentelemetry::trace::TraceFlags(::opentelemetry::trace::TraceFlags::kIsSampled);
+    }
+    std::string examples;
+    for (size_t i = 0; i < summary.example_num; ++i) {
+      if (i > 0) {
+        examples.append(",");
+      }
+      ::opentelemetry::trace::TraceId example(ToTraceIdSpan(summary.example_trace_ids[i]));
+      examples.append(trpc::opentelemetry::TraceIdHex(example).View());
+    }
+    std::string msg = fmt::format("suppressed {} similar logs", summary.suppressed);
+    logger_->EmitLogRecord(static_cast<::opentelemetry::logs::Severity>(summary.severity), msg.c_str(),
+                           ::opentelemetry::common::MakeAttributes(
+                               {{trpc::opentelemetry::kLogLineName, call_site->location.c_str()},
+                                {trpc::opentelemetry::kLogFunctionName, call_site->function.c_str()},
+                                {trpc::opentelemetry::kLogSuppressedName, static_cast<int64_t>(summary.suppressed)},
+                                {trpc::opentelemetry::kLogExampleTraceIdsName, examples.c_str()}}),
+                           trace_id, ::opentelemetry::trace::SpanId(), trace_flags, std::chrono::system_clock::now());
+  }
+}
+
 std::unique_ptr<::opentelemetry::sdk::logs::LogRecordExporter> OpenTelemetryLogging::GetExporter() {
   if (config_.protocol == "http") {
     ::opentelemetry::exporter::otlp::OtlpHttpLogRecordExporterOptions logger_opts;
@@ -95,54 +321,85 @@ std::unique_ptr<::opentelemetry::sdk::logs::LogRecordExporter> OpenTelemetryLogg
   return nullptr;
 }
 
-void OpenTelemetryLogging::InitLogLevelMapping() {
-  level_serverity_mapping_[Log::Level::trace] = ::opentelemetry::logs::Severity::kTrace;
-  level_serverity_mapping_[Log::Level::debug] = ::opentelemetry::logs::Severity::kDebug;
-  level_serverity_mapping_[Log::Level::info] = ::opentelemetry::logs::Severity::kInfo;
-  level_serverity_mapping_[Log::Level::warn] = ::opentelemetry::logs::Severity::kWarn;
-  level_serverity_mapping_[Log::Level::error] = ::opentelemetry::logs::Severity::kError;
-  level_serverity_mapping_[Log::Level::critical] = ::opentelemetry::logs::Severity::kFatal;
-}
-
 void OpenTelemetryLogging::Log(const Log::Level level, const char* filename_in, int line_in, const char* funcname_in,
                                std::string_view msg, const std::unordered_map<uint32_t, std::any>& extend_fields_msg) {
-  auto* server_tracing_span = GetServerTracingSpan(extend_fields_msg);
-  if (!server_tracing_span) {
-    return;
+  // the span of the server context is not copied, as it is only used during the call
+  const auto* span = trpc::opentelemetry::GetTracingSpanPtr(extend_fields_msg);
+  trpc::opentelemetry::OpenTelemetryTracingSpanPtr current_span;
+  if (!span) {
+    // the logs out of the server contexts, such as the ones of the background tasks, are linked to the current span
+    current_span = trpc::opentelemetry::GetCurrentSpan();
+    if (current_span) {
+      span = &current_span;
+    }
   }
 
-  if (server_tracing_span->span.type() != typeid(trpc::opentelemetry::OpenTelemetryTracingSpanPtr) ||
-      std::any_cast<const trpc::opentelemetry::OpenTelemetryTracingSpanPtr&>(server_tracing_span->span).get() ==
-          nullptr) {
+  // the logs without span are still reported, as there is no sampling decision to follow
+  auto span_ctx = span ? (*span)->GetContext() : ::opentelemetry::trace::SpanContext::GetInvalid();
+  if (span && !ShouldReport(level, span_ctx.IsSampled())) {
+    // buffers the logs of the trace not sampled yet, until deferred sampling decides whether to keep it when its local
+    // root span ends
+    if (tail_buffer_ && (*span)->IsRecording()) {
+      trpc::opentelemetry::TailLogRecord record;
+      record.severity = static_cast<uint8_t>(GetOpenTelemetryLogLevel(level));
+      record.filename = filename_in;
+      record.line = line_in;
+      record.funcname = funcname_in;
+      record.timestamp = std::chrono::system_clock::now();
+      span_ctx.span_id().CopyBytesTo(record.span_id);
+      tail_buffer_->Append(GetTailBufferKey(span_ctx.trace_id()), record, msg, GetSteadyMilliseconds());
+    }
     return;
   }
-  const auto span = std::any_cast<const trpc::opentelemetry::OpenTelemetryTracingSpanPtr&>(server_tracing_span->span);
 
-  auto span_ctx = span->GetContext();
-  if (ShouldReport(level, span_ctx.IsSampled())) {
-    std::string line = std::string(filename_in) + ":" + std::to_string(line_in);
-    logger_->EmitLogRecord(GetOpenTelemetryLogLevel(level), msg.data(),
-                           ::opentelemetry::common::MakeAttributes({{"line", std::move(line)}}), span_ctx.trace_id(),
-                           span_ctx.span_id(), span_ctx.trace_flags(), std::chrono::system_clock::now());
+  const trpc::opentelemetry::LogCallSite* call_site = nullptr;
+  if (rate_limiter_) {
+    // the log records beyond the rate of the call site are folded into its next summary
+    call_site = &trpc::opentelemetry::GetLogCallSite(filename_in, line_in, funcname_in);
+    uint8_t trace_id[16];
+    span_ctx.trace_id().CopyBytesTo(trace_id);
+    int64_t now_ns =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    if (!rate_limiter_->Allow(call_site->rate_limit_state, static_cast<uint8_t>(GetOpenTelemetryLogLevel(level)),
+                              trace_id, now_ns)) {
+      return;
+    }
   }
-}
 
-const ServerTracingSpan* OpenTelemetryLogging::GetServerTracingSpan(
-    const std::unordered_map<uint32_t, std::any>& extend_fields_msg) {
-  uint32_t filter_index = trpc::opentelemetry::GetTracingFilterDataIndex();
-  if (filter_index == trpc::opentelemetry::kInvalidTracingFilterDataIndex) {
-    return nullptr;
+  if (staging_) {
+    // copies the record into the ring of this thread, which is formatted and exported by the drainer. The names of
+    // the call site are not copied as they are __FILE__ and __FUNCTION__
+    staging_->Stage([&](trpc::opentelemetry::StagedLogRecord& record) {
+      record.severity = static_cast<uint8_t>(GetOpenTelemetryLogLevel(level));
+      record.filename = filename_in;
+      record.line = line_in;
+      record.funcname = funcname_in;
+      record.msg.assign(msg.data(), msg.size());
+      span_ctx.trace_id().CopyBytesTo(record.trace_id);
+      span_ctx.span_id().CopyBytesTo(record.span_id);
+      record.trace_flags = span_ctx.trace_flags().flags();
+      record.timestamp = std::chrono::system_clock::now();
+    });
+    return;
   }
-  auto it = extend_fields_msg.find(filter_index);
-  if (it == extend_fields_msg.end()) {
-    return nullptr;
+
+  if (!call_site) {
+    call_site = &trpc::opentelemetry::GetLogCallSite(filename_in, line_in, funcname_in);
   }
-  return std::any_cast<ServerTracingSpan>(&(it->second));
+  // the attributes refer to the interned strings of the call site instead of copying them
+  logger_->EmitLogRecord(GetOpenTelemetryLogLevel(level), msg.data(),
+                         ::opentelemetry::common::MakeAttributes(
+                             {{trpc::opentelemetry::kLogLineName, call_site->location.c_str()},
+                              {trpc::opentelemetry::kLogFunctionName, call_site->function.c_str()}}),
+                         span_ctx.trace_id(), span_ctx.span_id(), span_ctx.trace_flags(),
+                         std::chrono::system_clock::now());
 }
 
 ::opentelemetry::logs::Severity OpenTelemetryLogging::GetOpenTelemetryLogLevel(Log::Level trpc_log_level) {
-  if (level_serverity_mapping_.find(trpc_log_level) != level_serverity_mapping_.end()) {
-    return level_serverity_mapping_[trpc_log_level];
+  size_t index = static_cast<size_t>(trpc_log_level);
+  if (index < kLevelSeverities.size()) {
+    return kLevelSeverities[index];
   }
   return ::opentelemetry::logs::Severity::kError;
 }
@@ -14,6 +14,7 @@
 #ifdef ENABLE_LOGS_PREVIEW
 #pragma once
 
+#include <memory>
 #include <unordered_map>
 
 #include "opentelemetry/logs/logger.h"
@@ -21,6 +22,9 @@
 #include "trpc/log/logging.h"
 #include "trpc/tracing/tracing_filter_index.h"
 
+#include "trpc/telemetry/opentelemetry/logging/log_rate_limiter.h"
+#include "trpc/telemetry/opentelemetry/logging/log_staging.h"
+#include "trpc/telemetry/opentelemetry/logging/tail_log_buffer.h"
 #include "trpc/telemetry/opentelemetry/opentelemetry_common.h"
 #include "trpc/telemetry/opentelemetry/opentelemetry_telemetry_conf.h"
 
@@ -35,34 +39,79 @@ class OpenTelemetryLogging : public Logging {
 
   int Init() noexcept override;
 
+  /// @brief Starts the drainer of the staged log records if staging is enabled, the summaries of the suppressed log
+  ///        records if rate limiting is enabled, and the eviction of the expired buffered logs if the tail buffer is
+  ///        enabled.
+  void Start() noexcept override;
+
+  /// @brief Stops the drainer, the summaries and the eviction, and emits the staged log records and the summaries for
+  ///        the last time.
+  void Stop() noexcept override;
+
   void Log(const Log::Level level, const char* filename_in, int line_in, const char* funcname_in, std::string_view msg,
            const std::unordered_map<uint32_t, std::any>& extend_fields_msg) override;
 
+  /// @brief Gets the counters of the staged log records, which are all 0 if staging is disabled.
+  trpc::opentelemetry::LogStaging::Stats GetStagingStats() const;
+
+  /// @brief Flushes the logs buffered for a trace if deferred sampling keeps its local root span, or discards them
+  ///        otherwise. The logs of the child spans are buffered with the trace, so they are decided together. It is
+  ///        registered as the listener of deferred sampling when logs:tail_buffer_enabled is true.
+  /// @param trace_id the trace id of the local root span
+  /// @param span_id the span id of the local root span
+  /// @param sampled whether the local root span is kept
+  void OnDeferredSampled(const ::opentelemetry::trace::TraceId& trace_id, const ::opentelemetry::trace::SpanId& span_id,
+                         bool sampled);
+
+  /// @brief Gets the counters of the buffered logs, which are all 0 if the tail buffer is disabled.
+  trpc::opentelemetry::TailLogBuffer::Stats GetTailBufferStats() const;
+
  private:
   std::unique_ptr<::opentelemetry::sdk::logs::LogRecordExporter> GetExporter();
 
   bool InitOpenTelemetry();
 
-  // Gets the ServerTracingSpan from extend_fields_msg
-  const ServerTracingSpan* GetServerTracingSpan(const std::unordered_map<uint32_t, std::any>& extend_fields_msg);
-
-  // Initializes level_serverity_mapping_
-  void InitLogLevelMapping();
-
   // Gets the opentelemetry log level
-  ::opentelemetry::logs::Severity GetOpenTelemetryLogLevel(Log::Level trpc_log_level);
+  static ::opentelemetry::logs::Severity GetOpenTelemetryLogLevel(Log::Level trpc_log_level);
 
   // Checks if reporting is necessary
   bool ShouldReport(Log::Level level, bool is_sample);
 
+  // Creates staging_ if staging is enabled
+  void InitStaging();
+
+  // Emits a log record drained from staging_
+  void EmitStagedLogRecord(trpc::opentelemetry::StagedLogRecord& record);
+
+  // Creates tail_buffer_ if the tail buffer is enabled
+  void InitTailBuffer();
+
+  // Creates rate_limiter_ if rate limiting is enabled
+  void InitRateLimiter();
+
+  // Emits a summary record for each call site whose log records are suppressed since the last summary
+  void EmitRateLimitSummaries();
+
  private:
   OpenTelemetryConfig config_;
 
-  // a map of framework log levels to opentelemetry log levels.
-  std::unordered_map<Log::Level, ::opentelemetry::logs::Severity> level_serverity_mapping_;
-
   // opentelemetry logger
   ::opentelemetry::nostd::shared_ptr<::opentelemetry::logs::Logger> logger_;
+
+  // the staging of the log records, which is declared after logger_ as it emits the records into logger_ when it is
+  // destroyed
+  std::unique_ptr<trpc::opentelemetry::LogStaging> staging_;
+
+  // the logs of the traces not sampled yet, which are keyed by the trace id
+  std::unique_ptr<trpc::opentelemetry::TailLogBuffer> tail_buffer_;
+
+  // limits the log records of each call site
+  std::unique_ptr<trpc::opentelemetry::LogRateLimiter> rate_limiter_;
+
+  uint64_t summary_task_id_ = 0;
+
+  // discards the buffered logs of the traces which are never decided
+  uint64_t tail_evict_task_id_ = 0;
 };
 
 using OpenTelemetryLoggingPtr = RefPtr<OpenTelemetryLogging>;
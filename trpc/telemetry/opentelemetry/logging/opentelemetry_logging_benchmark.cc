@@ -0,0 +1,146 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#ifdef ENABLE_LOGS_PREVIEW
+#include <any>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "benchmark/benchmark.h"
+#include "opentelemetry/trace/noop.h"
+#include "trpc/common/config/trpc_config.h"
+#include "trpc/telemetry/telemetry.h"
+#include "trpc/telemetry/telemetry_factory.h"
+#include "trpc/tracing/tracing_filter_index.h"
+
+#include "trpc/telemetry/opentelemetry/logging/log_rate_limiter.h"
+#include "trpc/telemetry/opentelemetry/logging/log_staging.h"
+#include "trpc/telemetry/opentelemetry/logging/opentelemetry_logging.h"
+#include "trpc/telemetry/opentelemetry/opentelemetry_common.h"
+#include "trpc/telemetry/opentelemetry/tracing/opentelemetry_tracing.h"
+#include "trpc/telemetry/opentelemetry/tracing/opentelemetry_tracing_api.h"
+
+namespace {
+
+class BenchmarkTelemetry : public trpc::Telemetry {
+ public:
+  explicit BenchmarkTelemetry(trpc::TracingPtr tracing) : tracing_(std::move(tracing)) {}
+
+  std::string Name() const override { return trpc::opentelemetry::kOpenTelemetryTelemetryName; }
+
+  trpc::TracingPtr GetTracing() override { return tracing_; }
+
+  trpc::MetricsPtr GetMetrics() override { return nullptr; }
+
+  trpc::LoggingPtr GetLog() override { return nullptr; }
+
+ private:
+  trpc::TracingPtr tracing_;
+};
+
+struct Plugins {
+  trpc::OpenTelemetryTracingPtr tracing;
+  trpc::OpenTelemetryLoggingPtr logging;
+};
+
+const Plugins& GetPlugins() {
+  static Plugins plugins = [] {
+    trpc::TrpcConfig::GetInstance()->Init("./trpc/telemetry/opentelemetry/testing/opentelemetry_telemetry_test.yaml");
+    Plugins plugins;
+    plugins.tracing = trpc::MakeRefCounted<trpc::OpenTelemetryTracing>();
+    plugins.tracing->Init();
+    trpc::TelemetryFactory::GetInstance()->Register(trpc::MakeRefCounted<BenchmarkTelemetry>(plugins.tracing));
+    plugins.logging = trpc::MakeRefCounted<trpc::OpenTelemetryLogging>();
+    plugins.logging->Init();
+    return plugins;
+  }();
+  return plugins;
+}
+
+// Makes the filter data carried by the log records of a call, whose span is sampled or not
+std::unordered_map<uint32_t, std::any> MakeFilterData(bool sampled) {
+  constexpr uint8_t buf_span[] = {1, 2, 3, 4, 5, 6, 7, 8};
+  constexpr uint8_t buf_trace[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+  auto span_context = std::make_unique<::opentelemetry::trace::SpanContext>(
+      ::opentelemetry::trace::TraceId(buf_trace), ::opentelemetry::trace::SpanId(buf_span),
+      ::opentelemetry::trace::TraceFlags(sampled), false);
+  trpc::ServerTracingSpan server_span;
+  server_span.span = trpc::opentelemetry::OpenTelemetryTracingSpanPtr(
+      new ::opentelemetry::trace::NoopSpan(nullptr, std::move(span_context)));
+  return {{GetPlugins().tracing->GetPluginID(), std::move(server_span)}};
+}
+
+// The log lines of the unsampled calls, which are dropped by the sampler after the span is found
+void BM_LogNotSampled(benchmark::State& state) {
+  const auto& plugins = GetPlugins();
+  auto filter_data = MakeFilterData(false);
+  for (auto _ : state) {
+    plugins.logging->Log(trpc::Log::Level::info, __FILE__, __LINE__, __FUNCTION__, "benchmark message", filter_data);
+  }
+}
+
+// The log lines of the sampled calls, which are emitted into the batch processor
+void BM_LogSampled(benchmark::State& state) {
+  const auto& plugins = GetPlugins();
+  auto filter_data = MakeFilterData(true);
+  for (auto _ : state) {
+    plugins.logging->Log(trpc::Log::Level::info, __FILE__, __LINE__, __FUNCTION__, "benchmark message", filter_data);
+  }
+}
+
+// The log lines of the sampled calls which are staged, compared with BM_LogSampled. The records are dropped once the
+// ring is full, so the drainer emits nothing to keep up with the benchmark loop.
+void BM_LogStaged(benchmark::State& state) {
+  trpc::opentelemetry::LogStaging staging({}, [](trpc::opentelemetry::StagedLogRecord& record) {});
+  staging.Start();
+  auto filter_data = MakeFilterData(true);
+  auto span_ctx = (*trpc::opentelemetry::GetTracingSpanPtr(filter_data))->GetContext();
+  for (auto _ : state) {
+    staging.Stage([&span_ctx](trpc::opentelemetry::StagedLogRecord& record) {
+      record.severity = static_cast<uint8_t>(::opentelemetry::logs::Severity::kInfo);
+      record.filename = __FILE__;
+      record.line = __LINE__;
+      record.funcname = __FUNCTION__;
+      record.msg.assign("benchmark message");
+      span_ctx.trace_id().CopyBytesTo(record.trace_id);
+      span_ctx.span_id().CopyBytesTo(record.span_id);
+      record.trace_flags = span_ctx.trace_flags().flags();
+      record.timestamp = std::chrono::system_clock::now();
+    });
+  }
+  staging.Stop();
+}
+
+// The check of a call site which logs far beyond its rate, as in an outage of a dependency
+void BM_RateLimitSuppressed(benchmark::State& state) {
+  static trpc::opentelemetry::LogRateLimiter limiter(trpc::opentelemetry::LogRateLimiter::Options{});
+  static trpc::opentelemetry::LogRateLimiter::SiteState site_state;
+  uint8_t trace_id[16] = {1};
+  for (auto _ : state) {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    benchmark::DoNotOptimize(limiter.Allow(site_state, 17, trace_id, std::chrono::nanoseconds(now).count()));
+  }
+}
+
+}  // namespace
+
+BENCHMARK(BM_LogNotSampled);
+BENCHMARK(BM_LogSampled);
+BENCHMARK(BM_LogStaged);
+BENCHMARK(BM_RateLimitSuppressed)->Threads(1)->Threads(8);
+
+BENCHMARK_MAIN();
+#endif
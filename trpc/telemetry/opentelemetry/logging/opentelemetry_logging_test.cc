@@ -14,6 +14,8 @@
 #ifdef ENABLE_LOGS_PREVIEW
 #include "trpc/telemetry/opentelemetry/logging/opentelemetry_logging.h"
 
+#include <memory>
+
 #include "gtest/gtest.h"
 #include "opentelemetry/trace/noop.h"
 #include "trpc/common/config/trpc_config.h"
@@ -21,6 +23,7 @@
 
 #include "trpc/telemetry/opentelemetry/testing/mock_telemetry.h"
 #include "trpc/telemetry/opentelemetry/tracing/opentelemetry_tracing.h"
+#include "trpc/telemetry/opentelemetry/tracing/opentelemetry_tracing_api.h"
 
 namespace trpc::testing {
 
@@ -57,7 +60,7 @@ TEST_F(OpenTelemetryLoggingTest, Log) {
   TelemetryFactory::GetInstance()->Register(telemetry);
   EXPECT_CALL(*telemetry, GetTracing()).WillRepeatedly(::testing::Return(tracing));
 
-  // 2. log without extend_fields_msg
+  // 2. log without extend_fields_msg, which is reported without span
   logging_->Log(trpc::Log::Level::debug, "file", 1, "func", "msg", {{}});
 
   // 3. log with invalid span type
@@ -91,8 +94,70 @@ TEST_F(OpenTelemetryLoggingTest, Log) {
   ::opentelemetry::nostd::shared_ptr<::opentelemetry::trace::Span> sampled_span_ptr(
       new ::opentelemetry::trace::NoopSpan(nullptr, std::move(sample_context)));
   ServerTracingSpan sampled_server_span;
-  sampled_server_span.span = std::move(sampled_span_ptr);
+  sampled_server_span.span = sampled_span_ptr;
   logging_->Log(trpc::Log::Level::debug, "file", 1, "func", "msg", {{tracing->GetPluginID(), sampled_server_span}});
+
+  // 7. log out of the server context with the current span
+  {
+    auto scope = trpc::opentelemetry::WithCurrentSpan(sampled_span_ptr);
+    logging_->Log(trpc::Log::Level::debug, "file", 1, "func", "msg", {{}});
+  }
+
+  // 8. the records are emitted directly as staging is not enabled
+  ASSERT_EQ(0, logging_->GetStagingStats().staged);
+
+  // 9. the logs of the spans which are not recording are not buffered
+  logging_->OnDeferredSampled(trace_id, span_id, true);
+  ASSERT_EQ(0, logging_->GetTailBufferStats().buffered);
+}
+
+// A span which is recording but not sampled yet, whose sampling is deferred until it ends
+class DeferredSpan : public ::opentelemetry::trace::NoopSpan {
+ public:
+  DeferredSpan(const ::opentelemetry::trace::TraceId& trace_id, const ::opentelemetry::trace::SpanId& span_id)
+      : NoopSpan(nullptr, std::make_unique<::opentelemetry::trace::SpanContext>(
+                              trace_id, span_id, ::opentelemetry::trace::TraceFlags(false), false)) {}
+
+  bool IsRecording() const noexcept override { return true; }
+};
+
+TEST_F(OpenTelemetryLoggingTest, TailBufferNestedSpan) {
+  constexpr uint8_t buf_trace[] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1};
+  constexpr uint8_t buf_root_span[] = {1, 1, 1, 1, 1, 1, 1, 1};
+  constexpr uint8_t buf_child_span[] = {2, 2, 2, 2, 2, 2, 2, 2};
+  ::opentelemetry::trace::TraceId trace_id(buf_trace);
+  ::opentelemetry::trace::SpanId root_span_id(buf_root_span);
+  ServerTracingSpan server_span;
+  server_span.span = ::opentelemetry::nostd::shared_ptr<::opentelemetry::trace::Span>(
+      new DeferredSpan(trace_id, root_span_id));
+  ::opentelemetry::nostd::shared_ptr<::opentelemetry::trace::Span> child_span(
+      new DeferredSpan(trace_id, ::opentelemetry::trace::SpanId(buf_child_span)));
+  auto tracing_id = TelemetryFactory::GetInstance()
+                        ->Get(trpc::opentelemetry::kOpenTelemetryTelemetryName)
+                        ->GetTracing()
+                        ->GetPluginID();
+  auto stats = logging_->GetTailBufferStats();
+
+  // the logs of the server span and of its child span are buffered with the trace
+  logging_->Log(trpc::Log::Level::debug, "file", 1, "func", "msg", {{tracing_id, server_span}});
+  {
+    auto scope = trpc::opentelemetry::WithCurrentSpan(child_span);
+    logging_->Log(trpc::Log::Level::debug, "file", 2, "func", "msg", {{}});
+  }
+  ASSERT_EQ(stats.buffered + 2, logging_->GetTailBufferStats().buffered);
+
+  // both are flushed when the local root span is kept, even though the child span ended without being kept
+  logging_->OnDeferredSampled(trace_id, root_span_id, true);
+  ASSERT_EQ(stats.flushed + 2, logging_->GetTailBufferStats().flushed);
+
+  // both are discarded when the local root span is dropped
+  logging_->Log(trpc::Log::Level::debug, "file", 1, "func", "msg", {{tracing_id, server_span}});
+  {
+    auto scope = trpc::opentelemetry::WithCurrentSpan(child_span);
+    logging_->Log(trpc::Log::Level::debug, "file", 2, "func", "msg", {{}});
+  }
+  logging_->OnDeferredSampled(trace_id, root_span_id, false);
+  ASSERT_EQ(stats.discarded + 2, logging_->GetTailBufferStats().discarded);
 }
 
 }  // namespace trpc::testing
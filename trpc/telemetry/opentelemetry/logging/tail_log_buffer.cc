@@ -0,0 +1,130 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#include "trpc/telemetry/opentelemetry/logging/tail_log_buffer.h"
+
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+
+namespace trpc::opentelemetry {
+
+namespace {
+
+static_assert(std::is_trivially_destructible_v<TailLogRecord>, "discarding the records must not visit them");
+
+// The arena of a request is reserved with this size on its first log, which fits the logs of most requests
+constexpr size_t kInitialArenaSize = 1024;
+
+}  // namespace
+
+TailLogBuffer::TailLogBuffer(Options options) : options_(std::move(options)) {}
+
+bool TailLogBuffer::Append(uint64_t key, TailLogRecord record, std::string_view msg, uint64_t now_ms) {
+  auto& shard = GetShard(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = shard.requests.find(key);
+  if (it == shard.requests.end()) {
+    // makes room with the expired requests of the shard before dropping the log
+    if (size_.load(std::memory_order_relaxed) >= options_.max_requests &&
+        (EvictExpiredLocked(shard, now_ms) == 0 || size_.load(std::memory_order_relaxed) >= options_.max_requests)) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    it = shard.requests.try_emplace(key).first;
+    it->second.arena.reserve(std::min(kInitialArenaSize, options_.max_bytes_per_request));
+    it->second.created_ms = now_ms;
+    shard.next_expiry_ms = std::min(shard.next_expiry_ms, now_ms + options_.ttl_ms);
+    size_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  auto& logs = it->second;
+  size_t bytes = logs.arena.size() + msg.size() + (logs.records.size() + 1) * sizeof(TailLogRecord);
+  if (bytes > options_.max_bytes_per_request) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  record.msg_offset = static_cast<uint32_t>(logs.arena.size());
+  record.msg_size = static_cast<uint32_t>(msg.size());
+  logs.arena.append(msg.data(), msg.size());
+  logs.records.push_back(record);
+  buffered_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+bool TailLogBuffer::Take(uint64_t key, RequestLogs& logs) {
+  auto& shard = GetShard(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = shard.requests.find(key);
+  if (it == shard.requests.end()) {
+    return false;
+  }
+  logs = std::move(it->second);
+  shard.requests.erase(it);
+  size_.fetch_sub(1, std::memory_order_relaxed);
+  return true;
+}
+
+size_t TailLogBuffer::Discard(uint64_t key) {
+  RequestLogs logs;
+  if (!Take(key, logs)) {
+    return 0;
+  }
+  // the buffers are freed out of the lock when logs goes out of scope
+  discarded_.fetch_add(logs.records.size(), std::memory_order_relaxed);
+  return logs.records.size();
+}
+
+size_t TailLogBuffer::EvictExpired(uint64_t now_ms) {
+  size_t evicted = 0;
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    evicted += EvictExpiredLocked(shard, now_ms);
+  }
+  return evicted;
+}
+
+size_t TailLogBuffer::EvictExpiredLocked(Shard& shard, uint64_t now_ms) {
+  if (now_ms < shard.next_expiry_ms) {
+    return 0;
+  }
+
+  size_t evicted = 0;
+  uint64_t next_expiry_ms = UINT64_MAX;
+  for (auto it = shard.requests.begin(); it != shard.requests.end();) {
+    uint64_t expiry_ms = it->second.created_ms + options_.ttl_ms;
+    if (now_ms >= expiry_ms) {
+      expired_.fetch_add(it->second.records.size(), std::memory_order_relaxed);
+      it = shard.requests.erase(it);
+      ++evicted;
+    } else {
+      next_expiry_ms = std::min(next_expiry_ms, expiry_ms);
+      ++it;
+    }
+  }
+  shard.next_expiry_ms = next_expiry_ms;
+  size_.fetch_sub(evicted, std::memory_order_relaxed);
+  return evicted;
+}
+
+TailLogBuffer::Stats TailLogBuffer::GetStats() const {
+  Stats stats;
+  stats.buffered = buffered_.load(std::memory_order_relaxed);
+  stats.dropped = dropped_.load(std::memory_order_relaxed);
+  stats.flushed = flushed_.load(std::memory_order_relaxed);
+  stats.discarded = discarded_.load(std::memory_order_relaxed);
+  stats.expired = expired_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+}  // namespace trpc::opentelemetry
@@ -0,0 +1,157 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace trpc::opentelemetry {
+
+/// @brief A log record buffered for a request, whose message is kept in the arena of the request.
+struct TailLogRecord {
+  /// The id of the span which the log is written in, which may be a child span of the request
+  uint8_t span_id[8] = {};
+  /// The opentelemetry severity
+  uint8_t severity = 0;
+  /// The names of the call site, which are not copied as they are string literals such as __FILE__ and __FUNCTION__
+  const char* filename = nullptr;
+  int line = 0;
+  const char* funcname = nullptr;
+  std::chrono::system_clock::time_point timestamp;
+
+  /// The position of the message in the arena, which is set by TailLogBuffer
+  uint32_t msg_offset = 0;
+  uint32_t msg_size = 0;
+};
+
+/// @brief Buffers the logs of the requests which are not sampled yet, until the sampling of the request is finally
+///        decided. The logs of a request are flushed if the request is kept, or discarded otherwise.
+/// @note The buffers are bounded in bytes per request and in the number of requests, the logs beyond the bounds are
+///       dropped. The requests which are never decided, such as the ones whose logs are appended after the decision,
+///       expire after the ttl and are discarded by EvictExpired, or by Append when the number of requests is full.
+class TailLogBuffer {
+ public:
+  struct Options {
+    /// the maximum bytes of the logs of a request, including the messages and the records
+    size_t max_bytes_per_request = 64 * 1024;
+    /// the maximum number of requests being buffered
+    size_t max_requests = 10000;
+    /// the time after which a request is discarded if it is not decided yet, in milliseconds
+    uint64_t ttl_ms = 60000;
+  };
+
+  struct Stats {
+    /// the number of buffered logs
+    uint64_t buffered = 0;
+    /// the number of logs dropped by the bounds
+    uint64_t dropped = 0;
+    /// the number of logs flushed for the kept requests
+    uint64_t flushed = 0;
+    /// the number of logs discarded for the dropped requests
+    uint64_t discarded = 0;
+    /// the number of logs discarded for the requests expired before they are decided
+    uint64_t expired = 0;
+  };
+
+  explicit TailLogBuffer(Options options);
+
+  /// @brief Buffers a log of a request.
+  /// @param key the key of the request, such as its trace id
+  /// @param record the record, whose msg_offset and msg_size are set here
+  /// @param msg the message, which is copied into the arena of the request
+  /// @param now_ms the current time of the monotonic clock, in milliseconds
+  /// @return Return false if the log is dropped by the bounds.
+  bool Append(uint64_t key, TailLogRecord record, std::string_view msg, uint64_t now_ms);
+
+  /// @brief Flushes the buffered logs of a kept request.
+  /// @param key the key of the request
+  /// @param visitor the function called with each record and its message, which is called without locking
+  /// @return Return the number of flushed logs.
+  template <typename Visitor>
+  size_t Flush(uint64_t key, Visitor&& visitor) {
+    RequestLogs logs;
+    if (!Take(key, logs)) {
+      return 0;
+    }
+    for (const auto& record : logs.records) {
+      visitor(record, std::string_view(logs.arena.data() + record.msg_offset, record.msg_size));
+    }
+    flushed_.fetch_add(logs.records.size(), std::memory_order_relaxed);
+    return logs.records.size();
+  }
+
+  /// @brief Discards the buffered logs of a dropped request, which frees the arena of the request at once without
+  ///        visiting the logs.
+  /// @param key the key of the request
+  /// @return Return the number of discarded logs.
+  size_t Discard(uint64_t key);
+
+  /// @brief Discards the requests which are buffered for longer than the ttl, which should be called periodically.
+  /// @param now_ms the current time of the monotonic clock, in milliseconds
+  /// @return Return the number of discarded requests.
+  size_t EvictExpired(uint64_t now_ms);
+
+  /// @brief Gets the number of requests being buffered.
+  size_t Size() const { return size_.load(std::memory_order_relaxed); }
+
+  Stats GetStats() const;
+
+ private:
+  // The logs of a request, whose records are trivially destructible so that discarding them only frees the buffers
+  struct RequestLogs {
+    std::string arena;
+    std::vector<TailLogRecord> records;
+    // the time when the first log of the request is buffered
+    uint64_t created_ms = 0;
+  };
+
+  struct Shard {
+    std::mutex mutex;
+    std::unordered_map<uint64_t, RequestLogs> requests;
+    // no request of the shard expires before this time, so that the shard is not scanned before it
+    uint64_t next_expiry_ms = UINT64_MAX;
+  };
+
+  static constexpr size_t kShardNum = 16;
+
+  Shard& GetShard(uint64_t key) { return shards_[key % kShardNum]; }
+
+  bool Take(uint64_t key, RequestLogs& logs);
+
+  size_t EvictExpiredLocked(Shard& shard, uint64_t now_ms);
+
+ private:
+  const Options options_;
+
+  std::array<Shard, kShardNum> shards_;
+
+  // the number of requests being buffered, which bounds the requests without locking all the shards
+  std::atomic<size_t> size_{0};
+
+  std::atomic<uint64_t> buffered_{0};
+  std::atomic<uint64_t> dropped_{0};
+  std::atomic<uint64_t> flushed_{0};
+  std::atomic<uint64_t> discarded_{0};
+  std::atomic<uint64_t> expired_{0};
+};
+
+}  // namespace trpc::opentelemetry
@@ -0,0 +1,148 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#include "trpc/telemetry/opentelemetry/logging/tail_log_buffer.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace trpc::testing {
+
+using trpc::opentelemetry::TailLogBuffer;
+using trpc::opentelemetry::TailLogRecord;
+
+TailLogRecord MakeRecord(int line) {
+  TailLogRecord record;
+  record.filename = "file.cc";
+  record.line = line;
+  return record;
+}
+
+TEST(TailLogBufferTest, FlushAndDiscard) {
+  TailLogBuffer buffer(TailLogBuffer::Options{});
+
+  ASSERT_TRUE(buffer.Append(1, MakeRecord(1), "msg1", 0));
+  ASSERT_TRUE(buffer.Append(1, MakeRecord(2), "msg2", 0));
+  ASSERT_TRUE(buffer.Append(2, MakeRecord(3), "msg3", 0));
+  ASSERT_EQ(2, buffer.Size());
+
+  std::vector<std::string> msgs;
+  std::vector<int> lines;
+  ASSERT_EQ(2, buffer.Flush(1, [&](const TailLogRecord& record, std::string_view msg) {
+    lines.push_back(record.line);
+    msgs.emplace_back(msg);
+  }));
+  ASSERT_EQ((std::vector<int>{1, 2}), lines);
+  ASSERT_EQ((std::vector<std::string>{"msg1", "msg2"}), msgs);
+
+  ASSERT_EQ(1, buffer.Discard(2));
+  ASSERT_EQ(0, buffer.Size());
+
+  // the requests are removed once flushed or discarded
+  ASSERT_EQ(0, buffer.Flush(1, [](const TailLogRecord& record, std::string_view msg) { FAIL(); }));
+  ASSERT_EQ(0, buffer.Discard(2));
+
+  auto stats = buffer.GetStats();
+  ASSERT_EQ(3, stats.buffered);
+  ASSERT_EQ(0, stats.dropped);
+  ASSERT_EQ(2, stats.flushed);
+  ASSERT_EQ(1, stats.discarded);
+}
+
+TEST(TailLogBufferTest, Bounds) {
+  TailLogBuffer::Options options;
+  options.max_bytes_per_request = 2 * sizeof(TailLogRecord) + 10;
+  options.max_requests = 2;
+  TailLogBuffer buffer(options);
+
+  ASSERT_TRUE(buffer.Append(1, MakeRecord(1), "12345", 0));
+  ASSERT_TRUE(buffer.Append(1, MakeRecord(2), "12345", 0));
+  // beyond the bytes of the request
+  ASSERT_FALSE(buffer.Append(1, MakeRecord(3), "", 0));
+
+  ASSERT_TRUE(buffer.Append(2, MakeRecord(1), "msg", 0));
+  // beyond the number of requests
+  ASSERT_FALSE(buffer.Append(3, MakeRecord(1), "msg", 0));
+  ASSERT_EQ(2, buffer.GetStats().dropped);
+
+  // the request can be buffered after the other request is discarded
+  ASSERT_EQ(1, buffer.Discard(2));
+  ASSERT_TRUE(buffer.Append(3, MakeRecord(1), "msg", 0));
+}
+
+TEST(TailLogBufferTest, Expire) {
+  TailLogBuffer::Options options;
+  options.max_requests = 2;
+  options.ttl_ms = 100;
+  TailLogBuffer buffer(options);
+
+  // the request which never gets a decision
+  ASSERT_TRUE(buffer.Append(1, MakeRecord(1), "msg", 0));
+  ASSERT_TRUE(buffer.Append(1, MakeRecord(2), "msg", 50));
+  ASSERT_TRUE(buffer.Append(2, MakeRecord(1), "msg", 60));
+  ASSERT_EQ(0, buffer.EvictExpired(99));
+  ASSERT_EQ(2, buffer.Size());
+
+  // the requests are expired by the time their first logs are buffered
+  ASSERT_EQ(1, buffer.EvictExpired(100));
+  ASSERT_EQ(1, buffer.Size());
+  ASSERT_EQ(2, buffer.GetStats().expired);
+  ASSERT_EQ(0, buffer.Flush(1, [](const TailLogRecord& record, std::string_view msg) { FAIL(); }));
+
+  // a full buffer makes room with the expired requests of the shard when a new request comes
+  ASSERT_TRUE(buffer.Append(3, MakeRecord(1), "msg", 150));
+  ASSERT_FALSE(buffer.Append(4, MakeRecord(1), "msg", 150));
+  ASSERT_FALSE(buffer.Append(18, MakeRecord(1), "msg", 159));
+  // the request 18 is in the same shard as the expired request 2
+  ASSERT_TRUE(buffer.Append(18, MakeRecord(1), "msg", 160));
+  ASSERT_EQ(2, buffer.Size());
+  ASSERT_EQ(3, buffer.GetStats().expired);
+  ASSERT_EQ(1, buffer.Discard(18));
+  ASSERT_EQ(1, buffer.Discard(3));
+}
+
+TEST(TailLogBufferTest, MultiThread) {
+  constexpr int kThreadNum = 4;
+  constexpr int kRequestNum = 1000;
+
+  TailLogBuffer buffer(TailLogBuffer::Options{});
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadNum; ++i) {
+    threads.emplace_back([&buffer, i]() {
+      for (int j = 0; j < kRequestNum; ++j) {
+        uint64_t key = i * kRequestNum + j;
+        buffer.Append(key, MakeRecord(j), "msg", 0);
+        buffer.Append(key, MakeRecord(j), "msg", 0);
+        if (j % 2 == 0) {
+          buffer.Flush(key, [](const TailLogRecord& record, std::string_view msg) {});
+        } else {
+          buffer.Discard(key);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto stats = buffer.GetStats();
+  ASSERT_EQ(0, buffer.Size());
+  ASSERT_EQ(kThreadNum * kRequestNum * 2, stats.buffered);
+  ASSERT_EQ(kThreadNum * kRequestNum, stats.flushed);
+  ASSERT_EQ(kThreadNum * kRequestNum, stats.discarded);
+}
+
+}  // namespace trpc::testing
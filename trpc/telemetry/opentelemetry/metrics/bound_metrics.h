@@ -0,0 +1,73 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+
+#ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
+#pragma once
+
+#include <memory>
+#include <utility>
+
+#include "prometheus/counter.h"
+#include "prometheus/histogram.h"
+
+namespace trpc::opentelemetry {
+
+/// @brief A counter bound to fixed labels, which is reported without looking up the plugin or the labels.
+/// @note It is cheap to copy and thread-safe. The bound series will not be evicted while any copy of it is alive, and
+///       it stays valid across the reinitialization of the plugin. A default constructed one is unbound, and reports
+///       on it are ignored.
+class BoundCounter {
+ public:
+  BoundCounter() = default;
+
+  explicit BoundCounter(std::shared_ptr<::prometheus::Counter> counter) : counter_(std::move(counter)) {}
+
+  /// @brief Increments the counter by the value, which must be non-negative.
+  void Add(double value = 1) const {
+    if (counter_) {
+      counter_->Increment(value);
+    }
+  }
+
+  /// @brief Whether the counter is bound to a series.
+  bool IsBound() const { return counter_ != nullptr; }
+
+ private:
+  std::shared_ptr<::prometheus::Counter> counter_;
+};
+
+/// @brief A histogram bound to fixed labels and buckets, which is reported without looking up the plugin or the labels.
+/// @note It has the same semantics as BoundCounter.
+class BoundHistogram {
+ public:
+  BoundHistogram() = default;
+
+  explicit BoundHistogram(std::shared_ptr<::prometheus::Histogram> histogram) : histogram_(std::move(histogram)) {}
+
+  /// @brief Observes the value.
+  void Observe(double value) const {
+    if (histogram_) {
+      histogram_->Observe(value);
+    }
+  }
+
+  /// @brief Whether the histogram is bound to a series.
+  bool IsBound() const { return histogram_ != nullptr; }
+
+ private:
+  std::shared_ptr<::prometheus::Histogram> histogram_;
+};
+
+}  // namespace trpc::opentelemetry
+#endif
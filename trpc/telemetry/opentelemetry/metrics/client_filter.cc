@@ -14,14 +14,59 @@
 #ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
 #include "trpc/telemetry/opentelemetry/metrics/client_filter.h"
 
+#include <unordered_map>
+
 #include "trpc/common/config/trpc_config.h"
 #include "trpc/telemetry/telemetry_factory.h"
 #include "trpc/util/time.h"
 
 #include "trpc/telemetry/opentelemetry/metrics/common.h"
+#include "trpc/telemetry/opentelemetry/metrics/inflight_gauge.h"
+#include "trpc/telemetry/opentelemetry/metrics/label_selector.h"
+#include "trpc/telemetry/opentelemetry/metrics/trace_exemplar.h"
+#include "trpc/telemetry/opentelemetry/tracing/opentelemetry_tracing.h"
 
 namespace trpc {
 
+namespace opentelemetry {
+
+/// @brief A map used to store ClientPayloadSizeFuncs for different protocol.
+///        key: protocol name, value: ClientPayloadSizeFuncs
+std::unordered_map<std::string, ClientPayloadSizeFuncs> client_payload_size_funcs_map;
+
+void SetClientPayloadSizeFuncs(const std::string& protocol_name, const ClientPayloadSizeFuncs& size_funcs) {
+  if (size_funcs.request_size_func == nullptr || size_funcs.response_size_func == nullptr) {
+    TRPC_LOG_ERROR("can not set client payload size funcs of " << protocol_name << " with nullptr");
+    return;
+  }
+  client_payload_size_funcs_map[protocol_name] = size_funcs;
+}
+
+const ClientPayloadSizeFuncs& GetClientPayloadSizeFuncs(const std::string& protocol_name) {
+  auto it = client_payload_size_funcs_map.find(protocol_name);
+  if (it != client_payload_size_funcs_map.end()) {
+    return it->second;
+  }
+  // If there is no corresponding implementation set for the protocol, the sizes known by the framework are used by
+  // default.
+  static const ClientPayloadSizeFuncs default_size_funcs{ClientRequestLengthFunc, ClientResponseLengthFunc};
+  return default_size_funcs;
+}
+
+size_t ClientRequestLengthFunc(const ClientContextPtr& context) {
+  // the size of the message is set when the request is encoded, and is 0 if the protocol does not know it
+  auto& req = context->GetRequest();
+  return req ? req->GetMessageSize() : 0;
+}
+
+size_t ClientResponseLengthFunc(const ClientContextPtr& context) {
+  // the size of the message is set when the response is decoded
+  auto& rsp = context->GetResponse();
+  return rsp ? rsp->GetMessageSize() : 0;
+}
+
+}  // namespace opentelemetry
+
 int OpenTelemetryMetricsClientFilter::Init() {
   auto telemetry = TelemetryFactory::GetInstance()->Get(trpc::opentelemetry::kOpenTelemetryTelemetryName);
   if (!telemetry) {
@@ -32,6 +77,17 @@ int OpenTelemetryMetricsClientFilter::Init() {
   metrics_plugin_ = trpc::dynamic_pointer_cast<OpenTelemetryMetrics>(telemetry->GetMetrics());
   auto& config = metrics_plugin_->GetConfig();
   enabled_ = config.metrics_config.enabled;
+  label_mask_ = metrics_plugin_->GetClientLabelMask();
+  enable_peer_metrics_ = enabled_ && config.metrics_config.enable_peer_metrics;
+  if (enabled_ && config.metrics_config.enable_exemplar) {
+    auto tracing = trpc::dynamic_pointer_cast<OpenTelemetryTracing>(telemetry->GetTracing());
+    if (tracing) {
+      enable_exemplar_ = true;
+      tracing_index_ = tracing->GetPluginID();
+    } else {
+      TRPC_LOG_WARN("exemplar is enabled but the tracing of the plugin is unavailable, exemplars will not be reported");
+    }
+  }
 
   return 0;
 }
@@ -49,46 +105,71 @@ void OpenTelemetryMetricsClientFilter::operator()(FilterStatus& status, FilterPo
     return;
   }
 
-  ModuleMetricsInfo module_info;
-  module_info.source = kMetricsCallerSource;
-  module_info.infos[trpc::opentelemetry::kCallerService] = context->GetCallerName();
-  module_info.infos[trpc::opentelemetry::kCallerMethod] = context->GetCallerFuncName();
-  module_info.infos[trpc::opentelemetry::kCalleeService] = context->GetCalleeName();
-  module_info.infos[trpc::opentelemetry::kCalleeMethod] = context->GetFuncName();
-
   if (point == FilterPoint::CLIENT_PRE_RPC_INVOKE) {
-    ReportClientStartedTotal(context, module_info);
+    trpc::opentelemetry::RpcMetricsRecord record;
+    record.labels = BuildLabels(context);
+    record.inflight =
+        trpc::opentelemetry::InflightGuard(metrics_plugin_->GetClientInflightCounter(context->GetCalleeName()));
+    metrics_plugin_->ReportClientStartedTotal(record.labels);
+    context->SetFilterData(metrics_plugin_->GetRecordIndex(), std::move(record));
   } else if (point == FilterPoint::CLIENT_POST_RPC_INVOKE) {
-    ReportClientHandledSeconds(context, module_info);
-    ReportClientHandledTotal(context, module_info);
+    auto* record = context->GetFilterData<trpc::opentelemetry::RpcMetricsRecord>(metrics_plugin_->GetRecordIndex());
+    if (record) {
+      record->inflight.Release();
+      ReportClientHandled(context, record->labels);
+    } else {
+      std::map<std::string, std::string> labels = BuildLabels(context);
+      ReportClientHandled(context, labels);
+    }
   }
-
-  status = FilterStatus::CONTINUE;
 }
 
-void OpenTelemetryMetricsClientFilter::ReportClientStartedTotal(const ClientContextPtr& context,
-                                                                ModuleMetricsInfo& module_info) {
-  module_info.extend_info = trpc::opentelemetry::ModuleReportType::kClientStartedCount;
-  metrics_plugin_->ModuleReport(module_info);
+std::map<std::string, std::string> OpenTelemetryMetricsClientFilter::BuildLabels(const ClientContextPtr& context) {
+  // the labels which are not used by any client-side family are skipped
+  std::map<std::string, std::string> labels;
+  trpc::opentelemetry::AddRpcLabel(labels, label_mask_, trpc::opentelemetry::kCallerService, context->GetCallerName());
+  trpc::opentelemetry::AddRpcLabel(labels, label_mask_, trpc::opentelemetry::kCallerMethod,
+                                   context->GetCallerFuncName());
+  trpc::opentelemetry::AddRpcLabel(labels, label_mask_, trpc::opentelemetry::kCalleeService, context->GetCalleeName());
+  trpc::opentelemetry::AddRpcLabel(labels, label_mask_, trpc::opentelemetry::kCalleeMethod, context->GetFuncName());
+  return labels;
 }
 
-void OpenTelemetryMetricsClientFilter::ReportClientHandledSeconds(const ClientContextPtr& context,
-                                                                  ModuleMetricsInfo& module_info) {
-  module_info.extend_info = trpc::opentelemetry::ModuleReportType::kClientHandledTime;
-  module_info.cost_time = (trpc::time::GetMicroSeconds() - context->GetSendTimestampUs()) / 1000;
-  metrics_plugin_->ModuleReport(module_info);
+void OpenTelemetryMetricsClientFilter::ReportClientPayloadBytes(const ClientContextPtr& context,
+                                                                const std::map<std::string, std::string>& labels) {
+  auto& size_funcs = trpc::opentelemetry::GetClientPayloadSizeFuncs(context->GetCodecName());
+  // the request is not encoded if the RPC fails before sending, and the response is not decoded if the RPC fails,
+  // whose sizes are 0 and will not be reported
+  size_t request_size = size_funcs.request_size_func(context);
+  if (request_size > 0) {
+    metrics_plugin_->ReportClientRequestBytes(labels, request_size);
+  }
+  size_t response_size = size_funcs.response_size_func(context);
+  if (response_size > 0) {
+    metrics_plugin_->ReportClientResponseBytes(labels, response_size);
+  }
 }
 
-void OpenTelemetryMetricsClientFilter::ReportClientHandledTotal(const ClientContextPtr& context,
-                                                                ModuleMetricsInfo& module_info) {
-  module_info.extend_info = trpc::opentelemetry::ModuleReportType::kClientHandledCount;
-  int ret_code = context->GetStatus().GetFrameworkRetCode();
-  if (ret_code == trpc::TrpcRetCode::TRPC_INVOKE_SUCCESS) {
-    ret_code = context->GetStatus().GetFuncRetCode();
+void OpenTelemetryMetricsClientFilter::ReportClientHandled(const ClientContextPtr& context,
+                                                           std::map<std::string, std::string>& labels) {
+  trpc::opentelemetry::ExemplarContext exemplar;
+  bool has_exemplar = enable_exemplar_ && trpc::opentelemetry::GetSampledExemplarContext<ClientTracingSpan>(
+                                              context, tracing_index_, exemplar);
+  uint64_t cost_us = trpc::time::GetMicroSeconds() - context->GetSendTimestampUs();
+  metrics_plugin_->ReportClientHandledSeconds(labels, cost_us / 1000, has_exemplar ? &exemplar : nullptr);
+  ReportClientPayloadBytes(context, labels);
+
+  int ret_code = trpc::opentelemetry::GetRetCode(context);
+  if (enable_peer_metrics_) {
+    auto result = trpc::opentelemetry::ClassifyCallResult(ret_code, context->GetCalleeName(), context->GetFuncName());
+    metrics_plugin_->ReportClientPeer(context->GetCalleeName(), context->GetIp(), context->GetPort(), cost_us,
+                                      result.classification->type != trpc::opentelemetry::kSuccessType);
   }
 
-  trpc::opentelemetry::SetCallResult(ret_code, context->GetCalleeName(), context->GetFuncName(), module_info.infos);
-  metrics_plugin_->ModuleReport(module_info);
+  // the call result labels are only reported with the handled total
+  trpc::opentelemetry::SetSelectedCallResult(ret_code, context->GetCalleeName(), context->GetFuncName(), label_mask_,
+                                             labels);
+  metrics_plugin_->ReportClientHandledTotal(labels);
 }
 
 }  // namespace trpc
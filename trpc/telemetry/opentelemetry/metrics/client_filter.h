@@ -14,6 +14,9 @@
 #ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
 #pragma once
 
+#include <functional>
+#include <string>
+
 #include "trpc/client/client_context.h"
 #include "trpc/filter/filter.h"
 #include "trpc/telemetry/opentelemetry/metrics/opentelemetry_metrics.h"
@@ -21,6 +24,38 @@
 
 namespace trpc {
 
+namespace opentelemetry {
+
+/// @brief The client-side payload size function which returns the size of the request or response in bytes based on
+///        the ClientContext, 0 means the size is unknown and will not be reported.
+/// @param context ClientContext
+/// @return the size in bytes
+using ClientPayloadSizeFunc = std::function<size_t(const ClientContextPtr& context)>;
+
+/// @brief The payload size functions of a specific protocol.
+struct ClientPayloadSizeFuncs {
+  ClientPayloadSizeFunc request_size_func;
+  ClientPayloadSizeFunc response_size_func;
+};
+
+/// @brief Sets the client-side payload size functions for a specific protocol.
+/// @param protocol_name protocol name
+/// @param size_funcs payload size functions
+void SetClientPayloadSizeFuncs(const std::string& protocol_name, const ClientPayloadSizeFuncs& size_funcs);
+
+/// @brief Gets the client-side payload size functions for a specific protocol.
+/// @param protocol_name protocol name
+/// @return payload size functions
+const ClientPayloadSizeFuncs& GetClientPayloadSizeFuncs(const std::string& protocol_name);
+
+/// @brief The implementation function which gets the request size from the length of the encoded request.
+size_t ClientRequestLengthFunc(const ClientContextPtr& context);
+
+/// @brief The implementation function which gets the response size from the length of the decoded response.
+size_t ClientResponseLengthFunc(const ClientContextPtr& context);
+
+}  // namespace opentelemetry
+
 class OpenTelemetryMetricsClientFilter : public MessageClientFilter {
  public:
   int Init() override;
@@ -32,16 +67,30 @@ class OpenTelemetryMetricsClientFilter : public MessageClientFilter {
   void operator()(FilterStatus& status, FilterPoint point, const ClientContextPtr& context) override;
 
  private:
-  void ReportClientStartedTotal(const ClientContextPtr& context, ModuleMetricsInfo& module_info);
+  // Builds the caller and callee labels of the RPC
+  std::map<std::string, std::string> BuildLabels(const ClientContextPtr& context);
 
-  void ReportClientHandledSeconds(const ClientContextPtr& context, ModuleMetricsInfo& module_info);
+  // Reports the sizes of the encoded request and the decoded response, which are skipped if the sizes are unknown
+  void ReportClientPayloadBytes(const ClientContextPtr& context, const std::map<std::string, std::string>& labels);
 
-  void ReportClientHandledTotal(const ClientContextPtr& context, ModuleMetricsInfo& module_info);
+  void ReportClientHandled(const ClientContextPtr& context, std::map<std::string, std::string>& labels);
 
  private:
   OpenTelemetryMetricsPtr metrics_plugin_ = nullptr;
 
   bool enabled_ = false;
+
+  // whether to attach the sampled spans of the tracing plugin to the latency histograms as exemplars
+  bool enable_exemplar_ = false;
+
+  // the filter data index of the tracing plugin where the spans are stored
+  uint32_t tracing_index_ = 0;
+
+  // whether to report the RPCs to each peer
+  bool enable_peer_metrics_ = false;
+
+  // the labels used by the client-side RPC metrics, the others are not built
+  trpc::opentelemetry::LabelMask label_mask_ = trpc::opentelemetry::kAllRpcLabels;
 };
 
 }  // namespace trpc
@@ -17,7 +17,9 @@
 #include "gtest/gtest.h"
 #include "trpc/codec/trpc/trpc_client_codec.h"
 #include "trpc/common/config/trpc_config.h"
+#include "trpc/proto/testing/helloworld.pb.h"
 #include "trpc/telemetry/telemetry_factory.h"
+#include "trpc/util/buffer/noncontiguous_buffer.h"
 
 #include "trpc/telemetry/opentelemetry/metrics/opentelemetry_metrics.h"
 #include "trpc/telemetry/opentelemetry/testing/mock_telemetry.h"
@@ -68,12 +70,62 @@ TEST_F(OpenTelemetryMetricsClientFilterTest, Report) {
   FilterStatus status;
   client_filter_->operator()(status, FilterPoint::CLIENT_PRE_RPC_INVOKE, context);
   ASSERT_EQ(FilterStatus::CONTINUE, status);
+  // the record is built when the RPC starts
+  auto record_index = static_cast<OpenTelemetryMetrics*>(metrics_.get())->GetRecordIndex();
+  auto* record = context->GetFilterData<trpc::opentelemetry::RpcMetricsRecord>(record_index);
+  ASSERT_NE(nullptr, record);
+  ASSERT_EQ("trpc.test.helloworld.Greeter", record->labels[trpc::opentelemetry::kCalleeService]);
+  ASSERT_EQ("SayHello", record->labels[trpc::opentelemetry::kCalleeMethod]);
+  auto* inflight =
+      static_cast<OpenTelemetryMetrics*>(metrics_.get())->GetClientInflightCounter("trpc.test.helloworld.Greeter");
+  ASSERT_EQ(1, inflight->Value());
 
   trpc::Status frame_status;
   frame_status.SetFrameworkRetCode(101);
   context->SetStatus(frame_status);
   client_filter_->operator()(status, FilterPoint::CLIENT_POST_RPC_INVOKE, context);
   ASSERT_EQ(FilterStatus::CONTINUE, status);
+  // the call result is appended into the record when the RPC finishes
+  ASSERT_EQ("101", record->labels[trpc::opentelemetry::kCode]);
+  ASSERT_EQ(trpc::opentelemetry::kTimeoutType, record->labels[trpc::opentelemetry::kCodeType]);
+  ASSERT_EQ(0, inflight->Value());
+}
+
+TEST_F(OpenTelemetryMetricsClientFilterTest, PayloadSize) {
+  auto trpc_codec = std::make_shared<trpc::TrpcClientCodec>();
+  trpc::ClientContextPtr context = trpc::MakeRefCounted<trpc::ClientContext>(trpc_codec);
+  trpc::test::helloworld::HelloRequest hello_req;
+  hello_req.set_msg("hello");
+  trpc::test::helloworld::HelloReply hello_rsp;
+  hello_rsp.set_msg("hello world");
+
+  // the sizes are unknown before the messages are encoded or decoded
+  ASSERT_EQ(0, trpc::opentelemetry::ClientRequestLengthFunc(context));
+  ASSERT_EQ(0, trpc::opentelemetry::ClientResponseLengthFunc(context));
+
+  // the sizes are the lengths of the encoded messages whatever the encoding of the body is
+  context->SetReqEncodeType(TrpcContentEncodeType::TRPC_JSON_ENCODE);
+  context->GetRequest()->SetNonContiguousProtocolBody(CreateBufferSlow(hello_req.SerializeAsString()));
+  NoncontiguousBuffer req_buffer;
+  ASSERT_TRUE(context->GetRequest()->ZeroCopyEncode(req_buffer));
+  ASSERT_EQ(req_buffer.ByteSize(), trpc::opentelemetry::ClientRequestLengthFunc(context));
+  context->GetResponse()->SetNonContiguousProtocolBody(CreateBufferSlow(hello_rsp.SerializeAsString()));
+  NoncontiguousBuffer rsp_buffer;
+  ASSERT_TRUE(context->GetResponse()->ZeroCopyEncode(rsp_buffer));
+  ASSERT_EQ(rsp_buffer.ByteSize(), trpc::opentelemetry::ClientResponseLengthFunc(context));
+
+  // the default functions are used if the protocol does not set its own
+  auto& default_funcs = trpc::opentelemetry::GetClientPayloadSizeFuncs("test_protocol");
+  ASSERT_EQ(req_buffer.ByteSize(), default_funcs.request_size_func(context));
+  ASSERT_EQ(rsp_buffer.ByteSize(), default_funcs.response_size_func(context));
+
+  trpc::opentelemetry::ClientPayloadSizeFuncs size_funcs;
+  size_funcs.request_size_func = [](const ClientContextPtr&) -> size_t { return 10; };
+  size_funcs.response_size_func = [](const ClientContextPtr&) -> size_t { return 20; };
+  trpc::opentelemetry::SetClientPayloadSizeFuncs("test_protocol", size_funcs);
+  auto& test_funcs = trpc::opentelemetry::GetClientPayloadSizeFuncs("test_protocol");
+  ASSERT_EQ(10, test_funcs.request_size_func(context));
+  ASSERT_EQ(20, test_funcs.response_size_func(context));
 }
 
 }  // namespace trpc::testing
@@ -13,7 +13,12 @@
 
 #include "trpc/telemetry/opentelemetry/metrics/common.h"
 
+#include <algorithm>
+#include <deque>
+#include <limits>
 #include <set>
+#include <unordered_map>
+#include <utility>
 
 #include "trpc/codec/codec_helper.h"
 #include "trpc/util/log/logging.h"
@@ -22,44 +27,144 @@ namespace trpc::opentelemetry {
 
 namespace {
 
-/// @brief The map for user-configured error code mapping
-std::unordered_map<int, std::vector<OpenTelemetryMetricsCode> > user_code_map;
+// Codes in [0, kDenseCodeSize) are indexed directly, which covers all the framework codes
+constexpr int kDenseCodeSize = 1024;
+
+// The interned id which matches any service or method
+constexpr uint32_t kAnyId = 0;
+
+// The interned id of the service or method which is not configured by any rule
+constexpr uint32_t kUnknownId = std::numeric_limits<uint32_t>::max();
+
+struct CodeRule {
+  uint32_t service_id = kAnyId;
+  uint32_t method_id = kAnyId;
+  const CodeClassification* classification = nullptr;
+};
+
+struct CodeEntry {
+  std::string code;
+  // rules of the user configuration, in the configured order
+  std::vector<CodeRule> rules;
+  // used when none of the rules matches
+  const CodeClassification* fallback = nullptr;
+  bool match_service = false;
+  bool match_method = false;
+};
+
+/// @brief A precompiled table of the error code mapping, keyed by (code, interned service id, interned method id).
+class CodeTable {
+ public:
+  void Build(const std::vector<OpenTelemetryMetricsCode>& user_codes,
+             const std::vector<OpenTelemetryMetricsCode>& default_codes) {
+    classifications_.clear();
+    service_ids_.clear();
+    method_ids_.clear();
+    dense_.clear();
+    sparse_.clear();
+
+    std::unordered_map<int, CodeEntry> entries;
+    for (int code = 0; code < kDenseCodeSize; ++code) {
+      entries[code].fallback = &exception_;
+    }
+    for (const auto& metric_code : default_codes) {
+      CodeEntry& entry = entries[static_cast<int>(metric_code.code)];
+      entry.fallback = NewClassification(metric_code.type, metric_code.description);
+    }
+    for (const auto& metric_code : user_codes) {
+      CodeEntry& entry = entries[static_cast<int>(metric_code.code)];
+      CodeRule rule;
+      rule.service_id = Intern(service_ids_, metric_code.service);
+      rule.method_id = Intern(method_ids_, metric_code.method);
+      rule.classification = NewClassification(metric_code.type, metric_code.description);
+      entry.match_service |= rule.service_id != kAnyId;
+      entry.match_method |= rule.method_id != kAnyId;
+      entry.rules.push_back(rule);
+    }
 
-/// @brief The map for default error code mapping
-std::unordered_map<int, OpenTelemetryMetricsCode> default_code_map;
+    dense_.resize(kDenseCodeSize);
+    for (auto& [code, entry] : entries) {
+      entry.code = std::to_string(code);
+      if (entry.fallback == nullptr) {
+        entry.fallback = &exception_;
+      }
+      if (code >= 0 && code < kDenseCodeSize) {
+        dense_[code] = std::move(entry);
+      } else {
+        sparse_.emplace_back(code, std::move(entry));
+      }
+    }
+    std::sort(sparse_.begin(), sparse_.end(),
+              [](const auto& left, const auto& right) { return left.first < right.first; });
+  }
 
-bool IsServiceMatch(const OpenTelemetryMetricsCode& metric_code, const std::string& service_name) {
-  if (metric_code.service == "" || metric_code.service == service_name) {
-    return true;
+  CallResult Classify(int ret_code, const std::string& service_name, const std::string& method) const {
+    const CodeEntry* entry = Find(ret_code);
+    if (entry == nullptr) {
+      return CallResult{nullptr, &exception_};
+    }
+
+    // only the codes whose rules specify service or method need to look up the interned ids
+    uint32_t service_id = entry->match_service ? Lookup(service_ids_, service_name) : kAnyId;
+    uint32_t method_id = entry->match_method ? Lookup(method_ids_, method) : kAnyId;
+    for (const auto& rule : entry->rules) {
+      if ((rule.service_id == kAnyId || rule.service_id == service_id) &&
+          (rule.method_id == kAnyId || rule.method_id == method_id)) {
+        return CallResult{&entry->code, rule.classification};
+      }
+    }
+    return CallResult{&entry->code, entry->fallback};
   }
-  return false;
-}
 
-bool IsMethodMatch(const OpenTelemetryMetricsCode& metric_code, const std::string& method) {
-  if (metric_code.method == "" || metric_code.method == method) {
-    return true;
+ private:
+  static uint32_t Intern(std::unordered_map<std::string, uint32_t>& ids, const std::string& name) {
+    if (name.empty()) {
+      return kAnyId;
+    }
+    auto it = ids.emplace(name, static_cast<uint32_t>(ids.size() + 1)).first;
+    return it->second;
   }
-  return false;
-}
 
-bool IsMatchUserDefine(const OpenTelemetryMetricsCode& metric_code, const std::string& service_name,
-                       const std::string& method) {
-  if (IsServiceMatch(metric_code, service_name) && IsMethodMatch(metric_code, method)) {
-    return true;
+  static uint32_t Lookup(const std::unordered_map<std::string, uint32_t>& ids, const std::string& name) {
+    auto it = ids.find(name);
+    return it != ids.end() ? it->second : kUnknownId;
   }
-  return false;
-}
 
-void SetCallResultByDefault(int ret_code, std::map<std::string, std::string>& module_infos) {
-  if (default_code_map.find(ret_code) != default_code_map.end()) {
-    module_infos[kCodeType] = default_code_map[ret_code].type;
-    module_infos[kCodeDesc] = default_code_map[ret_code].description;
-    return;
+  const CodeEntry* Find(int ret_code) const {
+    if (ret_code >= 0 && ret_code < static_cast<int>(dense_.size())) {
+      return &dense_[ret_code];
+    }
+    auto it = std::lower_bound(sparse_.begin(), sparse_.end(), ret_code,
+                               [](const auto& item, int code) { return item.first < code; });
+    if (it != sparse_.end() && it->first == ret_code) {
+      return &it->second;
+    }
+    return nullptr;
+  }
+
+  const CodeClassification* NewClassification(const std::string& type, const std::string& description) {
+    return &classifications_.emplace_back(CodeClassification{type, description});
   }
+
+ private:
+  // deque keeps the addresses of the classifications stable
+  std::deque<CodeClassification> classifications_;
   // all other cases should be treated as exceptions
-  module_infos[kCodeType] = trpc::opentelemetry::kExceptionType;
-  module_infos[kCodeDesc] = "code!=0";
-}
+  const CodeClassification exception_{kExceptionType, "code!=0"};
+  std::unordered_map<std::string, uint32_t> service_ids_;
+  std::unordered_map<std::string, uint32_t> method_ids_;
+  std::vector<CodeEntry> dense_;
+  std::vector<std::pair<int, CodeEntry>> sparse_;
+};
+
+/// @brief The user-configured error code mapping
+std::vector<OpenTelemetryMetricsCode> user_codes;
+
+/// @brief The default error code mapping
+std::vector<OpenTelemetryMetricsCode> default_codes;
+
+/// @brief The table compiled from user_codes and default_codes
+CodeTable code_table;
 
 }  // namespace
 
@@ -67,45 +172,46 @@ void InitUserCodeMap(const std::vector<OpenTelemetryMetricsCode>& codes) {
   // "type" can only be one of three options:
   std::set<std::string> type_set = {kSuccessType, kTimeoutType, kExceptionType};
 
-  for (auto metric_code : codes) {
+  user_codes.clear();
+  for (const auto& metric_code : codes) {
     if (type_set.count(metric_code.type) == 0) {
       TRPC_LOG_ERROR("code type " << metric_code.type << " is not support");
       continue;
     }
-    user_code_map[metric_code.code].push_back(metric_code);
+    user_codes.push_back(metric_code);
   }
+  code_table.Build(user_codes, default_codes);
 }
 
 void InitDefaultCodeMap() {
-  default_code_map[trpc::TrpcRetCode::TRPC_INVOKE_SUCCESS] = OpenTelemetryMetricsCode{
-      .code = trpc::TrpcRetCode::TRPC_INVOKE_SUCCESS, .type = kSuccessType, .description = "code=0"};
-  default_code_map[trpc::TrpcRetCode::TRPC_SERVER_TIMEOUT_ERR] = OpenTelemetryMetricsCode{
-      .code = trpc::TrpcRetCode::TRPC_SERVER_TIMEOUT_ERR, .type = kTimeoutType, .description = "server timeout"};
-  default_code_map[trpc::TrpcRetCode::TRPC_SERVER_FULL_LINK_TIMEOUT_ERR] =
+  default_codes = {
+      OpenTelemetryMetricsCode{
+          .code = trpc::TrpcRetCode::TRPC_INVOKE_SUCCESS, .type = kSuccessType, .description = "code=0"},
+      OpenTelemetryMetricsCode{
+          .code = trpc::TrpcRetCode::TRPC_SERVER_TIMEOUT_ERR, .type = kTimeoutType, .description = "server timeout"},
       OpenTelemetryMetricsCode{.code = trpc::TrpcRetCode::TRPC_SERVER_FULL_LINK_TIMEOUT_ERR,
                                .type = kTimeoutType,
-                               .description = "server fulllink timeout"};
-  default_code_map[trpc::TrpcRetCode::TRPC_CLIENT_INVOKE_TIMEOUT_ERR] = OpenTelemetryMetricsCode{
-      .code = trpc::TrpcRetCode::TRPC_CLIENT_INVOKE_TIMEOUT_ERR, .type = kTimeoutType, .description = "client timeout"};
-  default_code_map[trpc::TrpcRetCode::TRPC_CLIENT_FULL_LINK_TIMEOUT_ERR] =
+                               .description = "server fulllink timeout"},
+      OpenTelemetryMetricsCode{.code = trpc::TrpcRetCode::TRPC_CLIENT_INVOKE_TIMEOUT_ERR,
+                               .type = kTimeoutType,
+                               .description = "client timeout"},
       OpenTelemetryMetricsCode{.code = trpc::TrpcRetCode::TRPC_CLIENT_FULL_LINK_TIMEOUT_ERR,
                                .type = kTimeoutType,
-                               .description = "client fulllink timeout"};
+                               .description = "client fulllink timeout"},
+  };
+  code_table.Build(user_codes, default_codes);
+}
+
+CallResult ClassifyCallResult(int ret_code, const std::string& service_name, const std::string& method) {
+  return code_table.Classify(ret_code, service_name, method);
 }
 
 void SetCallResult(int ret_code, const std::string& service_name, const std::string& method,
                    std::map<std::string, std::string>& module_infos) {
-  module_infos[kCode] = std::to_string(ret_code);
-  if (user_code_map.find(ret_code) != user_code_map.end()) {
-    for (auto& metric_code : user_code_map[ret_code]) {
-      if (IsMatchUserDefine(metric_code, service_name, method)) {
-        module_infos[kCodeType] = metric_code.type;
-        module_infos[kCodeDesc] = metric_code.description;
-        return;
-      }
-    }
-  }
-  SetCallResultByDefault(ret_code, module_infos);
+  CallResult result = code_table.Classify(ret_code, service_name, method);
+  module_infos[kCode] = result.code ? *result.code : std::to_string(ret_code);
+  module_infos[kCodeType] = result.classification->type;
+  module_infos[kCodeDesc] = result.classification->description;
 }
 
 }  // namespace trpc::opentelemetry
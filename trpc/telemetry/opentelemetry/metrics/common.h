@@ -13,9 +13,14 @@
 
 #pragma once
 
+#include <map>
 #include <string>
 #include <vector>
 
+#include "trpc/codec/codec_helper.h"
+
+#include "trpc/telemetry/opentelemetry/metrics/inflight_counter.h"
+#include "trpc/telemetry/opentelemetry/opentelemetry_common.h"
 #include "trpc/telemetry/opentelemetry/opentelemetry_telemetry_conf.h"
 
 namespace trpc::opentelemetry {
@@ -39,11 +44,56 @@ constexpr char kCode[] = "code";
 constexpr char kCodeType[] = "code_type";
 constexpr char kCodeDesc[] = "code_desc";
 
+/// @brief The service names of the proxies which push the metrics to the collector
+constexpr char kGrpcMetricsExporterServiceName[] = "trpc.opentelemetry.metrics.grpc_exporter";
+constexpr char kHttpMetricsExporterServiceName[] = "trpc.opentelemetry.metrics.http_exporter";
+
+/// @brief The resource attribute of the service which pushes the metrics
+constexpr char kMetricsServiceName[] = "service.name";
+
+/// @brief The aggregation temporalities of the pushed metrics
+constexpr char kDeltaTemporality[] = "delta";
+constexpr char kCumulativeTemporality[] = "cumulative";
+
 /// @brief Types of code
 constexpr char kSuccessType[] = "success";
 constexpr char kTimeoutType[] = "timeout";
 constexpr char kExceptionType[] = "exception";
 
+/// @brief The type and description of an error code, which are preallocated when initializing the code map.
+struct CodeClassification {
+  std::string type;
+  std::string description;
+};
+
+/// @brief The classified result of a call, whose label values point into the precompiled code table.
+/// @note The pointers are valid until the code map is initialized again.
+struct CallResult {
+  /// The label value of the code, it is nullptr when the code is out of the precompiled table.
+  const std::string* code = nullptr;
+  const CodeClassification* classification = nullptr;
+};
+
+/// @brief The metrics record of a RPC, which is built once when the RPC starts and is stored in the filter data, so
+///        that the reports when the RPC finishes reuse it instead of building the labels again.
+struct RpcMetricsRecord {
+  /// the caller and callee labels of the RPC, the call result labels are appended when the RPC finishes
+  std::map<std::string, std::string> labels;
+  /// the in-flight request of the RPC, which is released when the RPC finishes or the record is destroyed
+  InflightGuard inflight;
+};
+
+/// @brief Gets the return code of the RPC, which is the framework code if the framework fails, otherwise the code
+///        returned by the user function.
+template <typename ContextPtr>
+int GetRetCode(const ContextPtr& context) {
+  int ret_code = context->GetStatus().GetFrameworkRetCode();
+  if (ret_code == trpc::TrpcRetCode::TRPC_INVOKE_SUCCESS) {
+    ret_code = context->GetStatus().GetFuncRetCode();
+  }
+  return ret_code;
+}
+
 /// @brief Initializes the user-configured error code mapping map.
 /// @param codes the user-configured error code mapping information
 void InitUserCodeMap(const std::vector<OpenTelemetryMetricsCode>& codes);
@@ -51,6 +101,14 @@ void InitUserCodeMap(const std::vector<OpenTelemetryMetricsCode>& codes);
 /// @brief Initializes the default error code mapping map.
 void InitDefaultCodeMap();
 
+/// @brief Classifies the call result based on the error code, without allocation or string comparison of the label
+///        values.
+/// @param ret_code error code
+/// @param service_name servive name
+/// @param method method
+/// @return Return the classified result.
+CallResult ClassifyCallResult(int ret_code, const std::string& service_name, const std::string& method);
+
 /// @brief Sets the call result into the metrics info based on the error code.
 /// @param ret_code error code
 /// @param service_name servive name
@@ -115,4 +115,41 @@ TEST_F(OpenTelemetryMetricsCommonTest, DefaultDefine) {
   ASSERT_EQ("code!=0", module_infos[trpc::opentelemetry::kCodeDesc]);
 }
 
+TEST_F(OpenTelemetryMetricsCommonTest, ClassifyCallResult) {
+  // the label values of the precompiled codes are preallocated
+  auto result = trpc::opentelemetry::ClassifyCallResult(10002, "service1", "method1");
+  ASSERT_NE(nullptr, result.code);
+  ASSERT_EQ("10002", *result.code);
+  ASSERT_EQ(trpc::opentelemetry::kTimeoutType, result.classification->type);
+  ASSERT_EQ("user timeout", result.classification->description);
+  auto same_result = trpc::opentelemetry::ClassifyCallResult(10002, "service1", "method2");
+  ASSERT_EQ(result.code, same_result.code);
+  ASSERT_EQ(result.classification, same_result.classification);
+
+  // service does not match
+  result = trpc::opentelemetry::ClassifyCallResult(10002, "service2", "method1");
+  ASSERT_EQ("10002", *result.code);
+  ASSERT_EQ(trpc::opentelemetry::kExceptionType, result.classification->type);
+
+  // framework codes are indexed directly
+  result = trpc::opentelemetry::ClassifyCallResult(trpc::TrpcRetCode::TRPC_SERVER_TIMEOUT_ERR, "service1", "method1");
+  ASSERT_NE(nullptr, result.code);
+  ASSERT_EQ(std::to_string(trpc::TrpcRetCode::TRPC_SERVER_TIMEOUT_ERR), *result.code);
+  ASSERT_EQ("server timeout", result.classification->description);
+
+  // codes out of the table are treated as exceptions
+  result = trpc::opentelemetry::ClassifyCallResult(30000, "service1", "method1");
+  ASSERT_EQ(nullptr, result.code);
+  ASSERT_EQ(trpc::opentelemetry::kExceptionType, result.classification->type);
+  ASSERT_EQ("code!=0", result.classification->description);
+  result = trpc::opentelemetry::ClassifyCallResult(-1, "service1", "method1");
+  ASSERT_EQ(nullptr, result.code);
+  ASSERT_EQ(trpc::opentelemetry::kExceptionType, result.classification->type);
+
+  // the code label is still set for codes out of the table
+  std::map<std::string, std::string> module_infos;
+  trpc::opentelemetry::SetCallResult(30000, "service1", "method1", module_infos);
+  ASSERT_EQ("30000", module_infos[trpc::opentelemetry::kCode]);
+}
+
 }  // namespace trpc::testing
@@ -0,0 +1,152 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace trpc::opentelemetry {
+
+/// @brief The trace context attached to an observation as its exemplar.
+struct ExemplarContext {
+  std::array<uint8_t, 16> trace_id{};
+  std::array<uint8_t, 8> span_id{};
+};
+
+/// @brief An exemplar of a histogram bucket, which links the bucket to a sampled trace.
+struct Exemplar {
+  ExemplarContext context;
+  /// the observed value
+  double value = 0;
+  /// the time of the observation, in milliseconds
+  uint64_t timestamp_ms = 0;
+};
+
+/// @brief The exemplars of a histogram series, which keeps the latest exemplar of each bucket.
+/// @note Offer and Get are lock-free. The exemplars of a series are rate-limited by the interval passed to Offer, and
+///       an exemplar racing with another writer of the same bucket is dropped instead of waiting.
+class HistogramExemplars {
+ public:
+  /// @param bucket_boundaries the bucket boundaries of the histogram, the exemplars of the +Inf bucket are kept too
+  explicit HistogramExemplars(std::vector<double> bucket_boundaries)
+      : bucket_boundaries_(std::move(bucket_boundaries)),
+        slots_(std::make_unique<Slot[]>(bucket_boundaries_.size() + 1)) {}
+
+  /// @brief Offers an observation as the exemplar of its bucket.
+  /// @param value the observed value
+  /// @param context the trace context of the observation
+  /// @param now_ms the current time in milliseconds
+  /// @param min_interval_ms the minimum interval between two exemplars of the series
+  /// @return Return true if the exemplar is recorded, false if it is rate-limited or dropped.
+  bool Offer(double value, const ExemplarContext& context, uint64_t now_ms, uint64_t min_interval_ms) {
+    uint64_t last_ms = last_offer_ms_.load(std::memory_order_relaxed);
+    if (last_ms != 0 && now_ms < last_ms + min_interval_ms) {
+      return false;
+    }
+    if (!last_offer_ms_.compare_exchange_strong(last_ms, now_ms, std::memory_order_relaxed)) {
+      return false;
+    }
+
+    // the same bucket lookup as prometheus histogram: the first bucket whose upper bound is not less than the value
+    size_t index = std::distance(bucket_boundaries_.begin(),
+                                 std::lower_bound(bucket_boundaries_.begin(), bucket_boundaries_.end(), value));
+    return slots_[index].Store(value, context, now_ms);
+  }
+
+  /// @brief Gets the exemplar of the bucket.
+  /// @param bucket_index the index of the bucket, and the index of the +Inf bucket is the number of bucket boundaries
+  /// @param [out] exemplar the exemplar of the bucket
+  /// @return Return true if the bucket has an exemplar.
+  bool Get(size_t bucket_index, Exemplar& exemplar) const {
+    if (bucket_index > bucket_boundaries_.size()) {
+      return false;
+    }
+    return slots_[bucket_index].Load(exemplar);
+  }
+
+  /// @brief Gets the number of buckets, including the +Inf bucket.
+  size_t BucketCount() const { return bucket_boundaries_.size() + 1; }
+
+ private:
+  // A seqlock protected slot: the sequence is odd while it is being written. The fields are stored in atomic words so
+  // that the concurrent reads are well defined, and the readers retry or give up when the sequence changes.
+  struct alignas(64) Slot {
+    static constexpr int kReadRetries = 3;
+
+    std::atomic<uint32_t> seq{0};
+    std::atomic<uint64_t> trace_id_high{0};
+    std::atomic<uint64_t> trace_id_low{0};
+    std::atomic<uint64_t> span_id{0};
+    std::atomic<uint64_t> value_bits{0};
+    std::atomic<uint64_t> timestamp_ms{0};
+
+    bool Store(double value, const ExemplarContext& context, uint64_t now_ms) {
+      uint32_t start = seq.load(std::memory_order_relaxed);
+      if ((start & 1) || !seq.compare_exchange_strong(start, start + 1, std::memory_order_acquire)) {
+        return false;
+      }
+      // the readers which see any of the following stores will see the odd sequence
+      std::atomic_thread_fence(std::memory_order_release);
+      uint64_t words[4];
+      std::memcpy(&words[0], context.trace_id.data(), 16);
+      std::memcpy(&words[2], context.span_id.data(), 8);
+      std::memcpy(&words[3], &value, 8);
+      trace_id_high.store(words[0], std::memory_order_relaxed);
+      trace_id_low.store(words[1], std::memory_order_relaxed);
+      span_id.store(words[2], std::memory_order_relaxed);
+      value_bits.store(words[3], std::memory_order_relaxed);
+      timestamp_ms.store(now_ms, std::memory_order_relaxed);
+      seq.store(start + 2, std::memory_order_release);
+      return true;
+    }
+
+    bool Load(Exemplar& exemplar) const {
+      for (int i = 0; i < kReadRetries; ++i) {
+        uint32_t start = seq.load(std::memory_order_acquire);
+        if (start == 0) {
+          return false;
+        }
+        if (start & 1) {
+          continue;
+        }
+        uint64_t words[4] = {trace_id_high.load(std::memory_order_relaxed),
+                             trace_id_low.load(std::memory_order_relaxed), span_id.load(std::memory_order_relaxed),
+                             value_bits.load(std::memory_order_relaxed)};
+        uint64_t time = timestamp_ms.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq.load(std::memory_order_relaxed) != start) {
+          continue;
+        }
+        std::memcpy(exemplar.context.trace_id.data(), &words[0], 16);
+        std::memcpy(exemplar.context.span_id.data(), &words[2], 8);
+        std::memcpy(&exemplar.value, &words[3], 8);
+        exemplar.timestamp_ms = time;
+        return true;
+      }
+      return false;
+    }
+  };
+
+  const std::vector<double> bucket_boundaries_;
+  std::unique_ptr<Slot[]> slots_;
+  std::atomic<uint64_t> last_offer_ms_{0};
+};
+
+}  // namespace trpc::opentelemetry
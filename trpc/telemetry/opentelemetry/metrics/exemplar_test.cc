@@ -0,0 +1,79 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#include "trpc/telemetry/opentelemetry/metrics/exemplar.h"
+
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace trpc::testing {
+
+TEST(HistogramExemplarsTest, Offer) {
+  trpc::opentelemetry::HistogramExemplars exemplars({0.1, 1});
+  ASSERT_EQ(3, exemplars.BucketCount());
+
+  trpc::opentelemetry::Exemplar exemplar;
+  ASSERT_FALSE(exemplars.Get(0, exemplar));
+
+  trpc::opentelemetry::ExemplarContext context;
+  context.trace_id[0] = 1;
+  context.span_id[0] = 2;
+  ASSERT_TRUE(exemplars.Offer(0.5, context, 1000, 100));
+  ASSERT_FALSE(exemplars.Get(0, exemplar));
+  ASSERT_TRUE(exemplars.Get(1, exemplar));
+  ASSERT_EQ(0.5, exemplar.value);
+  ASSERT_EQ(1000, exemplar.timestamp_ms);
+  ASSERT_EQ(1, exemplar.context.trace_id[0]);
+  ASSERT_EQ(2, exemplar.context.span_id[0]);
+
+  // the exemplars of the series are rate-limited
+  ASSERT_FALSE(exemplars.Offer(5, context, 1050, 100));
+  ASSERT_FALSE(exemplars.Get(2, exemplar));
+  // the value equal to the upper bound falls into the bucket, and the values beyond all bounds fall into +Inf
+  ASSERT_TRUE(exemplars.Offer(0.1, context, 1100, 100));
+  ASSERT_TRUE(exemplars.Get(0, exemplar));
+  ASSERT_TRUE(exemplars.Offer(5, context, 1200, 100));
+  ASSERT_TRUE(exemplars.Get(2, exemplar));
+  ASSERT_EQ(5, exemplar.value);
+  ASSERT_FALSE(exemplars.Get(3, exemplar));
+}
+
+TEST(HistogramExemplarsTest, Concurrent) {
+  trpc::opentelemetry::HistogramExemplars exemplars({1});
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&exemplars, i]() {
+      trpc::opentelemetry::ExemplarContext context;
+      // the trace id and the value are written together, so that the reader can check they are consistent
+      context.trace_id.fill(static_cast<uint8_t>(i));
+      for (uint64_t now = 1; now <= 10000; ++now) {
+        exemplars.Offer(static_cast<double>(i) / 10, context, now, 0);
+      }
+    });
+  }
+
+  trpc::opentelemetry::Exemplar exemplar;
+  for (int i = 0; i < 10000; ++i) {
+    if (exemplars.Get(0, exemplar)) {
+      ASSERT_EQ(static_cast<double>(exemplar.context.trace_id[0]) / 10, exemplar.value);
+      ASSERT_EQ(exemplar.context.trace_id[0], exemplar.context.trace_id[15]);
+    }
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+}  // namespace trpc::testing
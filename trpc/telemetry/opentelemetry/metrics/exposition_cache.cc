@@ -0,0 +1,83 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#include "trpc/telemetry/opentelemetry/metrics/exposition_cache.h"
+
+#include <atomic>
+#include <utility>
+
+namespace trpc::opentelemetry {
+
+namespace {
+
+bool IsFresh(const std::shared_ptr<std::string>& exposition, uint64_t exposition_ms, uint64_t now_ms,
+             uint64_t min_interval_ms) {
+  // the exposition is refreshed if the clock goes backwards
+  return exposition && now_ms >= exposition_ms && now_ms - exposition_ms < min_interval_ms;
+}
+
+}  // namespace
+
+std::shared_ptr<const std::string> ExpositionCache::Get(uint64_t now_ms, uint64_t min_interval_ms) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (IsFresh(current_, current_ms_, now_ms, min_interval_ms)) {
+      return current_;
+    }
+  }
+
+  if (!refresh_mutex_.try_lock()) {
+    // another caller is refreshing, the previous exposition is good enough
+    auto current = Load();
+    if (current) {
+      return current;
+    }
+    refresh_mutex_.lock();
+  }
+  std::lock_guard<std::mutex> refresh_lock(refresh_mutex_, std::adopt_lock);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (IsFresh(current_, current_ms_, now_ms, min_interval_ms)) {
+      // refreshed by another caller while waiting
+      return current_;
+    }
+  }
+  Refresh(now_ms);
+  return Load();
+}
+
+void ExpositionCache::Refresh(uint64_t now_ms) {
+  // current_ is only replaced under refresh_mutex_, so it can be read here without mutex_
+  std::shared_ptr<std::string> buffer;
+  if (retired_ && retired_.use_count() == 1) {
+    // synchronizes with the release of the retired exposition by its last holder before reusing its buffer
+    std::atomic_thread_fence(std::memory_order_acquire);
+    buffer = std::move(retired_);
+    buffer->clear();
+  } else {
+    buffer = std::make_shared<std::string>();
+    if (current_) {
+      buffer->reserve(current_->size());
+    }
+  }
+  serializer_(*buffer);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    current_.swap(buffer);
+    current_ms_ = now_ms;
+  }
+  retired_ = std::move(buffer);
+}
+
+}  // namespace trpc::opentelemetry
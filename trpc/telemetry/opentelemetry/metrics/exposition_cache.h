@@ -0,0 +1,69 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace trpc::opentelemetry {
+
+/// @brief Caches the serialized exposition of the metrics, so that frequent or concurrent scrapes do not walk and
+///        serialize the whole registry each time.
+/// @note Only one caller refreshes the exposition at a time, and the others get the previous exposition instead of
+///       waiting, unless there is none yet. The buffer of a retired exposition is reused by the next refresh once no
+///       caller holds it, so serializing a large registry does not reallocate the text every time.
+class ExpositionCache {
+ public:
+  /// @brief The function which serializes the metrics, by appending to the buffer which has been cleared.
+  using Serializer = std::function<void(std::string& out)>;
+
+  explicit ExpositionCache(Serializer serializer) : serializer_(std::move(serializer)) {}
+
+  ExpositionCache(const ExpositionCache&) = delete;
+  ExpositionCache& operator=(const ExpositionCache&) = delete;
+
+  /// @brief Gets the exposition, which is refreshed if it is older than the minimum interval.
+  /// @param now_ms the current time in milliseconds
+  /// @param min_interval_ms the minimum interval between two refreshes, 0 means refreshing on every call
+  /// @return Return the exposition, which is shared by the callers and must not be modified.
+  std::shared_ptr<const std::string> Get(uint64_t now_ms, uint64_t min_interval_ms);
+
+ private:
+  // Serializes the metrics into a new exposition
+  void Refresh(uint64_t now_ms);
+
+  std::shared_ptr<const std::string> Load() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return current_;
+  }
+
+ private:
+  Serializer serializer_;
+
+  // serializes the refreshes
+  std::mutex refresh_mutex_;
+  // the exposition retired by the last refresh, whose buffer is reused once no caller holds it
+  std::shared_ptr<std::string> retired_;
+
+  // guards current_ and current_ms_
+  mutable std::mutex mutex_;
+  std::shared_ptr<std::string> current_;
+  uint64_t current_ms_ = 0;
+};
+
+}  // namespace trpc::opentelemetry
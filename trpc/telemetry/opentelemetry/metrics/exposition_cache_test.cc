@@ -0,0 +1,92 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#include "trpc/telemetry/opentelemetry/metrics/exposition_cache.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace trpc::testing {
+
+TEST(ExpositionCacheTest, Get) {
+  int serialized = 0;
+  trpc::opentelemetry::ExpositionCache cache([&serialized](std::string& out) {
+    ASSERT_TRUE(out.empty());
+    out.append("exposition").append(std::to_string(++serialized));
+  });
+
+  // the exposition is cached within the minimum interval
+  auto exposition = cache.Get(1000, 100);
+  ASSERT_EQ("exposition1", *exposition);
+  ASSERT_EQ(exposition, cache.Get(1099, 100));
+  ASSERT_EQ(1, serialized);
+
+  // and refreshed after the minimum interval, or when the clock goes backwards
+  ASSERT_EQ("exposition2", *cache.Get(1100, 100));
+  ASSERT_EQ("exposition3", *cache.Get(500, 100));
+
+  // 0 means refreshing on every call
+  ASSERT_EQ("exposition4", *cache.Get(500, 0));
+  ASSERT_EQ("exposition5", *cache.Get(500, 0));
+}
+
+TEST(ExpositionCacheTest, ReuseBuffer) {
+  trpc::opentelemetry::ExpositionCache cache([](std::string& out) { out.append(1000, 'a'); });
+
+  auto first = cache.Get(0, 0);
+  const char* first_data = first->data();
+  first.reset();
+  cache.Get(0, 0);
+  // the buffer of the first exposition is reused as it is released by the caller
+  ASSERT_EQ(first_data, cache.Get(0, 0)->data());
+
+  // the retired exposition held by a caller is never reused
+  auto held = cache.Get(0, 0);
+  std::string copy = *held;
+  cache.Get(0, 0);
+  cache.Get(0, 0);
+  ASSERT_EQ(copy, *held);
+}
+
+TEST(ExpositionCacheTest, ConcurrentGet) {
+  std::atomic<int> refreshing{0};
+  std::atomic<bool> overlapped{false};
+  trpc::opentelemetry::ExpositionCache cache([&](std::string& out) {
+    if (refreshing.fetch_add(1) != 0) {
+      overlapped = true;
+    }
+    out.append("exposition");
+    refreshing.fetch_sub(1);
+  });
+
+  constexpr int kThreadNum = 4;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadNum; ++i) {
+    threads.emplace_back([&cache]() {
+      for (int j = 0; j < 1000; ++j) {
+        ASSERT_EQ("exposition", *cache.Get(j, j % 2));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  // the refreshes never run concurrently
+  ASSERT_FALSE(overlapped);
+}
+
+}  // namespace trpc::testing
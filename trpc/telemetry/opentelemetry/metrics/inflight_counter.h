@@ -0,0 +1,97 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace trpc::opentelemetry {
+
+/// @brief A counter of in-flight requests, which is sharded so that concurrent requests on different threads do not
+///        contend on the same cache line.
+/// @note The increment and the decrement of a request may happen on different threads and thus different shards, so
+///       the value of a single shard can be negative, but the sum of all shards is always correct.
+class InflightCounter {
+ public:
+  void Increment() { shards_[ShardIndex()].value.fetch_add(1, std::memory_order_relaxed); }
+
+  void Decrement() { shards_[ShardIndex()].value.fetch_sub(1, std::memory_order_relaxed); }
+
+  /// @brief Gets the number of in-flight requests.
+  int64_t Value() const {
+    int64_t value = 0;
+    for (const auto& shard : shards_) {
+      value += shard.value.load(std::memory_order_relaxed);
+    }
+    return value;
+  }
+
+ private:
+  static constexpr size_t kShardNum = 16;
+
+  struct alignas(64) Shard {
+    std::atomic<int64_t> value{0};
+  };
+
+  static size_t ShardIndex() {
+    static std::atomic<size_t> next_index{0};
+    thread_local size_t index = next_index.fetch_add(1, std::memory_order_relaxed) % kShardNum;
+    return index;
+  }
+
+ private:
+  std::array<Shard, kShardNum> shards_;
+};
+
+/// @brief Holds an in-flight request of the counter, which is released when the guard is released or destroyed, so
+///        that requests which never finish normally do not leak. It is a value type without allocation.
+/// @note The guard is copyable so that it can be stored in the filter data, and each copy holds a request of its own.
+class InflightGuard {
+ public:
+  InflightGuard() = default;
+
+  explicit InflightGuard(InflightCounter* counter) : counter_(counter) { counter_->Increment(); }
+
+  InflightGuard(const InflightGuard& other) : counter_(other.counter_) {
+    if (counter_) {
+      counter_->Increment();
+    }
+  }
+
+  InflightGuard(InflightGuard&& other) noexcept : counter_(std::exchange(other.counter_, nullptr)) {}
+
+  InflightGuard& operator=(InflightGuard other) noexcept {
+    std::swap(counter_, other.counter_);
+    return *this;
+  }
+
+  ~InflightGuard() { Release(); }
+
+  /// @brief Releases the request, which does nothing if it is already released.
+  void Release() {
+    if (counter_) {
+      counter_->Decrement();
+      counter_ = nullptr;
+    }
+  }
+
+ private:
+  InflightCounter* counter_ = nullptr;
+};
+
+}  // namespace trpc::opentelemetry
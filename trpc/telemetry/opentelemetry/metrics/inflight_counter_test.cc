@@ -0,0 +1,84 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+
+#include "trpc/telemetry/opentelemetry/metrics/inflight_counter.h"
+
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace trpc::testing {
+
+TEST(InflightCounterTest, IncrementAndDecrement) {
+  trpc::opentelemetry::InflightCounter counter;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([&counter]() {
+      for (int j = 0; j < 1000; ++j) {
+        counter.Increment();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(8000, counter.Value());
+
+  // decrements on another thread
+  std::thread([&counter]() {
+    for (int j = 0; j < 3000; ++j) {
+      counter.Decrement();
+    }
+  }).join();
+  ASSERT_EQ(5000, counter.Value());
+}
+
+TEST(InflightGuardTest, Release) {
+  trpc::opentelemetry::InflightCounter counter;
+  {
+    trpc::opentelemetry::InflightGuard guard(&counter);
+    ASSERT_EQ(1, counter.Value());
+    guard.Release();
+    ASSERT_EQ(0, counter.Value());
+    // releasing again does nothing
+    guard.Release();
+    ASSERT_EQ(0, counter.Value());
+  }
+  ASSERT_EQ(0, counter.Value());
+
+  // the request is released when the guard is destroyed
+  { trpc::opentelemetry::InflightGuard guard(&counter); }
+  ASSERT_EQ(0, counter.Value());
+}
+
+TEST(InflightGuardTest, MoveAndCopy) {
+  trpc::opentelemetry::InflightCounter counter;
+  trpc::opentelemetry::InflightGuard guard(&counter);
+  trpc::opentelemetry::InflightGuard moved_guard(std::move(guard));
+  ASSERT_EQ(1, counter.Value());
+  guard.Release();
+  ASSERT_EQ(1, counter.Value());
+
+  // each copy holds a request of its own
+  trpc::opentelemetry::InflightGuard copied_guard(moved_guard);
+  ASSERT_EQ(2, counter.Value());
+  moved_guard = trpc::opentelemetry::InflightGuard();
+  ASSERT_EQ(1, counter.Value());
+  copied_guard.Release();
+  ASSERT_EQ(0, counter.Value());
+}
+
+}  // namespace trpc::testing
@@ -0,0 +1,217 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+
+#ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include "prometheus/counter.h"
+#include "prometheus/family.h"
+#include "prometheus/gauge.h"
+
+#include "trpc/telemetry/opentelemetry/metrics/inflight_counter.h"
+#include "trpc/telemetry/opentelemetry/metrics/labeled_family.h"
+#include "trpc/telemetry/opentelemetry/metrics/series_limiter.h"
+
+namespace trpc::opentelemetry {
+
+/// @brief The in-flight requests of a gauge family with fixed label names. The requests are counted by the sharded
+///        InflightCounter, and the values are copied into the gauges by Sync, which should be called periodically.
+/// @note The counters are never removed, so their number is bounded by SetMaxSeries. Once the limit is reached, the
+///       requests with new label values are counted by a single overflow gauge with the label `overflow="true"`, and
+///       the dropped_counter is incremented for each of them if it is not nullptr. Each thread caches the counters it
+///       has got recently, so that getting the counter of a request usually takes no lock.
+template <size_t N>
+class InflightGauges {
+ public:
+  InflightGauges(::prometheus::Family<::prometheus::Gauge>* family, const LabelNames<N>& label_names,
+                 ::prometheus::Counter* dropped_counter = nullptr)
+      : family_(family), dropped_counter_(dropped_counter), id_(next_id_.fetch_add(1, std::memory_order_relaxed)) {
+    for (size_t i = 0; i < N; ++i) {
+      label_names_[i] = std::string(label_names[i]);
+    }
+  }
+
+  InflightGauges(const InflightGauges&) = delete;
+  InflightGauges& operator=(const InflightGauges&) = delete;
+
+  /// @brief Sets the maximum number of the counters, 0 means unlimited. The counters created already are kept even if
+  ///        they are beyond the limit.
+  void SetMaxSeries(uint32_t max_series) { max_series_.store(max_series, std::memory_order_relaxed); }
+
+  /// @brief Gets the counter of the label values, and the counter will be created if it does not exist yet.
+  /// @return Return the counter, or the overflow counter if the limit of the counters is reached, which is valid as
+  ///         long as the InflightGauges is alive.
+  InflightCounter* Get(const LabelValues<N>& label_values) {
+    size_t hash = Hash(label_values);
+    CacheSlot& slot = GetThreadCache()[hash % kCacheSize];
+    if (slot.owner_id == id_ && slot.hash == hash && slot.entry->Matches(label_values)) {
+      return &slot.entry->counter;
+    }
+
+    Entry* entry = Find(hash, label_values);
+    if (!entry) {
+      entry = Add(hash, label_values);
+      if (!entry) {
+        // the overflow counter is not cached, as it matches no label values
+        return GetOverflow();
+      }
+    }
+    slot = CacheSlot{id_, hash, entry};
+    return &entry->counter;
+  }
+
+  /// @brief Copies the values of the counters into the gauges.
+  void Sync() {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    for (const auto& [hash, entry] : entries_) {
+      entry->gauge->Set(static_cast<double>(entry->counter.Value()));
+    }
+    if (overflow_gauge_.load(std::memory_order_acquire)) {
+      overflow_gauge_.load(std::memory_order_relaxed)->Set(static_cast<double>(overflow_counter_.Value()));
+    }
+  }
+
+  /// @brief Gets the number of the counters, excluding the overflow counter.
+  size_t Size() const { return entry_num_.load(std::memory_order_relaxed); }
+
+ private:
+  static constexpr size_t kCacheSize = 64;
+
+  struct Entry {
+    std::array<std::string, N> label_values;
+    ::prometheus::Gauge* gauge = nullptr;
+    InflightCounter counter;
+
+    bool Matches(const LabelValues<N>& values) const {
+      for (size_t i = 0; i < N; ++i) {
+        if (label_values[i] != values[i]) {
+          return false;
+        }
+      }
+      return true;
+    }
+  };
+
+  // The entries are never removed, so the cached pointers are valid as long as the owner is alive, and the owner is
+  // identified by its id instead of its address which may be reused
+  struct CacheSlot {
+    uint64_t owner_id = 0;
+    size_t hash = 0;
+    Entry* entry = nullptr;
+  };
+
+  static std::array<CacheSlot, kCacheSize>& GetThreadCache() {
+    thread_local std::array<CacheSlot, kCacheSize> cache;
+    return cache;
+  }
+
+  static size_t Hash(const LabelValues<N>& label_values) {
+    size_t seed = N;
+    for (const auto& value : label_values) {
+      seed ^= std::hash<std::string_view>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+    return seed;
+  }
+
+  Entry* Find(size_t hash, const LabelValues<N>& label_values) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return FindLocked(hash, label_values);
+  }
+
+  Entry* FindLocked(size_t hash, const LabelValues<N>& label_values) const {
+    auto range = entries_.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second->Matches(label_values)) {
+        return it->second.get();
+      }
+    }
+    return nullptr;
+  }
+
+  // returns nullptr if the limit is reached
+  Entry* Add(size_t hash, const LabelValues<N>& label_values) {
+    uint32_t max_series = max_series_.load(std::memory_order_relaxed);
+    // the requests beyond the limit do not take the exclusive lock
+    if (max_series > 0 && entry_num_.load(std::memory_order_relaxed) >= max_series) {
+      return nullptr;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (Entry* entry = FindLocked(hash, label_values)) {
+      return entry;
+    }
+    if (max_series > 0 && entries_.size() >= max_series) {
+      return nullptr;
+    }
+    auto entry = std::make_unique<Entry>();
+    std::map<std::string, std::string> labels;
+    for (size_t i = 0; i < N; ++i) {
+      entry->label_values[i] = std::string(label_values[i]);
+      labels.emplace(label_names_[i], entry->label_values[i]);
+    }
+    entry->gauge = &family_->Add(labels);
+    Entry* added = entries_.emplace(hash, std::move(entry))->second.get();
+    entry_num_.store(entries_.size(), std::memory_order_relaxed);
+    return added;
+  }
+
+  InflightCounter* GetOverflow() {
+    if (!overflow_gauge_.load(std::memory_order_acquire)) {
+      std::call_once(overflow_once_, [this]() {
+        overflow_gauge_.store(&family_->Add({{kOverflowLabelKey, kOverflowLabelValue}}), std::memory_order_release);
+      });
+    }
+    if (dropped_counter_) {
+      dropped_counter_->Increment();
+    }
+    return &overflow_counter_;
+  }
+
+ private:
+  // starts from 1, so that the empty cache slots match no owner
+  static inline std::atomic<uint64_t> next_id_{1};
+
+  ::prometheus::Family<::prometheus::Gauge>* family_;
+  ::prometheus::Counter* dropped_counter_;
+  std::array<std::string, N> label_names_;
+  const uint64_t id_;
+  std::atomic<uint32_t> max_series_{0};
+
+  mutable std::shared_mutex mutex_;
+  std::unordered_multimap<size_t, std::unique_ptr<Entry>> entries_;
+  // the size of entries_, which is read without the lock
+  std::atomic<size_t> entry_num_{0};
+
+  // counts the requests with new label values once the limit is reached, whose gauge is added on the first use
+  InflightCounter overflow_counter_;
+  std::once_flag overflow_once_;
+  std::atomic<::prometheus::Gauge*> overflow_gauge_{nullptr};
+};
+
+}  // namespace trpc::opentelemetry
+#endif
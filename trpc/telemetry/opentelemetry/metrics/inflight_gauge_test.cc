@@ -0,0 +1,116 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+
+#ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
+#include "trpc/telemetry/opentelemetry/metrics/inflight_gauge.h"
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "prometheus/registry.h"
+
+namespace trpc::testing {
+
+TEST(InflightGaugesTest, Sync) {
+  auto registry = std::make_shared<::prometheus::Registry>();
+  auto& family = ::prometheus::BuildGauge().Name("inflight_gauges_test").Help("test").Register(*registry);
+  trpc::opentelemetry::InflightGauges<2> inflight_gauges(&family, {"service", "method"});
+
+  auto* counter = inflight_gauges.Get({"service1", "method1"});
+  ASSERT_EQ(counter, inflight_gauges.Get({"service1", "method1"}));
+  ASSERT_NE(counter, inflight_gauges.Get({"service1", "method2"}));
+
+  counter->Increment();
+  counter->Increment();
+  auto& gauge = family.Add({{"service", "service1"}, {"method", "method1"}});
+  // the gauge is updated only after sync
+  ASSERT_EQ(0, gauge.Value());
+  inflight_gauges.Sync();
+  ASSERT_EQ(2, gauge.Value());
+
+  counter->Decrement();
+  inflight_gauges.Sync();
+  ASSERT_EQ(1, gauge.Value());
+}
+
+TEST(InflightGaugesTest, ThreadCache) {
+  auto registry = std::make_shared<::prometheus::Registry>();
+  auto& family = ::prometheus::BuildGauge().Name("inflight_gauges_cache_test").Help("test").Register(*registry);
+  trpc::opentelemetry::InflightGauges<1> inflight_gauges(&family, {"service"});
+  trpc::opentelemetry::InflightGauges<1> other_inflight_gauges(&family, {"other_service"});
+
+  // the cached counters are not shared by the gauges of the same label values
+  auto* counter = inflight_gauges.Get({"service"});
+  ASSERT_NE(counter, other_inflight_gauges.Get({"service"}));
+  ASSERT_EQ(counter, inflight_gauges.Get({"service"}));
+
+  // the threads get the same counter
+  std::vector<trpc::opentelemetry::InflightCounter*> counters(4);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < counters.size(); ++i) {
+    threads.emplace_back([&inflight_gauges, &counters, i]() {
+      for (int j = 0; j < 100; ++j) {
+        counters[i] = inflight_gauges.Get({"service"});
+        inflight_gauges.Get({"service" + std::to_string(j)});
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto* thread_counter : counters) {
+    ASSERT_EQ(counter, thread_counter);
+  }
+}
+
+TEST(InflightGaugesTest, MaxSeries) {
+  auto registry = std::make_shared<::prometheus::Registry>();
+  auto& family = ::prometheus::BuildGauge().Name("inflight_gauges_limit_test").Help("test").Register(*registry);
+  auto& dropped_family = ::prometheus::BuildCounter().Name("inflight_gauges_dropped").Help("test").Register(*registry);
+  auto& dropped_counter = dropped_family.Add({});
+  trpc::opentelemetry::InflightGauges<2> inflight_gauges(&family, {"service", "method"}, &dropped_counter);
+  inflight_gauges.SetMaxSeries(2);
+
+  auto* counter1 = inflight_gauges.Get({"service", "method1"});
+  auto* counter2 = inflight_gauges.Get({"service", "method2"});
+  ASSERT_NE(counter1, counter2);
+  ASSERT_EQ(2, inflight_gauges.Size());
+
+  // the requests with new label values are counted by the overflow counter
+  auto* overflow_counter = inflight_gauges.Get({"service", "method3"});
+  ASSERT_NE(counter1, overflow_counter);
+  ASSERT_NE(counter2, overflow_counter);
+  ASSERT_EQ(overflow_counter, inflight_gauges.Get({"service", "method4"}));
+  ASSERT_EQ(2, inflight_gauges.Size());
+  ASSERT_EQ(2, dropped_counter.Value());
+  // the existing label values still get their own counters
+  ASSERT_EQ(counter1, inflight_gauges.Get({"service", "method1"}));
+
+  overflow_counter->Increment();
+  inflight_gauges.Sync();
+  auto& overflow_gauge =
+      family.Add({{trpc::opentelemetry::kOverflowLabelKey, trpc::opentelemetry::kOverflowLabelValue}});
+  ASSERT_EQ(1, overflow_gauge.Value());
+
+  // no limit
+  inflight_gauges.SetMaxSeries(0);
+  ASSERT_NE(overflow_counter, inflight_gauges.Get({"service", "method3"}));
+  ASSERT_EQ(3, inflight_gauges.Size());
+}
+
+}  // namespace trpc::testing
+#endif
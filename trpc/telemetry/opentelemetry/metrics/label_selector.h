@@ -0,0 +1,184 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "trpc/telemetry/opentelemetry/metrics/common.h"
+
+namespace trpc::opentelemetry {
+
+/// @brief A set of the labels of the RPC metrics, in which each label takes the bit of its index in kRpcLabelNames.
+using LabelMask = uint32_t;
+
+/// @brief The labels of the RPC metrics which can be selected.
+constexpr const char* kRpcLabelNames[] = {kCallerService, kCallerMethod, kCalleeService, kCalleeMethod,
+                                          kCode,          kCodeType,     kCodeDesc};
+
+constexpr size_t kRpcLabelCount = sizeof(kRpcLabelNames) / sizeof(kRpcLabelNames[0]);
+
+/// @brief The mask which selects all the labels of the RPC metrics.
+constexpr LabelMask kAllRpcLabels = (1u << kRpcLabelCount) - 1;
+
+/// @brief Gets the bit of the label of the RPC metrics.
+/// @return Return the bit of the label, or 0 if the label is not one of kRpcLabelNames.
+inline LabelMask GetRpcLabelBit(std::string_view name) {
+  for (size_t i = 0; i < kRpcLabelCount; ++i) {
+    if (name == kRpcLabelNames[i]) {
+      return 1u << i;
+    }
+  }
+  return 0;
+}
+
+/// @brief Checks whether the label of the RPC metrics is selected by the mask.
+/// @param label one of kRpcLabelNames
+inline bool IsRpcLabelSelected(LabelMask mask, const char* label) { return (mask & GetRpcLabelBit(label)) != 0; }
+
+/// @brief Converts the configured label names into a mask.
+/// @param names the label names to keep, empty means keeping all the labels
+/// @param [out] unknown_names the names which are not labels of the RPC metrics, they are ignored
+/// @return Return the mask of the selected labels.
+inline LabelMask ToRpcLabelMask(const std::vector<std::string>& names, std::vector<std::string>* unknown_names) {
+  if (names.empty()) {
+    return kAllRpcLabels;
+  }
+
+  LabelMask mask = 0;
+  for (const auto& name : names) {
+    LabelMask bit = GetRpcLabelBit(name);
+    if (bit == 0 && unknown_names) {
+      unknown_names->push_back(name);
+    }
+    mask |= bit;
+  }
+  return mask;
+}
+
+/// @brief Adds the label of the RPC metrics if it is selected by the mask, the value is not copied otherwise.
+/// @param key one of kRpcLabelNames
+inline void AddRpcLabel(std::map<std::string, std::string>& labels, LabelMask mask, const char* key,
+                        const std::string& value) {
+  if (IsRpcLabelSelected(mask, key)) {
+    labels.emplace(key, value);
+  }
+}
+
+/// @brief Sets the call result labels selected by the mask like SetCallResult, the labels which are not selected are
+///        neither formatted nor copied.
+/// @param ret_code error code
+/// @param service_name servive name
+/// @param method method
+/// @param mask the selected labels
+/// @param [out] labels the labels to set into
+inline void SetSelectedCallResult(int ret_code, const std::string& service_name, const std::string& method,
+                                  LabelMask mask, std::map<std::string, std::string>& labels) {
+  if ((mask & kAllRpcLabels) == kAllRpcLabels) {
+    SetCallResult(ret_code, service_name, method, labels);
+    return;
+  }
+
+  CallResult result = ClassifyCallResult(ret_code, service_name, method);
+  if (IsRpcLabelSelected(mask, kCode)) {
+    labels[kCode] = result.code ? *result.code : std::to_string(ret_code);
+  }
+  if (IsRpcLabelSelected(mask, kCodeType)) {
+    labels[kCodeType] = result.classification->type;
+  }
+  if (IsRpcLabelSelected(mask, kCodeDesc)) {
+    labels[kCodeDesc] = result.classification->description;
+  }
+}
+
+/// @brief Checks whether the label is kept by the mask, labels which are not in kRpcLabelNames are always kept.
+inline bool IsLabelKept(const std::string& key, LabelMask mask) {
+  LabelMask bit = GetRpcLabelBit(key);
+  return bit == 0 || (mask & bit) != 0;
+}
+
+/// @brief Drops the labels of the RPC metrics which are not selected by the mask. Labels which are not in
+///        kRpcLabelNames, such as the labels of user reports, are always kept.
+/// @param labels the labels to select from
+/// @param mask the selected labels
+/// @param [out] buffer the storage of the selected labels, which is only used when some labels are dropped
+/// @return Return labels itself if nothing is dropped, otherwise the buffer filled with the selected labels.
+inline const std::map<std::string, std::string>& SelectRpcLabels(const std::map<std::string, std::string>& labels,
+                                                                 LabelMask mask,
+                                                                 std::map<std::string, std::string>& buffer) {
+  if ((mask & kAllRpcLabels) == kAllRpcLabels) {
+    return labels;
+  }
+
+  bool dropped = false;
+  for (size_t i = 0; i < kRpcLabelCount && !dropped; ++i) {
+    dropped = (mask & (1u << i)) == 0 && labels.count(kRpcLabelNames[i]) != 0;
+  }
+  if (!dropped) {
+    return labels;
+  }
+
+  buffer.clear();
+  for (const auto& [key, value] : labels) {
+    if (IsLabelKept(key, mask)) {
+      buffer.emplace_hint(buffer.end(), key, value);
+    }
+  }
+  return buffer;
+}
+
+/// @brief Hashes the labels selected by the mask like SelectRpcLabels, without copying them.
+/// @return Return the same hash as the labels returned by SelectRpcLabels with mask kAllRpcLabels.
+inline size_t HashSelectedRpcLabels(const std::map<std::string, std::string>& labels, LabelMask mask) {
+  bool select_all = (mask & kAllRpcLabels) == kAllRpcLabels;
+  size_t seed = 0;
+  for (const auto& [key, value] : labels) {
+    if (select_all || IsLabelKept(key, mask)) {
+      seed ^= std::hash<std::string>{}(key) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+      seed ^= std::hash<std::string>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+  }
+  return seed;
+}
+
+/// @brief Compares the selected labels with the labels selected by the mask like SelectRpcLabels, without copying them.
+/// @param selected the labels which have been selected
+/// @param labels the labels to select from
+/// @param mask the selected labels
+/// @return Return true if the selected labels of both are equal.
+inline bool EqualSelectedRpcLabels(const std::map<std::string, std::string>& selected,
+                                   const std::map<std::string, std::string>& labels, LabelMask mask) {
+  if ((mask & kAllRpcLabels) == kAllRpcLabels) {
+    return selected == labels;
+  }
+
+  auto selected_it = selected.begin();
+  for (const auto& label : labels) {
+    if (!IsLabelKept(label.first, mask)) {
+      continue;
+    }
+    if (selected_it == selected.end() || *selected_it != label) {
+      return false;
+    }
+    ++selected_it;
+  }
+  return selected_it == selected.end();
+}
+
+}  // namespace trpc::opentelemetry
@@ -0,0 +1,107 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#include "trpc/telemetry/opentelemetry/metrics/label_selector.h"
+
+#include "gtest/gtest.h"
+
+namespace trpc::testing {
+
+TEST(LabelSelectorTest, ToRpcLabelMask) {
+  std::vector<std::string> unknown_names;
+  ASSERT_EQ(trpc::opentelemetry::kAllRpcLabels, trpc::opentelemetry::ToRpcLabelMask({}, &unknown_names));
+
+  auto mask = trpc::opentelemetry::ToRpcLabelMask(
+      {trpc::opentelemetry::kCalleeService, trpc::opentelemetry::kCode, "unknown"}, &unknown_names);
+  ASSERT_TRUE(trpc::opentelemetry::IsRpcLabelSelected(mask, trpc::opentelemetry::kCalleeService));
+  ASSERT_TRUE(trpc::opentelemetry::IsRpcLabelSelected(mask, trpc::opentelemetry::kCode));
+  ASSERT_FALSE(trpc::opentelemetry::IsRpcLabelSelected(mask, trpc::opentelemetry::kCallerMethod));
+  ASSERT_FALSE(trpc::opentelemetry::IsRpcLabelSelected(mask, trpc::opentelemetry::kCodeDesc));
+  ASSERT_EQ(std::vector<std::string>{"unknown"}, unknown_names);
+}
+
+TEST(LabelSelectorTest, SelectRpcLabels) {
+  std::map<std::string, std::string> labels = {{trpc::opentelemetry::kCallerMethod, "caller_method"},
+                                               {trpc::opentelemetry::kCalleeService, "callee_service"},
+                                               {"user_key", "user_value"}};
+  std::map<std::string, std::string> buffer;
+
+  // returns the labels itself when nothing is dropped
+  ASSERT_EQ(&labels, &trpc::opentelemetry::SelectRpcLabels(labels, trpc::opentelemetry::kAllRpcLabels, buffer));
+  auto mask = trpc::opentelemetry::kAllRpcLabels & ~trpc::opentelemetry::GetRpcLabelBit(trpc::opentelemetry::kCode);
+  ASSERT_EQ(&labels, &trpc::opentelemetry::SelectRpcLabels(labels, mask, buffer));
+
+  mask = trpc::opentelemetry::GetRpcLabelBit(trpc::opentelemetry::kCalleeService);
+  const auto& selected = trpc::opentelemetry::SelectRpcLabels(labels, mask, buffer);
+  ASSERT_EQ(&buffer, &selected);
+  std::map<std::string, std::string> expected = {{trpc::opentelemetry::kCalleeService, "callee_service"},
+                                                 {"user_key", "user_value"}};
+  ASSERT_EQ(expected, selected);
+}
+
+TEST(LabelSelectorTest, HashAndEqualSelectedRpcLabels) {
+  std::map<std::string, std::string> labels = {{trpc::opentelemetry::kCallerMethod, "caller_method"},
+                                               {trpc::opentelemetry::kCalleeService, "callee_service"},
+                                               {"user_key", "user_value"}};
+  auto mask = trpc::opentelemetry::GetRpcLabelBit(trpc::opentelemetry::kCalleeService);
+  std::map<std::string, std::string> buffer;
+  std::map<std::string, std::string> selected = trpc::opentelemetry::SelectRpcLabels(labels, mask, buffer);
+
+  // the projection of the labels is the same as the selected labels
+  ASSERT_EQ(trpc::opentelemetry::HashSelectedRpcLabels(selected, trpc::opentelemetry::kAllRpcLabels),
+            trpc::opentelemetry::HashSelectedRpcLabels(labels, mask));
+  ASSERT_TRUE(trpc::opentelemetry::EqualSelectedRpcLabels(selected, labels, mask));
+  ASSERT_TRUE(trpc::opentelemetry::EqualSelectedRpcLabels(labels, labels, trpc::opentelemetry::kAllRpcLabels));
+  ASSERT_FALSE(trpc::opentelemetry::EqualSelectedRpcLabels(selected, labels, trpc::opentelemetry::kAllRpcLabels));
+
+  // the labels which are dropped do not matter
+  std::map<std::string, std::string> other_labels = labels;
+  other_labels[trpc::opentelemetry::kCallerMethod] = "other_caller_method";
+  ASSERT_EQ(trpc::opentelemetry::HashSelectedRpcLabels(labels, mask),
+            trpc::opentelemetry::HashSelectedRpcLabels(other_labels, mask));
+  ASSERT_TRUE(trpc::opentelemetry::EqualSelectedRpcLabels(selected, other_labels, mask));
+
+  // the labels which are kept do
+  other_labels["user_key"] = "other_user_value";
+  ASSERT_FALSE(trpc::opentelemetry::EqualSelectedRpcLabels(selected, other_labels, mask));
+  other_labels.erase("user_key");
+  ASSERT_FALSE(trpc::opentelemetry::EqualSelectedRpcLabels(selected, other_labels, mask));
+  ASSERT_FALSE(trpc::opentelemetry::EqualSelectedRpcLabels(other_labels, labels, mask));
+}
+
+TEST(LabelSelectorTest, SetSelectedCallResult) {
+  trpc::opentelemetry::InitDefaultCodeMap();
+
+  std::map<std::string, std::string> labels;
+  trpc::opentelemetry::SetSelectedCallResult(0, "service", "method", trpc::opentelemetry::kAllRpcLabels, labels);
+  ASSERT_EQ(3, labels.size());
+
+  labels.clear();
+  auto mask =
+      trpc::opentelemetry::ToRpcLabelMask({trpc::opentelemetry::kCode, trpc::opentelemetry::kCodeType}, nullptr);
+  trpc::opentelemetry::SetSelectedCallResult(0, "service", "method", mask, labels);
+  ASSERT_EQ(2, labels.size());
+  ASSERT_EQ("0", labels[trpc::opentelemetry::kCode]);
+  ASSERT_EQ(trpc::opentelemetry::kSuccessType, labels[trpc::opentelemetry::kCodeType]);
+  ASSERT_EQ(0, labels.count(trpc::opentelemetry::kCodeDesc));
+
+  labels.clear();
+  mask = trpc::opentelemetry::ToRpcLabelMask({trpc::opentelemetry::kCalleeService}, nullptr);
+  trpc::opentelemetry::AddRpcLabel(labels, mask, trpc::opentelemetry::kCalleeService, "service");
+  trpc::opentelemetry::AddRpcLabel(labels, mask, trpc::opentelemetry::kCalleeMethod, "method");
+  trpc::opentelemetry::SetSelectedCallResult(0, "service", "method", mask, labels);
+  std::map<std::string, std::string> expected = {{trpc::opentelemetry::kCalleeService, "service"}};
+  ASSERT_EQ(expected, labels);
+}
+
+}  // namespace trpc::testing
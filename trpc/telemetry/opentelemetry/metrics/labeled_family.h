@@ -0,0 +1,284 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+
+#ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "prometheus/counter.h"
+#include "prometheus/family.h"
+#include "prometheus/gauge.h"
+#include "prometheus/histogram.h"
+#include "trpc/util/time.h"
+
+#include "trpc/telemetry/opentelemetry/metrics/series_limiter.h"
+
+namespace trpc::opentelemetry {
+
+/// @brief The label names of a family, which are fixed when registering the family.
+template <size_t N>
+using LabelNames = std::array<std::string_view, N>;
+
+/// @brief The label values of a report, in the same order as the label names.
+template <size_t N>
+using LabelValues = std::array<std::string_view, N>;
+
+/// @brief A family whose series are limited by the metrics plugin, in the same way as the families of the plugin.
+class SeriesLimitable {
+ public:
+  virtual ~SeriesLimitable() = default;
+
+  /// @brief Sets the limit of the series. The label_mask of the options is ignored.
+  /// @param dropped_counter the counter incremented for every report folded into the overflow series, can be nullptr
+  /// @param evicted_counter the counter incremented for every evicted series, can be nullptr
+  virtual void SetLimit(const SeriesLimitOptions& options, ::prometheus::Counter* dropped_counter,
+                        ::prometheus::Counter* evicted_counter) = 0;
+
+  /// @brief Evicts the series that have not been updated within the ttl.
+  /// @return Return the number of evicted series.
+  virtual size_t EvictStale(uint64_t now_ms) = 0;
+};
+
+/// @brief A prometheus family whose label names are fixed when it is registered, so that reports only pass the label
+///        values by position. The series are cached by the hash of the values, and the labels map of prometheus is only
+///        built when a series is reported for the first time.
+/// @note It is thread-safe. The series are unlimited until SetLimit is called, after which reports with new label
+///       values beyond max_series are folded into the overflow series, and EvictStale removes the series which are not
+///       updated within the ttl, like SeriesLimitedFamily.
+template <typename T, size_t N>
+class LabeledFamily : public SeriesLimitable {
+ public:
+  LabeledFamily(::prometheus::Family<T>* family, const LabelNames<N>& label_names) : family_(family) {
+    for (size_t i = 0; i < N; ++i) {
+      label_names_[i] = std::string(label_names[i]);
+    }
+  }
+
+  LabeledFamily(const LabeledFamily&) = delete;
+  LabeledFamily& operator=(const LabeledFamily&) = delete;
+
+  void SetLimit(const SeriesLimitOptions& options, ::prometheus::Counter* dropped_counter,
+                ::prometheus::Counter* evicted_counter) override {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    max_series_ = options.max_series;
+    ttl_ms_ = options.ttl_ms;
+    dropped_counter_ = dropped_counter;
+    evicted_counter_ = evicted_counter;
+  }
+
+  /// @brief Updates the series with the label values, and the series will be created if it does not exist yet. The
+  ///        series is updated under the lock of the family, so that it can not be evicted meanwhile.
+  /// @param label_values the label values in the same order as the label names
+  /// @param now_ms the current time in milliseconds, which is used as the last updated time of the series
+  /// @param updater the function called with the series, or with the overflow series when the limit is reached
+  /// @param args the arguments used to create the series, such as the buckets of histogram
+  template <typename Updater, typename... Args>
+  void Update(const LabelValues<N>& label_values, uint64_t now_ms, Updater&& updater, Args&&... args) {
+    size_t hash = Hash(label_values);
+    {
+      std::shared_lock<std::shared_mutex> lock(mutex_);
+      if (Series* series = FindLocked(hash, label_values)) {
+        series->last_update_ms.store(now_ms, std::memory_order_relaxed);
+        updater(*series->metric);
+        return;
+      }
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    Series* series = FindLocked(hash, label_values);
+    if (!series) {
+      series = AddLocked(hash, label_values, std::forward<Args>(args)...);
+    }
+    series->last_update_ms.store(now_ms, std::memory_order_relaxed);
+    updater(*series->metric);
+  }
+
+  size_t EvictStale(uint64_t now_ms) override {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (ttl_ms_ == 0) {
+      return 0;
+    }
+
+    size_t evicted = 0;
+    for (auto it = series_.begin(); it != series_.end();) {
+      if (IsStale(it->second, now_ms)) {
+        family_->Remove(it->second.metric);
+        it = series_.erase(it);
+        ++evicted;
+      } else {
+        ++it;
+      }
+    }
+    if (overflow_.metric && IsStale(overflow_, now_ms)) {
+      family_->Remove(overflow_.metric);
+      overflow_.metric = nullptr;
+      ++evicted;
+    }
+
+    if (evicted_counter_ && evicted > 0) {
+      evicted_counter_->Increment(static_cast<double>(evicted));
+    }
+    return evicted;
+  }
+
+  /// @brief Gets the number of series in the family, excluding the overflow series.
+  size_t Size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return series_.size();
+  }
+
+  /// @brief Gets the label names of the family.
+  const std::array<std::string, N>& GetLabelNames() const { return label_names_; }
+
+ private:
+  struct Series {
+    std::array<std::string, N> label_values;
+    T* metric = nullptr;
+    // updated under the shared lock
+    std::atomic<uint64_t> last_update_ms{0};
+  };
+
+  static size_t Hash(const LabelValues<N>& label_values) {
+    size_t seed = N;
+    for (const auto& value : label_values) {
+      seed ^= std::hash<std::string_view>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+    return seed;
+  }
+
+  bool IsFull() const { return max_series_ > 0 && series_.size() >= max_series_; }
+
+  // Finds the series of the label values, or the overflow series if the values are new and the limit is reached
+  Series* FindLocked(size_t hash, const LabelValues<N>& label_values) {
+    auto range = series_.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      bool equal = true;
+      for (size_t i = 0; i < N && equal; ++i) {
+        equal = it->second.label_values[i] == label_values[i];
+      }
+      if (equal) {
+        return &it->second;
+      }
+    }
+    if (overflow_.metric && IsFull()) {
+      if (dropped_counter_) {
+        dropped_counter_->Increment();
+      }
+      return &overflow_;
+    }
+    return nullptr;
+  }
+
+  template <typename... Args>
+  Series* AddLocked(size_t hash, const LabelValues<N>& label_values, Args&&... args) {
+    if (IsFull()) {
+      if (dropped_counter_) {
+        dropped_counter_->Increment();
+      }
+      overflow_.metric = &family_->Add({{kOverflowLabelKey, kOverflowLabelValue}}, std::forward<Args>(args)...);
+      return &overflow_;
+    }
+
+    std::map<std::string, std::string> labels;
+    Series& series =
+        series_.emplace(std::piecewise_construct, std::forward_as_tuple(hash), std::forward_as_tuple())->second;
+    for (size_t i = 0; i < N; ++i) {
+      series.label_values[i] = std::string(label_values[i]);
+      labels.emplace(label_names_[i], series.label_values[i]);
+    }
+    series.metric = &family_->Add(labels, std::forward<Args>(args)...);
+    return &series;
+  }
+
+  bool IsStale(const Series& series, uint64_t now_ms) const {
+    uint64_t last_update_ms = series.last_update_ms.load(std::memory_order_relaxed);
+    return now_ms > last_update_ms && now_ms - last_update_ms >= ttl_ms_;
+  }
+
+ private:
+  ::prometheus::Family<T>* family_;
+  std::array<std::string, N> label_names_;
+
+  mutable std::shared_mutex mutex_;
+  std::unordered_multimap<size_t, Series> series_;
+  Series overflow_;
+  uint32_t max_series_ = 0;
+  uint64_t ttl_ms_ = 0;
+  ::prometheus::Counter* dropped_counter_ = nullptr;
+  ::prometheus::Counter* evicted_counter_ = nullptr;
+};
+
+/// @brief A counter family with fixed label names.
+template <size_t N>
+class LabeledCounterFamily : public LabeledFamily<::prometheus::Counter, N> {
+ public:
+  LabeledCounterFamily(::prometheus::Family<::prometheus::Counter>* family, const LabelNames<N>& label_names)
+      : LabeledFamily<::prometheus::Counter, N>(family, label_names) {}
+
+  /// @brief Increments the counter of the label values by the value, which must be non-negative.
+  void Increment(const LabelValues<N>& label_values, double value = 1) {
+    this->Update(label_values, trpc::time::GetMilliSeconds(),
+                 [value](::prometheus::Counter& counter) { counter.Increment(value); });
+  }
+};
+
+/// @brief A gauge family with fixed label names.
+template <size_t N>
+class LabeledGaugeFamily : public LabeledFamily<::prometheus::Gauge, N> {
+ public:
+  LabeledGaugeFamily(::prometheus::Family<::prometheus::Gauge>* family, const LabelNames<N>& label_names)
+      : LabeledFamily<::prometheus::Gauge, N>(family, label_names) {}
+
+  /// @brief Sets the gauge of the label values to the value.
+  void Set(const LabelValues<N>& label_values, double value) {
+    this->Update(label_values, trpc::time::GetMilliSeconds(),
+                 [value](::prometheus::Gauge& gauge) { gauge.Set(value); });
+  }
+};
+
+/// @brief A histogram family with fixed label names and buckets.
+template <size_t N>
+class LabeledHistogramFamily : public LabeledFamily<::prometheus::Histogram, N> {
+ public:
+  LabeledHistogramFamily(::prometheus::Family<::prometheus::Histogram>* family, const LabelNames<N>& label_names,
+                         std::vector<double> bucket)
+      : LabeledFamily<::prometheus::Histogram, N>(family, label_names), bucket_(std::move(bucket)) {}
+
+  /// @brief Observes the value into the histogram of the label values.
+  void Observe(const LabelValues<N>& label_values, double value) {
+    this->Update(
+        label_values, trpc::time::GetMilliSeconds(),
+        [value](::prometheus::Histogram& histogram) { histogram.Observe(value); }, bucket_);
+  }
+
+ private:
+  std::vector<double> bucket_;
+};
+
+}  // namespace trpc::opentelemetry
+#endif
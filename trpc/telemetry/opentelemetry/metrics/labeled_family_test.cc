@@ -0,0 +1,136 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+
+#ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
+#include "trpc/telemetry/opentelemetry/metrics/labeled_family.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "prometheus/registry.h"
+
+namespace trpc::testing {
+
+namespace {
+
+template <typename T, size_t N>
+T* AddSeries(trpc::opentelemetry::LabeledFamily<T, N>& labeled_family,
+             const trpc::opentelemetry::LabelValues<N>& label_values, uint64_t now_ms = 0) {
+  T* series = nullptr;
+  labeled_family.Update(label_values, now_ms, [&series](T& metric) { series = &metric; });
+  return series;
+}
+
+}  // namespace
+
+class LabeledFamilyTest : public ::testing::Test {
+ protected:
+  void SetUp() override { registry_ = std::make_shared<::prometheus::Registry>(); }
+
+ protected:
+  std::shared_ptr<::prometheus::Registry> registry_;
+};
+
+TEST_F(LabeledFamilyTest, Update) {
+  auto& family = ::prometheus::BuildCounter().Name("labeled_family_test").Help("test").Register(*registry_);
+  trpc::opentelemetry::LabeledFamily<::prometheus::Counter, 2> labeled_family(&family, {"key1", "key2"});
+
+  auto* counter = AddSeries(labeled_family, {"value1", "value2"});
+  // the label values are matched by position
+  ASSERT_EQ(counter, &family.Add({{"key1", "value1"}, {"key2", "value2"}}));
+  ASSERT_NE(counter, AddSeries(labeled_family, {"value2", "value1"}));
+
+  // the label values do not need to outlive the report
+  std::string value = "value";
+  value += "1";
+  ASSERT_EQ(counter, AddSeries(labeled_family, {value, "value2"}));
+}
+
+TEST_F(LabeledFamilyTest, MaxSeries) {
+  auto& family = ::prometheus::BuildCounter().Name("labeled_family_max_series").Help("test").Register(*registry_);
+  auto& counter_family = ::prometheus::BuildCounter().Name("labeled_family_counter").Help("test").Register(*registry_);
+  auto& dropped = counter_family.Add({{"type", "dropped"}});
+  auto& evicted = counter_family.Add({{"type", "evicted"}});
+  trpc::opentelemetry::LabeledCounterFamily<1> labeled_counter(&family, {"key"});
+  trpc::opentelemetry::SeriesLimitOptions options;
+  options.max_series = 2;
+  options.ttl_ms = 1000;
+  labeled_counter.SetLimit(options, &dropped, &evicted);
+
+  labeled_counter.Increment({"value1"});
+  labeled_counter.Increment({"value2"});
+  // the new label values are folded into the overflow series
+  labeled_counter.Increment({"value3"});
+  labeled_counter.Increment({"value4"}, 2);
+  ASSERT_EQ(2, labeled_counter.Size());
+  ASSERT_EQ(2, dropped.Value());
+  ASSERT_FALSE(family.Has({{"key", "value3"}}));
+  auto& overflow =
+      family.Add({{trpc::opentelemetry::kOverflowLabelKey, trpc::opentelemetry::kOverflowLabelValue}});
+  ASSERT_EQ(3, overflow.Value());
+  // the existing series are still reported normally
+  labeled_counter.Increment({"value1"});
+  ASSERT_EQ(2, family.Add({{"key", "value1"}}).Value());
+  ASSERT_EQ(2, dropped.Value());
+}
+
+TEST_F(LabeledFamilyTest, EvictStale) {
+  auto& family = ::prometheus::BuildCounter().Name("labeled_family_evict").Help("test").Register(*registry_);
+  trpc::opentelemetry::LabeledFamily<::prometheus::Counter, 1> labeled_family(&family, {"key"});
+  trpc::opentelemetry::SeriesLimitOptions options;
+  options.max_series = 1;
+  labeled_family.SetLimit(options, nullptr, nullptr);
+
+  AddSeries(labeled_family, {"value1"}, 1000);
+  AddSeries(labeled_family, {"value2"}, 1000);
+  // does not evict because ttl is not set
+  ASSERT_EQ(0, labeled_family.EvictStale(100000));
+
+  options.ttl_ms = 5000;
+  labeled_family.SetLimit(options, nullptr, nullptr);
+  ASSERT_EQ(0, labeled_family.EvictStale(3000));
+  // the series and the overflow series are evicted
+  ASSERT_EQ(2, labeled_family.EvictStale(6000));
+  ASSERT_EQ(0, labeled_family.Size());
+  ASSERT_FALSE(family.Has({{"key", "value1"}}));
+
+  // the evicted series frees up room for new series
+  AddSeries(labeled_family, {"value2"}, 7000);
+  ASSERT_TRUE(family.Has({{"key", "value2"}}));
+  ASSERT_EQ(1, labeled_family.Size());
+}
+
+TEST_F(LabeledFamilyTest, TypedFamily) {
+  auto& counter_family = ::prometheus::BuildCounter().Name("labeled_counter").Help("test").Register(*registry_);
+  trpc::opentelemetry::LabeledCounterFamily<1> labeled_counter(&counter_family, {"key"});
+  labeled_counter.Increment({"value"});
+  labeled_counter.Increment({"value"}, 2);
+  ASSERT_EQ(3, counter_family.Add({{"key", "value"}}).Value());
+
+  auto& gauge_family = ::prometheus::BuildGauge().Name("labeled_gauge").Help("test").Register(*registry_);
+  trpc::opentelemetry::LabeledGaugeFamily<1> labeled_gauge(&gauge_family, {"key"});
+  labeled_gauge.Set({"value"}, 5);
+  ASSERT_EQ(5, gauge_family.Add({{"key", "value"}}).Value());
+
+  auto& histogram_family =
+      ::prometheus::BuildHistogram().Name("labeled_histogram").Help("test").Register(*registry_);
+  trpc::opentelemetry::LabeledHistogramFamily<2> labeled_histogram(&histogram_family, {"key1", "key2"}, {1, 2, 3});
+  labeled_histogram.Observe({"value1", "value2"}, 1.5);
+  ASSERT_TRUE(histogram_family.Has({{"key1", "value1"}, {"key2", "value2"}}));
+}
+
+}  // namespace trpc::testing
+#endif
@@ -0,0 +1,250 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
+#include "trpc/telemetry/opentelemetry/metrics/open_metrics_serializer.h"
+
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+
+namespace trpc::opentelemetry {
+
+namespace {
+
+constexpr std::string_view kTotalSuffix = "_total";
+
+void AppendDouble(double value, std::string& out) {
+  if (std::isnan(value)) {
+    out.append("NaN");
+  } else if (std::isinf(value)) {
+    out.append(value > 0 ? "+Inf" : "-Inf");
+  } else {
+    // uses the shortest precision which round-trips
+    char buf[32];
+    int len = std::snprintf(buf, sizeof(buf), "%.15g", value);
+    if (std::strtod(buf, nullptr) != value) {
+      len = std::snprintf(buf, sizeof(buf), "%.17g", value);
+    }
+    out.append(buf, len);
+  }
+}
+
+void AppendUint(uint64_t value, std::string& out) {
+  char buf[24];
+  int len = std::snprintf(buf, sizeof(buf), "%" PRIu64, value);
+  out.append(buf, len);
+}
+
+void AppendHex(const uint8_t* data, size_t size, std::string& out) {
+  static constexpr char kHex[] = "0123456789abcdef";
+  for (size_t i = 0; i < size; ++i) {
+    out.push_back(kHex[data[i] >> 4]);
+    out.push_back(kHex[data[i] & 0xf]);
+  }
+}
+
+// Escapes the label value or the help text
+void AppendEscaped(const std::string& value, std::string& out) {
+  for (char c : value) {
+    if (c == '\\') {
+      out.append("\\\\");
+    } else if (c == '"') {
+      out.append("\\\"");
+    } else if (c == '\n') {
+      out.append("\\n");
+    } else {
+      out.push_back(c);
+    }
+  }
+}
+
+// Appends a sample line without the value, the extra label is appended when its name is not empty
+void AppendSampleName(std::string_view name, std::string_view suffix, const ::prometheus::ClientMetric& metric,
+                      std::string_view extra_name, const std::string& extra_value, std::string& out) {
+  out.append(name).append(suffix);
+  if (metric.label.empty() && extra_name.empty()) {
+    out.push_back(' ');
+    return;
+  }
+
+  out.push_back('{');
+  bool first = true;
+  for (const auto& label : metric.label) {
+    if (!first) {
+      out.push_back(',');
+    }
+    first = false;
+    out.append(label.name).append("=\"");
+    AppendEscaped(label.value, out);
+    out.push_back('"');
+  }
+  if (!extra_name.empty()) {
+    if (!first) {
+      out.push_back(',');
+    }
+    out.append(extra_name).append("=\"");
+    AppendEscaped(extra_value, out);
+    out.push_back('"');
+  }
+  out.append("} ");
+}
+
+void AppendExemplar(const Exemplar& exemplar, std::string& out) {
+  out.append(" # {trace_id=\"");
+  AppendHex(exemplar.context.trace_id.data(), exemplar.context.trace_id.size(), out);
+  out.append("\",span_id=\"");
+  AppendHex(exemplar.context.span_id.data(), exemplar.context.span_id.size(), out);
+  out.append("\"} ");
+  AppendDouble(exemplar.value, out);
+  // the timestamps of OpenMetrics are in seconds
+  out.push_back(' ');
+  AppendUint(exemplar.timestamp_ms / 1000, out);
+  out.push_back('.');
+  char millis[4];
+  std::snprintf(millis, sizeof(millis), "%03u", static_cast<unsigned>(exemplar.timestamp_ms % 1000));
+  out.append(millis, 3);
+}
+
+const BucketExemplars* FindExemplars(const std::map<std::map<std::string, std::string>, BucketExemplars>* series,
+                                     const ::prometheus::ClientMetric& metric) {
+  if (!series) {
+    return nullptr;
+  }
+  std::map<std::string, std::string> labels;
+  for (const auto& label : metric.label) {
+    labels.emplace(label.name, label.value);
+  }
+  auto it = series->find(labels);
+  return it != series->end() ? &it->second : nullptr;
+}
+
+void AppendHistogram(std::string_view name, const ::prometheus::ClientMetric& metric,
+                     const BucketExemplars* exemplars, std::string& out) {
+  std::string upper_bound;
+  for (size_t i = 0; i < metric.histogram.bucket.size(); ++i) {
+    const auto& bucket = metric.histogram.bucket[i];
+    upper_bound.clear();
+    AppendDouble(bucket.upper_bound, upper_bound);
+    AppendSampleName(name, "_bucket", metric, "le", upper_bound, out);
+    AppendUint(bucket.cumulative_count, out);
+    if (exemplars && i < exemplars->size() && (*exemplars)[i]) {
+      AppendExemplar(*(*exemplars)[i], out);
+    }
+    out.push_back('\n');
+  }
+  AppendSampleName(name, "_count", metric, "", "", out);
+  AppendUint(metric.histogram.sample_count, out);
+  out.push_back('\n');
+  AppendSampleName(name, "_sum", metric, "", "", out);
+  AppendDouble(metric.histogram.sample_sum, out);
+  out.push_back('\n');
+}
+
+void AppendSummary(std::string_view name, const ::prometheus::ClientMetric& metric, std::string& out) {
+  std::string quantile;
+  for (const auto& q : metric.summary.quantile) {
+    quantile.clear();
+    AppendDouble(q.quantile, quantile);
+    AppendSampleName(name, "", metric, "quantile", quantile, out);
+    AppendDouble(q.value, out);
+    out.push_back('\n');
+  }
+  AppendSampleName(name, "_count", metric, "", "", out);
+  AppendUint(metric.summary.sample_count, out);
+  out.push_back('\n');
+  AppendSampleName(name, "_sum", metric, "", "", out);
+  AppendDouble(metric.summary.sample_sum, out);
+  out.push_back('\n');
+}
+
+void AppendFamily(const ::prometheus::MetricFamily& family, const ExemplarSnapshot& exemplars, std::string& out) {
+  std::string_view name = family.name;
+  const char* type = "unknown";
+  switch (family.type) {
+    case ::prometheus::MetricType::Counter:
+      // the name of a counter family in OpenMetrics does not contain the suffix of its samples
+      if (name.size() > kTotalSuffix.size() && name.substr(name.size() - kTotalSuffix.size()) == kTotalSuffix) {
+        name.remove_suffix(kTotalSuffix.size());
+      }
+      type = "counter";
+      break;
+    case ::prometheus::MetricType::Gauge:
+      type = "gauge";
+      break;
+    case ::prometheus::MetricType::Summary:
+      type = "summary";
+      break;
+    case ::prometheus::MetricType::Histogram:
+      type = "histogram";
+      break;
+    default:
+      break;
+  }
+
+  out.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+  if (!family.help.empty()) {
+    out.append("# HELP ").append(name).append(" ");
+    AppendEscaped(family.help, out);
+    out.push_back('\n');
+  }
+
+  const std::map<std::map<std::string, std::string>, BucketExemplars>* family_exemplars = nullptr;
+  if (family.type == ::prometheus::MetricType::Histogram) {
+    auto it = exemplars.find(family.name);
+    if (it != exemplars.end()) {
+      family_exemplars = &it->second;
+    }
+  }
+
+  for (const auto& metric : family.metric) {
+    switch (family.type) {
+      case ::prometheus::MetricType::Counter:
+        AppendSampleName(name, kTotalSuffix, metric, "", "", out);
+        AppendDouble(metric.counter.value, out);
+        out.push_back('\n');
+        break;
+      case ::prometheus::MetricType::Gauge:
+        AppendSampleName(name, "", metric, "", "", out);
+        AppendDouble(metric.gauge.value, out);
+        out.push_back('\n');
+        break;
+      case ::prometheus::MetricType::Summary:
+        AppendSummary(name, metric, out);
+        break;
+      case ::prometheus::MetricType::Histogram:
+        AppendHistogram(name, metric, FindExemplars(family_exemplars, metric), out);
+        break;
+      default:
+        AppendSampleName(name, "", metric, "", "", out);
+        AppendDouble(metric.untyped.value, out);
+        out.push_back('\n');
+        break;
+    }
+  }
+}
+
+}  // namespace
+
+void SerializeOpenMetrics(const std::vector<::prometheus::MetricFamily>& families, const ExemplarSnapshot& exemplars,
+                          std::string& out) {
+  for (const auto& family : families) {
+    AppendFamily(family, exemplars, out);
+  }
+  out.append("# EOF\n");
+}
+
+}  // namespace trpc::opentelemetry
+#endif
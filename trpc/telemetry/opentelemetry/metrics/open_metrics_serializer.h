@@ -0,0 +1,49 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
+#pragma once
+
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "prometheus/metric_family.h"
+
+#include "trpc/telemetry/opentelemetry/metrics/exemplar.h"
+
+namespace trpc::opentelemetry {
+
+/// @brief The content type of the OpenMetrics text format.
+constexpr char kOpenMetricsContentType[] = "application/openmetrics-text; version=1.0.0; charset=utf-8";
+
+/// @brief The exemplars of the buckets of a histogram series, indexed by the bucket including the +Inf bucket.
+using BucketExemplars = std::vector<std::optional<Exemplar>>;
+
+/// @brief The exemplars copied out of the histogram families when exposing the metrics.
+///        key: family name, value: the exemplars of each series of the family keyed by the series labels
+using ExemplarSnapshot =
+    std::unordered_map<std::string, std::map<std::map<std::string, std::string>, BucketExemplars>>;
+
+/// @brief Serializes the metric families into the OpenMetrics text format, and attaches the exemplars to the buckets
+///        of the histogram series.
+/// @param families the metric families collected from the prometheus registry
+/// @param exemplars the exemplars of the histogram series
+/// @param [out] out the serialized text, which is appended to
+void SerializeOpenMetrics(const std::vector<::prometheus::MetricFamily>& families, const ExemplarSnapshot& exemplars,
+                          std::string& out);
+
+}  // namespace trpc::opentelemetry
+#endif
@@ -0,0 +1,96 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
+#include "trpc/telemetry/opentelemetry/metrics/open_metrics_serializer.h"
+
+#include <limits>
+
+#include "gtest/gtest.h"
+
+namespace trpc::testing {
+
+namespace {
+
+::prometheus::ClientMetric::Label Label(const std::string& name, const std::string& value) {
+  ::prometheus::ClientMetric::Label label;
+  label.name = name;
+  label.value = value;
+  return label;
+}
+
+}  // namespace
+
+TEST(OpenMetricsSerializerTest, CounterAndGauge) {
+  std::vector<::prometheus::MetricFamily> families(2);
+  families[0].name = "rpc_server_started_total";
+  families[0].help = "started \"rpc\"\n";
+  families[0].type = ::prometheus::MetricType::Counter;
+  families[0].metric.resize(1);
+  families[0].metric[0].label.push_back(Label("method", "a\\b"));
+  families[0].metric[0].counter.value = 3;
+  families[1].name = "rpc_inflight";
+  families[1].type = ::prometheus::MetricType::Gauge;
+  families[1].metric.resize(1);
+  families[1].metric[0].gauge.value = 0.5;
+
+  std::string out;
+  trpc::opentelemetry::SerializeOpenMetrics(families, {}, out);
+  ASSERT_EQ(
+      "# TYPE rpc_server_started counter\n"
+      "# HELP rpc_server_started started \\\"rpc\\\"\\n\n"
+      "rpc_server_started_total{method=\"a\\\\b\"} 3\n"
+      "# TYPE rpc_inflight gauge\n"
+      "rpc_inflight 0.5\n"
+      "# EOF\n",
+      out);
+}
+
+TEST(OpenMetricsSerializerTest, HistogramWithExemplars) {
+  std::vector<::prometheus::MetricFamily> families(1);
+  families[0].name = "rpc_server_handled_seconds";
+  families[0].type = ::prometheus::MetricType::Histogram;
+  families[0].metric.resize(1);
+  auto& metric = families[0].metric[0];
+  metric.label.push_back(Label("method", "Say"));
+  metric.histogram.sample_count = 2;
+  metric.histogram.sample_sum = 0.25;
+  metric.histogram.bucket.resize(2);
+  metric.histogram.bucket[0].upper_bound = 0.1;
+  metric.histogram.bucket[0].cumulative_count = 1;
+  metric.histogram.bucket[1].upper_bound = std::numeric_limits<double>::infinity();
+  metric.histogram.bucket[1].cumulative_count = 2;
+
+  trpc::opentelemetry::Exemplar exemplar;
+  exemplar.context.trace_id.fill(0xab);
+  exemplar.context.span_id.fill(0x01);
+  exemplar.value = 0.2;
+  exemplar.timestamp_ms = 1700000000123;
+  trpc::opentelemetry::ExemplarSnapshot exemplars;
+  exemplars["rpc_server_handled_seconds"][{{"method", "Say"}}] = {std::nullopt, exemplar};
+
+  std::string out;
+  trpc::opentelemetry::SerializeOpenMetrics(families, exemplars, out);
+  ASSERT_EQ(
+      "# TYPE rpc_server_handled_seconds histogram\n"
+      "rpc_server_handled_seconds_bucket{method=\"Say\",le=\"0.1\"} 1\n"
+      "rpc_server_handled_seconds_bucket{method=\"Say\",le=\"+Inf\"} 2 # "
+      "{trace_id=\"abababababababababababababababab\",span_id=\"0101010101010101\"} 0.2 1700000000.123\n"
+      "rpc_server_handled_seconds_count{method=\"Say\"} 2\n"
+      "rpc_server_handled_seconds_sum{method=\"Say\"} 0.25\n"
+      "# EOF\n",
+      out);
+}
+
+}  // namespace trpc::testing
+#endif
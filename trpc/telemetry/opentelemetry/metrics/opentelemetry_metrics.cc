@@ -14,11 +14,57 @@
 #ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
 #include "trpc/telemetry/opentelemetry/metrics/opentelemetry_metrics.h"
 
+#include <unistd.h>
+
+#include <algorithm>
+#include <string_view>
+#include <utility>
+
 #include "trpc/common/config/trpc_config.h"
+#include "trpc/runtime/common/periphery_task_scheduler.h"
+#include "trpc/util/time.h"
+
 #include "trpc/telemetry/opentelemetry/opentelemetry_telemetry_conf_parser.h"
 
 namespace trpc {
 
+namespace {
+
+// The minimum interval of evicting stale series, in milliseconds
+constexpr uint64_t kMinEvictIntervalMs = 1000;
+
+// The interval of copying the number of in-flight requests into the gauges, in milliseconds
+constexpr uint64_t kInflightSyncIntervalMs = 1000;
+
+// The interval of copying the reports of the peers into the families, in milliseconds
+constexpr uint64_t kPeerSyncIntervalMs = 1000;
+
+// The interval of updating the burn rates of the service level objectives, in milliseconds
+constexpr uint64_t kSloUpdateIntervalMs = 1000;
+
+// The name prefixes of the server-side and client-side RPC metrics families
+constexpr char kServerFamilyPrefix[] = "rpc_server_";
+constexpr char kClientFamilyPrefix[] = "rpc_client_";
+
+bool HasPrefix(std::string_view name, std::string_view prefix) { return name.substr(0, prefix.size()) == prefix; }
+
+void IncrementSeries(trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Counter>& family,
+                     const std::map<std::string, std::string>& labels, double value) {
+  family.Update(labels, trpc::time::GetMilliSeconds(), [value](::prometheus::Counter& counter) {
+    counter.Increment(value);
+  });
+}
+
+void ObserveSeries(trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Histogram>& family,
+                   const std::map<std::string, std::string>& labels, const std::vector<double>& buckets,
+                   double value) {
+  family.Update(
+      labels, trpc::time::GetMilliSeconds(),
+      [value](::prometheus::Histogram& histogram) { histogram.Observe(value); }, buckets);
+}
+
+}  // namespace
+
 int OpenTelemetryMetrics::Init() noexcept {
   bool ret = TrpcConfig::GetInstance()->GetPluginConfig("telemetry", trpc::opentelemetry::kOpenTelemetryTelemetryName,
                                                         config_);
@@ -33,21 +79,13 @@ int OpenTelemetryMetrics::Init() noexcept {
   }
 
   // initialize metrics family
-  client_started_total_family_ = trpc::prometheus::GetCounterFamily(kClientStartedTotalName, kClientStartedTotalDesc);
-  client_handled_total_family_ = trpc::prometheus::GetCounterFamily(kClientHandledTotalName, kClientHandledTotalDesc);
-  client_handled_seconds_family_ =
-      trpc::prometheus::GetHistogramFamily(kClientHandledSecondsName, kClientHandledSecondsDesc);
-  server_started_total_family_ = trpc::prometheus::GetCounterFamily(kServerStartedTotalName, kServerStartedTotalDesc);
-  server_handled_total_family_ = trpc::prometheus::GetCounterFamily(kServerHandledTotalName, kServerHandledTotalDesc);
-  server_handled_seconds_family_ =
-      trpc::prometheus::GetHistogramFamily(kServerHandledSecondsName, kServerHandledSecondsDesc);
-  opentelemetry_counter_family_ =
-      trpc::prometheus::GetCounterFamily(kOpenTelemetryCounterName, kOpenTelemetryCounterDesc);
-  opentelemetry_gauge_family_ = trpc::prometheus::GetGaugeFamily(kOpenTelemetryGaugeName, kOpenTelemetryGaugeDesc);
-  opentelemetry_summary_family_ =
-      trpc::prometheus::GetSummaryFamily(kOpenTelemetrySummaryName, kOpenTelemetrySummaryDesc);
-  opentelemetry_histogram_family_ =
-      trpc::prometheus::GetHistogramFamily(kOpenTelemetryHistogramName, kOpenTelemetryHistogramDesc);
+  InitFamilies();
+
+  // the cache is kept across reinitialization, as the text held by the callers may be reused
+  if (!open_metrics_cache_) {
+    open_metrics_cache_ =
+        std::make_unique<trpc::opentelemetry::ExpositionCache>([this](std::string& out) { WriteOpenMetrics(out); });
+  }
 
   // initializes the map of ModuleReportFunc for different ModuleReportType
   module_report_map_[trpc::opentelemetry::ModuleReportType::kClientStartedCount] =
@@ -70,6 +108,345 @@ int OpenTelemetryMetrics::Init() noexcept {
   return 0;
 }
 
+template <typename T>
+void OpenTelemetryMetrics::InitFamily(std::shared_ptr<trpc::opentelemetry::SeriesLimitedFamily<T>>& limited_family,
+                                      ::prometheus::Family<T>* family, const char* family_name) {
+  // the families are kept across reinitialization, so that the series held by others will not be invalidated
+  if (!limited_family) {
+    limited_family = std::make_shared<trpc::opentelemetry::SeriesLimitedFamily<T>>(
+        family, &series_dropped_total_family_->Add({{kSeriesFamilyLabel, family_name}}),
+        &series_evicted_total_family_->Add({{kSeriesFamilyLabel, family_name}}));
+  }
+  auto options = GetSeriesLimitOptions(family_name);
+  limited_family->SetOptions(options);
+
+  if (HasPrefix(family_name, kServerFamilyPrefix)) {
+    server_label_mask_ |= options.label_mask;
+  } else if (HasPrefix(family_name, kClientFamilyPrefix)) {
+    client_label_mask_ |= options.label_mask;
+  }
+}
+
+void OpenTelemetryMetrics::InitFamilies() {
+  series_dropped_total_family_ = trpc::prometheus::GetCounterFamily(kSeriesDroppedTotalName, kSeriesDroppedTotalDesc);
+  series_evicted_total_family_ = trpc::prometheus::GetCounterFamily(kSeriesEvictedTotalName, kSeriesEvictedTotalDesc);
+  // the masks are collected from the families initialized below
+  server_label_mask_ = 0;
+  client_label_mask_ = 0;
+
+  InitFamily(client_started_total_family_,
+             trpc::prometheus::GetCounterFamily(kClientStartedTotalName, kClientStartedTotalDesc),
+             kClientStartedTotalName);
+  InitFamily(client_handled_total_family_,
+             trpc::prometheus::GetCounterFamily(kClientHandledTotalName, kClientHandledTotalDesc),
+             kClientHandledTotalName);
+  InitFamily(client_handled_seconds_family_,
+             trpc::prometheus::GetHistogramFamily(kClientHandledSecondsName, kClientHandledSecondsDesc),
+             kClientHandledSecondsName);
+  InitFamily(client_request_bytes_family_,
+             trpc::prometheus::GetHistogramFamily(kClientRequestBytesName, kClientRequestBytesDesc),
+             kClientRequestBytesName);
+  InitFamily(client_response_bytes_family_,
+             trpc::prometheus::GetHistogramFamily(kClientResponseBytesName, kClientResponseBytesDesc),
+             kClientResponseBytesName);
+  InitFamily(server_started_total_family_,
+             trpc::prometheus::GetCounterFamily(kServerStartedTotalName, kServerStartedTotalDesc),
+             kServerStartedTotalName);
+  InitFamily(server_handled_total_family_,
+             trpc::prometheus::GetCounterFamily(kServerHandledTotalName, kServerHandledTotalDesc),
+             kServerHandledTotalName);
+  InitFamily(server_handled_seconds_family_,
+             trpc::prometheus::GetHistogramFamily(kServerHandledSecondsName, kServerHandledSecondsDesc),
+             kServerHandledSecondsName);
+  InitFamily(server_queue_wait_seconds_family_,
+             trpc::prometheus::GetHistogramFamily(kServerQueueWaitSecondsName, kServerQueueWaitSecondsDesc),
+             kServerQueueWaitSecondsName);
+  InitFamily(server_handler_seconds_family_,
+             trpc::prometheus::GetHistogramFamily(kServerHandlerSecondsName, kServerHandlerSecondsDesc),
+             kServerHandlerSecondsName);
+  InitFamily(server_send_seconds_family_,
+             trpc::prometheus::GetHistogramFamily(kServerSendSecondsName, kServerSendSecondsDesc),
+             kServerSendSecondsName);
+  InitFamily(server_request_bytes_family_,
+             trpc::prometheus::GetHistogramFamily(kServerRequestBytesName, kServerRequestBytesDesc),
+             kServerRequestBytesName);
+  InitFamily(server_response_bytes_family_,
+             trpc::prometheus::GetHistogramFamily(kServerResponseBytesName, kServerResponseBytesDesc),
+             kServerResponseBytesName);
+  InitFamily(opentelemetry_counter_family_,
+             trpc::prometheus::GetCounterFamily(kOpenTelemetryCounterName, kOpenTelemetryCounterDesc),
+             kOpenTelemetryCounterName);
+  InitFamily(opentelemetry_gauge_family_,
+             trpc::prometheus::GetGaugeFamily(kOpenTelemetryGaugeName, kOpenTelemetryGaugeDesc),
+             kOpenTelemetryGaugeName);
+  InitFamily(opentelemetry_summary_family_,
+             trpc::prometheus::GetSummaryFamily(kOpenTelemetrySummaryName, kOpenTelemetrySummaryDesc),
+             kOpenTelemetrySummaryName);
+  InitFamily(opentelemetry_histogram_family_,
+             trpc::prometheus::GetHistogramFamily(kOpenTelemetryHistogramName, kOpenTelemetryHistogramDesc),
+             kOpenTelemetryHistogramName);
+
+  // the in-flight gauges are kept across reinitialization, as the counters are held by the requests in progress
+  if (!server_inflight_gauges_) {
+    server_inflight_gauges_ = std::make_shared<trpc::opentelemetry::InflightGauges<2>>(
+        trpc::prometheus::GetGaugeFamily(kServerInflightName, kServerInflightDesc),
+        trpc::opentelemetry::LabelNames<2>{trpc::opentelemetry::kCalleeService, trpc::opentelemetry::kCalleeMethod},
+        &series_dropped_total_family_->Add({{kSeriesFamilyLabel, kServerInflightName}}));
+  }
+  // the method names come from the requests, so the number of the gauges is limited like the other families
+  server_inflight_gauges_->SetMaxSeries(GetSeriesLimitOptions(kServerInflightName).max_series);
+  if (!client_inflight_gauges_) {
+    client_inflight_gauges_ = std::make_shared<trpc::opentelemetry::InflightGauges<1>>(
+        trpc::prometheus::GetGaugeFamily(kClientInflightName, kClientInflightDesc),
+        trpc::opentelemetry::LabelNames<1>{trpc::opentelemetry::kCalleeService},
+        &series_dropped_total_family_->Add({{kSeriesFamilyLabel, kClientInflightName}}));
+  }
+  client_inflight_gauges_->SetMaxSeries(GetSeriesLimitOptions(kClientInflightName).max_series);
+
+  // the peer metrics is kept across reinitialization like the in-flight gauges, as it is used by the filter directly
+  if (config_.metrics_config.enable_peer_metrics && config_.metrics_config.max_peers > 0 && !client_peer_metrics_) {
+    client_peer_metrics_ = std::make_unique<trpc::opentelemetry::PeerMetrics>(
+        trpc::prometheus::GetHistogramFamily(kClientPeerHandledSecondsName, kClientPeerHandledSecondsDesc),
+        trpc::prometheus::GetCounterFamily(kClientPeerFailedTotalName, kClientPeerFailedTotalDesc),
+        config_.metrics_config.max_peers, config_.metrics_config.client_histogram_buckets);
+  }
+
+  // the trackers are kept across reinitialization like the peer metrics, as they are used by the filter directly
+  if (slos_.empty()) {
+    InitSlos();
+  }
+}
+
+void OpenTelemetryMetrics::InitSlos() {
+  ::prometheus::Family<::prometheus::Gauge>* burn_rate_family = nullptr;
+  for (const auto& objective : config_.metrics_config.slos) {
+    if (objective.name.empty() || objective.service.empty()) {
+      TRPC_FMT_WARN("slo {} of service {} should have both a name and a service, ignored", objective.name,
+                    objective.service);
+      continue;
+    }
+    if (!(objective.target > 0 && objective.target < 1)) {
+      TRPC_FMT_WARN("target {} of slo {} should be in (0, 1), ignored", objective.target, objective.name);
+      continue;
+    }
+    if (GetSlo(objective.name)) {
+      TRPC_FMT_WARN("slo {} is duplicated, ignored", objective.name);
+      continue;
+    }
+
+    if (!burn_rate_family) {
+      burn_rate_family = trpc::prometheus::GetGaugeFamily(kServerSloBurnRateName, kServerSloBurnRateDesc);
+    }
+    SloState slo;
+    slo.tracker = std::make_shared<trpc::opentelemetry::SloTracker>(objective, config_.metrics_config.slo_windows);
+    for (uint32_t window : slo.tracker->GetWindows()) {
+      slo.burn_rate_gauges.push_back(
+          &burn_rate_family->Add({{kSloLabel, objective.name}, {kSloWindowLabel, std::to_string(window) + "s"}}));
+    }
+    slos_.push_back(std::move(slo));
+  }
+}
+
+trpc::opentelemetry::SeriesLimitOptions OpenTelemetryMetrics::GetSeriesLimitOptions(const char* family_name) {
+  trpc::opentelemetry::SeriesLimitOptions options;
+  options.max_series = config_.metrics_config.max_series_per_family;
+  auto it = config_.metrics_config.family_max_series.find(family_name);
+  if (it != config_.metrics_config.family_max_series.end()) {
+    options.max_series = it->second;
+  }
+  options.ttl_ms = static_cast<uint64_t>(config_.metrics_config.series_ttl) * 60 * 1000;
+  options.label_mask = GetLabelMask(family_name);
+  return options;
+}
+
+trpc::opentelemetry::LabelMask OpenTelemetryMetrics::GetLabelMask(const char* family_name) {
+  const std::vector<std::string>* labels = nullptr;
+  auto it = config_.metrics_config.family_labels.find(family_name);
+  if (it != config_.metrics_config.family_labels.end()) {
+    labels = &it->second;
+  } else if (HasPrefix(family_name, kServerFamilyPrefix)) {
+    labels = &config_.metrics_config.server_labels;
+  } else if (HasPrefix(family_name, kClientFamilyPrefix)) {
+    labels = &config_.metrics_config.client_labels;
+  } else {
+    return trpc::opentelemetry::kAllRpcLabels;
+  }
+
+  std::vector<std::string> unknown_names;
+  trpc::opentelemetry::LabelMask mask = trpc::opentelemetry::ToRpcLabelMask(*labels, &unknown_names);
+  for (const auto& unknown_name : unknown_names) {
+    TRPC_FMT_WARN("label {} of family {} is not a label of the rpc metrics, ignored", unknown_name, family_name);
+  }
+  return mask;
+}
+
+void OpenTelemetryMetrics::Start() noexcept {
+  if (!config_.metrics_config.enabled) {
+    return;
+  }
+
+  if (inflight_task_id_ == 0) {
+    inflight_task_id_ = PeripheryTaskScheduler::GetInstance()->SubmitPeriodicalTask(
+        [this]() { SyncInflightGauges(); }, kInflightSyncIntervalMs, "OpenTelemetrySyncInflightGauges");
+  }
+
+  if (client_peer_metrics_ && peer_task_id_ == 0) {
+    peer_task_id_ = PeripheryTaskScheduler::GetInstance()->SubmitPeriodicalTask(
+        [this]() { SyncPeerMetrics(); }, kPeerSyncIntervalMs, "OpenTelemetrySyncPeerMetrics");
+  }
+
+  if (!slos_.empty() && slo_task_id_ == 0) {
+    slo_task_id_ = PeripheryTaskScheduler::GetInstance()->SubmitPeriodicalTask(
+        [this]() { UpdateSlos(); }, kSloUpdateIntervalMs, "OpenTelemetryUpdateSlos");
+  }
+
+  if (config_.metrics_config.series_ttl != 0 && evict_task_id_ == 0) {
+    uint64_t ttl_ms = static_cast<uint64_t>(config_.metrics_config.series_ttl) * 60 * 1000;
+    evict_task_id_ = PeripheryTaskScheduler::GetInstance()->SubmitPeriodicalTask(
+        [this]() { EvictStaleSeries(); }, std::max(ttl_ms / 2, kMinEvictIntervalMs), "OpenTelemetryEvictStaleSeries");
+  }
+
+  if (config_.metrics_config.export_enabled && !periodic_exporter_) {
+    StartExporter();
+  }
+
+  if (config_.metrics_config.shm_export_enabled && shm_task_id_ == 0) {
+    StartShmExport();
+  }
+}
+
+void OpenTelemetryMetrics::Stop() noexcept {
+  if (evict_task_id_ != 0) {
+    PeripheryTaskScheduler::GetInstance()->RemoveTask(evict_task_id_);
+    evict_task_id_ = 0;
+  }
+  if (inflight_task_id_ != 0) {
+    PeripheryTaskScheduler::GetInstance()->RemoveTask(inflight_task_id_);
+    inflight_task_id_ = 0;
+  }
+  if (peer_task_id_ != 0) {
+    PeripheryTaskScheduler::GetInstance()->RemoveTask(peer_task_id_);
+    peer_task_id_ = 0;
+    // flushes the reports since the last sync
+    SyncPeerMetrics();
+  }
+  if (slo_task_id_ != 0) {
+    PeripheryTaskScheduler::GetInstance()->RemoveTask(slo_task_id_);
+    slo_task_id_ = 0;
+  }
+  if (periodic_exporter_) {
+    // pushes the metrics reported before stopping
+    periodic_exporter_->Stop();
+    periodic_exporter_.reset();
+  }
+  if (shm_task_id_ != 0) {
+    PeripheryTaskScheduler::GetInstance()->RemoveTask(shm_task_id_);
+    shm_task_id_ = 0;
+    // removes the file, so that the agent stops reading the metrics of this process
+    shm_writer_.reset();
+  }
+}
+
+void OpenTelemetryMetrics::SyncInflightGauges() {
+  server_inflight_gauges_->Sync();
+  client_inflight_gauges_->Sync();
+}
+
+void OpenTelemetryMetrics::SyncPeerMetrics() { client_peer_metrics_->Sync(); }
+
+void OpenTelemetryMetrics::ReportClientPeer(std::string_view callee_service, std::string_view ip, int port,
+                                            uint64_t cost_us, bool failed) {
+  if (client_peer_metrics_) {
+    client_peer_metrics_->Report(callee_service, ip, port, cost_us, failed);
+  }
+}
+
+void OpenTelemetryMetrics::UpdateSlos() {
+  uint64_t now_ms = trpc::time::GetMilliSeconds();
+  for (auto& slo : slos_) {
+    slo.tracker->Update(now_ms);
+    const auto& windows = slo.tracker->GetWindows();
+    for (size_t i = 0; i < windows.size(); ++i) {
+      slo.burn_rate_gauges[i]->Set(slo.tracker->GetBurnRate(windows[i]));
+    }
+  }
+}
+
+void OpenTelemetryMetrics::ReportServerSlo(std::string_view callee_service, std::string_view callee_method,
+                                           uint64_t cost_ms, bool success) {
+  uint64_t now_ms = 0;
+  for (auto& slo : slos_) {
+    if (slo.tracker->Matches(callee_service, callee_method)) {
+      if (now_ms == 0) {
+        now_ms = trpc::time::GetMilliSeconds();
+      }
+      slo.tracker->Record(now_ms, cost_ms, success);
+    }
+  }
+}
+
+std::shared_ptr<const trpc::opentelemetry::SloTracker> OpenTelemetryMetrics::GetSlo(const std::string& name) const {
+  for (const auto& slo : slos_) {
+    if (slo.tracker->GetObjective().name == name) {
+      return slo.tracker;
+    }
+  }
+  return nullptr;
+}
+
+trpc::opentelemetry::InflightCounter* OpenTelemetryMetrics::GetServerInflightCounter(std::string_view callee_service,
+                                                                                   std::string_view callee_method) {
+  return server_inflight_gauges_->Get({callee_service, callee_method});
+}
+
+trpc::opentelemetry::InflightCounter* OpenTelemetryMetrics::GetClientInflightCounter(std::string_view callee_service) {
+  return client_inflight_gauges_->Get({callee_service});
+}
+
+void OpenTelemetryMetrics::EvictStaleSeries() {
+  uint64_t now_ms = trpc::time::GetMilliSeconds();
+  client_started_total_family_->EvictStale(now_ms);
+  client_handled_total_family_->EvictStale(now_ms);
+  client_handled_seconds_family_->EvictStale(now_ms);
+  client_request_bytes_family_->EvictStale(now_ms);
+  client_response_bytes_family_->EvictStale(now_ms);
+  server_started_total_family_->EvictStale(now_ms);
+  server_handled_total_family_->EvictStale(now_ms);
+  server_handled_seconds_family_->EvictStale(now_ms);
+  server_queue_wait_seconds_family_->EvictStale(now_ms);
+  server_handler_seconds_family_->EvictStale(now_ms);
+  server_send_seconds_family_->EvictStale(now_ms);
+  server_request_bytes_family_->EvictStale(now_ms);
+  server_response_bytes_family_->EvictStale(now_ms);
+  opentelemetry_counter_family_->EvictStale(now_ms);
+  opentelemetry_gauge_family_->EvictStale(now_ms);
+  opentelemetry_summary_family_->EvictStale(now_ms);
+  opentelemetry_histogram_family_->EvictStale(now_ms);
+
+  std::lock_guard<std::mutex> lock(registered_families_mutex_);
+  for (auto it = registered_families_.begin(); it != registered_families_.end();) {
+    if (auto family = it->lock()) {
+      family->EvictStale(now_ms);
+      ++it;
+    } else {
+      it = registered_families_.erase(it);
+    }
+  }
+}
+
+void OpenTelemetryMetrics::LimitRegisteredFamily(const char* family_name,
+                                                 const std::shared_ptr<trpc::opentelemetry::SeriesLimitable>& family) {
+  if (!config_.metrics_config.enabled) {  // does not enable metrics
+    TRPC_LOG_DEBUG("opentelemetry do not enable metrics, can not limit");
+    return;
+  }
+  family->SetLimit(GetSeriesLimitOptions(family_name),
+                   &series_dropped_total_family_->Add({{kSeriesFamilyLabel, family_name}}),
+                   &series_evicted_total_family_->Add({{kSeriesFamilyLabel, family_name}}));
+  std::lock_guard<std::mutex> lock(registered_families_mutex_);
+  registered_families_.push_back(family);
+}
+
 int OpenTelemetryMetrics::ModuleReport(const ModuleMetricsInfo& info) {
   if (!config_.metrics_config.enabled) {  // does not enable metrics
     TRPC_LOG_DEBUG("opentelemetry do not enable metrics, can not report");
@@ -91,53 +468,266 @@ int OpenTelemetryMetrics::ModuleReport(const ModuleMetricsInfo& info) {
 }
 
 void OpenTelemetryMetrics::ClientStartedTotalReportFunc(const ModuleMetricsInfo& metrics_info) {
-  auto& module_counter = client_started_total_family_->Add(metrics_info.infos);
-  module_counter.Increment();
+  ReportClientStartedTotal(metrics_info.infos);
 }
 
 void OpenTelemetryMetrics::ClientHandledTotalReportFunc(const ModuleMetricsInfo& metrics_info) {
-  auto& module_counter = client_handled_total_family_->Add(metrics_info.infos);
-  module_counter.Increment();
+  ReportClientHandledTotal(metrics_info.infos);
 }
 
 void OpenTelemetryMetrics::ClientHandledSecondsReportFunc(const ModuleMetricsInfo& metrics_info) {
-  auto& module_histogram =
-      client_handled_seconds_family_->Add(metrics_info.infos, config_.metrics_config.client_histogram_buckets);
-  module_histogram.Observe(static_cast<double>(metrics_info.cost_time) / 1000);
+  ReportClientHandledSeconds(metrics_info.infos, metrics_info.cost_time);
 }
 
 void OpenTelemetryMetrics::ServerStartedTotalReportFunc(const ModuleMetricsInfo& metrics_info) {
-  auto& module_counter = server_started_total_family_->Add(metrics_info.infos);
-  module_counter.Increment();
+  ReportServerStartedTotal(metrics_info.infos);
 }
 
 void OpenTelemetryMetrics::ServerHandledTotalReportFunc(const ModuleMetricsInfo& metrics_info) {
-  auto& module_counter = server_handled_total_family_->Add(metrics_info.infos);
-  module_counter.Increment();
+  ReportServerHandledTotal(metrics_info.infos);
 }
 
 void OpenTelemetryMetrics::ServerHandledSecondsReportFunc(const ModuleMetricsInfo& metrics_info) {
-  auto& module_histogram =
-      server_handled_seconds_family_->Add(metrics_info.infos, config_.metrics_config.server_histogram_buckets);
-  module_histogram.Observe(static_cast<double>(metrics_info.cost_time) / 1000);
+  ReportServerHandledSeconds(metrics_info.infos, metrics_info.cost_time);
+}
+
+void OpenTelemetryMetrics::ReportClientStartedTotal(const std::map<std::string, std::string>& labels) {
+  IncrementSeries(*client_started_total_family_, labels, 1);
+}
+
+void OpenTelemetryMetrics::ReportClientHandledTotal(const std::map<std::string, std::string>& labels) {
+  IncrementSeries(*client_handled_total_family_, labels, 1);
+}
+
+void OpenTelemetryMetrics::ReportClientHandledSeconds(const std::map<std::string, std::string>& labels,
+                                                      uint64_t cost_time,
+                                                      const trpc::opentelemetry::ExemplarContext* exemplar) {
+  if (exemplar) {
+    ObserveWithExemplar(*client_handled_seconds_family_, labels, config_.metrics_config.client_histogram_buckets,
+                        static_cast<double>(cost_time) / 1000, *exemplar);
+    return;
+  }
+  ObserveSeries(*client_handled_seconds_family_, labels, config_.metrics_config.client_histogram_buckets,
+                static_cast<double>(cost_time) / 1000);
+}
+
+void OpenTelemetryMetrics::ReportServerStartedTotal(const std::map<std::string, std::string>& labels) {
+  IncrementSeries(*server_started_total_family_, labels, 1);
+}
+
+void OpenTelemetryMetrics::ReportServerHandledTotal(const std::map<std::string, std::string>& labels) {
+  IncrementSeries(*server_handled_total_family_, labels, 1);
+}
+
+void OpenTelemetryMetrics::ReportServerHandledSeconds(const std::map<std::string, std::string>& labels,
+                                                      uint64_t cost_time,
+                                                      const trpc::opentelemetry::ExemplarContext* exemplar) {
+  if (exemplar) {
+    ObserveWithExemplar(*server_handled_seconds_family_, labels, config_.metrics_config.server_histogram_buckets,
+                        static_cast<double>(cost_time) / 1000, *exemplar);
+    return;
+  }
+  ObserveSeries(*server_handled_seconds_family_, labels, config_.metrics_config.server_histogram_buckets,
+                static_cast<double>(cost_time) / 1000);
+}
+
+void OpenTelemetryMetrics::ReportServerQueueWaitSeconds(const std::map<std::string, std::string>& labels,
+                                                        uint64_t cost_us) {
+  ObserveSeries(*server_queue_wait_seconds_family_, labels, config_.metrics_config.server_histogram_buckets,
+                static_cast<double>(cost_us) / 1000000);
+}
+
+void OpenTelemetryMetrics::ReportServerHandlerSeconds(const std::map<std::string, std::string>& labels,
+                                                      uint64_t cost_us) {
+  ObserveSeries(*server_handler_seconds_family_, labels, config_.metrics_config.server_histogram_buckets,
+                static_cast<double>(cost_us) / 1000000);
+}
+
+void OpenTelemetryMetrics::ReportServerSendSeconds(const std::map<std::string, std::string>& labels, uint64_t cost_us) {
+  ObserveSeries(*server_send_seconds_family_, labels, config_.metrics_config.server_histogram_buckets,
+                static_cast<double>(cost_us) / 1000000);
+}
+
+void OpenTelemetryMetrics::ReportClientRequestBytes(const std::map<std::string, std::string>& labels, size_t size) {
+  ObserveSeries(*client_request_bytes_family_, labels, config_.metrics_config.payload_histogram_buckets,
+                static_cast<double>(size));
+}
+
+void OpenTelemetryMetrics::ReportClientResponseBytes(const std::map<std::string, std::string>& labels, size_t size) {
+  ObserveSeries(*client_response_bytes_family_, labels, config_.metrics_config.payload_histogram_buckets,
+                static_cast<double>(size));
+}
+
+void OpenTelemetryMetrics::ReportServerRequestBytes(const std::map<std::string, std::string>& labels, size_t size) {
+  ObserveSeries(*server_request_bytes_family_, labels, config_.metrics_config.payload_histogram_buckets,
+                static_cast<double>(size));
+}
+
+void OpenTelemetryMetrics::ReportServerResponseBytes(const std::map<std::string, std::string>& labels, size_t size) {
+  ObserveSeries(*server_response_bytes_family_, labels, config_.metrics_config.payload_histogram_buckets,
+                static_cast<double>(size));
+}
+
+void OpenTelemetryMetrics::ObserveWithExemplar(
+    trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Histogram>& family,
+    const std::map<std::string, std::string>& labels, const std::vector<double>& buckets, double value,
+    const trpc::opentelemetry::ExemplarContext& exemplar) {
+  uint64_t now_ms = trpc::time::GetMilliSeconds();
+  uint64_t interval_ms = config_.metrics_config.exemplar_interval;
+  family.UpdateWithExemplars(
+      labels, now_ms, buckets,
+      [&](::prometheus::Histogram& histogram, trpc::opentelemetry::HistogramExemplars& exemplars) {
+        histogram.Observe(value);
+        exemplars.Offer(value, exemplar, now_ms, interval_ms);
+      },
+      buckets);
+}
+
+void OpenTelemetryMetrics::SnapshotExemplars(
+    const trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Histogram>& family, const char* family_name,
+    trpc::opentelemetry::ExemplarSnapshot& snapshot) {
+  family.ForEachExemplars([&snapshot, family_name](const std::map<std::string, std::string>& labels,
+                                                   const trpc::opentelemetry::HistogramExemplars& exemplars) {
+    trpc::opentelemetry::BucketExemplars buckets(exemplars.BucketCount());
+    trpc::opentelemetry::Exemplar exemplar;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+      if (exemplars.Get(i, exemplar)) {
+        buckets[i] = exemplar;
+      }
+    }
+    snapshot[family_name].emplace(labels, std::move(buckets));
+  });
+}
+
+int OpenTelemetryMetrics::CollectOpenMetrics(std::string& out) {
+  std::shared_ptr<const std::string> text = CollectOpenMetrics();
+  if (!text) {
+    return -1;
+  }
+  out.append(*text);
+  return 0;
+}
+
+std::shared_ptr<const std::string> OpenTelemetryMetrics::CollectOpenMetrics() {
+  if (!config_.metrics_config.enabled) {  // does not enable metrics
+    TRPC_LOG_DEBUG("opentelemetry do not enable metrics, can not collect");
+    return nullptr;
+  }
+  return open_metrics_cache_->Get(trpc::time::GetMilliSeconds(), config_.metrics_config.collect_min_interval);
+}
+
+void OpenTelemetryMetrics::WriteOpenMetrics(std::string& out) {
+  // the collected families and exemplars are copies, so the families are only locked while collecting, and the
+  // serialization does not block the reports
+  std::vector<::prometheus::MetricFamily> families;
+  trpc::opentelemetry::ExemplarSnapshot exemplars;
+  CollectWithExemplars(families, exemplars);
+  trpc::opentelemetry::SerializeOpenMetrics(families, exemplars, out);
+}
+
+void OpenTelemetryMetrics::CollectWithExemplars(std::vector<::prometheus::MetricFamily>& families,
+                                                trpc::opentelemetry::ExemplarSnapshot& exemplars) {
+  // copies the exemplars before collecting, so that no exemplar points to an observation newer than the buckets
+  SnapshotExemplars(*client_handled_seconds_family_, kClientHandledSecondsName, exemplars);
+  SnapshotExemplars(*server_handled_seconds_family_, kServerHandledSecondsName, exemplars);
+  families = trpc::prometheus::Collect();
+}
+
+std::unique_ptr<trpc::opentelemetry::OtlpMetricsExporter> OpenTelemetryMetrics::GetExporter() {
+  ServiceProxyOption service_opts;
+  service_opts.codec_name = config_.protocol;
+  service_opts.selector_name = config_.selector_name;
+  service_opts.timeout = config_.timeout;
+  if (config_.protocol == "http") {
+    service_opts.name = trpc::opentelemetry::kHttpMetricsExporterServiceName;
+    // the target of the proxy is the host of the addr, which is an url like "http://127.0.0.1:4318"
+    std::string_view target = config_.addr;
+    size_t scheme_pos = target.find("://");
+    if (scheme_pos != std::string_view::npos) {
+      target.remove_prefix(scheme_pos + 3);
+    }
+    target = target.substr(0, target.find('/'));
+    service_opts.target = std::string(target);
+    return std::make_unique<trpc::opentelemetry::HttpMetricsExporter>(service_opts, config_.addr + "/v1/metrics");
+  } else if (config_.protocol == "grpc") {
+    service_opts.name = trpc::opentelemetry::kGrpcMetricsExporterServiceName;
+    service_opts.target = config_.addr;
+    return std::make_unique<trpc::opentelemetry::GrpcMetricsExporter>(service_opts);
+  }
+  return nullptr;
+}
+
+void OpenTelemetryMetrics::StartExporter() {
+  auto exporter = GetExporter();
+  if (!exporter) {
+    TRPC_FMT_ERROR("get opentelemetry metrics exporter fail, protocol is invalid: {}", config_.protocol);
+    return;
+  }
+
+  trpc::opentelemetry::PeriodicMetricsExporter::Options options;
+  options.interval_ms = config_.metrics_config.export_interval;
+  const auto& temporality = config_.metrics_config.export_temporality;
+  if (temporality != trpc::opentelemetry::kDeltaTemporality &&
+      temporality != trpc::opentelemetry::kCumulativeTemporality) {
+    TRPC_FMT_WARN("unknown export_temporality: {}, use {} instead", temporality,
+                  trpc::opentelemetry::kDeltaTemporality);
+  }
+  options.converter_options.delta_temporality = temporality != trpc::opentelemetry::kCumulativeTemporality;
+  options.converter_options.batch_size = config_.metrics_config.export_batch_size;
+  const auto& server_config = TrpcConfig::GetInstance()->GetServerConfig();
+  options.converter_options.resources[trpc::opentelemetry::kMetricsServiceName] =
+      server_config.app + "." + server_config.server;
+  for (auto& [key, value] : config_.traces_config.resources) {
+    options.converter_options.resources[key] = value;
+  }
+
+  periodic_exporter_ = std::make_unique<trpc::opentelemetry::PeriodicMetricsExporter>(
+      std::move(options), std::move(exporter),
+      [this](std::vector<::prometheus::MetricFamily>& families, trpc::opentelemetry::ExemplarSnapshot& exemplars) {
+        CollectWithExemplars(families, exemplars);
+      });
+  periodic_exporter_->Start();
+}
+
+void OpenTelemetryMetrics::StartShmExport() {
+  auto writer = std::make_unique<trpc::opentelemetry::ShmMetricsWriter>();
+  std::string path = config_.metrics_config.shm_export_dir + "/trpc_metrics." + std::to_string(::getpid());
+  if (writer->Open(path, config_.metrics_config.shm_max_records) != 0) {
+    TRPC_FMT_ERROR("open opentelemetry shm metrics file {} fail, shm export is disabled", path);
+    return;
+  }
+
+  shm_writer_ = std::move(writer);
+  PublishShmMetrics();
+  shm_task_id_ = PeripheryTaskScheduler::GetInstance()->SubmitPeriodicalTask(
+      [this]() { PublishShmMetrics(); }, config_.metrics_config.shm_export_interval, "OpenTelemetryPublishShmMetrics");
+}
+
+void OpenTelemetryMetrics::PublishShmMetrics() {
+  size_t skipped = shm_writer_->Publish(trpc::prometheus::Collect(), trpc::time::GetMilliSeconds());
+  if (skipped != 0) {
+    // the series are skipped if their keys are too long, they have too many buckets, or the file is full
+    TRPC_FMT_WARN("{} series are not published into the shm metrics file, shm_max_records: {}", skipped,
+                  config_.metrics_config.shm_max_records);
+  }
 }
 
 int OpenTelemetryMetrics::SetDataReport(const std::map<std::string, std::string>& labels, double value) {
-  auto& gauge = opentelemetry_gauge_family_->Add(labels);
-  gauge.Set(value);
+  opentelemetry_gauge_family_->Update(labels, trpc::time::GetMilliSeconds(),
+                                      [value](::prometheus::Gauge& gauge) { gauge.Set(value); });
   return 0;
 }
 
 int OpenTelemetryMetrics::SumDataReport(const std::map<std::string, std::string>& labels, double value) {
-  auto& counter = opentelemetry_counter_family_->Add(labels);
-  counter.Increment(value);
+  IncrementSeries(*opentelemetry_counter_family_, labels, value);
   return 0;
 }
 
 int OpenTelemetryMetrics::MidDataReport(const std::map<std::string, std::string>& labels, double value) {
   auto pro_quantiles = ::prometheus::Summary::Quantiles{{0.5, 0.05}};
-  auto& summary = opentelemetry_summary_family_->Add(labels, std::move(pro_quantiles));
-  summary.Observe(value);
+  opentelemetry_summary_family_->Update(
+      labels, trpc::time::GetMilliSeconds(), [value](::prometheus::Summary& summary) { summary.Observe(value); },
+      std::move(pro_quantiles));
   return 0;
 }
 
@@ -155,22 +745,24 @@ int OpenTelemetryMetrics::QuantilesDataReport(const std::map<std::string, std::s
     }
     pro_quantiles.emplace_back(::prometheus::detail::CKMSQuantiles::Quantile(val[0], val[1]));
   }
-  auto& summary = opentelemetry_summary_family_->Add(labels, std::move(pro_quantiles));
-  summary.Observe(value);
+  opentelemetry_summary_family_->Update(
+      labels, trpc::time::GetMilliSeconds(), [value](::prometheus::Summary& summary) { summary.Observe(value); },
+      std::move(pro_quantiles));
   return 0;
 }
 
 namespace {
 
 template <typename T>
-int HistogramDataReportTemplate(::prometheus::Family<::prometheus::Histogram>* family,
+int HistogramDataReportTemplate(trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Histogram>* family,
                                 const std::map<std::string, std::string>& labels, T&& bucket, double value) {
   if (bucket.size() == 0) {
     TRPC_LOG_ERROR("bucket size must > 0");
     return -1;
   }
-  auto& histogram = family->Add(labels, std::forward<T>(bucket));
-  histogram.Observe(value);
+  family->Update(
+      labels, trpc::time::GetMilliSeconds(), [value](::prometheus::Histogram& histogram) { histogram.Observe(value); },
+      std::forward<T>(bucket));
   return 0;
 }
 
@@ -178,12 +770,34 @@ int HistogramDataReportTemplate(::prometheus::Family<::prometheus::Histogram>* f
 
 int OpenTelemetryMetrics::HistogramDataReport(const std::map<std::string, std::string>& labels,
                                               HistogramBucket&& bucket, double value) {
-  return HistogramDataReportTemplate(opentelemetry_histogram_family_, labels, std::move(bucket), value);
+  return HistogramDataReportTemplate(opentelemetry_histogram_family_.get(), labels, std::move(bucket), value);
 }
 
 int OpenTelemetryMetrics::HistogramDataReport(const std::map<std::string, std::string>& labels,
                                               const HistogramBucket& bucket, double value) {
-  return HistogramDataReportTemplate(opentelemetry_histogram_family_, labels, bucket, value);
+  return HistogramDataReportTemplate(opentelemetry_histogram_family_.get(), labels, bucket, value);
+}
+
+trpc::opentelemetry::BoundCounter OpenTelemetryMetrics::BindCounter(const std::map<std::string, std::string>& labels) {
+  if (!config_.metrics_config.enabled) {  // does not enable metrics
+    TRPC_LOG_DEBUG("opentelemetry do not enable metrics, can not bind");
+    return trpc::opentelemetry::BoundCounter();
+  }
+  return trpc::opentelemetry::BoundCounter(opentelemetry_counter_family_->Bind(labels, trpc::time::GetMilliSeconds()));
+}
+
+trpc::opentelemetry::BoundHistogram OpenTelemetryMetrics::BindHistogram(
+    const std::map<std::string, std::string>& labels, const HistogramBucket& bucket) {
+  if (!config_.metrics_config.enabled) {  // does not enable metrics
+    TRPC_LOG_DEBUG("opentelemetry do not enable metrics, can not bind");
+    return trpc::opentelemetry::BoundHistogram();
+  }
+  if (bucket.size() == 0) {
+    TRPC_LOG_ERROR("bucket size must > 0");
+    return trpc::opentelemetry::BoundHistogram();
+  }
+  return trpc::opentelemetry::BoundHistogram(
+      opentelemetry_histogram_family_->Bind(labels, trpc::time::GetMilliSeconds(), bucket));
 }
 
 int OpenTelemetryMetrics::SingleAttrReport(const SingleAttrMetricsInfo& info) { return SingleAttrReportTemplate(info); }
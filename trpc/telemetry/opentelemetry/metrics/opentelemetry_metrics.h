@@ -16,6 +16,10 @@
 
 #include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -24,11 +28,25 @@
 #include "prometheus/histogram.h"
 #include "prometheus/registry.h"
 #include "prometheus/summary.h"
+#include "trpc/filter/filter_id_counter.h"
 #include "trpc/metrics/metrics.h"
 #include "trpc/util/log/logging.h"
 #include "trpc/util/prometheus.h"
 
+#include "trpc/telemetry/opentelemetry/metrics/bound_metrics.h"
 #include "trpc/telemetry/opentelemetry/metrics/common.h"
+#include "trpc/telemetry/opentelemetry/metrics/exemplar.h"
+#include "trpc/telemetry/opentelemetry/metrics/exposition_cache.h"
+#include "trpc/telemetry/opentelemetry/metrics/inflight_gauge.h"
+#include "trpc/telemetry/opentelemetry/metrics/label_selector.h"
+#include "trpc/telemetry/opentelemetry/metrics/labeled_family.h"
+#include "trpc/telemetry/opentelemetry/metrics/open_metrics_serializer.h"
+#include "trpc/telemetry/opentelemetry/metrics/otlp_metrics_exporter.h"
+#include "trpc/telemetry/opentelemetry/metrics/peer_metrics.h"
+#include "trpc/telemetry/opentelemetry/metrics/periodic_metrics_exporter.h"
+#include "trpc/telemetry/opentelemetry/metrics/series_limiter.h"
+#include "trpc/telemetry/opentelemetry/metrics/shm_metrics_writer.h"
+#include "trpc/telemetry/opentelemetry/metrics/slo_tracker.h"
 #include "trpc/telemetry/opentelemetry/opentelemetry_common.h"
 #include "trpc/telemetry/opentelemetry/opentelemetry_telemetry_conf.h"
 
@@ -41,6 +59,10 @@ class OpenTelemetryMetrics : public Metrics {
 
   int Init() noexcept override;
 
+  void Start() noexcept override;
+
+  void Stop() noexcept override;
+
   int ModuleReport(const ModuleMetricsInfo& info) override;
 
   int SingleAttrReport(const SingleAttrMetricsInfo& info) override;
@@ -52,6 +74,115 @@ class OpenTelemetryMetrics : public Metrics {
   /// @brief Gets the config for OpenTelemetryMetrics
   const OpenTelemetryConfig& GetConfig() { return config_; }
 
+  /// @brief Gets the index of the filter data where the filters store the RpcMetricsRecord of a RPC
+  uint16_t GetRecordIndex() const { return record_index_; }
+
+  /// @brief Gets the labels used by any of the server-side RPC metrics families, the filter skips building the others.
+  trpc::opentelemetry::LabelMask GetServerLabelMask() const { return server_label_mask_; }
+
+  /// @brief Gets the labels used by any of the client-side RPC metrics families, the filter skips building the others.
+  trpc::opentelemetry::LabelMask GetClientLabelMask() const { return client_label_mask_; }
+
+  /// @brief Reports the number of RPCs started on the client, which is the same as ModuleReport with
+  ///        kClientStartedCount but without the dispatching of ModuleMetricsInfo.
+  /// @note This interface is for internal use only and should not be used by users. May be modified in the future.
+  void ReportClientStartedTotal(const std::map<std::string, std::string>& labels);
+
+  /// @brief Reports the number of RPCs completed by the client, the labels should contain the call result.
+  /// @note This interface is for internal use only and should not be used by users. May be modified in the future.
+  void ReportClientHandledTotal(const std::map<std::string, std::string>& labels);
+
+  /// @brief Reports the latency of the client-side RPC, in milliseconds.
+  /// @param exemplar the trace context of the sampled span which is attached to the bucket as its exemplar, nullptr
+  ///        means no exemplar
+  /// @note This interface is for internal use only and should not be used by users. May be modified in the future.
+  void ReportClientHandledSeconds(const std::map<std::string, std::string>& labels, uint64_t cost_time,
+                                  const trpc::opentelemetry::ExemplarContext* exemplar = nullptr);
+
+  /// @brief Reports the number of RPCs started on the server.
+  /// @note This interface is for internal use only and should not be used by users. May be modified in the future.
+  void ReportServerStartedTotal(const std::map<std::string, std::string>& labels);
+
+  /// @brief Reports the number of RPCs completed on the server, the labels should contain the call result.
+  /// @note This interface is for internal use only and should not be used by users. May be modified in the future.
+  void ReportServerHandledTotal(const std::map<std::string, std::string>& labels);
+
+  /// @brief Reports the latency of the server-side RPC, in milliseconds.
+  /// @param exemplar the trace context of the sampled span which is attached to the bucket as its exemplar, nullptr
+  ///        means no exemplar
+  /// @note This interface is for internal use only and should not be used by users. May be modified in the future.
+  void ReportServerHandledSeconds(const std::map<std::string, std::string>& labels, uint64_t cost_time,
+                                  const trpc::opentelemetry::ExemplarContext* exemplar = nullptr);
+
+  /// @brief Reports the time waited from receiving the request to invoking the handler on the server, in microseconds.
+  /// @note This interface is for internal use only and should not be used by users. May be modified in the future.
+  void ReportServerQueueWaitSeconds(const std::map<std::string, std::string>& labels, uint64_t cost_us);
+
+  /// @brief Reports the execution time of the handler on the server, in microseconds.
+  /// @note This interface is for internal use only and should not be used by users. May be modified in the future.
+  void ReportServerHandlerSeconds(const std::map<std::string, std::string>& labels, uint64_t cost_us);
+
+  /// @brief Reports the time from the handler returning to the response being sent on the server, which includes
+  ///        encoding, in microseconds.
+  /// @note This interface is for internal use only and should not be used by users. May be modified in the future.
+  void ReportServerSendSeconds(const std::map<std::string, std::string>& labels, uint64_t cost_us);
+
+  /// @brief Reports the size of the request sent by the client, in bytes.
+  /// @note This interface is for internal use only and should not be used by users. May be modified in the future.
+  void ReportClientRequestBytes(const std::map<std::string, std::string>& labels, size_t size);
+
+  /// @brief Reports the size of the response received by the client, in bytes.
+  /// @note This interface is for internal use only and should not be used by users. May be modified in the future.
+  void ReportClientResponseBytes(const std::map<std::string, std::string>& labels, size_t size);
+
+  /// @brief Reports the size of the request received by the server, in bytes.
+  /// @note This interface is for internal use only and should not be used by users. May be modified in the future.
+  void ReportServerRequestBytes(const std::map<std::string, std::string>& labels, size_t size);
+
+  /// @brief Reports the size of the response sent by the server, in bytes.
+  /// @note This interface is for internal use only and should not be used by users. May be modified in the future.
+  void ReportServerResponseBytes(const std::map<std::string, std::string>& labels, size_t size);
+
+  /// @brief Gets the counter of the in-flight requests of the server-side method.
+  /// @note This interface is for internal use only and should not be used by users. May be modified in the future.
+  trpc::opentelemetry::InflightCounter* GetServerInflightCounter(std::string_view callee_service,
+                                                                 std::string_view callee_method);
+
+  /// @brief Gets the counter of the in-flight requests of the client-side callee.
+  /// @note This interface is for internal use only and should not be used by users. May be modified in the future.
+  trpc::opentelemetry::InflightCounter* GetClientInflightCounter(std::string_view callee_service);
+
+  /// @brief Reports the latency and the result of the client-side RPC to the peer, which is skipped if the peer
+  ///        metrics is not enabled.
+  /// @param cost_us the latency of the RPC, in microseconds
+  /// @note This interface is for internal use only and should not be used by users. May be modified in the future.
+  void ReportClientPeer(std::string_view callee_service, std::string_view ip, int port, uint64_t cost_us,
+                        bool failed);
+
+  /// @brief Checks whether any service level objective is configured.
+  bool HasSlo() const { return !slos_.empty(); }
+
+  /// @brief Counts the server-side RPC into the service level objectives of its method.
+  /// @param cost_ms the latency of the RPC, in milliseconds
+  /// @param success whether the RPC succeeded according to the code classification
+  /// @note This interface is for internal use only and should not be used by users. May be modified in the future.
+  void ReportServerSlo(std::string_view callee_service, std::string_view callee_method, uint64_t cost_ms,
+                       bool success);
+
+  /// @brief Gets the tracker of the service level objective by its name.
+  /// @return Return the tracker, or nullptr if the objective is not configured.
+  std::shared_ptr<const trpc::opentelemetry::SloTracker> GetSlo(const std::string& name) const;
+
+  /// @brief Serializes all the metrics of the prometheus registry into the OpenMetrics text format, with the exemplars
+  ///        of the latency histograms. The text is cached for metrics.collect_min_interval.
+  /// @param [out] out the serialized text, which is appended to
+  /// @return Return 0 on success, -1 if metrics is not enabled.
+  int CollectOpenMetrics(std::string& out);
+
+  /// @brief Gets the OpenMetrics text like CollectOpenMetrics, but shares the cached text instead of copying it.
+  /// @return Return the serialized text which must not be modified, or nullptr if metrics is not enabled.
+  std::shared_ptr<const std::string> CollectOpenMetrics();
+
   /// @brief Reports metrics data with SET type
   /// @note This interface is for internal use only and should not be used by users. May be modified in the future.
   int SetDataReport(const std::map<std::string, std::string>& labels, double value);
@@ -75,6 +206,21 @@ class OpenTelemetryMetrics : public Metrics {
   int HistogramDataReport(const std::map<std::string, std::string>& labels, const HistogramBucket& bucket,
                           double value);
 
+  /// @brief Limits the series of the family registered by the user like the other families, and evicts its stale series
+  ///        together with them. The family is only kept by a weak reference.
+  /// @note This interface is for internal use only and should not be used by users. May be modified in the future.
+  void LimitRegisteredFamily(const char* family_name,
+                             const std::shared_ptr<trpc::opentelemetry::SeriesLimitable>& family);
+
+  /// @brief Binds a counter of SUM type metrics data to the labels
+  /// @note This interface is for internal use only and should not be used by users. May be modified in the future.
+  trpc::opentelemetry::BoundCounter BindCounter(const std::map<std::string, std::string>& labels);
+
+  /// @brief Binds a histogram of HISTOGRAM type metrics data to the labels
+  /// @note This interface is for internal use only and should not be used by users. May be modified in the future.
+  trpc::opentelemetry::BoundHistogram BindHistogram(const std::map<std::string, std::string>& labels,
+                                                    const HistogramBucket& bucket);
+
  private:
   // Type definition of reporting functions for module metrics data
   using ModuleReportFunc = std::function<void(const ModuleMetricsInfo& info)>;
@@ -97,6 +243,63 @@ class OpenTelemetryMetrics : public Metrics {
   // ModuleReportFunc for kServerHandledTime type
   void ServerHandledSecondsReportFunc(const ModuleMetricsInfo& metrics_info);
 
+  // Initializes the series limited families
+  void InitFamilies();
+
+  // Initializes a series limited family
+  template <typename T>
+  void InitFamily(std::shared_ptr<trpc::opentelemetry::SeriesLimitedFamily<T>>& limited_family,
+                  ::prometheus::Family<T>* family, const char* family_name);
+
+  // Gets the series limit options of the family from the config
+  trpc::opentelemetry::SeriesLimitOptions GetSeriesLimitOptions(const char* family_name);
+
+  // Gets the labels kept in the family from the config
+  trpc::opentelemetry::LabelMask GetLabelMask(const char* family_name);
+
+  // Evicts the series which have not been updated within the ttl of all families
+  void EvictStaleSeries();
+
+  // Copies the number of in-flight requests into the gauges
+  void SyncInflightGauges();
+
+  // Copies the reports of the peers into the families
+  void SyncPeerMetrics();
+
+  // Creates the trackers of the valid service level objectives
+  void InitSlos();
+
+  // Recomputes the burn rates of the service level objectives and copies them into the gauges
+  void UpdateSlos();
+
+  // Observes the latency and offers it as an exemplar of the histogram series
+  void ObserveWithExemplar(trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Histogram>& family,
+                           const std::map<std::string, std::string>& labels, const std::vector<double>& buckets,
+                           double value, const trpc::opentelemetry::ExemplarContext& exemplar);
+
+  // Serializes all the metrics into the OpenMetrics text format, which is called by the exposition cache
+  void WriteOpenMetrics(std::string& out);
+
+  // Collects the metric families of the prometheus registry, together with the exemplars of the latency histograms
+  void CollectWithExemplars(std::vector<::prometheus::MetricFamily>& families,
+                            trpc::opentelemetry::ExemplarSnapshot& exemplars);
+
+  // Creates the exporter of the configured protocol, which pushes the metrics to the collector
+  std::unique_ptr<trpc::opentelemetry::OtlpMetricsExporter> GetExporter();
+
+  // Starts pushing the metrics to the collector periodically
+  void StartExporter();
+
+  // Creates the shared memory file and starts publishing the metrics into it periodically
+  void StartShmExport();
+
+  // Publishes the metrics of the prometheus registry into the shared memory file
+  void PublishShmMetrics();
+
+  // Copies the exemplars of the histogram family into the snapshot
+  static void SnapshotExemplars(const trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Histogram>& family,
+                                const char* family_name, trpc::opentelemetry::ExemplarSnapshot& snapshot);
+
   template <typename T>
   int SingleAttrReportTemplate(T&& info) {
     if (!config_.metrics_config.enabled) {  // does not enable metrics
@@ -160,48 +363,164 @@ class OpenTelemetryMetrics : public Metrics {
   std::unordered_map<trpc::opentelemetry::ModuleReportType, ModuleReportFunc> module_report_map_;
 
   // metrics family for number of client-side RPC calls
-  ::prometheus::Family<::prometheus::Counter>* client_started_total_family_;
+  std::shared_ptr<trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Counter>> client_started_total_family_;
   static constexpr char kClientStartedTotalName[] = "rpc_client_started_total";
   static constexpr char kClientStartedTotalDesc[] = "Total number of RPCs started on the client.";
   // metrics family for for client requests, error rate, timeout rate, and success rate
-  ::prometheus::Family<::prometheus::Counter>* client_handled_total_family_;
+  std::shared_ptr<trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Counter>> client_handled_total_family_;
   static constexpr char kClientHandledTotalName[] = "rpc_client_handled_total";
   static constexpr char kClientHandledTotalDesc[] =
       "Total number of RPCs completed by the client, regardless of success or failure.";
   // metrics family for distribution of client-side execution time
-  ::prometheus::Family<::prometheus::Histogram>* client_handled_seconds_family_;
+  std::shared_ptr<trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Histogram>> client_handled_seconds_family_;
   static constexpr char kClientHandledSecondsName[] = "rpc_client_handled_seconds";
   static constexpr char kClientHandledSecondsDesc[] =
       "Histogram of response latency (seconds) of the RPC until it is finished by the application.";
+  // metrics family for distribution of client-side request size
+  std::shared_ptr<trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Histogram>> client_request_bytes_family_;
+  static constexpr char kClientRequestBytesName[] = "rpc_client_request_bytes";
+  static constexpr char kClientRequestBytesDesc[] = "Histogram of request size (bytes) of the RPC sent by the client.";
+  // metrics family for distribution of client-side response size
+  std::shared_ptr<trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Histogram>> client_response_bytes_family_;
+  static constexpr char kClientResponseBytesName[] = "rpc_client_response_bytes";
+  static constexpr char kClientResponseBytesDesc[] =
+      "Histogram of response size (bytes) of the RPC received by the client.";
 
   // metrics family for number of server-side RPC calls
-  ::prometheus::Family<::prometheus::Counter>* server_started_total_family_;
+  std::shared_ptr<trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Counter>> server_started_total_family_;
   static constexpr char kServerStartedTotalName[] = "rpc_server_started_total";
   static constexpr char kServerStartedTotalDesc[] = "Total number of RPCs started on the server.";
   // metrics family for for server requests, error rate, timeout rate, and success rate
-  ::prometheus::Family<::prometheus::Counter>* server_handled_total_family_;
+  std::shared_ptr<trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Counter>> server_handled_total_family_;
   static constexpr char kServerHandledTotalName[] = "rpc_server_handled_total";
   static constexpr char kServerHandledTotalDesc[] =
       "Total number of RPCs completed on the server, regardless of success or failure.";
   // metrics family for distribution of server-side execution time
-  ::prometheus::Family<::prometheus::Histogram>* server_handled_seconds_family_;
+  std::shared_ptr<trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Histogram>> server_handled_seconds_family_;
   static constexpr char kServerHandledSecondsName[] = "rpc_server_handled_seconds";
   static constexpr char kServerHandledSecondsDesc[] =
       "Histogram of response latency (seconds) of RPC that had been application-level handled by the server.";
+  // metrics family for distribution of server-side time waited before invoking the handler
+  std::shared_ptr<trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Histogram>> server_queue_wait_seconds_family_;
+  static constexpr char kServerQueueWaitSecondsName[] = "rpc_server_queue_wait_seconds";
+  static constexpr char kServerQueueWaitSecondsDesc[] =
+      "Histogram of time (seconds) waited by the RPC from being received to being dispatched to the handler.";
+  // metrics family for distribution of server-side handler execution time
+  std::shared_ptr<trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Histogram>> server_handler_seconds_family_;
+  static constexpr char kServerHandlerSecondsName[] = "rpc_server_handler_seconds";
+  static constexpr char kServerHandlerSecondsDesc[] =
+      "Histogram of execution time (seconds) of the handler of the RPC.";
+  // metrics family for distribution of server-side time of encoding and sending the response
+  std::shared_ptr<trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Histogram>> server_send_seconds_family_;
+  static constexpr char kServerSendSecondsName[] = "rpc_server_send_seconds";
+  static constexpr char kServerSendSecondsDesc[] =
+      "Histogram of time (seconds) taken by the RPC from the handler returning to the response being sent.";
+  // metrics family for distribution of server-side request size
+  std::shared_ptr<trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Histogram>> server_request_bytes_family_;
+  static constexpr char kServerRequestBytesName[] = "rpc_server_request_bytes";
+  static constexpr char kServerRequestBytesDesc[] =
+      "Histogram of request size (bytes) of the RPC received by the server.";
+  // metrics family for distribution of server-side response size
+  std::shared_ptr<trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Histogram>> server_response_bytes_family_;
+  static constexpr char kServerResponseBytesName[] = "rpc_server_response_bytes";
+  static constexpr char kServerResponseBytesDesc[] =
+      "Histogram of response size (bytes) of the RPC sent by the server.";
 
   // custom metrics data
-  ::prometheus::Family<::prometheus::Counter>* opentelemetry_counter_family_;
+  std::shared_ptr<trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Counter>> opentelemetry_counter_family_;
   static constexpr char kOpenTelemetryCounterName[] = "opentelemetry_counter_report";
   static constexpr char kOpenTelemetryCounterDesc[] = "trpc-cpp opentelemetry counter report.";
-  ::prometheus::Family<::prometheus::Gauge>* opentelemetry_gauge_family_;
+  std::shared_ptr<trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Gauge>> opentelemetry_gauge_family_;
   static constexpr char kOpenTelemetryGaugeName[] = "opentelemetry_gauge_report";
   static constexpr char kOpenTelemetryGaugeDesc[] = "trpc-cpp opentelemetry gauge report.";
-  ::prometheus::Family<::prometheus::Summary>* opentelemetry_summary_family_;
+  std::shared_ptr<trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Summary>> opentelemetry_summary_family_;
   static constexpr char kOpenTelemetrySummaryName[] = "opentelemetry_summary_report";
   static constexpr char kOpenTelemetrySummaryDesc[] = "trpc-cpp opentelemetry summary report.";
-  ::prometheus::Family<::prometheus::Histogram>* opentelemetry_histogram_family_;
+  std::shared_ptr<trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Histogram>> opentelemetry_histogram_family_;
   static constexpr char kOpenTelemetryHistogramName[] = "opentelemetry_histogram_report";
   static constexpr char kOpenTelemetryHistogramDesc[] = "trpc-cpp opentelemetry histogram report.";
+
+  // the families registered by the user, whose stale series are evicted together with the families above
+  std::mutex registered_families_mutex_;
+  std::vector<std::weak_ptr<trpc::opentelemetry::SeriesLimitable>> registered_families_;
+
+  // metrics family for the number of reports folded into the overflow series because of the series limit
+  ::prometheus::Family<::prometheus::Counter>* series_dropped_total_family_ = nullptr;
+  static constexpr char kSeriesDroppedTotalName[] = "opentelemetry_series_dropped_total";
+  static constexpr char kSeriesDroppedTotalDesc[] =
+      "Total number of reports folded into the overflow series because the family reached its series limit.";
+  // metrics family for the number of series evicted because they were not updated within the ttl
+  ::prometheus::Family<::prometheus::Counter>* series_evicted_total_family_ = nullptr;
+  static constexpr char kSeriesEvictedTotalName[] = "opentelemetry_series_evicted_total";
+  static constexpr char kSeriesEvictedTotalDesc[] =
+      "Total number of series evicted because they were not updated within the ttl.";
+  static constexpr char kSeriesFamilyLabel[] = "family";
+
+  // in-flight requests of each server-side method
+  std::shared_ptr<trpc::opentelemetry::InflightGauges<2>> server_inflight_gauges_;
+  static constexpr char kServerInflightName[] = "rpc_server_inflight_requests";
+  static constexpr char kServerInflightDesc[] = "Number of RPCs being handled on the server.";
+  // in-flight requests of each client-side callee
+  std::shared_ptr<trpc::opentelemetry::InflightGauges<1>> client_inflight_gauges_;
+  static constexpr char kClientInflightName[] = "rpc_client_inflight_requests";
+  static constexpr char kClientInflightDesc[] = "Number of RPCs started by the client and not finished yet.";
+
+  // the union of the labels kept in the server-side and client-side RPC metrics families
+  trpc::opentelemetry::LabelMask server_label_mask_ = trpc::opentelemetry::kAllRpcLabels;
+  trpc::opentelemetry::LabelMask client_label_mask_ = trpc::opentelemetry::kAllRpcLabels;
+
+  // latency and failures of the client-side RPCs to each of the top-K peers
+  std::unique_ptr<trpc::opentelemetry::PeerMetrics> client_peer_metrics_;
+  static constexpr char kClientPeerHandledSecondsName[] = "rpc_client_peer_handled_seconds";
+  static constexpr char kClientPeerHandledSecondsDesc[] =
+      "Histogram of response latency (seconds) of the RPC to each peer, the peers out of the top-K by traffic are "
+      "aggregated into the \"other\" peer.";
+  static constexpr char kClientPeerFailedTotalName[] = "rpc_client_peer_failed_total";
+  static constexpr char kClientPeerFailedTotalDesc[] =
+      "Total number of failed RPCs to each peer, the peers out of the top-K by traffic are aggregated into the "
+      "\"other\" peer.";
+
+  // The tracker of a service level objective, and the gauges of its burn rates in the same order as its windows
+  struct SloState {
+    std::shared_ptr<trpc::opentelemetry::SloTracker> tracker;
+    std::vector<::prometheus::Gauge*> burn_rate_gauges;
+  };
+
+  // the service level objectives of the server-side RPCs
+  std::vector<SloState> slos_;
+  static constexpr char kServerSloBurnRateName[] = "rpc_server_slo_burn_rate";
+  static constexpr char kServerSloBurnRateDesc[] =
+      "Burn rate of the error budget of the service level objective over the sliding window, 1 means the budget is "
+      "consumed exactly by the end of the window.";
+  static constexpr char kSloLabel[] = "slo";
+  static constexpr char kSloWindowLabel[] = "window";
+
+  // the id of the periodic task which evicts stale series
+  uint64_t evict_task_id_ = 0;
+
+  // the id of the periodic task which syncs the in-flight gauges
+  uint64_t inflight_task_id_ = 0;
+
+  // the id of the periodic task which syncs the peer metrics
+  uint64_t peer_task_id_ = 0;
+
+  // the id of the periodic task which updates the burn rates of the service level objectives
+  uint64_t slo_task_id_ = 0;
+
+  // the OpenMetrics text shared by the collections within collect_min_interval
+  std::unique_ptr<trpc::opentelemetry::ExpositionCache> open_metrics_cache_;
+
+  // pushes the metrics to the collector when export_enabled is set
+  std::unique_ptr<trpc::opentelemetry::PeriodicMetricsExporter> periodic_exporter_;
+
+  // publishes the metrics into the shared memory file when shm_export_enabled is set
+  std::unique_ptr<trpc::opentelemetry::ShmMetricsWriter> shm_writer_;
+
+  // the id of the periodic task which publishes the metrics into the shared memory file
+  uint64_t shm_task_id_ = 0;
+
+  // the index of the filter data where the RpcMetricsRecord is stored
+  const uint16_t record_index_ = trpc::GetNextFilterID();
 };
 
 using OpenTelemetryMetricsPtr = RefPtr<OpenTelemetryMetrics>;
@@ -88,5 +88,54 @@ int ReportHistogramMetricsInfo(const std::map<std::string, std::string>& labels,
   return ReportHistogramTemplate(labels, std::move(bucket), value);
 }
 
+BoundCounter BindCounter(const std::map<std::string, std::string>& labels) {
+  trpc::OpenTelemetryMetricsPtr metrics = GetMetricsPlugin();
+  if (!metrics) {
+    return BoundCounter();
+  }
+  return metrics->BindCounter(labels);
+}
+
+BoundHistogram BindHistogram(const std::map<std::string, std::string>& labels, const HistogramBucket& bucket) {
+  trpc::OpenTelemetryMetricsPtr metrics = GetMetricsPlugin();
+  if (!metrics) {
+    return BoundHistogram();
+  }
+  return metrics->BindHistogram(labels, bucket);
+}
+
+void LimitRegisteredFamily(const char* name, const std::shared_ptr<SeriesLimitable>& family) {
+  trpc::OpenTelemetryMetricsPtr metrics = GetMetricsPlugin();
+  if (!metrics) {
+    TRPC_FMT_WARN("metrics plugin is unavailable, the series of family {} are not limited", name);
+    return;
+  }
+  metrics->LimitRegisteredFamily(name, family);
+}
+
+int CollectOpenMetrics(std::string& out) {
+  trpc::OpenTelemetryMetricsPtr metrics = GetMetricsPlugin();
+  if (!metrics) {
+    return -1;
+  }
+  return metrics->CollectOpenMetrics(out);
+}
+
+std::shared_ptr<const std::string> CollectOpenMetrics() {
+  trpc::OpenTelemetryMetricsPtr metrics = GetMetricsPlugin();
+  if (!metrics) {
+    return nullptr;
+  }
+  return metrics->CollectOpenMetrics();
+}
+
+std::shared_ptr<const SloTracker> GetSlo(const std::string& name) {
+  trpc::OpenTelemetryMetricsPtr metrics = GetMetricsPlugin();
+  if (!metrics) {
+    return nullptr;
+  }
+  return metrics->GetSlo(name);
+}
+
 }  // namespace trpc::opentelemetry
 #endif
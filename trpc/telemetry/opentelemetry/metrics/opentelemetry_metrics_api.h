@@ -15,9 +15,16 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <string>
+#include <utility>
 
 #include "trpc/metrics/metrics.h"
+#include "trpc/util/prometheus.h"
+
+#include "trpc/telemetry/opentelemetry/metrics/bound_metrics.h"
+#include "trpc/telemetry/opentelemetry/metrics/labeled_family.h"
+#include "trpc/telemetry/opentelemetry/metrics/slo_tracker.h"
 
 /// @brief OpenTelemetry metrics interfaces for user programing
 namespace trpc::opentelemetry {
@@ -58,5 +65,77 @@ int ReportHistogramMetricsInfo(const std::map<std::string, std::string>& labels,
 int ReportHistogramMetricsInfo(const std::map<std::string, std::string>& labels, HistogramBucket&& bucket,
                                double value);
 
+/// @brief Binds a counter to the labels, which reports the same data as ReportSumMetricsInfo. The plugin and the labels
+///        are looked up only once here, so it is suitable for reporting in tight loops.
+/// @return Return the bound counter, or an unbound one which ignores reports when the metrics is unavailable.
+BoundCounter BindCounter(const std::map<std::string, std::string>& labels);
+
+/// @brief Binds a histogram to the labels and buckets, which reports the same data as ReportHistogramMetricsInfo.
+/// @return Return the bound histogram, or an unbound one which ignores reports when the metrics is unavailable or the
+///         bucket is empty.
+BoundHistogram BindHistogram(const std::map<std::string, std::string>& labels, const HistogramBucket& bucket);
+
+/// @brief Serializes all the metrics into the OpenMetrics text format, with the trace exemplars of the RPC latency
+///        histograms when metrics.enable_exemplar is set. It can be served with kOpenMetricsContentType by a custom
+///        admin handler, since the prometheus text format has no exemplars.
+///        The text is cached for metrics.collect_min_interval, so that frequent scrapes do not serialize the whole
+///        registry each time.
+/// @param [out] out the serialized text, which is appended to
+/// @return Return 0 for success and non-zero for failure.
+int CollectOpenMetrics(std::string& out);
+
+/// @brief Gets the OpenMetrics text like CollectOpenMetrics, but shares the cached text instead of copying it, which
+///        saves a copy for large registries.
+/// @return Return the serialized text which must not be modified, or nullptr for failure.
+std::shared_ptr<const std::string> CollectOpenMetrics();
+
+/// @brief Gets the tracker of the service level objective configured in metrics.slos by its name. The tracker should be
+///        looked up once and kept, then querying its burn rates by GetBurnRate is a single atomic load, which is cheap
+///        enough for making decisions on the request path, such as load shedding.
+/// @param name the name of the objective
+/// @return Return the tracker, or nullptr if the metrics is unavailable or the objective is not configured.
+std::shared_ptr<const SloTracker> GetSlo(const std::string& name);
+
+/// @brief Limits the series of the family registered by the user like the families of the plugin, by
+///        metrics.max_series_per_family, metrics.family_max_series and metrics.series_ttl.
+/// @param name the name of the family
+/// @note This interface is for internal use only and should not be used by users. May be modified in the future.
+void LimitRegisteredFamily(const char* name, const std::shared_ptr<SeriesLimitable>& family);
+
+/// @brief Registers a counter family whose label names are fixed, so that reports only pass the label values without
+///        building the labels map. It should be called once at startup after the plugin is initialized, and the result
+///        should be kept for reporting. The series of the family are limited by the series limit and ttl of the
+///        metrics config.
+/// @param name the name of the family, which must be unique
+/// @param desc the description of the family
+/// @param label_names the label names of the family
+template <size_t N>
+std::shared_ptr<LabeledCounterFamily<N>> RegisterCounterFamily(const char* name, const char* desc,
+                                                               const LabelNames<N>& label_names) {
+  auto family = std::make_shared<LabeledCounterFamily<N>>(trpc::prometheus::GetCounterFamily(name, desc), label_names);
+  LimitRegisteredFamily(name, family);
+  return family;
+}
+
+/// @brief Registers a gauge family whose label names are fixed.
+template <size_t N>
+std::shared_ptr<LabeledGaugeFamily<N>> RegisterGaugeFamily(const char* name, const char* desc,
+                                                           const LabelNames<N>& label_names) {
+  auto family = std::make_shared<LabeledGaugeFamily<N>>(trpc::prometheus::GetGaugeFamily(name, desc), label_names);
+  LimitRegisteredFamily(name, family);
+  return family;
+}
+
+/// @brief Registers a histogram family whose label names and buckets are fixed.
+template <size_t N>
+std::shared_ptr<LabeledHistogramFamily<N>> RegisterHistogramFamily(const char* name, const char* desc,
+                                                                   const LabelNames<N>& label_names,
+                                                                   HistogramBucket bucket) {
+  auto family = std::make_shared<LabeledHistogramFamily<N>>(trpc::prometheus::GetHistogramFamily(name, desc),
+                                                            label_names, std::move(bucket));
+  LimitRegisteredFamily(name, family);
+  return family;
+}
+
 }  // namespace trpc::opentelemetry
 #endif
@@ -17,6 +17,7 @@
 #include "gtest/gtest.h"
 #include "trpc/common/config/trpc_config.h"
 #include "trpc/telemetry/telemetry_factory.h"
+#include "trpc/util/prometheus.h"
 
 #include "trpc/telemetry/opentelemetry/metrics/opentelemetry_metrics.h"
 #include "trpc/telemetry/opentelemetry/testing/mock_telemetry.h"
@@ -84,5 +85,99 @@ TEST_F(OpenTelemetryMetricsAPITest, Report) {
   ASSERT_EQ(0, trpc::opentelemetry::ReportHistogramMetricsInfo(labels, std::move(bucket), 10));
 }
 
+TEST_F(OpenTelemetryMetricsAPITest, Bind) {
+  // 1. reports on the unbound counter are ignored
+  trpc::opentelemetry::BoundCounter unbound_counter;
+  ASSERT_FALSE(unbound_counter.IsBound());
+  unbound_counter.Add(1);
+
+  auto telemetry = MakeRefCounted<MockOpenTelemetryTelemetry>();
+  TelemetryFactory::GetInstance()->Register(telemetry);
+  EXPECT_CALL(*telemetry, GetMetrics()).WillRepeatedly(::testing::Return(metrics_));
+
+  // 2. testing bind counter, which reports the same series as ReportSumMetricsInfo
+  auto counter = trpc::opentelemetry::BindCounter(GetTestLabels("bind_counter_value"));
+  ASSERT_TRUE(counter.IsBound());
+  counter.Add(1);
+  counter.Add(2);
+  auto counter_family = trpc::prometheus::GetCounterFamily("opentelemetry_counter_report", "");
+  ASSERT_EQ(3, counter_family->Add(GetTestLabels("bind_counter_value")).Value());
+  ASSERT_EQ(0, trpc::opentelemetry::ReportSumMetricsInfo(GetTestLabels("bind_counter_value"), 1));
+  ASSERT_EQ(4, counter_family->Add(GetTestLabels("bind_counter_value")).Value());
+
+  // 3. testing bind histogram
+  ASSERT_FALSE(trpc::opentelemetry::BindHistogram(GetTestLabels("bind_histogram_value"), {}).IsBound());
+  auto histogram = trpc::opentelemetry::BindHistogram(GetTestLabels("bind_histogram_value"), {0.1, 0.5, 1});
+  ASSERT_TRUE(histogram.IsBound());
+  histogram.Observe(0.2);
+
+  // 4. the bound series stay valid across reinitialization
+  ASSERT_EQ(0, metrics_->Init());
+  counter.Add(1);
+  ASSERT_EQ(5, counter_family->Add(GetTestLabels("bind_counter_value")).Value());
+}
+
+TEST_F(OpenTelemetryMetricsAPITest, RegisterFamily) {
+  constexpr trpc::opentelemetry::LabelNames<2> kLabelNames = {"label1", "label2"};
+  auto counter_family =
+      trpc::opentelemetry::RegisterCounterFamily("labeled_counter_test", "labeled counter test", kLabelNames);
+  counter_family->Increment({"value1", "value2"}, 2);
+  ASSERT_EQ(2, trpc::prometheus::GetCounterFamily("labeled_counter_test", "labeled counter test")
+                   ->Add({{"label1", "value1"}, {"label2", "value2"}})
+                   .Value());
+
+  auto gauge_family = trpc::opentelemetry::RegisterGaugeFamily("labeled_gauge_test", "labeled gauge test", kLabelNames);
+  gauge_family->Set({"value1", "value2"}, 10);
+
+  auto histogram_family = trpc::opentelemetry::RegisterHistogramFamily("labeled_histogram_test",
+                                                                        "labeled histogram test", kLabelNames, {1, 2});
+  histogram_family->Observe({"value1", "value2"}, 1);
+}
+
+TEST_F(OpenTelemetryMetricsAPITest, RegisterLimitedFamily) {
+  auto telemetry = MakeRefCounted<MockOpenTelemetryTelemetry>();
+  TelemetryFactory::GetInstance()->Register(telemetry);
+  EXPECT_CALL(*telemetry, GetMetrics()).WillRepeatedly(::testing::Return(metrics_));
+
+  // the family is limited by metrics.family_max_series of the config
+  constexpr trpc::opentelemetry::LabelNames<1> kLabelNames = {"label"};
+  auto counter_family = trpc::opentelemetry::RegisterCounterFamily("labeled_limited_counter_test",
+                                                                   "labeled limited counter test", kLabelNames);
+  counter_family->Increment({"value1"});
+  counter_family->Increment({"value2"});
+  ASSERT_EQ(1, counter_family->Size());
+  auto* family = trpc::prometheus::GetCounterFamily("labeled_limited_counter_test", "labeled limited counter test");
+  ASSERT_FALSE(family->Has({{"label", "value2"}}));
+  ASSERT_TRUE(family->Has({{trpc::opentelemetry::kOverflowLabelKey, trpc::opentelemetry::kOverflowLabelValue}}));
+}
+
+TEST_F(OpenTelemetryMetricsAPITest, CollectOpenMetrics) {
+  auto telemetry = MakeRefCounted<MockOpenTelemetryTelemetry>();
+  TelemetryFactory::GetInstance()->Register(telemetry);
+  EXPECT_CALL(*telemetry, GetMetrics()).WillRepeatedly(::testing::Return(metrics_));
+
+  std::string out;
+  ASSERT_EQ(0, trpc::opentelemetry::CollectOpenMetrics(out));
+  auto text = trpc::opentelemetry::CollectOpenMetrics();
+  ASSERT_NE(nullptr, text);
+  ASSERT_EQ(0, text->compare(text->size() - 6, 6, "# EOF\n"));
+}
+
+TEST_F(OpenTelemetryMetricsAPITest, GetSlo) {
+  auto telemetry = MakeRefCounted<MockOpenTelemetryTelemetry>();
+  TelemetryFactory::GetInstance()->Register(telemetry);
+  EXPECT_CALL(*telemetry, GetMetrics()).WillRepeatedly(::testing::Return(metrics_));
+
+  ASSERT_EQ(nullptr, trpc::opentelemetry::GetSlo("unknown_slo"));
+  auto slo = trpc::opentelemetry::GetSlo("test_slo");
+  ASSERT_NE(nullptr, slo);
+  ASSERT_EQ(0, slo->GetBurnRate(60));
+  ASSERT_EQ(-1, slo->GetBurnRate(1));
+
+  // the tracker is kept across reinitialization
+  ASSERT_EQ(0, metrics_->Init());
+  ASSERT_EQ(slo, trpc::opentelemetry::GetSlo("test_slo"));
+}
+
 }  // namespace trpc::testing
 #endif
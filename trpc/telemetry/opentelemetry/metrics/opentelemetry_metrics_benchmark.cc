@@ -0,0 +1,177 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+
+#ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "trpc/common/config/trpc_config.h"
+#include "trpc/util/prometheus.h"
+#include "trpc/util/time.h"
+
+#include "trpc/telemetry/opentelemetry/metrics/common.h"
+#include "trpc/telemetry/opentelemetry/metrics/exposition_cache.h"
+#include "trpc/telemetry/opentelemetry/metrics/open_metrics_serializer.h"
+#include "trpc/telemetry/opentelemetry/metrics/opentelemetry_metrics.h"
+
+namespace {
+
+constexpr char kCaller[] = "trpc.test.helloworld.client";
+constexpr char kCallee[] = "trpc.test.helloworld.Greeter";
+constexpr char kFunc[] = "/trpc.test.helloworld.Greeter/SayHello";
+
+trpc::OpenTelemetryMetricsPtr GetMetrics() {
+  static trpc::OpenTelemetryMetricsPtr metrics = [] {
+    trpc::TrpcConfig::GetInstance()->Init("./trpc/telemetry/opentelemetry/testing/opentelemetry_telemetry_test.yaml");
+    auto metrics = trpc::MakeRefCounted<trpc::OpenTelemetryMetrics>();
+    metrics->Init();
+    return metrics;
+  }();
+  return metrics;
+}
+
+trpc::ModuleMetricsInfo MakeModuleMetricsInfo() {
+  trpc::ModuleMetricsInfo module_info;
+  module_info.source = trpc::kMetricsCalleeSource;
+  module_info.infos[trpc::opentelemetry::kCallerService] = kCaller;
+  module_info.infos[trpc::opentelemetry::kCallerMethod] = "";
+  module_info.infos[trpc::opentelemetry::kCalleeService] = kCallee;
+  module_info.infos[trpc::opentelemetry::kCalleeMethod] = kFunc;
+  return module_info;
+}
+
+// The server-side metrics reports of a RPC through ModuleReport, which builds the labels at each filter point and
+// dispatches by the std::any extend_info.
+void BM_ModuleReport(benchmark::State& state) {
+  auto metrics = GetMetrics();
+  for (auto _ : state) {
+    trpc::ModuleMetricsInfo started_info = MakeModuleMetricsInfo();
+    started_info.extend_info = trpc::opentelemetry::ModuleReportType::kServerStartedCount;
+    metrics->ModuleReport(started_info);
+
+    trpc::ModuleMetricsInfo handled_info = MakeModuleMetricsInfo();
+    handled_info.extend_info = trpc::opentelemetry::ModuleReportType::kServerHandledTime;
+    handled_info.cost_time = 1;
+    metrics->ModuleReport(handled_info);
+    handled_info.extend_info = trpc::opentelemetry::ModuleReportType::kServerHandledCount;
+    trpc::opentelemetry::SetCallResult(0, kCallee, kFunc, handled_info.infos);
+    metrics->ModuleReport(handled_info);
+  }
+}
+
+// The server-side metrics reports of a RPC through the RpcMetricsRecord and the typed reporting interfaces.
+void BM_RpcMetricsRecord(benchmark::State& state) {
+  auto metrics = GetMetrics();
+  for (auto _ : state) {
+    trpc::opentelemetry::RpcMetricsRecord record;
+    record.labels = {{trpc::opentelemetry::kCallerService, kCaller},
+                     {trpc::opentelemetry::kCallerMethod, ""},
+                     {trpc::opentelemetry::kCalleeService, kCallee},
+                     {trpc::opentelemetry::kCalleeMethod, kFunc}};
+    metrics->ReportServerStartedTotal(record.labels);
+
+    metrics->ReportServerHandledSeconds(record.labels, 1);
+    trpc::opentelemetry::SetCallResult(0, kCallee, kFunc, record.labels);
+    metrics->ReportServerHandledTotal(record.labels);
+  }
+}
+
+// The number of series of the custom metrics in the registry when benchmarking the scrapes
+constexpr int kSeriesNum = 50000;
+
+std::map<std::string, std::string> MakeSeriesLabels(int index) { return {{"series_key", std::to_string(index)}}; }
+
+void PrepareSeries() {
+  static bool prepared = [] {
+    auto metrics = GetMetrics();
+    for (int i = 0; i < kSeriesNum; ++i) {
+      metrics->SumDataReport(MakeSeriesLabels(i), 1);
+    }
+    return true;
+  }();
+  benchmark::DoNotOptimize(prepared);
+}
+
+// Collects and serializes the whole registry into a new text, which is what every scrape did without the cache.
+void SerializeRegistry(std::string& out) {
+  std::vector<::prometheus::MetricFamily> families = trpc::prometheus::Collect();
+  trpc::opentelemetry::SerializeOpenMetrics(families, {}, out);
+}
+
+// A scrape which serializes the registry into a new text.
+void BM_SerializeOpenMetrics(benchmark::State& state) {
+  PrepareSeries();
+  for (auto _ : state) {
+    std::string out;
+    SerializeRegistry(out);
+    benchmark::DoNotOptimize(out.data());
+  }
+}
+
+// A scrape through the exposition cache, whose argument is the minimum interval in milliseconds. The registry is
+// serialized into a reused buffer on every scrape when it is 0, and only once when it is longer than the benchmark.
+void BM_CachedOpenMetrics(benchmark::State& state) {
+  PrepareSeries();
+  trpc::opentelemetry::ExpositionCache cache(SerializeRegistry);
+  for (auto _ : state) {
+    auto text = cache.Get(trpc::time::GetMilliSeconds(), state.range(0));
+    benchmark::DoNotOptimize(text->data());
+  }
+}
+
+// Reports to the registry while another thread keeps scraping it through the exposition cache, whose argument is the
+// minimum interval in milliseconds. The max_stall_us counter is the latency of the slowest report.
+void BM_ReportDuringScrape(benchmark::State& state) {
+  PrepareSeries();
+  auto metrics = GetMetrics();
+  trpc::opentelemetry::ExpositionCache cache(SerializeRegistry);
+  uint64_t min_interval_ms = state.range(0);
+  std::atomic<bool> stopped{false};
+  std::thread scraper([&cache, &stopped, min_interval_ms]() {
+    while (!stopped.load(std::memory_order_relaxed)) {
+      cache.Get(trpc::time::GetMilliSeconds(), min_interval_ms);
+    }
+  });
+
+  int index = 0;
+  int64_t max_stall_ns = 0;
+  for (auto _ : state) {
+    auto begin = std::chrono::steady_clock::now();
+    metrics->SumDataReport(MakeSeriesLabels(index), 1);
+    auto end = std::chrono::steady_clock::now();
+    max_stall_ns = std::max<int64_t>(max_stall_ns, std::chrono::nanoseconds(end - begin).count());
+    index = (index + 1) % kSeriesNum;
+  }
+
+  stopped = true;
+  scraper.join();
+  state.counters["max_stall_us"] = static_cast<double>(max_stall_ns) / 1000;
+}
+
+}  // namespace
+
+BENCHMARK(BM_ModuleReport);
+BENCHMARK(BM_RpcMetricsRecord);
+BENCHMARK(BM_SerializeOpenMetrics)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CachedOpenMetrics)->Arg(0)->Arg(60000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ReportDuringScrape)->Arg(0)->Arg(1000)->UseRealTime();
+
+BENCHMARK_MAIN();
+#endif
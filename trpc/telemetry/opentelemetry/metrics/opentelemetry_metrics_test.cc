@@ -189,5 +189,40 @@ TEST_F(OpenTelemetryMetricsTest, MultiAttrReport) {
   ASSERT_NE(0, metrics_->MultiAttrReport(std::move(max_info)));
 }
 
+TEST_F(OpenTelemetryMetricsTest, CollectOpenMetrics) {
+  trpc::opentelemetry::ExemplarContext exemplar;
+  exemplar.trace_id.fill(0xab);
+  exemplar.span_id.fill(0xcd);
+  metrics_->ReportServerHandledSeconds({{"exemplar_key", "exemplar_value"}}, 1000, &exemplar);
+
+  std::string out;
+  ASSERT_EQ(0, metrics_->CollectOpenMetrics(out));
+  ASSERT_NE(std::string::npos, out.find("# TYPE rpc_server_handled_seconds histogram"));
+  ASSERT_NE(std::string::npos, out.find("span_id=\"cdcdcdcdcdcdcdcd\""));
+  ASSERT_EQ(0, out.compare(out.size() - 6, 6, "# EOF\n"));
+
+  // the text is serialized again as collect_min_interval is 0
+  auto text = metrics_->CollectOpenMetrics();
+  metrics_->ReportServerHandledSeconds({{"exemplar_key", "new_exemplar_value"}}, 1000);
+  auto new_text = metrics_->CollectOpenMetrics();
+  ASSERT_EQ(std::string::npos, text->find("new_exemplar_value"));
+  ASSERT_NE(std::string::npos, new_text->find("new_exemplar_value"));
+}
+
+TEST_F(OpenTelemetryMetricsTest, ServerSlo) {
+  ASSERT_TRUE(metrics_->HasSlo());
+  ASSERT_EQ(nullptr, metrics_->GetSlo("unknown_slo"));
+  auto slo = metrics_->GetSlo("test_slo");
+  ASSERT_NE(nullptr, slo);
+  ASSERT_EQ("ser1", slo->GetObjective().service);
+  ASSERT_EQ(std::vector<uint32_t>({60, 300}), slo->GetWindows());
+
+  // the rpcs of the other methods are not counted
+  metrics_->ReportServerSlo("ser1", "method1", 10, true);
+  metrics_->ReportServerSlo("ser1", "method1", 1000, true);
+  metrics_->ReportServerSlo("ser1", "method2", 1000, false);
+  ASSERT_EQ(0, slo->GetBurnRate(60));
+}
+
 }  // namespace trpc::testing
 #endif
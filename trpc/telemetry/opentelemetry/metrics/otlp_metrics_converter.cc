@@ -0,0 +1,324 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
+#include "trpc/telemetry/opentelemetry/metrics/otlp_metrics_converter.h"
+
+#include <utility>
+
+namespace trpc::opentelemetry {
+
+namespace {
+
+using ::opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceRequest;
+namespace otlp_common = ::opentelemetry::proto::common::v1;
+namespace otlp_metrics = ::opentelemetry::proto::metrics::v1;
+
+constexpr char kScopeName[] = "trpc.opentelemetry.metrics";
+
+void AddAttribute(const std::string& key, const std::string& value,
+                  ::google::protobuf::RepeatedPtrField<otlp_common::KeyValue>* attributes) {
+  auto* attribute = attributes->Add();
+  attribute->set_key(key);
+  attribute->mutable_value()->set_string_value(value);
+}
+
+void AddAttributes(const ::prometheus::ClientMetric& metric,
+                   ::google::protobuf::RepeatedPtrField<otlp_common::KeyValue>* attributes) {
+  attributes->Reserve(metric.label.size());
+  for (const auto& label : metric.label) {
+    AddAttribute(label.name, label.value, attributes);
+  }
+}
+
+const BucketExemplars* FindExemplars(const std::map<std::map<std::string, std::string>, BucketExemplars>* series,
+                                     const ::prometheus::ClientMetric& metric) {
+  if (!series) {
+    return nullptr;
+  }
+  std::map<std::string, std::string> labels;
+  for (const auto& label : metric.label) {
+    labels.emplace(label.name, label.value);
+  }
+  auto it = series->find(labels);
+  return it != series->end() ? &it->second : nullptr;
+}
+
+}  // namespace
+
+// Appends the data points into the requests, and starts a new request when the current one is full. The metric of a
+// family is split into one metric in each request it spans.
+class OtlpMetricsConverter::RequestBuilder {
+ public:
+  RequestBuilder(const Options& options, std::vector<ExportMetricsServiceRequest>& requests)
+      : options_(options), requests_(requests) {}
+
+  void StartFamily(const ::prometheus::MetricFamily& family) {
+    family_ = &family;
+    metric_ = nullptr;
+  }
+
+  // Gets the metric to which the next data point of the family is added
+  otlp_metrics::Metric* NextPoint() {
+    if (options_.batch_size > 0 && points_ >= options_.batch_size) {
+      scope_metrics_ = nullptr;
+      metric_ = nullptr;
+    }
+    if (!scope_metrics_) {
+      NewRequest();
+    }
+    if (!metric_) {
+      NewMetric();
+    }
+    ++points_;
+    return metric_;
+  }
+
+ private:
+  void NewRequest() {
+    auto* resource_metrics = requests_.emplace_back().add_resource_metrics();
+    auto* attributes = resource_metrics->mutable_resource()->mutable_attributes();
+    for (const auto& [key, value] : options_.resources) {
+      AddAttribute(key, value, attributes);
+    }
+    scope_metrics_ = resource_metrics->add_scope_metrics();
+    scope_metrics_->mutable_scope()->set_name(kScopeName);
+    points_ = 0;
+  }
+
+  void NewMetric() {
+    metric_ = scope_metrics_->add_metrics();
+    metric_->set_name(family_->name);
+    metric_->set_description(family_->help);
+    auto temporality = options_.delta_temporality ? otlp_metrics::AGGREGATION_TEMPORALITY_DELTA
+                                                  : otlp_metrics::AGGREGATION_TEMPORALITY_CUMULATIVE;
+    switch (family_->type) {
+      case ::prometheus::MetricType::Counter:
+        metric_->mutable_sum()->set_aggregation_temporality(temporality);
+        metric_->mutable_sum()->set_is_monotonic(true);
+        break;
+      case ::prometheus::MetricType::Histogram:
+        metric_->mutable_histogram()->set_aggregation_temporality(temporality);
+        break;
+      case ::prometheus::MetricType::Summary:
+        // the summaries of OTLP are always cumulative
+        metric_->mutable_summary();
+        break;
+      default:
+        metric_->mutable_gauge();
+        break;
+    }
+  }
+
+ private:
+  const Options& options_;
+  std::vector<ExportMetricsServiceRequest>& requests_;
+  const ::prometheus::MetricFamily* family_ = nullptr;
+  otlp_metrics::ScopeMetrics* scope_metrics_ = nullptr;
+  otlp_metrics::Metric* metric_ = nullptr;
+  uint32_t points_ = 0;
+};
+
+OtlpMetricsConverter::OtlpMetricsConverter(Options options, uint64_t start_time_ns)
+    : options_(std::move(options)), start_time_ns_(start_time_ns), last_time_ns_(start_time_ns) {}
+
+std::vector<ExportMetricsServiceRequest> OtlpMetricsConverter::Convert(
+    const std::vector<::prometheus::MetricFamily>& families, const ExemplarSnapshot& exemplars, uint64_t now_ns) {
+  ++generation_;
+  std::vector<ExportMetricsServiceRequest> requests;
+  RequestBuilder builder(options_, requests);
+  for (const auto& family : families) {
+    builder.StartFamily(family);
+    const std::map<std::map<std::string, std::string>, BucketExemplars>* family_exemplars = nullptr;
+    if (family.type == ::prometheus::MetricType::Histogram) {
+      auto it = exemplars.find(family.name);
+      if (it != exemplars.end()) {
+        family_exemplars = &it->second;
+      }
+    }
+
+    for (const auto& metric : family.metric) {
+      switch (family.type) {
+        case ::prometheus::MetricType::Counter:
+          ConvertCounter(family, metric, now_ns, builder);
+          break;
+        case ::prometheus::MetricType::Histogram:
+          ConvertHistogram(family, metric, FindExemplars(family_exemplars, metric), now_ns, builder);
+          break;
+        case ::prometheus::MetricType::Summary:
+          ConvertSummary(family, metric, now_ns, builder);
+          break;
+        default: {
+          auto* point = builder.NextPoint()->mutable_gauge()->add_data_points();
+          AddAttributes(metric, point->mutable_attributes());
+          point->set_time_unix_nano(now_ns);
+          point->set_as_double(family.type == ::prometheus::MetricType::Gauge ? metric.gauge.value
+                                                                               : metric.untyped.value);
+          break;
+        }
+      }
+    }
+  }
+
+  // removes the states of the series which have been evicted from the registry
+  for (auto it = states_.begin(); it != states_.end();) {
+    if (it->second.generation != generation_) {
+      it = states_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  last_time_ns_ = now_ns;
+  return requests;
+}
+
+void OtlpMetricsConverter::ConvertCounter(const ::prometheus::MetricFamily& family,
+                                          const ::prometheus::ClientMetric& metric, uint64_t now_ns,
+                                          RequestBuilder& builder) {
+  bool is_new = false;
+  SeriesState& state = GetState(family, metric, is_new);
+  double value = metric.counter.value;
+  if (!is_new && value < state.counter_value) {
+    // the series has been evicted and recreated since the previous conversion
+    state.counter_value = 0;
+    state.start_time_ns = last_time_ns_;
+  }
+  double delta = value - state.counter_value;
+  uint64_t start_time_ns = GetStartTime(state);
+  state.counter_value = value;
+  if (options_.delta_temporality && !is_new && delta == 0) {
+    return;
+  }
+
+  auto* point = builder.NextPoint()->mutable_sum()->add_data_points();
+  AddAttributes(metric, point->mutable_attributes());
+  point->set_start_time_unix_nano(start_time_ns);
+  point->set_time_unix_nano(now_ns);
+  point->set_as_double(options_.delta_temporality ? delta : value);
+}
+
+void OtlpMetricsConverter::ConvertHistogram(const ::prometheus::MetricFamily& family,
+                                            const ::prometheus::ClientMetric& metric, const BucketExemplars* exemplars,
+                                            uint64_t now_ns, RequestBuilder& builder) {
+  const auto& buckets = metric.histogram.bucket;
+  bool is_new = false;
+  SeriesState& state = GetState(family, metric, is_new);
+  if (!is_new &&
+      (metric.histogram.sample_count < state.sample_count || buckets.size() != state.cumulative_counts.size())) {
+    // the series has been evicted and recreated since the previous conversion
+    state.sample_count = 0;
+    state.sample_sum = 0;
+    state.cumulative_counts.clear();
+    state.start_time_ns = last_time_ns_;
+  }
+  state.cumulative_counts.resize(buckets.size(), 0);
+  uint64_t start_time_ns = GetStartTime(state);
+  if (options_.delta_temporality && !is_new && metric.histogram.sample_count == state.sample_count) {
+    return;
+  }
+
+  auto* point = builder.NextPoint()->mutable_histogram()->add_data_points();
+  AddAttributes(metric, point->mutable_attributes());
+  point->set_start_time_unix_nano(start_time_ns);
+  point->set_time_unix_nano(now_ns);
+  if (options_.delta_temporality) {
+    point->set_count(metric.histogram.sample_count - state.sample_count);
+    point->set_sum(metric.histogram.sample_sum - state.sample_sum);
+  } else {
+    point->set_count(metric.histogram.sample_count);
+    point->set_sum(metric.histogram.sample_sum);
+  }
+
+  // the buckets of prometheus are cumulative and end with +Inf, while the buckets of OTLP are not cumulative and the
+  // +Inf bound is implied
+  point->mutable_bucket_counts()->Reserve(buckets.size());
+  point->mutable_explicit_bounds()->Reserve(buckets.size());
+  uint64_t previous_count = 0;
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    uint64_t count = buckets[i].cumulative_count;
+    if (options_.delta_temporality) {
+      count -= state.cumulative_counts[i];
+    }
+    point->add_bucket_counts(count - previous_count);
+    previous_count = count;
+    if (i + 1 < buckets.size()) {
+      point->add_explicit_bounds(buckets[i].upper_bound);
+    }
+    state.cumulative_counts[i] = buckets[i].cumulative_count;
+  }
+  state.sample_count = metric.histogram.sample_count;
+  state.sample_sum = metric.histogram.sample_sum;
+
+  if (!exemplars) {
+    return;
+  }
+  for (const auto& exemplar : *exemplars) {
+    // the exemplars exported by the previous conversions are skipped
+    if (!exemplar || exemplar->timestamp_ms * 1000000 <= last_time_ns_) {
+      continue;
+    }
+    auto* otlp_exemplar = point->add_exemplars();
+    otlp_exemplar->set_time_unix_nano(exemplar->timestamp_ms * 1000000);
+    otlp_exemplar->set_as_double(exemplar->value);
+    otlp_exemplar->set_trace_id(exemplar->context.trace_id.data(), exemplar->context.trace_id.size());
+    otlp_exemplar->set_span_id(exemplar->context.span_id.data(), exemplar->context.span_id.size());
+  }
+}
+
+void OtlpMetricsConverter::ConvertSummary(const ::prometheus::MetricFamily& family,
+                                          const ::prometheus::ClientMetric& metric, uint64_t now_ns,
+                                          RequestBuilder& builder) {
+  bool is_new = false;
+  SeriesState& state = GetState(family, metric, is_new);
+  if (!is_new && metric.summary.sample_count < state.sample_count) {
+    state.start_time_ns = last_time_ns_;
+  }
+  state.sample_count = metric.summary.sample_count;
+
+  auto* point = builder.NextPoint()->mutable_summary()->add_data_points();
+  AddAttributes(metric, point->mutable_attributes());
+  point->set_start_time_unix_nano(state.start_time_ns);
+  point->set_time_unix_nano(now_ns);
+  point->set_count(metric.summary.sample_count);
+  point->set_sum(metric.summary.sample_sum);
+  for (const auto& quantile : metric.summary.quantile) {
+    auto* value = point->add_quantile_values();
+    value->set_quantile(quantile.quantile);
+    value->set_value(quantile.value);
+  }
+}
+
+OtlpMetricsConverter::SeriesState& OtlpMetricsConverter::GetState(const ::prometheus::MetricFamily& family,
+                                                                  const ::prometheus::ClientMetric& metric,
+                                                                  bool& is_new) {
+  // the labels are sorted by name in prometheus, so they identify the series in a fixed order
+  key_buffer_.assign(family.name);
+  for (const auto& label : metric.label) {
+    key_buffer_.push_back('\0');
+    key_buffer_.append(label.name);
+    key_buffer_.push_back('\0');
+    key_buffer_.append(label.value);
+  }
+
+  auto [it, inserted] = states_.try_emplace(key_buffer_);
+  is_new = inserted;
+  if (inserted) {
+    // the series existing at the first conversion are counted from the start time
+    it->second.start_time_ns = generation_ == 1 ? start_time_ns_ : last_time_ns_;
+  }
+  it->second.generation = generation_;
+  return it->second;
+}
+
+}  // namespace trpc::opentelemetry
+#endif
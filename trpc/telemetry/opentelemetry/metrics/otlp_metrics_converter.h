@@ -0,0 +1,110 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "opentelemetry/proto/collector/metrics/v1/metrics_service.pb.h"
+#include "prometheus/metric_family.h"
+
+#include "trpc/telemetry/opentelemetry/metrics/open_metrics_serializer.h"
+
+namespace trpc::opentelemetry {
+
+/// @brief Converts the metric families collected from the prometheus registry into OTLP export requests.
+/// @note It keeps the values of the previous conversion to compute the deltas, so it is not thread-safe and should be
+///       used by the exporting thread only.
+class OtlpMetricsConverter {
+ public:
+  struct Options {
+    /// whether to convert the counters and histograms into the deltas since the previous conversion, otherwise they
+    /// are converted with cumulative temporality
+    bool delta_temporality = true;
+    /// the maximum number of data points in each request, 0 means unlimited
+    uint32_t batch_size = 1000;
+    /// the attributes of the resource which reports the metrics
+    std::map<std::string, std::string> resources;
+  };
+
+  /// @param options conversion options
+  /// @param start_time_ns the start time of the cumulative series, in nanoseconds since epoch
+  OtlpMetricsConverter(Options options, uint64_t start_time_ns);
+
+  /// @brief Converts the metric families into export requests.
+  /// @param families the metric families collected from the prometheus registry
+  /// @param exemplars the exemplars of the histogram series, only the ones recorded after the previous conversion are
+  ///        attached
+  /// @param now_ns the time of the collection, in nanoseconds since epoch
+  /// @return Return the requests, each of which contains at most batch_size data points. With delta temporality, the
+  ///         counters and histograms which have not changed since the previous conversion are skipped.
+  std::vector<::opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceRequest> Convert(
+      const std::vector<::prometheus::MetricFamily>& families, const ExemplarSnapshot& exemplars, uint64_t now_ns);
+
+ private:
+  // The values of a series at the previous conversion
+  struct SeriesState {
+    double counter_value = 0;
+    uint64_t sample_count = 0;
+    double sample_sum = 0;
+    std::vector<uint64_t> cumulative_counts;
+    // the start time of the cumulative values, which is moved forward when the series is reset
+    uint64_t start_time_ns = 0;
+    uint64_t generation = 0;
+  };
+
+  class RequestBuilder;
+
+  void ConvertCounter(const ::prometheus::MetricFamily& family, const ::prometheus::ClientMetric& metric,
+                      uint64_t now_ns, RequestBuilder& builder);
+
+  void ConvertHistogram(const ::prometheus::MetricFamily& family, const ::prometheus::ClientMetric& metric,
+                        const BucketExemplars* exemplars, uint64_t now_ns, RequestBuilder& builder);
+
+  void ConvertSummary(const ::prometheus::MetricFamily& family, const ::prometheus::ClientMetric& metric,
+                      uint64_t now_ns, RequestBuilder& builder);
+
+  // Gets the state of the series and marks it as alive in this conversion, whether the state is new is returned
+  SeriesState& GetState(const ::prometheus::MetricFamily& family, const ::prometheus::ClientMetric& metric,
+                        bool& is_new);
+
+  // Gets the start time of the data points of the series
+  uint64_t GetStartTime(const SeriesState& state) const {
+    return options_.delta_temporality ? last_time_ns_ : state.start_time_ns;
+  }
+
+ private:
+  const Options options_;
+
+  const uint64_t start_time_ns_;
+
+  // the time of the previous conversion
+  uint64_t last_time_ns_;
+
+  // the number of conversions, used to remove the states of the series which no longer exist
+  uint64_t generation_ = 0;
+
+  // key: the family name and the labels of the series
+  std::unordered_map<std::string, SeriesState> states_;
+
+  // the buffer used to build the key of the series
+  std::string key_buffer_;
+};
+
+}  // namespace trpc::opentelemetry
+#endif
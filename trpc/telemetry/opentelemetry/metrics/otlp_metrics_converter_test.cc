@@ -0,0 +1,172 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
+#include "trpc/telemetry/opentelemetry/metrics/otlp_metrics_converter.h"
+
+#include <limits>
+
+#include "gtest/gtest.h"
+
+namespace trpc::testing {
+
+namespace {
+
+::prometheus::MetricFamily CounterFamily(const std::string& value, double counter) {
+  ::prometheus::MetricFamily family;
+  family.name = "test_counter_total";
+  family.help = "test counter";
+  family.type = ::prometheus::MetricType::Counter;
+  family.metric.resize(1);
+  family.metric[0].label.push_back({"key", value});
+  family.metric[0].counter.value = counter;
+  return family;
+}
+
+::prometheus::MetricFamily HistogramFamily(uint64_t first_bucket, uint64_t count, double sum) {
+  ::prometheus::MetricFamily family;
+  family.name = "test_histogram";
+  family.type = ::prometheus::MetricType::Histogram;
+  family.metric.resize(1);
+  family.metric[0].label.push_back({"key", "value"});
+  family.metric[0].histogram.sample_count = count;
+  family.metric[0].histogram.sample_sum = sum;
+  family.metric[0].histogram.bucket.resize(2);
+  family.metric[0].histogram.bucket[0].upper_bound = 0.1;
+  family.metric[0].histogram.bucket[0].cumulative_count = first_bucket;
+  family.metric[0].histogram.bucket[1].upper_bound = std::numeric_limits<double>::infinity();
+  family.metric[0].histogram.bucket[1].cumulative_count = count;
+  return family;
+}
+
+const ::opentelemetry::proto::metrics::v1::Metric& FirstMetric(
+    const ::opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceRequest& request) {
+  return request.resource_metrics(0).scope_metrics(0).metrics(0);
+}
+
+}  // namespace
+
+TEST(OtlpMetricsConverterTest, DeltaCounter) {
+  trpc::opentelemetry::OtlpMetricsConverter::Options options;
+  options.resources["service.name"] = "test.server";
+  trpc::opentelemetry::OtlpMetricsConverter converter(options, 1000);
+
+  auto requests = converter.Convert({CounterFamily("value", 3)}, {}, 2000);
+  ASSERT_EQ(1, requests.size());
+  ASSERT_EQ("service.name", requests[0].resource_metrics(0).resource().attributes(0).key());
+  const auto& metric = FirstMetric(requests[0]);
+  ASSERT_EQ("test_counter_total", metric.name());
+  ASSERT_EQ(::opentelemetry::proto::metrics::v1::AGGREGATION_TEMPORALITY_DELTA,
+            metric.sum().aggregation_temporality());
+  ASSERT_TRUE(metric.sum().is_monotonic());
+  ASSERT_EQ(3, metric.sum().data_points(0).as_double());
+  ASSERT_EQ(1000, metric.sum().data_points(0).start_time_unix_nano());
+  ASSERT_EQ(2000, metric.sum().data_points(0).time_unix_nano());
+  ASSERT_EQ("key", metric.sum().data_points(0).attributes(0).key());
+  ASSERT_EQ("value", metric.sum().data_points(0).attributes(0).value().string_value());
+
+  // the unchanged series are skipped
+  requests = converter.Convert({CounterFamily("value", 3)}, {}, 3000);
+  ASSERT_TRUE(requests.empty());
+
+  requests = converter.Convert({CounterFamily("value", 5)}, {}, 4000);
+  ASSERT_EQ(2, FirstMetric(requests[0]).sum().data_points(0).as_double());
+  ASSERT_EQ(3000, FirstMetric(requests[0]).sum().data_points(0).start_time_unix_nano());
+
+  // the series recreated after eviction starts from zero
+  requests = converter.Convert({CounterFamily("value", 1)}, {}, 5000);
+  ASSERT_EQ(1, FirstMetric(requests[0]).sum().data_points(0).as_double());
+}
+
+TEST(OtlpMetricsConverterTest, CumulativeCounter) {
+  trpc::opentelemetry::OtlpMetricsConverter::Options options;
+  options.delta_temporality = false;
+  trpc::opentelemetry::OtlpMetricsConverter converter(options, 1000);
+
+  converter.Convert({CounterFamily("value", 3)}, {}, 2000);
+  auto requests = converter.Convert({CounterFamily("value", 3)}, {}, 3000);
+  const auto& metric = FirstMetric(requests[0]);
+  ASSERT_EQ(::opentelemetry::proto::metrics::v1::AGGREGATION_TEMPORALITY_CUMULATIVE,
+            metric.sum().aggregation_temporality());
+  ASSERT_EQ(3, metric.sum().data_points(0).as_double());
+  ASSERT_EQ(1000, metric.sum().data_points(0).start_time_unix_nano());
+
+  // the start time of the recreated series is moved forward
+  requests = converter.Convert({CounterFamily("value", 1)}, {}, 4000);
+  ASSERT_EQ(1, FirstMetric(requests[0]).sum().data_points(0).as_double());
+  ASSERT_EQ(3000, FirstMetric(requests[0]).sum().data_points(0).start_time_unix_nano());
+}
+
+TEST(OtlpMetricsConverterTest, DeltaHistogram) {
+  trpc::opentelemetry::OtlpMetricsConverter converter({}, 1000);
+
+  trpc::opentelemetry::Exemplar exemplar;
+  exemplar.context.trace_id.fill(0xab);
+  exemplar.context.span_id.fill(0xcd);
+  exemplar.value = 0.5;
+  exemplar.timestamp_ms = 1;
+  trpc::opentelemetry::ExemplarSnapshot exemplars;
+  exemplars["test_histogram"][{{"key", "value"}}] = {std::nullopt, exemplar};
+
+  auto requests = converter.Convert({HistogramFamily(1, 2, 0.55)}, exemplars, 2000000);
+  const auto& point = FirstMetric(requests[0]).histogram().data_points(0);
+  ASSERT_EQ(2, point.count());
+  ASSERT_EQ(0.55, point.sum());
+  ASSERT_EQ(1, point.explicit_bounds_size());
+  ASSERT_EQ(0.1, point.explicit_bounds(0));
+  ASSERT_EQ(2, point.bucket_counts_size());
+  ASSERT_EQ(1, point.bucket_counts(0));
+  ASSERT_EQ(1, point.bucket_counts(1));
+  ASSERT_EQ(1, point.exemplars_size());
+  ASSERT_EQ(0.5, point.exemplars(0).as_double());
+  ASSERT_EQ(std::string(16, '\xab'), point.exemplars(0).trace_id());
+  ASSERT_EQ(std::string(8, '\xcd'), point.exemplars(0).span_id());
+
+  requests = converter.Convert({HistogramFamily(1, 5, 1)}, exemplars, 3000000);
+  const auto& delta_point = FirstMetric(requests[0]).histogram().data_points(0);
+  ASSERT_EQ(3, delta_point.count());
+  ASSERT_EQ(0, delta_point.bucket_counts(0));
+  ASSERT_EQ(3, delta_point.bucket_counts(1));
+  // the exemplar has been exported
+  ASSERT_EQ(0, delta_point.exemplars_size());
+}
+
+TEST(OtlpMetricsConverterTest, Batch) {
+  trpc::opentelemetry::OtlpMetricsConverter::Options options;
+  options.batch_size = 2;
+  trpc::opentelemetry::OtlpMetricsConverter converter(options, 0);
+
+  auto family = CounterFamily("value1", 1);
+  family.metric.resize(3, family.metric[0]);
+  family.metric[1].label[0].value = "value2";
+  family.metric[2].label[0].value = "value3";
+  ::prometheus::MetricFamily gauge_family;
+  gauge_family.name = "test_gauge";
+  gauge_family.type = ::prometheus::MetricType::Gauge;
+  gauge_family.metric.resize(1);
+  gauge_family.metric[0].gauge.value = 10;
+
+  auto requests = converter.Convert({family, gauge_family}, {}, 1000);
+  ASSERT_EQ(2, requests.size());
+  ASSERT_EQ(2, FirstMetric(requests[0]).sum().data_points_size());
+  // the family is split into the next request
+  const auto& scope_metrics = requests[1].resource_metrics(0).scope_metrics(0);
+  ASSERT_EQ(2, scope_metrics.metrics_size());
+  ASSERT_EQ("test_counter_total", scope_metrics.metrics(0).name());
+  ASSERT_EQ(1, scope_metrics.metrics(0).sum().data_points_size());
+  ASSERT_EQ("test_gauge", scope_metrics.metrics(1).name());
+  ASSERT_EQ(10, scope_metrics.metrics(1).gauge().data_points(0).as_double());
+}
+
+}  // namespace trpc::testing
+#endif
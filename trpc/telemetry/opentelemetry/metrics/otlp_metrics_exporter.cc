@@ -0,0 +1,90 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#include "trpc/telemetry/opentelemetry/metrics/otlp_metrics_exporter.h"
+
+#include <utility>
+
+#include "trpc/client/make_client_context.h"
+#include "trpc/client/trpc_client.h"
+#include "trpc/util/log/logging.h"
+
+namespace trpc::opentelemetry {
+
+namespace {
+
+constexpr char kContentTypeHeader[] = "Content-Type";
+constexpr char kProtobufContentType[] = "application/x-protobuf";
+
+}  // namespace
+
+GrpcMetricsExporter::GrpcMetricsExporter(const ServiceProxyOption& options) {
+  metrics_service_proxy_ =
+      GetTrpcClient()->GetProxy<::opentelemetry::proto::collector::metrics::v1::MetricsServiceServiceProxy>(
+          options.name, &options);
+  TRPC_ASSERT(metrics_service_proxy_);
+}
+
+GrpcMetricsExporter::GrpcMetricsExporter(
+    std::shared_ptr<::opentelemetry::proto::collector::metrics::v1::MetricsServiceServiceProxy> proxy)
+    : metrics_service_proxy_(std::move(proxy)) {
+  TRPC_ASSERT(metrics_service_proxy_);
+}
+
+bool GrpcMetricsExporter::Export(
+    const ::opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceRequest& request) {
+  ClientContextPtr client_context = trpc::MakeClientContext(metrics_service_proxy_);
+
+  ::opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceResponse response;
+
+  ::trpc::Status status = metrics_service_proxy_->Export(client_context, request, &response);
+
+  if (!status.OK()) {
+    TRPC_LOG_ERROR("[OpenTelemetry METRICS GRPC Exporter] Export() failed: " << status.ToString());
+    return false;
+  }
+  return true;
+}
+
+HttpMetricsExporter::HttpMetricsExporter(const ServiceProxyOption& options, std::string url) : url_(std::move(url)) {
+  http_proxy_ = GetTrpcClient()->GetProxy<http::HttpServiceProxy>(options.name, &options);
+  TRPC_ASSERT(http_proxy_);
+}
+
+HttpMetricsExporter::HttpMetricsExporter(std::shared_ptr<http::HttpServiceProxy> proxy, std::string url)
+    : http_proxy_(std::move(proxy)), url_(std::move(url)) {
+  TRPC_ASSERT(http_proxy_);
+}
+
+bool HttpMetricsExporter::Export(
+    const ::opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceRequest& request) {
+  std::string body;
+  if (!request.SerializeToString(&body)) {
+    TRPC_LOG_ERROR("[OpenTelemetry METRICS HTTP Exporter] serialize request failed");
+    return false;
+  }
+
+  ClientContextPtr client_context = trpc::MakeClientContext(http_proxy_);
+  client_context->SetHttpHeader(kContentTypeHeader, kProtobufContentType);
+
+  std::string response;
+  ::trpc::Status status = http_proxy_->Post(client_context, url_, std::move(body), &response);
+
+  if (!status.OK()) {
+    TRPC_LOG_ERROR("[OpenTelemetry METRICS HTTP Exporter] Export() failed: " << status.ToString());
+    return false;
+  }
+  return true;
+}
+
+}  // namespace trpc::opentelemetry
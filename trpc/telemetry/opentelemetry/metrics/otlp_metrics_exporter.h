@@ -0,0 +1,67 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "opentelemetry/proto/collector/metrics/v1/metrics_service.pb.h"
+#include "trpc/client/http/http_service_proxy.h"
+#include "trpc/client/service_proxy_option.h"
+#include "trpc/telemetry/opentelemetry/metrics/metrics_service.trpc.pb.h"
+
+namespace trpc::opentelemetry {
+
+/// @brief The exporter which sends the OTLP metrics to the collector.
+class OtlpMetricsExporter {
+ public:
+  virtual ~OtlpMetricsExporter() = default;
+
+  /// @brief Sends the request to the collector synchronously.
+  /// @return Return true on success.
+  virtual bool Export(const ::opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceRequest& request) = 0;
+};
+
+/// @brief Metrics exporter based on the trpc framework that uses the gRPC protocol for reporting.
+class GrpcMetricsExporter final : public OtlpMetricsExporter {
+ public:
+  explicit GrpcMetricsExporter(const ServiceProxyOption& options);
+
+  explicit GrpcMetricsExporter(
+      std::shared_ptr<::opentelemetry::proto::collector::metrics::v1::MetricsServiceServiceProxy> proxy);
+
+  bool Export(const ::opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceRequest& request) override;
+
+ private:
+  std::shared_ptr<::opentelemetry::proto::collector::metrics::v1::MetricsServiceServiceProxy> metrics_service_proxy_;
+};
+
+/// @brief Metrics exporter based on the trpc framework that posts the protobuf encoded metrics over HTTP.
+class HttpMetricsExporter final : public OtlpMetricsExporter {
+ public:
+  /// @param options the options of the http proxy, whose target is the address of the collector
+  /// @param url the url of the metrics endpoint of the collector, such as "http://127.0.0.1:4318/v1/metrics"
+  HttpMetricsExporter(const ServiceProxyOption& options, std::string url);
+
+  HttpMetricsExporter(std::shared_ptr<http::HttpServiceProxy> proxy, std::string url);
+
+  bool Export(const ::opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceRequest& request) override;
+
+ private:
+  std::shared_ptr<http::HttpServiceProxy> http_proxy_;
+
+  const std::string url_;
+};
+
+}  // namespace trpc::opentelemetry
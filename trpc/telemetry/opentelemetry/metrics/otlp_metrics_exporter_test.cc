@@ -0,0 +1,63 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#include "trpc/telemetry/opentelemetry/metrics/otlp_metrics_exporter.h"
+
+#include "gtest/gtest.h"
+#include "trpc/client/testing/service_proxy_testing.h"
+#include "trpc/client/trpc_client.h"
+
+#include "trpc/telemetry/opentelemetry/metrics/common.h"
+#include "trpc/telemetry/opentelemetry/metrics/metrics_service.trpc.pb.mock.h"
+
+namespace trpc::testing {
+
+class GrpcMetricsExporterTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase() { RegisterPlugins(); }
+  static void TearDownTestCase() {
+    trpc::GetTrpcClient()->Stop();
+    UnregisterPlugins();
+    trpc::GetTrpcClient()->Destroy();
+  }
+};
+
+TEST_F(GrpcMetricsExporterTest, Export) {
+  ServiceProxyOption options;
+  options.codec_name = "grpc";
+  options.selector_name = "direct";
+  options.target = "127.0.0.1:8888";
+  options.threadmodel_type_name = kSeparate;
+  options.threadmodel_instance_name = kSeparateAdminInstance;
+  auto mock_proxy =
+      trpc::GetTrpcClient()->GetProxy<::opentelemetry::proto::collector::metrics::v1::MockMetricsServiceServiceProxy>(
+          trpc::opentelemetry::kGrpcMetricsExporterServiceName, &options);
+  auto exporter = std::make_shared<trpc::opentelemetry::GrpcMetricsExporter>(mock_proxy);
+
+  ::opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceRequest request;
+  request.add_resource_metrics()->add_scope_metrics()->add_metrics()->set_name("test_metric");
+
+  // 1. exports success
+  EXPECT_CALL(*mock_proxy, Export(::testing::_, ::testing::_, ::testing::_))
+      .Times(::testing::Exactly(1))
+      .WillOnce(::testing::Return(::trpc::kSuccStatus));
+  ASSERT_TRUE(exporter->Export(request));
+
+  // 2. exports failed
+  EXPECT_CALL(*mock_proxy, Export(::testing::_, ::testing::_, ::testing::_))
+      .Times(::testing::Exactly(1))
+      .WillOnce(::testing::Return(::trpc::Status(-1, "")));
+  ASSERT_FALSE(exporter->Export(request));
+}
+
+}  // namespace trpc::testing
@@ -0,0 +1,274 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
+#include "trpc/telemetry/opentelemetry/metrics/peer_metrics.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <unordered_set>
+#include <utility>
+
+#include "trpc/telemetry/opentelemetry/metrics/common.h"
+
+namespace trpc::opentelemetry {
+
+namespace {
+
+// the number of the estimated counts of the peers which are not tracked for each tracked peer
+constexpr size_t kCandidatesPerPeer = 4;
+
+}  // namespace
+
+PeerMetrics::Stats::Stats(size_t bucket_num)
+    : bucket_counts(std::make_unique<std::atomic<uint64_t>[]>(bucket_num)), bucket_num(bucket_num) {
+  for (size_t i = 0; i < bucket_num; ++i) {
+    bucket_counts[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void PeerMetrics::Stats::Add(size_t bucket_index, uint64_t cost_us, bool failed_call) {
+  bucket_counts[bucket_index].fetch_add(1, std::memory_order_relaxed);
+  sum_us.fetch_add(cost_us, std::memory_order_relaxed);
+  if (failed_call) {
+    failed.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void PeerMetrics::Stats::MoveTo(Stats& other) {
+  for (size_t i = 0; i < bucket_num; ++i) {
+    other.bucket_counts[i].fetch_add(bucket_counts[i].exchange(0, std::memory_order_relaxed),
+                                     std::memory_order_relaxed);
+  }
+  other.sum_us.fetch_add(sum_us.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+  other.failed.fetch_add(failed.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+PeerMetrics::PeerMetrics(::prometheus::Family<::prometheus::Histogram>* seconds_family,
+                         ::prometheus::Family<::prometheus::Counter>* failed_family, size_t max_peers,
+                         std::vector<double> buckets)
+    : seconds_family_(seconds_family),
+      failed_family_(failed_family),
+      max_peers_(max_peers),
+      buckets_(std::move(buckets)),
+      keys_(std::make_unique<std::atomic<uint64_t>[]>(max_peers)),
+      counts_(std::make_unique<std::atomic<uint64_t>[]>(max_peers)),
+      candidate_num_(std::max<size_t>(max_peers * kCandidatesPerPeer, 1)),
+      candidate_counts_(std::make_unique<std::atomic<uint64_t>[]>(candidate_num_)),
+      other_stats_(buckets_.size() + 1) {
+  slots_.reserve(max_peers_);
+  for (size_t i = 0; i < max_peers_; ++i) {
+    keys_[i].store(0, std::memory_order_relaxed);
+    counts_[i].store(0, std::memory_order_relaxed);
+    slots_.push_back(std::make_unique<Slot>(buckets_.size() + 1));
+  }
+  for (size_t i = 0; i < candidate_num_; ++i) {
+    candidate_counts_[i].store(0, std::memory_order_relaxed);
+  }
+  min_count_.store(MinCount(), std::memory_order_relaxed);
+
+  ::prometheus::Labels other_labels = {{kCalleeService, kOtherPeer}, {kPeerLabel, kOtherPeer}};
+  other_series_.seconds = &seconds_family_->Add(other_labels, buckets_);
+  other_series_.failed = &failed_family_->Add(other_labels);
+}
+
+void PeerMetrics::Report(std::string_view callee_service, std::string_view ip, int port, uint64_t cost_us,
+                         bool failed) {
+  uint64_t key = HashPeer(callee_service, ip, port);
+  size_t index = Find(key);
+  if (index == kNotTracked) {
+    // the peer is only tracked once its estimated count exceeds the least count of the tracked peers
+    uint64_t estimated_count =
+        candidate_counts_[key % candidate_num_].fetch_add(1, std::memory_order_relaxed) + 1;
+    if (estimated_count > min_count_.load(std::memory_order_relaxed)) {
+      index = Replace(key, estimated_count, callee_service, ip, port);
+    }
+  }
+
+  size_t bucket_index = BucketIndex(cost_us);
+  if (index == kNotTracked) {
+    other_stats_.Add(bucket_index, cost_us, failed);
+    return;
+  }
+  counts_[index].fetch_add(1, std::memory_order_relaxed);
+  slots_[index]->stats.Add(bucket_index, cost_us, failed);
+}
+
+void PeerMetrics::Sync() {
+  std::unordered_set<uint64_t> tracked_keys;
+  for (size_t i = 0; i < max_peers_; ++i) {
+    Slot& slot = *slots_[i];
+    if (slot.busy.test_and_set(std::memory_order_acquire)) {
+      // the peer is being replaced, its reports are flushed in the next sync
+      tracked_keys.insert(keys_[i].load(std::memory_order_relaxed));
+      continue;
+    }
+
+    uint64_t key = keys_[i].load(std::memory_order_relaxed);
+    if (key == 0) {
+      slot.busy.clear(std::memory_order_release);
+      continue;
+    }
+    auto it = series_.find(key);
+    if (it == series_.end()) {
+      ::prometheus::Labels labels = {{kCalleeService, slot.callee_service},
+                                     {kPeerLabel, FormatPeer(slot.ip, slot.port)}};
+      PeerSeries series{&seconds_family_->Add(labels, buckets_), &failed_family_->Add(labels)};
+      it = series_.emplace(key, series).first;
+    }
+    slot.busy.clear(std::memory_order_release);
+
+    tracked_keys.insert(key);
+    Flush(slot.stats, it->second);
+  }
+  Flush(other_stats_, other_series_);
+
+  // the series of the replaced peers are removed, so that the number of series is bounded by max_peers
+  for (auto it = series_.begin(); it != series_.end();) {
+    if (tracked_keys.count(it->first) == 0) {
+      seconds_family_->Remove(it->second.seconds);
+      failed_family_->Remove(it->second.failed);
+      it = series_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  for (size_t i = 0; i < max_peers_; ++i) {
+    Decay(counts_[i]);
+  }
+  for (size_t i = 0; i < candidate_num_; ++i) {
+    Decay(candidate_counts_[i]);
+  }
+  min_count_.store(MinCount(), std::memory_order_relaxed);
+}
+
+size_t PeerMetrics::Size() const {
+  size_t size = 0;
+  for (size_t i = 0; i < max_peers_; ++i) {
+    if (keys_[i].load(std::memory_order_relaxed) != 0) {
+      ++size;
+    }
+  }
+  return size;
+}
+
+uint64_t PeerMetrics::HashPeer(std::string_view callee_service, std::string_view ip, int port) {
+  uint64_t seed = std::hash<std::string_view>{}(callee_service);
+  seed ^= std::hash<std::string_view>{}(ip) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+  seed ^= std::hash<int>{}(port) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+  // 0 is reserved for the empty slots
+  return seed == 0 ? 1 : seed;
+}
+
+std::string PeerMetrics::FormatPeer(std::string_view ip, int port) {
+  std::string peer;
+  // ipv6 addresses are bracketed to separate them from the port
+  if (ip.find(':') != std::string_view::npos) {
+    peer.append("[").append(ip).append("]");
+  } else {
+    peer.append(ip);
+  }
+  return peer.append(":").append(std::to_string(port));
+}
+
+size_t PeerMetrics::Find(uint64_t key) const {
+  for (size_t i = 0; i < max_peers_; ++i) {
+    if (keys_[i].load(std::memory_order_relaxed) == key) {
+      return i;
+    }
+  }
+  return kNotTracked;
+}
+
+size_t PeerMetrics::Replace(uint64_t key, uint64_t estimated_count, std::string_view callee_service,
+                            std::string_view ip, int port) {
+  size_t min_index = kNotTracked;
+  uint64_t min_count = std::numeric_limits<uint64_t>::max();
+  for (size_t i = 0; i < max_peers_ && min_count != 0; ++i) {
+    uint64_t count = counts_[i].load(std::memory_order_relaxed);
+    if (count < min_count) {
+      min_index = i;
+      min_count = count;
+    }
+  }
+  if (min_index == kNotTracked || estimated_count <= min_count) {
+    return kNotTracked;
+  }
+
+  Slot& slot = *slots_[min_index];
+  if (slot.busy.test_and_set(std::memory_order_acquire)) {
+    return kNotTracked;
+  }
+  // the peer may have been tracked by another call meanwhile
+  size_t index = Find(key);
+  if (index != kNotTracked) {
+    slot.busy.clear(std::memory_order_release);
+    return index;
+  }
+  // the reports of the replaced peer which are not synced yet are aggregated into the "other" series
+  if (keys_[min_index].load(std::memory_order_relaxed) != 0) {
+    slot.stats.MoveTo(other_stats_);
+  }
+  slot.callee_service.assign(callee_service.data(), callee_service.size());
+  slot.ip.assign(ip.data(), ip.size());
+  slot.port = port;
+  // the new peer takes its estimated count, which is the upper bound of its count as the peers sharing the counter
+  // are counted together
+  counts_[min_index].store(estimated_count, std::memory_order_relaxed);
+  keys_[min_index].store(key, std::memory_order_relaxed);
+  slot.busy.clear(std::memory_order_release);
+  candidate_counts_[key % candidate_num_].store(0, std::memory_order_relaxed);
+  min_count_.store(MinCount(), std::memory_order_relaxed);
+  return min_index;
+}
+
+uint64_t PeerMetrics::MinCount() const {
+  uint64_t min_count = std::numeric_limits<uint64_t>::max();
+  for (size_t i = 0; i < max_peers_ && min_count != 0; ++i) {
+    min_count = std::min(min_count, counts_[i].load(std::memory_order_relaxed));
+  }
+  return max_peers_ == 0 ? std::numeric_limits<uint64_t>::max() : min_count;
+}
+
+void PeerMetrics::Decay(std::atomic<uint64_t>& count) {
+  // the calls counted meanwhile are not lost
+  count.fetch_sub(count.load(std::memory_order_relaxed) / 2, std::memory_order_relaxed);
+}
+
+size_t PeerMetrics::BucketIndex(uint64_t cost_us) const {
+  double seconds = static_cast<double>(cost_us) / 1000000;
+  return std::lower_bound(buckets_.begin(), buckets_.end(), seconds) - buckets_.begin();
+}
+
+void PeerMetrics::Flush(Stats& stats, const PeerSeries& series) {
+  std::vector<double> bucket_increments(stats.bucket_num);
+  bool observed = false;
+  for (size_t i = 0; i < stats.bucket_num; ++i) {
+    uint64_t count = stats.bucket_counts[i].exchange(0, std::memory_order_relaxed);
+    bucket_increments[i] = static_cast<double>(count);
+    observed = observed || count != 0;
+  }
+  uint64_t sum_us = stats.sum_us.exchange(0, std::memory_order_relaxed);
+  if (observed) {
+    series.seconds->ObserveMultiple(bucket_increments, static_cast<double>(sum_us) / 1000000);
+  }
+  uint64_t failed = stats.failed.exchange(0, std::memory_order_relaxed);
+  if (failed != 0) {
+    series.failed->Increment(static_cast<double>(failed));
+  }
+}
+
+}  // namespace trpc::opentelemetry
+#endif
@@ -0,0 +1,161 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "prometheus/counter.h"
+#include "prometheus/family.h"
+#include "prometheus/histogram.h"
+
+namespace trpc::opentelemetry {
+
+/// @brief The label of the address of the peer.
+constexpr char kPeerLabel[] = "peer";
+
+/// @brief The label value of the series into which the peers out of the top-K are aggregated.
+constexpr char kOtherPeer[] = "other";
+
+/// @brief The latency and failures of the calls to each peer of the client, whose number of series is bounded by
+///        keeping only the top-K peers by traffic. The calls to the peers which are not tracked are aggregated into the
+///        "other" series, and their counts are estimated by a small table of counters indexed by the hash of the peer.
+///        A peer replaces the tracked peer with the least count only when its estimated count exceeds that count, so
+///        the peers out of the top-K do not churn the tracked peers. The counts decay by half at every Sync, so that
+///        the peers which are no longer called give way to the new ones.
+/// @note Report is lock-free when the peer is tracked, and a call to a peer which is not tracked only increments its
+///       estimated count unless it replaces a peer. Replacing a peer only tries to acquire the slot, and the call goes
+///       to the "other" series if the slot is busy. The reports are accumulated in atomic counters, and are copied into
+///       the prometheus families by Sync, which should be called periodically by a single thread. Calls racing with
+///       the replacement of their peer may be attributed to the new peer or to "other".
+class PeerMetrics {
+ public:
+  /// @param seconds_family the histogram family of the latency of the calls, in seconds
+  /// @param failed_family the counter family of the failed calls
+  /// @param max_peers the maximum number of tracked peers
+  /// @param buckets the bucket boundaries of the latency histogram, in seconds
+  PeerMetrics(::prometheus::Family<::prometheus::Histogram>* seconds_family,
+              ::prometheus::Family<::prometheus::Counter>* failed_family, size_t max_peers,
+              std::vector<double> buckets);
+
+  PeerMetrics(const PeerMetrics&) = delete;
+  PeerMetrics& operator=(const PeerMetrics&) = delete;
+
+  /// @brief Reports a call to the peer.
+  /// @param callee_service the name of the callee service
+  /// @param ip the ip of the peer
+  /// @param port the port of the peer
+  /// @param cost_us the latency of the call, in microseconds
+  /// @param failed whether the call failed
+  void Report(std::string_view callee_service, std::string_view ip, int port, uint64_t cost_us, bool failed);
+
+  /// @brief Copies the reports accumulated since the last sync into the prometheus families, removes the series of
+  ///        the peers which are no longer tracked, and decays the counts of the peers.
+  void Sync();
+
+  /// @brief Gets the number of tracked peers.
+  size_t Size() const;
+
+ private:
+  // The reports accumulated since the last sync
+  struct Stats {
+    explicit Stats(size_t bucket_num);
+
+    void Add(size_t bucket_index, uint64_t cost_us, bool failed);
+
+    // Moves the accumulated reports into the other stats
+    void MoveTo(Stats& other);
+
+    std::unique_ptr<std::atomic<uint64_t>[]> bucket_counts;
+    size_t bucket_num;
+    std::atomic<uint64_t> sum_us{0};
+    std::atomic<uint64_t> failed{0};
+  };
+
+  struct alignas(64) Slot {
+    explicit Slot(size_t bucket_num) : stats(bucket_num) {}
+
+    // guards the labels, and serializes the replacement of the peer
+    std::atomic_flag busy = ATOMIC_FLAG_INIT;
+    // the labels are formatted by Sync when the series is added
+    std::string callee_service;
+    std::string ip;
+    int port = 0;
+    Stats stats;
+  };
+
+  // The series of a tracked peer, which is only accessed by Sync
+  struct PeerSeries {
+    ::prometheus::Histogram* seconds = nullptr;
+    ::prometheus::Counter* failed = nullptr;
+  };
+
+  static constexpr size_t kNotTracked = static_cast<size_t>(-1);
+
+  static uint64_t HashPeer(std::string_view callee_service, std::string_view ip, int port);
+
+  static std::string FormatPeer(std::string_view ip, int port);
+
+  size_t Find(uint64_t key) const;
+
+  // Replaces the tracked peer with the least count if it is less than the estimated count of the new peer
+  size_t Replace(uint64_t key, uint64_t estimated_count, std::string_view callee_service, std::string_view ip,
+                 int port);
+
+  // Gets the least count of the tracked peers, which is 0 if there is an empty slot
+  uint64_t MinCount() const;
+
+  // Halves the counts so that the recent calls weigh more
+  static void Decay(std::atomic<uint64_t>& count);
+
+  size_t BucketIndex(uint64_t cost_us) const;
+
+  // Copies the accumulated reports into the series
+  void Flush(Stats& stats, const PeerSeries& series);
+
+ private:
+  ::prometheus::Family<::prometheus::Histogram>* seconds_family_;
+  ::prometheus::Family<::prometheus::Counter>* failed_family_;
+  const size_t max_peers_;
+  const std::vector<double> buckets_;
+
+  // the keys and the estimated counts of the tracked peers are kept apart from the slots, so that looking up a peer
+  // scans contiguous memory. 0 means the slot is empty
+  std::unique_ptr<std::atomic<uint64_t>[]> keys_;
+  std::unique_ptr<std::atomic<uint64_t>[]> counts_;
+  std::vector<std::unique_ptr<Slot>> slots_;
+  // the least count of the tracked peers, which is refreshed by Sync and Replace, so that the calls to the peers
+  // which are not tracked can be compared with it without scanning the counts
+  std::atomic<uint64_t> min_count_{0};
+
+  // the estimated counts of the peers which are not tracked, indexed by the key of the peer
+  const size_t candidate_num_;
+  std::unique_ptr<std::atomic<uint64_t>[]> candidate_counts_;
+
+  Stats other_stats_;
+  PeerSeries other_series_;
+
+  // the series of the tracked peers, key: the key of the peer
+  std::unordered_map<uint64_t, PeerSeries> series_;
+};
+
+}  // namespace trpc::opentelemetry
+#endif
@@ -0,0 +1,188 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
+#include "trpc/telemetry/opentelemetry/metrics/peer_metrics.h"
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "prometheus/registry.h"
+
+#include "trpc/telemetry/opentelemetry/metrics/common.h"
+
+namespace trpc::testing {
+
+class PeerMetricsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    registry_ = std::make_shared<::prometheus::Registry>();
+    seconds_family_ = &::prometheus::BuildHistogram().Name("peer_seconds").Help("test").Register(*registry_);
+    failed_family_ = &::prometheus::BuildCounter().Name("peer_failed").Help("test").Register(*registry_);
+  }
+
+  ::prometheus::ClientMetric::Histogram CollectSeconds(const std::string& callee_service, const std::string& peer) {
+    return seconds_family_->Add({{trpc::opentelemetry::kCalleeService, callee_service},
+                                 {trpc::opentelemetry::kPeerLabel, peer}},
+                                buckets_)
+        .Collect()
+        .histogram;
+  }
+
+  double CollectFailed(const std::string& callee_service, const std::string& peer) {
+    return failed_family_
+        ->Add({{trpc::opentelemetry::kCalleeService, callee_service}, {trpc::opentelemetry::kPeerLabel, peer}})
+        .Value();
+  }
+
+  bool HasPeer(const std::string& callee_service, const std::string& peer) {
+    return seconds_family_->Has(
+        {{trpc::opentelemetry::kCalleeService, callee_service}, {trpc::opentelemetry::kPeerLabel, peer}});
+  }
+
+ protected:
+  std::shared_ptr<::prometheus::Registry> registry_;
+  ::prometheus::Family<::prometheus::Histogram>* seconds_family_;
+  ::prometheus::Family<::prometheus::Counter>* failed_family_;
+  std::vector<double> buckets_ = {0.01, 0.1};
+};
+
+TEST_F(PeerMetricsTest, Report) {
+  trpc::opentelemetry::PeerMetrics peer_metrics(seconds_family_, failed_family_, 2, buckets_);
+
+  peer_metrics.Report("service", "127.0.0.1", 8000, 5000, false);
+  peer_metrics.Report("service", "127.0.0.1", 8000, 50000, true);
+  peer_metrics.Report("service", "::1", 8000, 500000, false);
+  ASSERT_EQ(2, peer_metrics.Size());
+
+  peer_metrics.Sync();
+  auto histogram = CollectSeconds("service", "127.0.0.1:8000");
+  ASSERT_EQ(2, histogram.sample_count);
+  ASSERT_DOUBLE_EQ(0.055, histogram.sample_sum);
+  ASSERT_EQ(1, histogram.bucket[0].cumulative_count);
+  ASSERT_EQ(2, histogram.bucket[1].cumulative_count);
+  ASSERT_EQ(1, CollectFailed("service", "127.0.0.1:8000"));
+  ASSERT_EQ(1, CollectSeconds("service", "[::1]:8000").sample_count);
+
+  // the reports are only flushed once
+  peer_metrics.Sync();
+  ASSERT_EQ(2, CollectSeconds("service", "127.0.0.1:8000").sample_count);
+}
+
+TEST_F(PeerMetricsTest, TopK) {
+  trpc::opentelemetry::PeerMetrics peer_metrics(seconds_family_, failed_family_, 2, buckets_);
+
+  for (int i = 0; i < 10; ++i) {
+    peer_metrics.Report("service", "127.0.0.1", 8000, 1000, false);
+  }
+  peer_metrics.Report("service", "127.0.0.1", 8001, 1000, false);
+  peer_metrics.Sync();
+  ASSERT_TRUE(HasPeer("service", "127.0.0.1:8001"));
+
+  // the calls to the new peer go to "other" until its count exceeds the least count of the tracked peers, which is 2
+  // for 8001 after the following call
+  peer_metrics.Report("service", "127.0.0.1", 8001, 1000, true);
+  peer_metrics.Report("service", "127.0.0.1", 8002, 1000, false);
+  peer_metrics.Report("service", "127.0.0.1", 8002, 1000, false);
+  ASSERT_EQ(2, peer_metrics.Size());
+  peer_metrics.Sync();
+  ASSERT_TRUE(HasPeer("service", "127.0.0.1:8001"));
+  ASSERT_FALSE(HasPeer("service", "127.0.0.1:8002"));
+  ASSERT_EQ(2, CollectSeconds(trpc::opentelemetry::kOtherPeer, trpc::opentelemetry::kOtherPeer).sample_count);
+
+  // the new peer replaces the peer with the least count once its count exceeds it, and the unsynced reports of the
+  // replaced peer go to "other"
+  peer_metrics.Report("service", "127.0.0.1", 8001, 1000, true);
+  peer_metrics.Report("service", "127.0.0.1", 8002, 1000, false);
+  peer_metrics.Report("service", "127.0.0.1", 8002, 1000, false);
+  ASSERT_EQ(2, peer_metrics.Size());
+  peer_metrics.Sync();
+  ASSERT_TRUE(HasPeer("service", "127.0.0.1:8000"));
+  ASSERT_TRUE(HasPeer("service", "127.0.0.1:8002"));
+  ASSERT_FALSE(HasPeer("service", "127.0.0.1:8001"));
+  ASSERT_EQ(10, CollectSeconds("service", "127.0.0.1:8000").sample_count);
+  ASSERT_EQ(1, CollectSeconds("service", "127.0.0.1:8002").sample_count);
+  ASSERT_EQ(4, CollectSeconds(trpc::opentelemetry::kOtherPeer, trpc::opentelemetry::kOtherPeer).sample_count);
+  ASSERT_EQ(1, CollectFailed(trpc::opentelemetry::kOtherPeer, trpc::opentelemetry::kOtherPeer));
+}
+
+TEST_F(PeerMetricsTest, NoChurnByRarePeers) {
+  trpc::opentelemetry::PeerMetrics peer_metrics(seconds_family_, failed_family_, 2, buckets_);
+
+  for (int i = 0; i < 100; ++i) {
+    peer_metrics.Report("service", "127.0.0.1", 8000, 1000, false);
+    peer_metrics.Report("service", "127.0.0.1", 8001, 1000, false);
+  }
+  peer_metrics.Sync();
+
+  // the peers which are called once do not replace the tracked peers
+  for (int port = 9000; port < 9050; ++port) {
+    peer_metrics.Report("service", "127.0.0.1", port, 1000, false);
+  }
+  peer_metrics.Sync();
+  ASSERT_TRUE(HasPeer("service", "127.0.0.1:8000"));
+  ASSERT_TRUE(HasPeer("service", "127.0.0.1:8001"));
+  ASSERT_EQ(50, CollectSeconds(trpc::opentelemetry::kOtherPeer, trpc::opentelemetry::kOtherPeer).sample_count);
+
+  // the tracked peers which are no longer called give way to the new peers as their counts decay
+  for (int i = 0; i < 10; ++i) {
+    peer_metrics.Sync();
+  }
+  for (int i = 0; i < 3; ++i) {
+    peer_metrics.Report("service", "127.0.0.1", 8002, 1000, false);
+  }
+  peer_metrics.Sync();
+  ASSERT_TRUE(HasPeer("service", "127.0.0.1:8002"));
+}
+
+TEST_F(PeerMetricsTest, ConcurrentReport) {
+  trpc::opentelemetry::PeerMetrics peer_metrics(seconds_family_, failed_family_, 4, buckets_);
+
+  constexpr int kThreadNum = 4;
+  constexpr int kReportNum = 10000;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadNum; ++i) {
+    threads.emplace_back([&peer_metrics, i]() {
+      for (int j = 0; j < kReportNum; ++j) {
+        peer_metrics.Report("service", "127.0.0.1", 8000 + (j % (i + 3)), 1000, false);
+      }
+    });
+  }
+  std::thread sync_thread([&peer_metrics]() {
+    for (int i = 0; i < 100; ++i) {
+      peer_metrics.Sync();
+    }
+  });
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  sync_thread.join();
+  peer_metrics.Sync();
+
+  // the number of series is bounded by the tracked peers and the "other" series
+  int series_num = 0;
+  for (int port = 8000; port < 8000 + kThreadNum + 2; ++port) {
+    if (HasPeer("service", "127.0.0.1:" + std::to_string(port))) {
+      ++series_num;
+    }
+  }
+  ASSERT_LE(peer_metrics.Size(), 4);
+  ASSERT_LE(series_num, 4);
+  ASSERT_TRUE(HasPeer(trpc::opentelemetry::kOtherPeer, trpc::opentelemetry::kOtherPeer));
+}
+
+}  // namespace trpc::testing
+#endif
@@ -0,0 +1,93 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
+#include "trpc/telemetry/opentelemetry/metrics/periodic_metrics_exporter.h"
+
+#include <chrono>
+#include <utility>
+
+#include "trpc/util/log/logging.h"
+
+namespace trpc::opentelemetry {
+
+namespace {
+
+uint64_t GetNowNanoSeconds() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+PeriodicMetricsExporter::PeriodicMetricsExporter(Options options, std::unique_ptr<OtlpMetricsExporter> exporter,
+                                                 CollectFunc collect_func)
+    : options_(std::move(options)),
+      exporter_(std::move(exporter)),
+      collect_func_(std::move(collect_func)),
+      converter_(options_.converter_options, GetNowNanoSeconds()) {}
+
+PeriodicMetricsExporter::~PeriodicMetricsExporter() { Stop(); }
+
+void PeriodicMetricsExporter::Start() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (thread_.joinable()) {
+    return;
+  }
+  stopped_ = false;
+  thread_ = std::thread([this]() { Run(); });
+}
+
+void PeriodicMetricsExporter::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!thread_.joinable()) {
+      return;
+    }
+    stopped_ = true;
+  }
+  cond_.notify_all();
+  thread_.join();
+}
+
+int PeriodicMetricsExporter::ExportOnce() {
+  std::vector<::prometheus::MetricFamily> families;
+  ExemplarSnapshot exemplars;
+  collect_func_(families, exemplars);
+
+  auto requests = converter_.Convert(families, exemplars, GetNowNanoSeconds());
+  int failed = 0;
+  for (const auto& request : requests) {
+    if (!exporter_->Export(request)) {
+      ++failed;
+    }
+  }
+  if (failed > 0) {
+    TRPC_FMT_ERROR("export metrics failed, {} of {} requests are dropped", failed, requests.size());
+  }
+  return failed;
+}
+
+void PeriodicMetricsExporter::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopped_) {
+    cond_.wait_for(lock, std::chrono::milliseconds(options_.interval_ms), [this]() { return stopped_; });
+    // exports without holding the lock, and the metrics are flushed for the last time when stopped
+    lock.unlock();
+    ExportOnce();
+    lock.lock();
+  }
+}
+
+}  // namespace trpc::opentelemetry
+#endif
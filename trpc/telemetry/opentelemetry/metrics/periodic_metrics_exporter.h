@@ -0,0 +1,82 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "prometheus/metric_family.h"
+
+#include "trpc/telemetry/opentelemetry/metrics/open_metrics_serializer.h"
+#include "trpc/telemetry/opentelemetry/metrics/otlp_metrics_converter.h"
+#include "trpc/telemetry/opentelemetry/metrics/otlp_metrics_exporter.h"
+
+namespace trpc::opentelemetry {
+
+/// @brief Pushes the metrics to the collector periodically. The metrics are collected, converted and exported in its
+///        own thread, so that the reporting threads are only blocked by the collection of the families they report.
+class PeriodicMetricsExporter {
+ public:
+  /// @brief The function which collects the metric families and the exemplars of the histograms.
+  using CollectFunc =
+      std::function<void(std::vector<::prometheus::MetricFamily>& families, ExemplarSnapshot& exemplars)>;
+
+  struct Options {
+    /// the interval between two exports, in milliseconds
+    uint32_t interval_ms = 10000;
+    /// the options of converting the metrics into OTLP
+    OtlpMetricsConverter::Options converter_options;
+  };
+
+  PeriodicMetricsExporter(Options options, std::unique_ptr<OtlpMetricsExporter> exporter, CollectFunc collect_func);
+
+  ~PeriodicMetricsExporter();
+
+  /// @brief Starts the exporting thread.
+  void Start();
+
+  /// @brief Stops the exporting thread, and exports the metrics for the last time.
+  void Stop();
+
+  /// @brief Collects and exports the metrics once in the calling thread.
+  /// @return Return the number of requests which failed to be exported.
+  int ExportOnce();
+
+ private:
+  void Run();
+
+ private:
+  const Options options_;
+
+  std::unique_ptr<OtlpMetricsExporter> exporter_;
+
+  CollectFunc collect_func_;
+
+  // only used by the exporting thread, or by the calling thread of ExportOnce when the exporting thread is not running
+  OtlpMetricsConverter converter_;
+
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  bool stopped_ = false;
+  std::thread thread_;
+};
+
+}  // namespace trpc::opentelemetry
+#endif
@@ -0,0 +1,84 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
+#include "trpc/telemetry/opentelemetry/metrics/periodic_metrics_exporter.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+namespace trpc::testing {
+
+namespace {
+
+class FakeMetricsExporter : public trpc::opentelemetry::OtlpMetricsExporter {
+ public:
+  explicit FakeMetricsExporter(std::shared_ptr<std::atomic<int>> exported, bool succ = true)
+      : exported_(exported), succ_(succ) {}
+
+  bool Export(const ::opentelemetry::proto::collector::metrics::v1::ExportMetricsServiceRequest& request) override {
+    *exported_ += request.resource_metrics(0).scope_metrics(0).metrics_size();
+    return succ_;
+  }
+
+ private:
+  std::shared_ptr<std::atomic<int>> exported_;
+  bool succ_;
+};
+
+void CollectGauge(std::vector<::prometheus::MetricFamily>& families, trpc::opentelemetry::ExemplarSnapshot&) {
+  families.resize(1);
+  families[0].name = "test_gauge";
+  families[0].type = ::prometheus::MetricType::Gauge;
+  families[0].metric.resize(1);
+  families[0].metric[0].gauge.value = 1;
+}
+
+}  // namespace
+
+TEST(PeriodicMetricsExporterTest, ExportOnce) {
+  auto exported = std::make_shared<std::atomic<int>>(0);
+  trpc::opentelemetry::PeriodicMetricsExporter succ_exporter({}, std::make_unique<FakeMetricsExporter>(exported),
+                                                             CollectGauge);
+  ASSERT_EQ(0, succ_exporter.ExportOnce());
+  ASSERT_EQ(1, *exported);
+
+  trpc::opentelemetry::PeriodicMetricsExporter fail_exporter(
+      {}, std::make_unique<FakeMetricsExporter>(exported, false), CollectGauge);
+  ASSERT_EQ(1, fail_exporter.ExportOnce());
+}
+
+TEST(PeriodicMetricsExporterTest, StartAndStop) {
+  auto exported = std::make_shared<std::atomic<int>>(0);
+  trpc::opentelemetry::PeriodicMetricsExporter::Options options;
+  options.interval_ms = 10;
+  trpc::opentelemetry::PeriodicMetricsExporter exporter(options, std::make_unique<FakeMetricsExporter>(exported),
+                                                        CollectGauge);
+  exporter.Start();
+  while (*exported < 2) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  exporter.Stop();
+
+  // the metrics are exported for the last time when stopping
+  int stopped_exported = *exported;
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  ASSERT_EQ(stopped_exported, *exported);
+}
+
+}  // namespace trpc::testing
+#endif
@@ -0,0 +1,260 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "prometheus/counter.h"
+#include "prometheus/family.h"
+
+#include "trpc/telemetry/opentelemetry/metrics/exemplar.h"
+#include "trpc/telemetry/opentelemetry/metrics/label_selector.h"
+
+namespace trpc::opentelemetry {
+
+/// @brief The label key and value of the series into which reports beyond the series limit are folded.
+constexpr char kOverflowLabelKey[] = "overflow";
+constexpr char kOverflowLabelValue[] = "true";
+
+/// @brief Options for limiting the series of a metrics family.
+struct SeriesLimitOptions {
+  /// The maximum number of series in the family, 0 means unlimited.
+  uint32_t max_series = 0;
+  /// Series that have not been updated within this duration will be evicted, 0 means never evicting.
+  /// The unit of ttl is milliseconds
+  uint64_t ttl_ms = 0;
+  /// The labels of the RPC metrics kept in the series, the other labels of the RPC metrics are dropped before looking
+  /// up the series.
+  LabelMask label_mask = kAllRpcLabels;
+};
+
+/// @brief A wrapper of the prometheus family which bounds the number of its series. Once the limit is reached, reports
+///        with new labels are folded into a single overflow series, and series which are not updated within the ttl
+///        are removed from the family by EvictStale.
+/// @note The dropped_counter is incremented for every report folded into the overflow series, and the evicted_counter
+///       is incremented for every evicted series. Both of them can be nullptr.
+///       The family must be managed by std::shared_ptr when using Bind.
+template <typename T>
+class SeriesLimitedFamily : public std::enable_shared_from_this<SeriesLimitedFamily<T>> {
+ public:
+  SeriesLimitedFamily(::prometheus::Family<T>* family, ::prometheus::Counter* dropped_counter,
+                      ::prometheus::Counter* evicted_counter)
+      : family_(family), dropped_counter_(dropped_counter), evicted_counter_(evicted_counter) {}
+
+  /// @brief Sets the limit options.
+  void SetOptions(const SeriesLimitOptions& options) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    options_ = options;
+  }
+
+  /// @brief Updates the series with the labels, and the series will be created if it does not exist yet. The series
+  ///        is updated under the lock of the family, so that it can not be evicted meanwhile.
+  /// @param labels the labels of the series
+  /// @param now_ms the current time in milliseconds, which is used as the last updated time of the series
+  /// @param updater the function called with the series, or with the overflow series when the limit is reached
+  /// @param args the arguments used to create the series, such as the buckets of histogram
+  template <typename Updater, typename... Args>
+  void Update(const std::map<std::string, std::string>& labels, uint64_t now_ms, Updater&& updater, Args&&... args) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    updater(*AddLocked(labels, now_ms, std::forward<Args>(args)...)->metric);
+  }
+
+  /// @brief Updates the series like Update, together with the exemplars of the series which are created on first use.
+  /// @param bucket_boundaries the bucket boundaries of the exemplars, which should be the same as the histogram
+  /// @param updater the function called with the series and its exemplars, which are removed together when the series
+  ///        is evicted
+  template <typename Updater, typename... Args>
+  void UpdateWithExemplars(const std::map<std::string, std::string>& labels, uint64_t now_ms,
+                           const std::vector<double>& bucket_boundaries, Updater&& updater, Args&&... args) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Series* series = AddLocked(labels, now_ms, std::forward<Args>(args)...);
+    if (!series->exemplars) {
+      // the labels are the same as the key of the series
+      std::map<std::string, std::string> series_labels = {{kOverflowLabelKey, kOverflowLabelValue}};
+      if (series != &overflow_) {
+        series_labels = series->labels;
+      }
+      series->exemplars = std::make_shared<SeriesExemplars>(std::move(series_labels), bucket_boundaries);
+    }
+    updater(*series->metric, series->exemplars->exemplars);
+  }
+
+  /// @brief Visits the exemplars of the series which have ever been added with exemplars, including the overflow
+  ///        series. It is used when exposing the metrics. The reports of the family are only blocked while taking the
+  ///        references of the exemplars, not while visiting them, and the exemplars of the series evicted meanwhile
+  ///        are still visited.
+  /// @param visitor the function called with the labels and the exemplars of each series
+  void ForEachExemplars(const std::function<void(const std::map<std::string, std::string>& labels,
+                                                 const HistogramExemplars& exemplars)>& visitor) const {
+    std::vector<std::shared_ptr<const SeriesExemplars>> snapshot;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      snapshot.reserve(series_.size() + 1);
+      for (const auto& [hash, series] : series_) {
+        if (series.exemplars) {
+          snapshot.push_back(series.exemplars);
+        }
+      }
+      if (overflow_.metric && overflow_.exemplars) {
+        snapshot.push_back(overflow_.exemplars);
+      }
+    }
+    for (const auto& series_exemplars : snapshot) {
+      visitor(series_exemplars->labels, series_exemplars->exemplars);
+    }
+  }
+
+  /// @brief Gets the series like Update, and pins it so that it will not be evicted while the returned pointer or any
+  ///        of its copies is alive.
+  /// @return Return the pinned series, which can be used without looking up the labels again.
+  template <typename... Args>
+  std::shared_ptr<T> Bind(const std::map<std::string, std::string>& labels, uint64_t now_ms, Args&&... args) {
+    T* metric = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      metric = AddLocked(labels, now_ms, std::forward<Args>(args)...)->metric;
+      ++pins_[metric];
+    }
+    return std::shared_ptr<T>(metric, [family = this->shared_from_this()](T* pinned) { family->Unpin(pinned); });
+  }
+
+  /// @brief Evicts the series that have not been updated within the ttl.
+  /// @param now_ms the current time in milliseconds
+  /// @return Return the number of evicted series.
+  size_t EvictStale(uint64_t now_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (options_.ttl_ms == 0) {
+      return 0;
+    }
+
+    size_t evicted = 0;
+    for (auto it = series_.begin(); it != series_.end();) {
+      if (IsStale(it->second, now_ms)) {
+        family_->Remove(it->second.metric);
+        it = series_.erase(it);
+        ++evicted;
+      } else {
+        ++it;
+      }
+    }
+    if (overflow_.metric && IsStale(overflow_, now_ms)) {
+      family_->Remove(overflow_.metric);
+      overflow_.metric = nullptr;
+      overflow_.exemplars.reset();
+      ++evicted;
+    }
+
+    if (evicted_counter_ && evicted > 0) {
+      evicted_counter_->Increment(static_cast<double>(evicted));
+    }
+    return evicted;
+  }
+
+  /// @brief Gets the number of series in the family, excluding the overflow series.
+  size_t Size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return series_.size();
+  }
+
+  /// @brief Gets the underlying prometheus family.
+  ::prometheus::Family<T>* GetFamily() const { return family_; }
+
+ private:
+  // The exemplars of a series with its labels, which are shared with ForEachExemplars so that they can be visited
+  // without holding the lock
+  struct SeriesExemplars {
+    SeriesExemplars(std::map<std::string, std::string> series_labels, const std::vector<double>& bucket_boundaries)
+        : labels(std::move(series_labels)), exemplars(bucket_boundaries) {}
+
+    const std::map<std::string, std::string> labels;
+    HistogramExemplars exemplars;
+  };
+
+  struct Series {
+    // the labels selected by the label mask
+    std::map<std::string, std::string> labels;
+    T* metric = nullptr;
+    uint64_t last_update_ms = 0;
+    std::shared_ptr<SeriesExemplars> exemplars;
+  };
+
+  // The series are looked up by the labels selected by the label mask, which are hashed and compared in place, so the
+  // reported labels are only copied when a new series is added
+  template <typename... Args>
+  Series* AddLocked(const std::map<std::string, std::string>& reported_labels, uint64_t now_ms, Args&&... args) {
+    size_t hash = HashSelectedRpcLabels(reported_labels, options_.label_mask);
+    auto range = series_.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (EqualSelectedRpcLabels(it->second.labels, reported_labels, options_.label_mask)) {
+        it->second.last_update_ms = now_ms;
+        return &it->second;
+      }
+    }
+
+    if (options_.max_series > 0 && series_.size() >= options_.max_series) {
+      if (dropped_counter_) {
+        dropped_counter_->Increment();
+      }
+      if (!overflow_.metric) {
+        overflow_.metric = &family_->Add({{kOverflowLabelKey, kOverflowLabelValue}}, std::forward<Args>(args)...);
+      }
+      overflow_.last_update_ms = now_ms;
+      return &overflow_;
+    }
+
+    std::map<std::string, std::string> buffer;
+    const auto& labels = SelectRpcLabels(reported_labels, options_.label_mask, buffer);
+    T* metric = &family_->Add(labels, std::forward<Args>(args)...);
+    return &series_.emplace(hash, Series{labels, metric, now_ms, nullptr})->second;
+  }
+
+  void Unpin(T* metric) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = pins_.find(metric);
+    if (it != pins_.end() && --(it->second) == 0) {
+      pins_.erase(it);
+    }
+  }
+
+  // the pinned series are never stale
+  bool IsStale(const Series& series, uint64_t now_ms) const {
+    return now_ms > series.last_update_ms && now_ms - series.last_update_ms >= options_.ttl_ms &&
+           pins_.count(series.metric) == 0;
+  }
+
+ private:
+  ::prometheus::Family<T>* family_;
+  ::prometheus::Counter* dropped_counter_;
+  ::prometheus::Counter* evicted_counter_;
+
+  mutable std::mutex mutex_;
+  SeriesLimitOptions options_;
+  // key: the hash of the selected labels
+  std::unordered_multimap<size_t, Series> series_;
+  Series overflow_;
+  // the number of bindings of each pinned series
+  std::unordered_map<T*, uint32_t> pins_;
+};
+
+}  // namespace trpc::opentelemetry
+#endif
@@ -0,0 +1,254 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
+#include "trpc/telemetry/opentelemetry/metrics/series_limiter.h"
+
+#include <atomic>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "prometheus/histogram.h"
+#include "prometheus/registry.h"
+
+namespace trpc::testing {
+
+namespace {
+
+// Gets the series which is updated, the series may be evicted once it is returned
+template <typename T, typename... Args>
+T* AddSeries(trpc::opentelemetry::SeriesLimitedFamily<T>& limited_family,
+             const std::map<std::string, std::string>& labels, uint64_t now_ms, Args&&... args) {
+  T* series = nullptr;
+  limited_family.Update(
+      labels, now_ms, [&series](T& metric) { series = &metric; }, std::forward<Args>(args)...);
+  return series;
+}
+
+}  // namespace
+
+class SeriesLimitedFamilyTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    registry_ = std::make_shared<::prometheus::Registry>();
+    family_ = &::prometheus::BuildCounter().Name("series_limiter_test").Help("test").Register(*registry_);
+    auto& counter_family =
+        ::prometheus::BuildCounter().Name("series_limiter_counter").Help("test").Register(*registry_);
+    dropped_ = &counter_family.Add({{"type", "dropped"}});
+    evicted_ = &counter_family.Add({{"type", "evicted"}});
+  }
+
+ protected:
+  std::shared_ptr<::prometheus::Registry> registry_;
+  ::prometheus::Family<::prometheus::Counter>* family_;
+  ::prometheus::Counter* dropped_;
+  ::prometheus::Counter* evicted_;
+};
+
+TEST_F(SeriesLimitedFamilyTest, MaxSeries) {
+  trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Counter> limited_family(family_, dropped_, evicted_);
+  trpc::opentelemetry::SeriesLimitOptions options;
+  options.max_series = 2;
+  limited_family.SetOptions(options);
+
+  auto* counter1 = AddSeries(limited_family, {{"key", "value1"}}, 0);
+  auto* counter2 = AddSeries(limited_family, {{"key", "value2"}}, 0);
+  ASSERT_NE(counter1, counter2);
+  ASSERT_EQ(counter1, AddSeries(limited_family, {{"key", "value1"}}, 0));
+  ASSERT_EQ(2, limited_family.Size());
+  ASSERT_EQ(0, dropped_->Value());
+
+  // the new series are folded into the overflow series
+  auto* overflow1 = AddSeries(limited_family, {{"key", "value3"}}, 0);
+  auto* overflow2 = AddSeries(limited_family, {{"key", "value4"}}, 0);
+  ASSERT_EQ(overflow1, overflow2);
+  ASSERT_NE(counter1, overflow1);
+  ASSERT_EQ(2, limited_family.Size());
+  ASSERT_EQ(2, dropped_->Value());
+  ASSERT_TRUE(family_->Has({{trpc::opentelemetry::kOverflowLabelKey, trpc::opentelemetry::kOverflowLabelValue}}));
+  ASSERT_FALSE(family_->Has({{"key", "value3"}}));
+
+  // existing series are still reported normally
+  ASSERT_EQ(counter2, AddSeries(limited_family, {{"key", "value2"}}, 0));
+}
+
+TEST_F(SeriesLimitedFamilyTest, EvictStale) {
+  trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Counter> limited_family(family_, dropped_, evicted_);
+  trpc::opentelemetry::SeriesLimitOptions options;
+  options.max_series = 1;
+  limited_family.SetOptions(options);
+
+  AddSeries(limited_family, {{"key", "value1"}}, 1000);
+  AddSeries(limited_family, {{"key", "value2"}}, 1000);
+
+  // does not evict because ttl is not set
+  ASSERT_EQ(0, limited_family.EvictStale(100000));
+
+  options.ttl_ms = 5000;
+  limited_family.SetOptions(options);
+  // does not evict because the series are not stale yet
+  ASSERT_EQ(0, limited_family.EvictStale(3000));
+  // the series and the overflow series are evicted
+  ASSERT_EQ(2, limited_family.EvictStale(6000));
+  ASSERT_EQ(0, limited_family.Size());
+  ASSERT_EQ(2, evicted_->Value());
+  ASSERT_FALSE(family_->Has({{"key", "value1"}}));
+
+  // the evicted series frees up room for new series
+  AddSeries(limited_family, {{"key", "value2"}}, 7000);
+  ASSERT_TRUE(family_->Has({{"key", "value2"}}));
+  AddSeries(limited_family, {{"key", "value3"}}, 12000);
+  ASSERT_EQ(1, limited_family.EvictStale(12500));
+  ASSERT_EQ(0, limited_family.Size());
+}
+
+TEST_F(SeriesLimitedFamilyTest, UpdateWhileEvicting) {
+  trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Counter> limited_family(family_, dropped_, evicted_);
+  trpc::opentelemetry::SeriesLimitOptions options;
+  options.ttl_ms = 1;
+  limited_family.SetOptions(options);
+
+  // the series are evicted as soon as they are updated, and the updates never touch an evicted series
+  std::atomic<bool> stopped{false};
+  std::thread evict_thread([&limited_family, &stopped]() {
+    uint64_t now_ms = 1000;
+    while (!stopped.load(std::memory_order_relaxed)) {
+      limited_family.EvictStale(++now_ms);
+    }
+  });
+  for (int i = 0; i < 10000; ++i) {
+    limited_family.Update({{"key", "value"}}, 0, [](::prometheus::Counter& counter) { counter.Increment(); });
+  }
+  stopped = true;
+  evict_thread.join();
+}
+
+TEST_F(SeriesLimitedFamilyTest, Histogram) {
+  auto& histogram_family =
+      ::prometheus::BuildHistogram().Name("series_limiter_histogram").Help("test").Register(*registry_);
+  trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Histogram> limited_family(&histogram_family, nullptr,
+                                                                                   nullptr);
+  trpc::opentelemetry::SeriesLimitOptions options;
+  options.max_series = 1;
+  options.ttl_ms = 1000;
+  limited_family.SetOptions(options);
+
+  ::prometheus::Histogram::BucketBoundaries buckets = {1, 2, 3};
+  auto observe = [](::prometheus::Histogram& histogram) { histogram.Observe(1); };
+  limited_family.Update({{"key", "value1"}}, 0, observe, buckets);
+  limited_family.Update({{"key", "value2"}}, 0, observe, buckets);
+  ASSERT_EQ(1, limited_family.Size());
+  ASSERT_EQ(2, limited_family.EvictStale(2000));
+}
+
+TEST_F(SeriesLimitedFamilyTest, Exemplars) {
+  auto& histogram_family =
+      ::prometheus::BuildHistogram().Name("series_limiter_exemplars").Help("test").Register(*registry_);
+  trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Histogram> limited_family(&histogram_family, nullptr,
+                                                                                   nullptr);
+  trpc::opentelemetry::SeriesLimitOptions options;
+  options.max_series = 1;
+  options.ttl_ms = 1000;
+  limited_family.SetOptions(options);
+
+  ::prometheus::Histogram::BucketBoundaries buckets = {1, 2, 3};
+  // the series added without exemplars has no exemplars until it is added with exemplars
+  auto* histogram = AddSeries(limited_family, {{"key", "value1"}}, 0, buckets);
+  ::prometheus::Histogram* series = nullptr;
+  const trpc::opentelemetry::HistogramExemplars* exemplars = nullptr;
+  auto get_series = [&series, &exemplars](::prometheus::Histogram& histogram,
+                                          trpc::opentelemetry::HistogramExemplars& histogram_exemplars) {
+    series = &histogram;
+    exemplars = &histogram_exemplars;
+  };
+  limited_family.UpdateWithExemplars({{"key", "value1"}}, 0, buckets, get_series, buckets);
+  ASSERT_EQ(histogram, series);
+  ASSERT_EQ(4, exemplars->BucketCount());
+  auto* first_exemplars = exemplars;
+  limited_family.UpdateWithExemplars({{"key", "value1"}}, 0, buckets, get_series, buckets);
+  ASSERT_EQ(first_exemplars, exemplars);
+  limited_family.UpdateWithExemplars({{"key", "value2"}}, 0, buckets, get_series, buckets);
+
+  std::map<std::map<std::string, std::string>, const trpc::opentelemetry::HistogramExemplars*> visited;
+  limited_family.ForEachExemplars(
+      [&visited](const std::map<std::string, std::string>& labels,
+                 const trpc::opentelemetry::HistogramExemplars& exemplars) { visited[labels] = &exemplars; });
+  ASSERT_EQ(2, visited.size());
+  std::map<std::string, std::string> labels = {{"key", "value1"}};
+  ASSERT_EQ(first_exemplars, visited[labels]);
+  labels = {{trpc::opentelemetry::kOverflowLabelKey, trpc::opentelemetry::kOverflowLabelValue}};
+  ASSERT_EQ(1, visited.count(labels));
+
+  // the exemplars are evicted together with the series
+  ASSERT_EQ(2, limited_family.EvictStale(2000));
+  visited.clear();
+  limited_family.ForEachExemplars(
+      [&visited](const std::map<std::string, std::string>& labels,
+                 const trpc::opentelemetry::HistogramExemplars& exemplars) { visited[labels] = &exemplars; });
+  ASSERT_TRUE(visited.empty());
+}
+
+TEST_F(SeriesLimitedFamilyTest, Bind) {
+  auto limited_family =
+      std::make_shared<trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Counter>>(family_, dropped_, evicted_);
+  trpc::opentelemetry::SeriesLimitOptions options;
+  options.max_series = 1;
+  options.ttl_ms = 1000;
+  limited_family->SetOptions(options);
+
+  auto counter = limited_family->Bind({{"key", "value1"}}, 0);
+  auto copied_counter = counter;
+  ASSERT_EQ(counter.get(), AddSeries(*limited_family, {{"key", "value1"}}, 0));
+  // the overflow series can be bound too
+  auto overflow = limited_family->Bind({{"key", "value2"}}, 0);
+  ASSERT_NE(counter.get(), overflow.get());
+
+  // the bound series are not evicted
+  ASSERT_EQ(0, limited_family->EvictStale(2000));
+  counter->Increment();
+  ASSERT_EQ(1, limited_family->Size());
+
+  // the series can be evicted after all the bindings are released
+  counter.reset();
+  overflow.reset();
+  ASSERT_EQ(1, limited_family->EvictStale(3000));
+  copied_counter.reset();
+  ASSERT_EQ(1, limited_family->EvictStale(4000));
+  ASSERT_EQ(0, limited_family->Size());
+}
+
+TEST_F(SeriesLimitedFamilyTest, LabelMask) {
+  trpc::opentelemetry::SeriesLimitedFamily<::prometheus::Counter> limited_family(family_, dropped_, evicted_);
+  trpc::opentelemetry::SeriesLimitOptions options;
+  options.label_mask = trpc::opentelemetry::GetRpcLabelBit(trpc::opentelemetry::kCalleeService);
+  limited_family.SetOptions(options);
+
+  // the reports which only differ in the dropped labels share the same series
+  auto* counter1 = AddSeries(limited_family,
+                             {{trpc::opentelemetry::kCalleeService, "service"},
+                              {trpc::opentelemetry::kCalleeMethod, "method1"},
+                              {"user_key", "user_value"}},
+                             0);
+  auto* counter2 = AddSeries(limited_family,
+                             {{trpc::opentelemetry::kCalleeService, "service"},
+                              {trpc::opentelemetry::kCalleeMethod, "method2"},
+                              {"user_key", "user_value"}},
+                             0);
+  ASSERT_EQ(counter1, counter2);
+  ASSERT_EQ(1, limited_family.Size());
+  // the labels which are not labels of the RPC metrics are kept
+  ASSERT_TRUE(family_->Has({{trpc::opentelemetry::kCalleeService, "service"}, {"user_key", "user_value"}}));
+}
+
+}  // namespace trpc::testing
+#endif
@@ -14,14 +14,56 @@
 #ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
 #include "trpc/telemetry/opentelemetry/metrics/server_filter.h"
 
+#include <unordered_map>
+
 #include "trpc/common/config/trpc_config.h"
 #include "trpc/telemetry/telemetry_factory.h"
 #include "trpc/util/time.h"
 
 #include "trpc/telemetry/opentelemetry/metrics/common.h"
+#include "trpc/telemetry/opentelemetry/metrics/inflight_gauge.h"
+#include "trpc/telemetry/opentelemetry/metrics/label_selector.h"
+#include "trpc/telemetry/opentelemetry/metrics/trace_exemplar.h"
+#include "trpc/telemetry/opentelemetry/server_stages.h"
+#include "trpc/telemetry/opentelemetry/tracing/opentelemetry_tracing.h"
 
 namespace trpc {
 
+namespace opentelemetry {
+
+/// @brief A map used to store ServerPayloadSizeFuncs for different protocol.
+///        key: protocol name, value: ServerPayloadSizeFuncs
+std::unordered_map<std::string, ServerPayloadSizeFuncs> server_payload_size_funcs_map;
+
+void SetServerPayloadSizeFuncs(const std::string& protocol_name, const ServerPayloadSizeFuncs& size_funcs) {
+  if (size_funcs.request_size_func == nullptr || size_funcs.response_size_func == nullptr) {
+    TRPC_LOG_ERROR("can not set server payload size funcs of " << protocol_name << " with nullptr");
+    return;
+  }
+  server_payload_size_funcs_map[protocol_name] = size_funcs;
+}
+
+const ServerPayloadSizeFuncs& GetServerPayloadSizeFuncs(const std::string& protocol_name) {
+  auto it = server_payload_size_funcs_map.find(protocol_name);
+  if (it != server_payload_size_funcs_map.end()) {
+    return it->second;
+  }
+  // If there is no corresponding implementation set for the protocol, the sizes known by the framework are used by
+  // default.
+  static const ServerPayloadSizeFuncs default_size_funcs{ServerRequestLengthFunc, ServerResponseLengthFunc};
+  return default_size_funcs;
+}
+
+size_t ServerRequestLengthFunc(const ServerContextPtr& context) { return context->GetRequestLength(); }
+
+size_t ServerResponseLengthFunc(const ServerContextPtr& context) {
+  // the size of the message is set when the response is encoded, and is 0 if the protocol does not know it
+  auto& rsp_msg = context->GetResponseMsg();
+  return rsp_msg ? rsp_msg->GetMessageSize() : 0;
+}
+
+}  // namespace opentelemetry
+
 int OpenTelemetryMetricsServerFilter::Init() {
   auto telemetry = TelemetryFactory::GetInstance()->Get(trpc::opentelemetry::kOpenTelemetryTelemetryName);
   if (!telemetry) {
@@ -32,12 +74,25 @@ int OpenTelemetryMetricsServerFilter::Init() {
   metrics_plugin_ = trpc::dynamic_pointer_cast<OpenTelemetryMetrics>(telemetry->GetMetrics());
   auto& config = metrics_plugin_->GetConfig();
   enabled_ = config.metrics_config.enabled;
+  label_mask_ = metrics_plugin_->GetServerLabelMask();
+  enable_slo_ = enabled_ && metrics_plugin_->HasSlo();
+  if (enabled_ && config.metrics_config.enable_exemplar) {
+    auto tracing = trpc::dynamic_pointer_cast<OpenTelemetryTracing>(telemetry->GetTracing());
+    if (tracing) {
+      enable_exemplar_ = true;
+      tracing_index_ = tracing->GetPluginID();
+    } else {
+      TRPC_LOG_WARN("exemplar is enabled but the tracing of the plugin is unavailable, exemplars will not be reported");
+    }
+  }
 
   return 0;
 }
 
 std::vector<FilterPoint> OpenTelemetryMetricsServerFilter::GetFilterPoint() {
-  std::vector<FilterPoint> points = {FilterPoint::SERVER_POST_RECV_MSG, FilterPoint::SERVER_PRE_SEND_MSG};
+  std::vector<FilterPoint> points = {FilterPoint::SERVER_POST_RECV_MSG, FilterPoint::SERVER_PRE_RPC_INVOKE,
+                                     FilterPoint::SERVER_POST_RPC_INVOKE, FilterPoint::SERVER_PRE_SEND_MSG,
+                                     FilterPoint::SERVER_POST_SEND_MSG};
   return points;
 }
 
@@ -48,44 +103,101 @@ void OpenTelemetryMetricsServerFilter::operator()(FilterStatus& status, FilterPo
     return;
   }
 
-  ModuleMetricsInfo module_info;
-  module_info.source = kMetricsCalleeSource;
-  module_info.infos[trpc::opentelemetry::kCallerService] = context->GetCallerName();
-  module_info.infos[trpc::opentelemetry::kCallerMethod] = "";
-  module_info.infos[trpc::opentelemetry::kCalleeService] = context->GetCalleeName();
-  module_info.infos[trpc::opentelemetry::kCalleeMethod] = context->GetFuncName();
-
   if (point == FilterPoint::SERVER_POST_RECV_MSG) {
-    ReportServerStartedTotal(context, module_info);
+    trpc::opentelemetry::RpcMetricsRecord record;
+    record.labels = BuildLabels(context);
+    record.inflight = trpc::opentelemetry::InflightGuard(
+        metrics_plugin_->GetServerInflightCounter(context->GetCalleeName(), context->GetFuncName()));
+    trpc::opentelemetry::GetServerStages(context);
+    metrics_plugin_->ReportServerStartedTotal(record.labels);
+    ReportServerRequestBytes(context, record.labels);
+    context->SetFilterData(metrics_plugin_->GetRecordIndex(), std::move(record));
+  } else if (point == FilterPoint::SERVER_PRE_RPC_INVOKE) {
+    auto* record = context->GetFilterData<trpc::opentelemetry::RpcMetricsRecord>(metrics_plugin_->GetRecordIndex());
+    auto* stages = trpc::opentelemetry::MarkServerDispatched(context);
+    if (record && stages) {
+      metrics_plugin_->ReportServerQueueWaitSeconds(record->labels, stages->dispatch_us - stages->recv_us);
+    }
+  } else if (point == FilterPoint::SERVER_POST_RPC_INVOKE) {
+    auto* record = context->GetFilterData<trpc::opentelemetry::RpcMetricsRecord>(metrics_plugin_->GetRecordIndex());
+    auto* stages = trpc::opentelemetry::MarkServerHandled(context);
+    if (record && stages) {
+      metrics_plugin_->ReportServerHandlerSeconds(record->labels, stages->handled_us - stages->dispatch_us);
+    }
   } else if (point == FilterPoint::SERVER_PRE_SEND_MSG) {
-    ReportServerHandledSeconds(context, module_info);
-    ReportServerHandledTotal(context, module_info);
+    auto* record = context->GetFilterData<trpc::opentelemetry::RpcMetricsRecord>(metrics_plugin_->GetRecordIndex());
+    if (record) {
+      record->inflight.Release();
+      ReportServerHandled(context, record->labels);
+    } else {
+      // the record does not exist if the response is sent without going through SERVER_POST_RECV_MSG
+      std::map<std::string, std::string> labels = BuildLabels(context);
+      ReportServerHandled(context, labels);
+    }
+  } else if (point == FilterPoint::SERVER_POST_SEND_MSG) {
+    auto* record = context->GetFilterData<trpc::opentelemetry::RpcMetricsRecord>(metrics_plugin_->GetRecordIndex());
+    if (record) {
+      // the response has been encoded, whose size is only known now
+      ReportServerResponseBytes(context, record->labels);
+      auto* stages = trpc::opentelemetry::FindServerStages(context);
+      if (stages && stages->handled_us != 0) {
+        // the labels contain the call result which is appended at SERVER_PRE_SEND_MSG
+        metrics_plugin_->ReportServerSendSeconds(record->labels,
+                                                 trpc::time::GetSteadyMicroSeconds() - stages->handled_us);
+      }
+    } else {
+      ReportServerResponseBytes(context, BuildLabels(context));
+    }
   }
 }
 
-void OpenTelemetryMetricsServerFilter::ReportServerStartedTotal(const ServerContextPtr& context,
-                                                                ModuleMetricsInfo& module_info) {
-  module_info.extend_info = trpc::opentelemetry::ModuleReportType::kServerStartedCount;
-  metrics_plugin_->ModuleReport(module_info);
+std::map<std::string, std::string> OpenTelemetryMetricsServerFilter::BuildLabels(const ServerContextPtr& context) {
+  // the labels which are not used by any server-side family are skipped
+  std::map<std::string, std::string> labels;
+  trpc::opentelemetry::AddRpcLabel(labels, label_mask_, trpc::opentelemetry::kCallerService, context->GetCallerName());
+  if (trpc::opentelemetry::IsRpcLabelSelected(label_mask_, trpc::opentelemetry::kCallerMethod)) {
+    labels.emplace(trpc::opentelemetry::kCallerMethod, "");
+  }
+  trpc::opentelemetry::AddRpcLabel(labels, label_mask_, trpc::opentelemetry::kCalleeService, context->GetCalleeName());
+  trpc::opentelemetry::AddRpcLabel(labels, label_mask_, trpc::opentelemetry::kCalleeMethod, context->GetFuncName());
+  return labels;
 }
 
-void OpenTelemetryMetricsServerFilter::ReportServerHandledSeconds(const ServerContextPtr& context,
-                                                                  ModuleMetricsInfo& module_info) {
-  module_info.extend_info = trpc::opentelemetry::ModuleReportType::kServerHandledTime;
-  module_info.cost_time = trpc::time::GetMilliSeconds() - context->GetRecvTimestamp();
-  metrics_plugin_->ModuleReport(module_info);
+void OpenTelemetryMetricsServerFilter::ReportServerRequestBytes(const ServerContextPtr& context,
+                                                                const std::map<std::string, std::string>& labels) {
+  size_t size = trpc::opentelemetry::GetServerPayloadSizeFuncs(context->GetCodecName()).request_size_func(context);
+  if (size > 0) {
+    metrics_plugin_->ReportServerRequestBytes(labels, size);
+  }
+}
+
+void OpenTelemetryMetricsServerFilter::ReportServerResponseBytes(const ServerContextPtr& context,
+                                                                 const std::map<std::string, std::string>& labels) {
+  size_t size = trpc::opentelemetry::GetServerPayloadSizeFuncs(context->GetCodecName()).response_size_func(context);
+  if (size > 0) {
+    metrics_plugin_->ReportServerResponseBytes(labels, size);
+  }
 }
 
-void OpenTelemetryMetricsServerFilter::ReportServerHandledTotal(const ServerContextPtr& context,
-                                                                ModuleMetricsInfo& module_info) {
-  module_info.extend_info = trpc::opentelemetry::ModuleReportType::kServerHandledCount;
-  int ret_code = context->GetStatus().GetFrameworkRetCode();
-  if (ret_code == trpc::TrpcRetCode::TRPC_INVOKE_SUCCESS) {
-    ret_code = context->GetStatus().GetFuncRetCode();
+void OpenTelemetryMetricsServerFilter::ReportServerHandled(const ServerContextPtr& context,
+                                                           std::map<std::string, std::string>& labels) {
+  trpc::opentelemetry::ExemplarContext exemplar;
+  bool has_exemplar = enable_exemplar_ && trpc::opentelemetry::GetSampledExemplarContext<ServerTracingSpan>(
+                                              context, tracing_index_, exemplar);
+  uint64_t cost_ms = trpc::time::GetMilliSeconds() - context->GetRecvTimestamp();
+  metrics_plugin_->ReportServerHandledSeconds(labels, cost_ms, has_exemplar ? &exemplar : nullptr);
+
+  int ret_code = trpc::opentelemetry::GetRetCode(context);
+  if (enable_slo_) {
+    auto result = trpc::opentelemetry::ClassifyCallResult(ret_code, context->GetCalleeName(), context->GetFuncName());
+    metrics_plugin_->ReportServerSlo(context->GetCalleeName(), context->GetFuncName(), cost_ms,
+                                     result.classification->type == trpc::opentelemetry::kSuccessType);
   }
 
-  trpc::opentelemetry::SetCallResult(ret_code, context->GetCalleeName(), context->GetFuncName(), module_info.infos);
-  metrics_plugin_->ModuleReport(module_info);
+  // the call result labels are only reported with the handled total
+  trpc::opentelemetry::SetSelectedCallResult(ret_code, context->GetCalleeName(), context->GetFuncName(), label_mask_,
+                                             labels);
+  metrics_plugin_->ReportServerHandledTotal(labels);
 }
 
 }  // namespace trpc
@@ -14,6 +14,9 @@
 #ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
 #pragma once
 
+#include <functional>
+#include <string>
+
 #include "trpc/filter/filter.h"
 #include "trpc/server/server_context.h"
 #include "trpc/telemetry/opentelemetry/metrics/opentelemetry_metrics.h"
@@ -21,6 +24,39 @@
 
 namespace trpc {
 
+namespace opentelemetry {
+
+/// @brief The server-side payload size function which returns the size of the request or response in bytes based on
+///        the ServerContext, 0 means the size is unknown and will not be reported.
+/// @param context ServerContext
+/// @return the size in bytes
+using ServerPayloadSizeFunc = std::function<size_t(const ServerContextPtr& context)>;
+
+/// @brief The payload size functions of a specific protocol.
+struct ServerPayloadSizeFuncs {
+  ServerPayloadSizeFunc request_size_func;
+  ServerPayloadSizeFunc response_size_func;
+};
+
+/// @brief Sets the server-side payload size functions for a specific protocol.
+/// @param protocol_name protocol name
+/// @param size_funcs payload size functions
+void SetServerPayloadSizeFuncs(const std::string& protocol_name, const ServerPayloadSizeFuncs& size_funcs);
+
+/// @brief Gets the server-side payload size functions for a specific protocol.
+/// @param protocol_name protocol name
+/// @return payload size functions
+const ServerPayloadSizeFuncs& GetServerPayloadSizeFuncs(const std::string& protocol_name);
+
+/// @brief The implementation function which gets the request size from the length of the decoded request.
+size_t ServerRequestLengthFunc(const ServerContextPtr& context);
+
+/// @brief The implementation function which gets the response size from the length of the encoded response, so it
+///        must be called after the response is sent.
+size_t ServerResponseLengthFunc(const ServerContextPtr& context);
+
+}  // namespace opentelemetry
+
 class OpenTelemetryMetricsServerFilter : public MessageServerFilter {
  public:
   int Init() override;
@@ -32,16 +68,33 @@ class OpenTelemetryMetricsServerFilter : public MessageServerFilter {
   void operator()(FilterStatus& status, FilterPoint point, const ServerContextPtr& context) override;
 
  private:
-  void ReportServerStartedTotal(const ServerContextPtr& context, ModuleMetricsInfo& module_info);
+  // Builds the caller and callee labels of the RPC
+  std::map<std::string, std::string> BuildLabels(const ServerContextPtr& context);
 
-  void ReportServerHandledSeconds(const ServerContextPtr& context, ModuleMetricsInfo& module_info);
+  // Reports the size of the request, which is skipped if the size is unknown
+  void ReportServerRequestBytes(const ServerContextPtr& context, const std::map<std::string, std::string>& labels);
 
-  void ReportServerHandledTotal(const ServerContextPtr& context, ModuleMetricsInfo& module_info);
+  // Reports the size of the encoded response, which is skipped if the size is unknown
+  void ReportServerResponseBytes(const ServerContextPtr& context, const std::map<std::string, std::string>& labels);
+
+  void ReportServerHandled(const ServerContextPtr& context, std::map<std::string, std::string>& labels);
 
  private:
   OpenTelemetryMetricsPtr metrics_plugin_ = nullptr;
 
   bool enabled_ = false;
+
+  // whether to attach the sampled spans of the tracing plugin to the latency histograms as exemplars
+  bool enable_exemplar_ = false;
+
+  // the filter data index of the tracing plugin where the spans are stored
+  uint32_t tracing_index_ = 0;
+
+  // whether to count the RPCs into the service level objectives
+  bool enable_slo_ = false;
+
+  // the labels used by the server-side RPC metrics, the others are not built
+  trpc::opentelemetry::LabelMask label_mask_ = trpc::opentelemetry::kAllRpcLabels;
 };
 
 }  // namespace trpc
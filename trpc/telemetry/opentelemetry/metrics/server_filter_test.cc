@@ -22,7 +22,9 @@
 #include "trpc/server/rpc/rpc_service_impl.h"
 #include "trpc/server/testing/server_context_testing.h"
 #include "trpc/telemetry/telemetry_factory.h"
+#include "trpc/util/buffer/noncontiguous_buffer.h"
 
+#include "trpc/telemetry/opentelemetry/server_stages.h"
 #include "trpc/telemetry/opentelemetry/testing/mock_telemetry.h"
 
 namespace trpc::testing {
@@ -56,9 +58,12 @@ MetricsPtr OpenTelemetryMetricsServerFilterTest::metrics_;
 TEST_F(OpenTelemetryMetricsServerFilterTest, Init) {
   ASSERT_EQ(trpc::opentelemetry::kOpenTelemetryTelemetryName, server_filter_->Name());
   std::vector<FilterPoint> points = server_filter_->GetFilterPoint();
-  ASSERT_EQ(2, points.size());
+  ASSERT_EQ(5, points.size());
   ASSERT_TRUE(std::find(points.begin(), points.end(), FilterPoint::SERVER_POST_RECV_MSG) != points.end());
+  ASSERT_TRUE(std::find(points.begin(), points.end(), FilterPoint::SERVER_PRE_RPC_INVOKE) != points.end());
+  ASSERT_TRUE(std::find(points.begin(), points.end(), FilterPoint::SERVER_POST_RPC_INVOKE) != points.end());
   ASSERT_TRUE(std::find(points.begin(), points.end(), FilterPoint::SERVER_PRE_SEND_MSG) != points.end());
+  ASSERT_TRUE(std::find(points.begin(), points.end(), FilterPoint::SERVER_POST_SEND_MSG) != points.end());
 }
 
 TEST_F(OpenTelemetryMetricsServerFilterTest, Report) {
@@ -72,12 +77,70 @@ TEST_F(OpenTelemetryMetricsServerFilterTest, Report) {
   FilterStatus status;
   server_filter_->operator()(status, FilterPoint::SERVER_POST_RECV_MSG, context);
   ASSERT_EQ(FilterStatus::CONTINUE, status);
+  // the record is built when the RPC starts
+  auto record_index = static_cast<OpenTelemetryMetrics*>(metrics_.get())->GetRecordIndex();
+  auto* record = context->GetFilterData<trpc::opentelemetry::RpcMetricsRecord>(record_index);
+  ASSERT_NE(nullptr, record);
+  ASSERT_EQ(4, record->labels.size());
+  auto* inflight = static_cast<OpenTelemetryMetrics*>(metrics_.get())
+                       ->GetServerInflightCounter(context->GetCalleeName(), context->GetFuncName());
+  ASSERT_EQ(1, inflight->Value());
+  auto* stages = trpc::opentelemetry::FindServerStages(context);
+  ASSERT_NE(nullptr, stages);
+  ASSERT_NE(0, stages->recv_us);
+
+  // the timestamps of the stages are captured to break down the latency
+  server_filter_->operator()(status, FilterPoint::SERVER_PRE_RPC_INVOKE, context);
+  ASSERT_GE(stages->dispatch_us, stages->recv_us);
+  server_filter_->operator()(status, FilterPoint::SERVER_POST_RPC_INVOKE, context);
+  ASSERT_GE(stages->handled_us, stages->dispatch_us);
 
   trpc::Status frame_status;
   frame_status.SetFrameworkRetCode(101);
   context->SetStatus(frame_status);
   server_filter_->operator()(status, FilterPoint::SERVER_PRE_SEND_MSG, context);
   ASSERT_EQ(FilterStatus::CONTINUE, status);
+  // the call result is appended into the record when the RPC finishes
+  ASSERT_EQ("101", record->labels[trpc::opentelemetry::kCode]);
+  ASSERT_EQ(trpc::opentelemetry::kTimeoutType, record->labels[trpc::opentelemetry::kCodeType]);
+  ASSERT_EQ(0, inflight->Value());
+  server_filter_->operator()(status, FilterPoint::SERVER_POST_SEND_MSG, context);
+  ASSERT_EQ(FilterStatus::CONTINUE, status);
+}
+
+TEST_F(OpenTelemetryMetricsServerFilterTest, PayloadSize) {
+  DummyTrpcProtocol req_data;
+  trpc::test::helloworld::HelloRequest hello_req;
+  NoncontiguousBuffer req_bin_data;
+  ASSERT_TRUE(PackTrpcRequest(req_data, static_cast<void*>(&hello_req), req_bin_data));
+  std::shared_ptr<RpcServiceImpl> test_rpc_server_impl = std::make_shared<RpcServiceImpl>();
+  ServerContextPtr context = MakeTestServerContext("trpc", test_rpc_server_impl.get(), std::move(req_bin_data));
+  ASSERT_EQ(context->GetRequestLength(), trpc::opentelemetry::ServerRequestLengthFunc(context));
+
+  // the size is unknown before the response is encoded
+  ASSERT_EQ(0, trpc::opentelemetry::ServerResponseLengthFunc(context));
+
+  // the size is the length of the encoded response whatever the encoding of the body is
+  trpc::test::helloworld::HelloReply hello_rsp;
+  hello_rsp.set_msg("hello world");
+  context->SetRspEncodeType(TrpcContentEncodeType::TRPC_JSON_ENCODE);
+  context->GetResponseMsg()->SetNonContiguousProtocolBody(CreateBufferSlow(hello_rsp.SerializeAsString()));
+  NoncontiguousBuffer rsp_buffer;
+  ASSERT_TRUE(context->GetResponseMsg()->ZeroCopyEncode(rsp_buffer));
+  ASSERT_EQ(rsp_buffer.ByteSize(), trpc::opentelemetry::ServerResponseLengthFunc(context));
+
+  // the default functions are used if the protocol does not set its own
+  auto& default_funcs = trpc::opentelemetry::GetServerPayloadSizeFuncs("test_protocol");
+  ASSERT_EQ(context->GetRequestLength(), default_funcs.request_size_func(context));
+  ASSERT_EQ(rsp_buffer.ByteSize(), default_funcs.response_size_func(context));
+
+  trpc::opentelemetry::ServerPayloadSizeFuncs size_funcs;
+  size_funcs.request_size_func = [](const ServerContextPtr&) -> size_t { return 10; };
+  size_funcs.response_size_func = [](const ServerContextPtr&) -> size_t { return 20; };
+  trpc::opentelemetry::SetServerPayloadSizeFuncs("test_protocol", size_funcs);
+  auto& test_funcs = trpc::opentelemetry::GetServerPayloadSizeFuncs("test_protocol");
+  ASSERT_EQ(10, test_funcs.request_size_func(context));
+  ASSERT_EQ(20, test_funcs.response_size_func(context));
 }
 
 }  // namespace trpc::testing
@@ -0,0 +1,109 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/// @brief The layout of the shared memory file into which the metrics are published, which is read by the local agent.
+///        The file is a header followed by `capacity` fixed-size records:
+///
+///          offset 0                : ShmMetricsHeader (64 bytes)
+///          offset 64 + i * 512     : ShmMetricsRecord i, for i in [0, capacity)
+///
+///        All the fields are little-endian as the host, and every field which may change after the file is created is
+///        an 8-byte (or 4-byte) lock-free atomic, so the file can be mapped by other processes safely.
+///        Each record is protected by a seqlock: the writer makes the sequence odd before updating the record, and even
+///        again after. A reader copies the record between two loads of the sequence, and retries if they differ or are
+///        odd. Only the records before record_num have ever been used, and the records whose type is kFree are unused.
+namespace trpc::opentelemetry {
+
+/// @brief "TRPM", which is stored after the header is initialized.
+constexpr uint32_t kShmMetricsMagic = 0x4d505254;
+
+constexpr uint32_t kShmMetricsVersion = 1;
+
+/// @brief The maximum size of the key of a record, which is the series id in the Prometheus text format such as
+///        `rpc_server_handled_total{callee_method="SayHello",code="0"}`. Series with longer keys are not published.
+constexpr size_t kShmMetricsKeyWords = 30;
+constexpr size_t kShmMetricsMaxKeySize = kShmMetricsKeyWords * sizeof(uint64_t);
+
+/// @brief The maximum number of buckets of a histogram record including the +Inf bucket. Histograms with more buckets
+///        are not published.
+constexpr size_t kShmMetricsMaxBuckets = 15;
+
+/// @brief The type of a record.
+enum class ShmMetricType : uint8_t {
+  kFree = 0,
+  kCounter = 1,
+  kGauge = 2,
+  kHistogram = 3,
+};
+
+struct ShmMetricsHeader {
+  /// kShmMetricsMagic once the header is initialized, 0 before
+  std::atomic<uint32_t> magic;
+  /// kShmMetricsVersion
+  uint32_t version;
+  /// The size of the header, which is the offset of the first record
+  uint32_t header_size;
+  /// The size of each record
+  uint32_t record_size;
+  /// The number of records in the file
+  uint32_t capacity;
+  /// The pid of the writer process
+  int32_t pid;
+  /// The number of records which have ever been used, which only grows
+  std::atomic<uint32_t> record_num;
+  uint32_t reserved;
+  /// The time of the latest publishing, in milliseconds since the epoch
+  std::atomic<uint64_t> update_ms;
+  uint64_t reserved2[3];
+};
+
+struct ShmMetricsRecord {
+  /// The seqlock sequence, which is odd while the record is being written
+  std::atomic<uint64_t> sequence;
+  /// The type in bits [0, 8), the number of buckets in bits [8, 16), and the size of the key in bits [16, 32)
+  std::atomic<uint64_t> meta;
+  /// The key, which is not null-terminated
+  std::atomic<uint64_t> key[kShmMetricsKeyWords];
+  /// The bits of the double value of the counter or the gauge, or the sum of the histogram
+  std::atomic<uint64_t> value;
+  /// The sample count of the histogram
+  std::atomic<uint64_t> count;
+  /// The bits of the double upper bounds of the buckets, the last one is +Inf
+  std::atomic<uint64_t> upper_bounds[kShmMetricsMaxBuckets];
+  /// The cumulative counts of the buckets
+  std::atomic<uint64_t> bucket_counts[kShmMetricsMaxBuckets];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "the atomics in shared memory must be lock-free");
+static_assert(sizeof(ShmMetricsHeader) == 64, "the layout of the header is fixed");
+static_assert(sizeof(ShmMetricsRecord) == 512, "the layout of the record is fixed");
+
+/// @brief Packs the meta of a record.
+inline uint64_t PackShmMetricsMeta(ShmMetricType type, size_t bucket_num, size_t key_size) {
+  return static_cast<uint64_t>(type) | (static_cast<uint64_t>(bucket_num) << 8) |
+         (static_cast<uint64_t>(key_size) << 16);
+}
+
+/// @brief Gets the size of the file with the capacity.
+inline size_t GetShmMetricsFileSize(uint32_t capacity) {
+  return sizeof(ShmMetricsHeader) + static_cast<size_t>(capacity) * sizeof(ShmMetricsRecord);
+}
+
+}  // namespace trpc::opentelemetry
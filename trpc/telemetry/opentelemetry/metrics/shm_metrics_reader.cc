@@ -0,0 +1,154 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#include "trpc/telemetry/opentelemetry/metrics/shm_metrics_reader.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace trpc::opentelemetry {
+
+namespace {
+
+// The maximum number of attempts to read a record which is being written
+constexpr int kMaxReadAttempts = 64;
+
+double BitsDouble(uint64_t bits) {
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+}  // namespace
+
+int ShmMetricsReader::Open(const std::string& path) {
+  Close();
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return -1;
+  }
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(ShmMetricsHeader)) {
+    ::close(fd);
+    return -1;
+  }
+  size_t size = static_cast<size_t>(st.st_size);
+  void* addr = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  // the mapping stays valid after closing the file
+  ::close(fd);
+  if (addr == MAP_FAILED) {
+    return -1;
+  }
+
+  const auto* header = static_cast<const ShmMetricsHeader*>(addr);
+  if (header->magic.load(std::memory_order_acquire) != kShmMetricsMagic || header->version != kShmMetricsVersion ||
+      header->header_size != sizeof(ShmMetricsHeader) || header->record_size != sizeof(ShmMetricsRecord) ||
+      size < GetShmMetricsFileSize(header->capacity)) {
+    ::munmap(addr, size);
+    return -1;
+  }
+
+  addr_ = addr;
+  size_ = size;
+  header_ = header;
+  records_ = reinterpret_cast<const ShmMetricsRecord*>(static_cast<const char*>(addr) + sizeof(ShmMetricsHeader));
+  return 0;
+}
+
+void ShmMetricsReader::Close() {
+  if (!header_) {
+    return;
+  }
+  ::munmap(addr_, size_);
+  addr_ = nullptr;
+  size_ = 0;
+  header_ = nullptr;
+  records_ = nullptr;
+}
+
+bool ShmMetricsReader::Read(uint32_t record_index, ShmMetricsSample& sample) const {
+  if (!header_ || record_index >= header_->capacity) {
+    return false;
+  }
+
+  const ShmMetricsRecord& record = records_[record_index];
+  char key[kShmMetricsMaxKeySize];
+  for (int attempt = 0; attempt < kMaxReadAttempts; ++attempt) {
+    uint64_t sequence = record.sequence.load(std::memory_order_acquire);
+    if (sequence & 1) {
+      continue;
+    }
+
+    uint64_t meta = record.meta.load(std::memory_order_relaxed);
+    auto type = static_cast<ShmMetricType>(meta & 0xff);
+    // the fields are validated after the sequence is checked, as they may be torn
+    size_t bucket_num = std::min<size_t>((meta >> 8) & 0xff, kShmMetricsMaxBuckets);
+    size_t key_size = std::min<size_t>((meta >> 16) & 0xffff, kShmMetricsMaxKeySize);
+    for (size_t i = 0; i * sizeof(uint64_t) < key_size; ++i) {
+      uint64_t word = record.key[i].load(std::memory_order_relaxed);
+      std::memcpy(key + i * sizeof(uint64_t), &word, sizeof(word));
+    }
+    uint64_t value = record.value.load(std::memory_order_relaxed);
+    uint64_t count = record.count.load(std::memory_order_relaxed);
+    sample.upper_bounds.resize(bucket_num);
+    sample.bucket_counts.resize(bucket_num);
+    for (size_t i = 0; i < bucket_num; ++i) {
+      sample.upper_bounds[i] = BitsDouble(record.upper_bounds[i].load(std::memory_order_relaxed));
+      sample.bucket_counts[i] = record.bucket_counts[i].load(std::memory_order_relaxed);
+    }
+
+    // the loads above are not reordered after the second load of the sequence
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (record.sequence.load(std::memory_order_relaxed) != sequence) {
+      continue;
+    }
+
+    if (type == ShmMetricType::kFree) {
+      return false;
+    }
+    sample.type = type;
+    sample.key.assign(key, key_size);
+    sample.value = BitsDouble(value);
+    sample.count = count;
+    if (type != ShmMetricType::kHistogram) {
+      sample.upper_bounds.clear();
+      sample.bucket_counts.clear();
+    }
+    return true;
+  }
+  return false;
+}
+
+size_t ShmMetricsReader::ForEach(const std::function<void(const ShmMetricsSample& sample)>& visitor) const {
+  if (!header_) {
+    return 0;
+  }
+
+  size_t visited = 0;
+  ShmMetricsSample sample;
+  uint32_t record_num = std::min(header_->record_num.load(std::memory_order_acquire), header_->capacity);
+  for (uint32_t i = 0; i < record_num; ++i) {
+    if (Read(i, sample)) {
+      visitor(sample);
+      ++visited;
+    }
+  }
+  return visited;
+}
+
+}  // namespace trpc::opentelemetry
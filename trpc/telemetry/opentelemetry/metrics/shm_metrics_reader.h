@@ -0,0 +1,82 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "trpc/telemetry/opentelemetry/metrics/shm_metrics_layout.h"
+
+namespace trpc::opentelemetry {
+
+/// @brief A series read from the shared memory file.
+struct ShmMetricsSample {
+  ShmMetricType type = ShmMetricType::kFree;
+  /// The series id in the Prometheus text format, such as `rpc_server_handled_total{code="0"}`
+  std::string key;
+  /// The value of the counter or the gauge, or the sum of the histogram
+  double value = 0;
+  /// The sample count of the histogram
+  uint64_t count = 0;
+  /// The upper bounds and the cumulative counts of the buckets of the histogram, the last bucket is +Inf
+  std::vector<double> upper_bounds;
+  std::vector<uint64_t> bucket_counts;
+};
+
+/// @brief Reads the metrics published by ShmMetricsWriter, which is what the local agent does. It depends on nothing
+///        but the layout, and reading the series only accesses the mapped memory without any system call.
+/// @note A reader can be used by one thread at a time.
+class ShmMetricsReader {
+ public:
+  ShmMetricsReader() = default;
+  ~ShmMetricsReader() { Close(); }
+
+  ShmMetricsReader(const ShmMetricsReader&) = delete;
+  ShmMetricsReader& operator=(const ShmMetricsReader&) = delete;
+
+  /// @brief Maps the file read-only, and checks its header.
+  /// @param path the path of the file
+  /// @return Return 0 on success, -1 if the file can not be mapped or is not a metrics file of a known version.
+  int Open(const std::string& path);
+
+  void Close();
+
+  /// @brief Gets the pid of the writer process, which can be used to find the files of the exited processes.
+  int32_t GetPid() const { return header_ ? header_->pid : 0; }
+
+  /// @brief Gets the time of the latest publishing, in milliseconds since the epoch.
+  uint64_t GetUpdateTime() const { return header_ ? header_->update_ms.load(std::memory_order_acquire) : 0; }
+
+  /// @brief Reads the series of the record.
+  /// @param record_index the index of the record
+  /// @param [out] sample the series, whose buffers are reused
+  /// @return Return true if the record is in use and read consistently, false if it is free or keeps being written.
+  bool Read(uint32_t record_index, ShmMetricsSample& sample) const;
+
+  /// @brief Reads all the series in the file.
+  /// @param visitor the function called with each series, whose argument is only valid during the call
+  /// @return Return the number of visited series.
+  size_t ForEach(const std::function<void(const ShmMetricsSample& sample)>& visitor) const;
+
+ private:
+  void* addr_ = nullptr;
+  size_t size_ = 0;
+  const ShmMetricsHeader* header_ = nullptr;
+  const ShmMetricsRecord* records_ = nullptr;
+};
+
+}  // namespace trpc::opentelemetry
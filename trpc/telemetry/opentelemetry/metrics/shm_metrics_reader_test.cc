@@ -0,0 +1,90 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#include "trpc/telemetry/opentelemetry/metrics/shm_metrics_reader.h"
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace trpc::testing {
+
+namespace {
+
+void WriteFile(const std::string& path, const std::vector<char>& content) {
+  FILE* file = std::fopen(path.c_str(), "wb");
+  ASSERT_NE(nullptr, file);
+  std::fwrite(content.data(), 1, content.size(), file);
+  std::fclose(file);
+}
+
+}  // namespace
+
+TEST(ShmMetricsReaderTest, OpenInvalidFile) {
+  std::string path = ::testing::TempDir() + "shm_metrics_reader_test." + std::to_string(::getpid());
+  trpc::opentelemetry::ShmMetricsReader reader;
+  ASSERT_EQ(-1, reader.Open(path));
+
+  // too small to have a header
+  WriteFile(path, std::vector<char>(16));
+  ASSERT_EQ(-1, reader.Open(path));
+
+  // not initialized by the writer
+  std::vector<char> content(trpc::opentelemetry::GetShmMetricsFileSize(1));
+  WriteFile(path, content);
+  ASSERT_EQ(-1, reader.Open(path));
+
+  // the records are truncated
+  auto* header = reinterpret_cast<trpc::opentelemetry::ShmMetricsHeader*>(content.data());
+  header->magic.store(trpc::opentelemetry::kShmMetricsMagic);
+  header->version = trpc::opentelemetry::kShmMetricsVersion;
+  header->header_size = sizeof(trpc::opentelemetry::ShmMetricsHeader);
+  header->record_size = sizeof(trpc::opentelemetry::ShmMetricsRecord);
+  header->capacity = 2;
+  WriteFile(path, content);
+  ASSERT_EQ(-1, reader.Open(path));
+
+  header->capacity = 1;
+  WriteFile(path, content);
+  ASSERT_EQ(0, reader.Open(path));
+  trpc::opentelemetry::ShmMetricsSample sample;
+  ASSERT_FALSE(reader.Read(0, sample));
+  ASSERT_FALSE(reader.Read(1, sample));
+  ASSERT_EQ(0, reader.ForEach([](const trpc::opentelemetry::ShmMetricsSample&) {}));
+
+  // a record which keeps being written can not be read
+  auto* record = reinterpret_cast<trpc::opentelemetry::ShmMetricsRecord*>(
+      content.data() + sizeof(trpc::opentelemetry::ShmMetricsHeader));
+  record->sequence.store(1);
+  record->meta.store(trpc::opentelemetry::PackShmMetricsMeta(trpc::opentelemetry::ShmMetricType::kGauge, 0, 0));
+  header->record_num.store(1);
+  WriteFile(path, content);
+  ASSERT_EQ(0, reader.Open(path));
+  ASSERT_FALSE(reader.Read(0, sample));
+
+  record->sequence.store(2);
+  WriteFile(path, content);
+  ASSERT_EQ(0, reader.Open(path));
+  ASSERT_TRUE(reader.Read(0, sample));
+  ASSERT_EQ(trpc::opentelemetry::ShmMetricType::kGauge, sample.type);
+  ASSERT_EQ(1, reader.ForEach([](const trpc::opentelemetry::ShmMetricsSample&) {}));
+
+  reader.Close();
+  ::unlink(path.c_str());
+}
+
+}  // namespace trpc::testing
@@ -0,0 +1,275 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
+#include "trpc/telemetry/opentelemetry/metrics/shm_metrics_writer.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "trpc/util/log/logging.h"
+
+namespace trpc::opentelemetry {
+
+namespace {
+
+ShmMetricType ToShmMetricType(::prometheus::MetricType type) {
+  switch (type) {
+    case ::prometheus::MetricType::Counter:
+      return ShmMetricType::kCounter;
+    case ::prometheus::MetricType::Gauge:
+      return ShmMetricType::kGauge;
+    case ::prometheus::MetricType::Histogram:
+      return ShmMetricType::kHistogram;
+    default:
+      return ShmMetricType::kFree;
+  }
+}
+
+uint64_t DoubleBits(double value) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+// Appends the label value escaped as the Prometheus text format
+void AppendEscaped(const std::string& value, std::string& out) {
+  for (char c : value) {
+    if (c == '\\') {
+      out.append("\\\\");
+    } else if (c == '"') {
+      out.append("\\\"");
+    } else if (c == '\n') {
+      out.append("\\n");
+    } else {
+      out.push_back(c);
+    }
+  }
+}
+
+}  // namespace
+
+int ShmMetricsWriter::Open(const std::string& path, uint32_t capacity) {
+  Close();
+  if (capacity == 0) {
+    TRPC_FMT_ERROR("capacity of shm metrics file {} should be greater than 0", path);
+    return -1;
+  }
+
+  int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    TRPC_FMT_ERROR("open shm metrics file {} failed: {}", path, std::strerror(errno));
+    return -1;
+  }
+  size_t size = GetShmMetricsFileSize(capacity);
+  // the file is zero-filled, so all the records are free
+  if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    TRPC_FMT_ERROR("truncate shm metrics file {} failed: {}", path, std::strerror(errno));
+    ::close(fd);
+    ::unlink(path.c_str());
+    return -1;
+  }
+  void* addr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (addr == MAP_FAILED) {
+    TRPC_FMT_ERROR("map shm metrics file {} failed: {}", path, std::strerror(errno));
+    ::close(fd);
+    ::unlink(path.c_str());
+    return -1;
+  }
+
+  path_ = path;
+  fd_ = fd;
+  addr_ = addr;
+  size_ = size;
+  capacity_ = capacity;
+  header_ = static_cast<ShmMetricsHeader*>(addr);
+  records_ = reinterpret_cast<ShmMetricsRecord*>(static_cast<char*>(addr) + sizeof(ShmMetricsHeader));
+
+  header_->version = kShmMetricsVersion;
+  header_->header_size = sizeof(ShmMetricsHeader);
+  header_->record_size = sizeof(ShmMetricsRecord);
+  header_->capacity = capacity;
+  header_->pid = ::getpid();
+  // the magic is stored last, so that the readers never see a partially initialized header
+  header_->magic.store(kShmMetricsMagic, std::memory_order_release);
+  return 0;
+}
+
+void ShmMetricsWriter::Close() {
+  if (!header_) {
+    return;
+  }
+  ::munmap(addr_, size_);
+  ::close(fd_);
+  ::unlink(path_.c_str());
+
+  fd_ = -1;
+  addr_ = nullptr;
+  size_ = 0;
+  header_ = nullptr;
+  records_ = nullptr;
+  capacity_ = 0;
+  index_.clear();
+  free_records_.clear();
+}
+
+size_t ShmMetricsWriter::Publish(const std::vector<::prometheus::MetricFamily>& families, uint64_t now_ms) {
+  if (!header_) {
+    return 0;
+  }
+
+  ++generation_;
+  size_t skipped = 0;
+  for (const auto& family : families) {
+    ShmMetricType type = ToShmMetricType(family.type);
+    if (type == ShmMetricType::kFree) {
+      continue;
+    }
+    for (const auto& metric : family.metric) {
+      if (type == ShmMetricType::kHistogram && metric.histogram.bucket.size() > kShmMetricsMaxBuckets) {
+        ++skipped;
+        continue;
+      }
+      if (!BuildKey(family.name, metric)) {
+        ++skipped;
+        continue;
+      }
+      bool is_new = false;
+      ShmMetricsRecord* record = GetRecord(is_new);
+      if (!record) {
+        ++skipped;
+        continue;
+      }
+
+      BeginWrite(*record);
+      if (is_new) {
+        WriteKey(*record);
+      }
+      WriteValues(*record, type, metric);
+      EndWrite(*record);
+    }
+  }
+  FreeAbsentRecords();
+  header_->update_ms.store(now_ms, std::memory_order_release);
+  return skipped;
+}
+
+bool ShmMetricsWriter::BuildKey(const std::string& name, const ::prometheus::ClientMetric& metric) {
+  key_.assign(name);
+  if (!metric.label.empty()) {
+    key_.push_back('{');
+    for (size_t i = 0; i < metric.label.size(); ++i) {
+      if (i != 0) {
+        key_.push_back(',');
+      }
+      key_.append(metric.label[i].name).append("=\"");
+      AppendEscaped(metric.label[i].value, key_);
+      key_.push_back('"');
+    }
+    key_.push_back('}');
+  }
+  return key_.size() <= kShmMetricsMaxKeySize;
+}
+
+ShmMetricsRecord* ShmMetricsWriter::GetRecord(bool& is_new) {
+  auto it = index_.find(key_);
+  if (it != index_.end()) {
+    it->second.generation = generation_;
+    is_new = false;
+    return &records_[it->second.record_index];
+  }
+
+  uint32_t record_index = 0;
+  if (!free_records_.empty()) {
+    record_index = free_records_.back();
+    free_records_.pop_back();
+  } else {
+    // the record is free until it is written under the seqlock, so it can be counted in before being written
+    record_index = header_->record_num.load(std::memory_order_relaxed);
+    if (record_index >= capacity_) {
+      return nullptr;
+    }
+    header_->record_num.store(record_index + 1, std::memory_order_release);
+  }
+  index_.emplace(key_, Entry{record_index, generation_});
+  is_new = true;
+  return &records_[record_index];
+}
+
+void ShmMetricsWriter::WriteKey(ShmMetricsRecord& record) {
+  for (size_t i = 0; i * sizeof(uint64_t) < key_.size(); ++i) {
+    size_t offset = i * sizeof(uint64_t);
+    uint64_t word = 0;
+    std::memcpy(&word, key_.data() + offset, std::min(sizeof(uint64_t), key_.size() - offset));
+    record.key[i].store(word, std::memory_order_relaxed);
+  }
+}
+
+void ShmMetricsWriter::WriteValues(ShmMetricsRecord& record, ShmMetricType type,
+                                   const ::prometheus::ClientMetric& metric) {
+  size_t bucket_num = type == ShmMetricType::kHistogram ? metric.histogram.bucket.size() : 0;
+  record.meta.store(PackShmMetricsMeta(type, bucket_num, key_.size()), std::memory_order_relaxed);
+  switch (type) {
+    case ShmMetricType::kCounter:
+      record.value.store(DoubleBits(metric.counter.value), std::memory_order_relaxed);
+      break;
+    case ShmMetricType::kGauge:
+      record.value.store(DoubleBits(metric.gauge.value), std::memory_order_relaxed);
+      break;
+    case ShmMetricType::kHistogram:
+      record.value.store(DoubleBits(metric.histogram.sample_sum), std::memory_order_relaxed);
+      record.count.store(metric.histogram.sample_count, std::memory_order_relaxed);
+      for (size_t i = 0; i < bucket_num; ++i) {
+        record.upper_bounds[i].store(DoubleBits(metric.histogram.bucket[i].upper_bound), std::memory_order_relaxed);
+        record.bucket_counts[i].store(metric.histogram.bucket[i].cumulative_count, std::memory_order_relaxed);
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+void ShmMetricsWriter::FreeAbsentRecords() {
+  for (auto it = index_.begin(); it != index_.end();) {
+    if (it->second.generation == generation_) {
+      ++it;
+      continue;
+    }
+    ShmMetricsRecord& record = records_[it->second.record_index];
+    BeginWrite(record);
+    record.meta.store(PackShmMetricsMeta(ShmMetricType::kFree, 0, 0), std::memory_order_relaxed);
+    EndWrite(record);
+    free_records_.push_back(it->second.record_index);
+    it = index_.erase(it);
+  }
+}
+
+void ShmMetricsWriter::BeginWrite(ShmMetricsRecord& record) {
+  uint64_t sequence = record.sequence.load(std::memory_order_relaxed);
+  record.sequence.store(sequence + 1, std::memory_order_relaxed);
+  // the odd sequence is visible before any of the following writes
+  std::atomic_thread_fence(std::memory_order_release);
+}
+
+void ShmMetricsWriter::EndWrite(ShmMetricsRecord& record) {
+  uint64_t sequence = record.sequence.load(std::memory_order_relaxed);
+  record.sequence.store(sequence + 1, std::memory_order_release);
+}
+
+}  // namespace trpc::opentelemetry
+#endif
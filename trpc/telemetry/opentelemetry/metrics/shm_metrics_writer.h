@@ -0,0 +1,105 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "prometheus/metric_family.h"
+
+#include "trpc/telemetry/opentelemetry/metrics/shm_metrics_layout.h"
+
+namespace trpc::opentelemetry {
+
+/// @brief Publishes the collected metrics into a memory-mapped file in the layout of shm_metrics_layout.h, so that a
+///        local agent can read the metrics of all the processes on the host without scraping each of them.
+/// @note Publish should be called by a single thread. The counters, gauges and histograms are published, and the
+///       summaries are not.
+class ShmMetricsWriter {
+ public:
+  ShmMetricsWriter() = default;
+  ~ShmMetricsWriter() { Close(); }
+
+  ShmMetricsWriter(const ShmMetricsWriter&) = delete;
+  ShmMetricsWriter& operator=(const ShmMetricsWriter&) = delete;
+
+  /// @brief Creates the file, which is truncated if it exists, and maps it into memory.
+  /// @param path the path of the file, which should be on a memory file system such as /dev/shm
+  /// @param capacity the maximum number of series in the file
+  /// @return Return 0 on success, -1 on failure.
+  int Open(const std::string& path, uint32_t capacity);
+
+  /// @brief Unmaps and removes the file, so that the agent stops reading the metrics of the exited process.
+  void Close();
+
+  /// @brief Publishes the series of the families. The records of the series which were published before but are
+  ///        absent now are freed and reused by the new series.
+  /// @param families the metric families collected from the prometheus registry
+  /// @param now_ms the current time in milliseconds since the epoch
+  /// @return Return the number of series which are not published, because their keys are too long, they have too
+  ///         many buckets, or the file is full.
+  size_t Publish(const std::vector<::prometheus::MetricFamily>& families, uint64_t now_ms);
+
+  /// @brief Gets the number of published series.
+  size_t Size() const { return index_.size(); }
+
+ private:
+  struct Entry {
+    uint32_t record_index;
+    // the generation of the latest publishing which contains the series
+    uint64_t generation;
+  };
+
+  // Builds the key of the series into key_, returns false if it is too long
+  bool BuildKey(const std::string& name, const ::prometheus::ClientMetric& metric);
+
+  // Gets the record of the series in key_, which is allocated if the series is new
+  ShmMetricsRecord* GetRecord(bool& is_new);
+
+  // Writes key_ into the record
+  void WriteKey(ShmMetricsRecord& record);
+
+  void WriteValues(ShmMetricsRecord& record, ShmMetricType type, const ::prometheus::ClientMetric& metric);
+
+  // Frees the records of the series absent from the latest publishing
+  void FreeAbsentRecords();
+
+  static void BeginWrite(ShmMetricsRecord& record);
+
+  static void EndWrite(ShmMetricsRecord& record);
+
+ private:
+  std::string path_;
+  int fd_ = -1;
+  void* addr_ = nullptr;
+  size_t size_ = 0;
+  ShmMetricsHeader* header_ = nullptr;
+  ShmMetricsRecord* records_ = nullptr;
+  uint32_t capacity_ = 0;
+
+  // the records of the published series, key: the key of the series
+  std::unordered_map<std::string, Entry> index_;
+  std::vector<uint32_t> free_records_;
+  uint64_t generation_ = 0;
+
+  // reused for building the keys
+  std::string key_;
+};
+
+}  // namespace trpc::opentelemetry
+#endif
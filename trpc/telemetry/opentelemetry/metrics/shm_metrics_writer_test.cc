@@ -0,0 +1,217 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
+#include "trpc/telemetry/opentelemetry/metrics/shm_metrics_writer.h"
+
+#include <unistd.h>
+
+#include <atomic>
+#include <limits>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "trpc/telemetry/opentelemetry/metrics/shm_metrics_reader.h"
+
+namespace trpc::testing {
+
+namespace {
+
+::prometheus::MetricFamily CreateCounterFamily(const std::string& name, const std::vector<std::string>& codes,
+                                               double value) {
+  ::prometheus::MetricFamily family;
+  family.name = name;
+  family.type = ::prometheus::MetricType::Counter;
+  for (const auto& code : codes) {
+    ::prometheus::ClientMetric metric;
+    metric.label.push_back({"code", code});
+    metric.counter.value = value;
+    family.metric.push_back(std::move(metric));
+  }
+  return family;
+}
+
+::prometheus::MetricFamily CreateHistogramFamily(const std::string& name, size_t bucket_num, uint64_t count) {
+  ::prometheus::MetricFamily family;
+  family.name = name;
+  family.type = ::prometheus::MetricType::Histogram;
+  ::prometheus::ClientMetric metric;
+  metric.histogram.sample_count = count;
+  metric.histogram.sample_sum = static_cast<double>(count) * 2;
+  for (size_t i = 0; i < bucket_num; ++i) {
+    ::prometheus::ClientMetric::Bucket bucket;
+    bucket.upper_bound = i + 1 == bucket_num ? std::numeric_limits<double>::infinity() : static_cast<double>(i + 1);
+    bucket.cumulative_count = i + 1 == bucket_num ? count : count * i / bucket_num;
+    metric.histogram.bucket.push_back(bucket);
+  }
+  family.metric.push_back(std::move(metric));
+  return family;
+}
+
+std::map<std::string, trpc::opentelemetry::ShmMetricsSample> ReadAll(
+    const trpc::opentelemetry::ShmMetricsReader& reader) {
+  std::map<std::string, trpc::opentelemetry::ShmMetricsSample> samples;
+  reader.ForEach([&samples](const trpc::opentelemetry::ShmMetricsSample& sample) { samples[sample.key] = sample; });
+  return samples;
+}
+
+}  // namespace
+
+class ShmMetricsWriterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    path_ = ::testing::TempDir() + "shm_metrics_writer_test." + std::to_string(::getpid());
+  }
+
+ protected:
+  std::string path_;
+};
+
+TEST_F(ShmMetricsWriterTest, Publish) {
+  trpc::opentelemetry::ShmMetricsWriter writer;
+  ASSERT_EQ(0, writer.Open(path_, 16));
+
+  std::vector<::prometheus::MetricFamily> families;
+  families.push_back(CreateCounterFamily("rpc_server_handled_total", {"0", "a\"b"}, 3));
+  families.push_back(CreateHistogramFamily("rpc_server_handled_seconds", 3, 10));
+  ::prometheus::MetricFamily gauge_family;
+  gauge_family.name = "rpc_server_inflight";
+  gauge_family.type = ::prometheus::MetricType::Gauge;
+  gauge_family.metric.emplace_back();
+  gauge_family.metric.back().gauge.value = -1.5;
+  families.push_back(gauge_family);
+  ASSERT_EQ(0, writer.Publish(families, 1000));
+  ASSERT_EQ(4, writer.Size());
+
+  trpc::opentelemetry::ShmMetricsReader reader;
+  ASSERT_EQ(0, reader.Open(path_));
+  ASSERT_EQ(::getpid(), reader.GetPid());
+  ASSERT_EQ(1000, reader.GetUpdateTime());
+
+  auto samples = ReadAll(reader);
+  ASSERT_EQ(4, samples.size());
+  auto& counter = samples["rpc_server_handled_total{code=\"0\"}"];
+  ASSERT_EQ(trpc::opentelemetry::ShmMetricType::kCounter, counter.type);
+  ASSERT_EQ(3, counter.value);
+  ASSERT_EQ(1, samples.count("rpc_server_handled_total{code=\"a\\\"b\"}"));
+  auto& gauge = samples["rpc_server_inflight"];
+  ASSERT_EQ(trpc::opentelemetry::ShmMetricType::kGauge, gauge.type);
+  ASSERT_EQ(-1.5, gauge.value);
+  auto& histogram = samples["rpc_server_handled_seconds"];
+  ASSERT_EQ(trpc::opentelemetry::ShmMetricType::kHistogram, histogram.type);
+  ASSERT_EQ(20, histogram.value);
+  ASSERT_EQ(10, histogram.count);
+  ASSERT_EQ((std::vector<double>{1, 2, std::numeric_limits<double>::infinity()}), histogram.upper_bounds);
+  ASSERT_EQ((std::vector<uint64_t>{0, 3, 10}), histogram.bucket_counts);
+
+  // the values are updated in place
+  families[0] = CreateCounterFamily("rpc_server_handled_total", {"0", "a\"b"}, 5);
+  ASSERT_EQ(0, writer.Publish(families, 2000));
+  samples = ReadAll(reader);
+  ASSERT_EQ(5, samples["rpc_server_handled_total{code=\"0\"}"].value);
+  ASSERT_EQ(2000, reader.GetUpdateTime());
+
+  // the file is removed when the writer is closed
+  writer.Close();
+  ASSERT_NE(0, ::access(path_.c_str(), F_OK));
+}
+
+TEST_F(ShmMetricsWriterTest, ReuseRecord) {
+  trpc::opentelemetry::ShmMetricsWriter writer;
+  ASSERT_EQ(0, writer.Open(path_, 2));
+  trpc::opentelemetry::ShmMetricsReader reader;
+  ASSERT_EQ(0, reader.Open(path_));
+
+  ASSERT_EQ(0, writer.Publish({CreateCounterFamily("counter", {"1", "2"}, 1)}, 1000));
+  ASSERT_EQ(2, ReadAll(reader).size());
+
+  // the file is full
+  ASSERT_EQ(1, writer.Publish({CreateCounterFamily("counter", {"1", "2", "3"}, 1)}, 1000));
+  auto samples = ReadAll(reader);
+  ASSERT_EQ(2, samples.size());
+  ASSERT_EQ(0, samples.count("counter{code=\"3\"}"));
+
+  // the record of the absent series is freed, and reused by the new series
+  ASSERT_EQ(0, writer.Publish({CreateCounterFamily("counter", {"1"}, 1)}, 1000));
+  samples = ReadAll(reader);
+  ASSERT_EQ(1, samples.size());
+  ASSERT_EQ(1, samples.count("counter{code=\"1\"}"));
+
+  ASSERT_EQ(0, writer.Publish({CreateCounterFamily("counter", {"1", "3"}, 2)}, 1000));
+  samples = ReadAll(reader);
+  ASSERT_EQ(2, samples.size());
+  ASSERT_EQ(2, samples["counter{code=\"3\"}"].value);
+  ASSERT_EQ(2, writer.Size());
+}
+
+TEST_F(ShmMetricsWriterTest, SkipUnsupportedSeries) {
+  trpc::opentelemetry::ShmMetricsWriter writer;
+  ASSERT_EQ(-1, writer.Open(path_, 0));
+  ASSERT_EQ(0, writer.Open(path_, 16));
+
+  std::vector<::prometheus::MetricFamily> families;
+  families.push_back(CreateCounterFamily(std::string(trpc::opentelemetry::kShmMetricsMaxKeySize, 'a'), {"0"}, 1));
+  families.push_back(CreateHistogramFamily("too_many_buckets", trpc::opentelemetry::kShmMetricsMaxBuckets + 1, 1));
+  families.push_back(CreateHistogramFamily("max_buckets", trpc::opentelemetry::kShmMetricsMaxBuckets, 1));
+  ::prometheus::MetricFamily summary_family;
+  summary_family.name = "summary";
+  summary_family.type = ::prometheus::MetricType::Summary;
+  summary_family.metric.emplace_back();
+  families.push_back(summary_family);
+  ASSERT_EQ(2, writer.Publish(families, 1000));
+
+  trpc::opentelemetry::ShmMetricsReader reader;
+  ASSERT_EQ(0, reader.Open(path_));
+  auto samples = ReadAll(reader);
+  ASSERT_EQ(1, samples.size());
+  ASSERT_EQ(trpc::opentelemetry::kShmMetricsMaxBuckets, samples["max_buckets"].bucket_counts.size());
+}
+
+TEST_F(ShmMetricsWriterTest, ConcurrentRead) {
+  trpc::opentelemetry::ShmMetricsWriter writer;
+  ASSERT_EQ(0, writer.Open(path_, 16));
+  ASSERT_EQ(0, writer.Publish({CreateHistogramFamily("histogram", 10, 0)}, 0));
+
+  std::atomic<bool> stopped{false};
+  std::thread publisher([&writer, &stopped] {
+    for (uint64_t count = 1; count <= 20000; ++count) {
+      writer.Publish({CreateHistogramFamily("histogram", 10, count)}, count);
+    }
+    stopped = true;
+  });
+
+  trpc::opentelemetry::ShmMetricsReader reader;
+  ASSERT_EQ(0, reader.Open(path_));
+  trpc::opentelemetry::ShmMetricsSample sample;
+  uint64_t last_count = 0;
+  while (!stopped) {
+    if (!reader.Read(0, sample)) {
+      continue;
+    }
+    // a torn record would mix the fields of different publishing
+    ASSERT_EQ(sample.count, sample.bucket_counts.back());
+    ASSERT_EQ(static_cast<double>(sample.count) * 2, sample.value);
+    ASSERT_LE(last_count, sample.count);
+    last_count = sample.count;
+  }
+  publisher.join();
+  ASSERT_TRUE(reader.Read(0, sample));
+  ASSERT_EQ(20000, sample.count);
+}
+
+}  // namespace trpc::testing
+#endif
@@ -0,0 +1,107 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#include "trpc/telemetry/opentelemetry/metrics/slo_tracker.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace trpc::opentelemetry {
+
+namespace {
+
+constexpr uint64_t kCountMask = 0xffffffff;
+
+std::vector<uint32_t> NormalizeWindows(std::vector<uint32_t> windows) {
+  windows.erase(std::remove(windows.begin(), windows.end(), 0), windows.end());
+  std::sort(windows.begin(), windows.end());
+  windows.erase(std::unique(windows.begin(), windows.end()), windows.end());
+  return windows;
+}
+
+}  // namespace
+
+SloTracker::SloTracker(const OpenTelemetryMetricsSlo& objective, std::vector<uint32_t> windows)
+    : objective_(objective),
+      windows_(NormalizeWindows(std::move(windows))),
+      bucket_num_(windows_.empty() ? 1 : windows_.back() + 1),
+      buckets_(std::make_unique<Bucket[]>(bucket_num_)),
+      burn_rates_(std::make_unique<std::atomic<double>[]>(windows_.size())) {
+  for (size_t i = 0; i < windows_.size(); ++i) {
+    burn_rates_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void SloTracker::Record(uint64_t now_ms, uint64_t cost_ms, bool success) {
+  uint64_t second = now_ms / 1000;
+  Bucket& bucket = buckets_[second % bucket_num_];
+  Increment(bucket.total, second);
+  if (!success || (objective_.latency_threshold != 0 && cost_ms > objective_.latency_threshold)) {
+    Increment(bucket.bad, second);
+  }
+}
+
+void SloTracker::Update(uint64_t now_ms) {
+  uint64_t now_second = now_ms / 1000;
+  uint64_t total = 0;
+  uint64_t bad = 0;
+  size_t window_index = 0;
+  // accumulates the buckets from the newest to the oldest, and the burn rate of a window is computed when reaching
+  // its oldest second
+  for (uint64_t age = 0; age < bucket_num_ && window_index < windows_.size() && age <= now_second; ++age) {
+    uint64_t second = now_second - age;
+    const Bucket& bucket = buckets_[second % bucket_num_];
+    total += CountOf(bucket.total, second);
+    bad += CountOf(bucket.bad, second);
+
+    while (window_index < windows_.size() && windows_[window_index] == age + 1) {
+      double burn_rate = total == 0 ? 0 : static_cast<double>(bad) / total / (1 - objective_.target);
+      burn_rates_[window_index].store(burn_rate, std::memory_order_relaxed);
+      ++window_index;
+    }
+  }
+}
+
+double SloTracker::GetBurnRate(uint32_t window_seconds) const {
+  for (size_t i = 0; i < windows_.size(); ++i) {
+    if (windows_[i] == window_seconds) {
+      return burn_rates_[i].load(std::memory_order_relaxed);
+    }
+  }
+  return -1;
+}
+
+void SloTracker::Increment(std::atomic<uint64_t>& counter, uint64_t second) {
+  uint64_t tag = second << 32;
+  uint64_t old_value = counter.load(std::memory_order_relaxed);
+  uint64_t new_value = 0;
+  do {
+    uint64_t old_tag = old_value & ~kCountMask;
+    if (old_tag == tag) {
+      new_value = old_value + 1;
+    } else if (old_tag < tag) {
+      // the bucket belongs to an expired second
+      new_value = tag | 1;
+    } else {
+      // the bucket has been taken by a later second, which happens only if the clock goes backwards
+      return;
+    }
+  } while (!counter.compare_exchange_weak(old_value, new_value, std::memory_order_relaxed));
+}
+
+uint64_t SloTracker::CountOf(const std::atomic<uint64_t>& counter, uint64_t second) {
+  uint64_t value = counter.load(std::memory_order_relaxed);
+  return (value >> 32) == (second & kCountMask) ? (value & kCountMask) : 0;
+}
+
+}  // namespace trpc::opentelemetry
@@ -0,0 +1,93 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "trpc/telemetry/opentelemetry/opentelemetry_telemetry_conf.h"
+
+namespace trpc::opentelemetry {
+
+/// @brief Evaluates the burn rate of the error budget of a service level objective over several sliding windows.
+///        The calls are counted in a ring buffer of per-second buckets, and the burn rates are recomputed by Update,
+///        which should be called periodically, so that reading them is a single atomic load.
+/// @note The burn rate is the ratio of bad calls divided by the error budget (1 - target). A burn rate of 1 consumes
+///       exactly the budget over the window, and a burn rate of 14.4 over one hour consumes 2% of a 30-day budget.
+class SloTracker {
+ public:
+  /// @param objective the objective, whose target should be in (0, 1)
+  /// @param windows the sliding windows, in seconds
+  SloTracker(const OpenTelemetryMetricsSlo& objective, std::vector<uint32_t> windows);
+
+  SloTracker(const SloTracker&) = delete;
+  SloTracker& operator=(const SloTracker&) = delete;
+
+  /// @brief Gets the objective.
+  const OpenTelemetryMetricsSlo& GetObjective() const { return objective_; }
+
+  /// @brief Gets the sliding windows, in seconds.
+  const std::vector<uint32_t>& GetWindows() const { return windows_; }
+
+  /// @brief Checks whether the calls of the method are counted by the objective.
+  bool Matches(std::string_view service, std::string_view method) const {
+    return service == objective_.service && (objective_.method.empty() || method == objective_.method);
+  }
+
+  /// @brief Counts a call, which is lock-free.
+  /// @param now_ms the current time in milliseconds
+  /// @param cost_ms the latency of the call, in milliseconds
+  /// @param success whether the call succeeded
+  void Record(uint64_t now_ms, uint64_t cost_ms, bool success);
+
+  /// @brief Recomputes the burn rates of all the windows ending at now.
+  /// @param now_ms the current time in milliseconds
+  void Update(uint64_t now_ms);
+
+  /// @brief Gets the burn rate of the window computed by the latest Update.
+  /// @param window_seconds one of the windows
+  /// @return Return the burn rate, or -1 if the window is not configured.
+  double GetBurnRate(uint32_t window_seconds) const;
+
+ private:
+  // The number of calls in a second, tagged with the second in the high 32 bits so that a bucket of an expired second
+  // is reset by the same atomic operation that counts the call
+  struct Bucket {
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> bad{0};
+  };
+
+  static void Increment(std::atomic<uint64_t>& counter, uint64_t second);
+
+  static uint64_t CountOf(const std::atomic<uint64_t>& counter, uint64_t second);
+
+ private:
+  const OpenTelemetryMetricsSlo objective_;
+
+  // sorted in ascending order
+  std::vector<uint32_t> windows_;
+
+  // the buckets of the longest window and the current second
+  const size_t bucket_num_;
+  std::unique_ptr<Bucket[]> buckets_;
+
+  // the burn rates of the windows, in the same order as windows_
+  std::unique_ptr<std::atomic<double>[]> burn_rates_;
+};
+
+}  // namespace trpc::opentelemetry
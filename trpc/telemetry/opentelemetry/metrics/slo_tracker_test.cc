@@ -0,0 +1,114 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#include "trpc/telemetry/opentelemetry/metrics/slo_tracker.h"
+
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace trpc::testing {
+
+namespace {
+
+trpc::OpenTelemetryMetricsSlo CreateObjective() {
+  trpc::OpenTelemetryMetricsSlo objective;
+  objective.name = "test_slo";
+  objective.service = "trpc.test.helloworld.Greeter";
+  objective.method = "SayHello";
+  objective.target = 0.9;
+  objective.latency_threshold = 100;
+  return objective;
+}
+
+}  // namespace
+
+TEST(SloTrackerTest, Matches) {
+  trpc::opentelemetry::SloTracker tracker(CreateObjective(), {60});
+  ASSERT_TRUE(tracker.Matches("trpc.test.helloworld.Greeter", "SayHello"));
+  ASSERT_FALSE(tracker.Matches("trpc.test.helloworld.Greeter", "SayHi"));
+  ASSERT_FALSE(tracker.Matches("trpc.test.helloworld.Other", "SayHello"));
+
+  auto objective = CreateObjective();
+  objective.method = "";
+  trpc::opentelemetry::SloTracker service_tracker(objective, {60});
+  ASSERT_TRUE(service_tracker.Matches("trpc.test.helloworld.Greeter", "SayHi"));
+}
+
+TEST(SloTrackerTest, BurnRate) {
+  trpc::opentelemetry::SloTracker tracker(CreateObjective(), {10, 2, 10, 0});
+  ASSERT_EQ(std::vector<uint32_t>({2, 10}), tracker.GetWindows());
+  ASSERT_EQ(-1, tracker.GetBurnRate(60));
+
+  uint64_t now_ms = 1000000;
+  // 10 calls 5 seconds ago, 1 of which failed
+  for (int i = 0; i < 10; ++i) {
+    tracker.Record(now_ms - 5000, 10, i != 0);
+  }
+  // 10 calls in the current second, 1 of which is too slow and 1 of which failed
+  for (int i = 0; i < 10; ++i) {
+    tracker.Record(now_ms, i == 0 ? 200 : 10, i != 1);
+  }
+  ASSERT_EQ(0, tracker.GetBurnRate(2));
+
+  tracker.Update(now_ms);
+  // the ratio of bad calls is 0.2 in the last 2 seconds, and 0.15 in the last 10 seconds
+  ASSERT_DOUBLE_EQ(2, tracker.GetBurnRate(2));
+  ASSERT_DOUBLE_EQ(1.5, tracker.GetBurnRate(10));
+
+  // the calls slide out of the windows
+  tracker.Update(now_ms + 2000);
+  ASSERT_DOUBLE_EQ(0, tracker.GetBurnRate(2));
+  ASSERT_DOUBLE_EQ(1.5, tracker.GetBurnRate(10));
+  tracker.Update(now_ms + 6000);
+  ASSERT_DOUBLE_EQ(2, tracker.GetBurnRate(10));
+  tracker.Update(now_ms + 10000);
+  ASSERT_DOUBLE_EQ(0, tracker.GetBurnRate(10));
+
+  // the buckets of the expired seconds are reused
+  tracker.Record(now_ms + 11000, 10, false);
+  tracker.Update(now_ms + 11000);
+  ASSERT_DOUBLE_EQ(10, tracker.GetBurnRate(2));
+  ASSERT_DOUBLE_EQ(10, tracker.GetBurnRate(10));
+}
+
+TEST(SloTrackerTest, ConcurrentRecord) {
+  trpc::opentelemetry::SloTracker tracker(CreateObjective(), {60});
+
+  constexpr int kThreadNum = 4;
+  constexpr int kRecordNum = 10000;
+  uint64_t now_ms = 1000000;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadNum; ++i) {
+    threads.emplace_back([&tracker, now_ms]() {
+      for (int j = 0; j < kRecordNum; ++j) {
+        tracker.Record(now_ms + j % 3000, 10, j % 10 != 0);
+      }
+    });
+  }
+  std::thread update_thread([&tracker, now_ms]() {
+    for (int i = 0; i < 100; ++i) {
+      tracker.Update(now_ms + 3000);
+    }
+  });
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  update_thread.join();
+
+  tracker.Update(now_ms + 3000);
+  ASSERT_DOUBLE_EQ(1, tracker.GetBurnRate(60));
+}
+
+}  // namespace trpc::testing
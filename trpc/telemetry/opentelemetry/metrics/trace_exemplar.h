@@ -0,0 +1,53 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#pragma once
+
+#include <any>
+#include <cstdint>
+#include <cstring>
+
+#include "trpc/tracing/tracing_filter_index.h"
+
+#include "trpc/telemetry/opentelemetry/metrics/exemplar.h"
+#include "trpc/telemetry/opentelemetry/tracing/common.h"
+
+namespace trpc::opentelemetry {
+
+/// @brief Gets the exemplar context from the span which the tracing filter stores in the context.
+/// @tparam TracingSpan ServerTracingSpan or ClientTracingSpan
+/// @param context server context or client context
+/// @param tracing_index the filter data index of the tracing plugin
+/// @param [out] exemplar the trace id and span id of the span
+/// @return Return true if the span exists and is sampled, the unsampled requests only pay the lookup of the span.
+template <typename TracingSpan, typename ContextPtr>
+bool GetSampledExemplarContext(const ContextPtr& context, uint32_t tracing_index, ExemplarContext& exemplar) {
+  auto* tracing_span = context->template GetFilterData<TracingSpan>(tracing_index);
+  if (!tracing_span) {
+    return false;
+  }
+  auto* span = std::any_cast<OpenTelemetryTracingSpanPtr>(&tracing_span->span);
+  if (!span || span->get() == nullptr) {
+    return false;
+  }
+
+  auto span_context = (*span)->GetContext();
+  if (!span_context.IsSampled()) {
+    return false;
+  }
+  std::memcpy(exemplar.trace_id.data(), span_context.trace_id().Id().data(), exemplar.trace_id.size());
+  std::memcpy(exemplar.span_id.data(), span_context.span_id().Id().data(), exemplar.span_id.size());
+  return true;
+}
+
+}  // namespace trpc::opentelemetry
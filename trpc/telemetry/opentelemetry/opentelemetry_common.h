@@ -13,6 +13,8 @@
 
 #pragma once
 
+#include <cstdint>
+
 namespace trpc::opentelemetry {
 
 /// @brief OpenTelemetry telemetry name
@@ -21,4 +23,17 @@ constexpr char kOpenTelemetryTelemetryName[] = "opentelemetry";
 /// @brief OpenTelemetry logger name
 constexpr char kOpenTelemetryLoggerName[] = "opentelemetry";
 
+/// @brief The monotonic timestamps of the stages of a server-side RPC, which are captured at the filter points and are
+///        used to break down the latency. The unit is microseconds, and 0 means the stage has not been reached.
+/// @note They are captured once per RPC and shared by the server-side filters, see server_stages.h.
+struct ServerStageTimestamps {
+  /// the time when the request is received by the transport, which is converted from the receive timestamp of the
+  /// ServerContext
+  uint64_t recv_us = 0;
+  /// captured at SERVER_PRE_RPC_INVOKE
+  uint64_t dispatch_us = 0;
+  /// captured at SERVER_POST_RPC_INVOKE
+  uint64_t handled_us = 0;
+};
+
 }  // namespace trpc::opentelemetry
@@ -13,6 +13,8 @@
 
 #include "trpc/telemetry/opentelemetry/opentelemetry_server_filter.h"
 
+#include <algorithm>
+
 namespace trpc {
 
 OpenTelemetryServerFilter::OpenTelemetryServerFilter() {
@@ -38,25 +40,27 @@ int OpenTelemetryServerFilter::Init() {
 
 std::vector<FilterPoint> OpenTelemetryServerFilter::GetFilterPoint() {
   // the filter points of tracing
-  std::vector<FilterPoint> points = {FilterPoint::SERVER_PRE_RPC_INVOKE, FilterPoint::SERVER_POST_RPC_INVOKE};
+  std::vector<FilterPoint> points = tracing_filter_->GetFilterPoint();
 #ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
-  // the filter points of metrics
-  points.push_back(FilterPoint::SERVER_POST_RECV_MSG);
-  points.push_back(FilterPoint::SERVER_PRE_SEND_MSG);
+  // the filter points of metrics which are not hooked by tracing
+  for (auto point : metrics_filter_->GetFilterPoint()) {
+    if (std::find(points.begin(), points.end(), point) == points.end()) {
+      points.push_back(point);
+    }
+  }
 #endif
   return points;
 }
 
 void OpenTelemetryServerFilter::operator()(FilterStatus& status, FilterPoint point, const ServerContextPtr& context) {
   // deals with tracing filter point
-  if (point == FilterPoint::SERVER_PRE_RPC_INVOKE || point == FilterPoint::SERVER_POST_RPC_INVOKE) {
+  if (point == FilterPoint::SERVER_POST_RECV_MSG || point == FilterPoint::SERVER_PRE_RPC_INVOKE ||
+      point == FilterPoint::SERVER_POST_RPC_INVOKE) {
     tracing_filter_->operator()(status, point, context);
   }
 #ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
-  // deals with metrics filter point
-  if (point == FilterPoint::SERVER_POST_RECV_MSG || point == FilterPoint::SERVER_PRE_SEND_MSG) {
-    metrics_filter_->operator()(status, point, context);
-  }
+  // deals with metrics filter point, which hooks all the filter points
+  metrics_filter_->operator()(status, point, context);
 #endif
   status = FilterStatus::CONTINUE;
 }
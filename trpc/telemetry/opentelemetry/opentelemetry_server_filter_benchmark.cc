@@ -0,0 +1,103 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "trpc/codec/trpc/testing/trpc_protocol_testing.h"
+#include "trpc/common/config/trpc_config.h"
+#include "trpc/proto/testing/helloworld.pb.h"
+#include "trpc/server/rpc/rpc_service_impl.h"
+#include "trpc/server/service_adapter.h"
+#include "trpc/server/testing/server_context_testing.h"
+#include "trpc/telemetry/telemetry_factory.h"
+
+#include "trpc/telemetry/opentelemetry/opentelemetry_server_filter.h"
+#include "trpc/telemetry/opentelemetry/opentelemetry_telemetry.h"
+
+namespace {
+
+// the number of the contexts built at a time out of the timing, which amortizes the pauses of the timing
+constexpr size_t kContextBatch = 1024;
+
+std::shared_ptr<trpc::OpenTelemetryServerFilter> GetFilter() {
+  static std::shared_ptr<trpc::OpenTelemetryServerFilter> filter = [] {
+    trpc::TrpcConfig::GetInstance()->Init("./trpc/telemetry/opentelemetry/testing/opentelemetry_telemetry_test.yaml");
+    trpc::TelemetryPtr telemetry = trpc::MakeRefCounted<trpc::OpenTelemetryTelemetry>();
+    trpc::TelemetryFactory::GetInstance()->Register(telemetry);
+    telemetry->Init();
+    auto filter = std::make_shared<trpc::OpenTelemetryServerFilter>();
+    filter->Init();
+    return filter;
+  }();
+  return filter;
+}
+
+class ContextMaker {
+ public:
+  ContextMaker() {
+    trpc::ServiceAdapterOption option;
+    option.protocol = "trpc";
+    adapter_ = std::make_unique<trpc::ServiceAdapter>(std::move(option));
+    service_.SetAdapter(adapter_.get());
+  }
+
+  trpc::ServerContextPtr Make() {
+    trpc::testing::DummyTrpcProtocol req_data;
+    trpc::test::helloworld::HelloRequest hello_req;
+    trpc::NoncontiguousBuffer req_bin_data;
+    trpc::testing::PackTrpcRequest(req_data, static_cast<void*>(&hello_req), req_bin_data);
+    return trpc::testing::MakeTestServerContext("trpc", &service_, std::move(req_bin_data));
+  }
+
+ private:
+  std::unique_ptr<trpc::ServiceAdapter> adapter_;
+  trpc::RpcServiceImpl service_;
+};
+
+// The overhead of the telemetry filter for a RPC, which runs OpenTelemetryServerFilter at all the server filter points
+// in the order of the framework. It only uses the interfaces of the baseline, so that the same file measures the
+// filter before and after a change.
+void BM_ServerFilter(benchmark::State& state) {
+  auto filter = GetFilter();
+  ContextMaker maker;
+  std::vector<trpc::ServerContextPtr> contexts;
+  size_t index = 0;
+  for (auto _ : state) {
+    if (index == contexts.size()) {
+      // the contexts are built out of the timing, as the framework builds them before the filters
+      state.PauseTiming();
+      contexts.clear();
+      for (size_t i = 0; i < kContextBatch; ++i) {
+        contexts.push_back(maker.Make());
+      }
+      index = 0;
+      state.ResumeTiming();
+    }
+
+    const auto& context = contexts[index++];
+    trpc::FilterStatus status;
+    (*filter)(status, trpc::FilterPoint::SERVER_POST_RECV_MSG, context);
+    (*filter)(status, trpc::FilterPoint::SERVER_PRE_RPC_INVOKE, context);
+    (*filter)(status, trpc::FilterPoint::SERVER_POST_RPC_INVOKE, context);
+    (*filter)(status, trpc::FilterPoint::SERVER_PRE_SEND_MSG, context);
+    (*filter)(status, trpc::FilterPoint::SERVER_POST_SEND_MSG, context);
+  }
+}
+
+}  // namespace
+
+BENCHMARK(BM_ServerFilter);
+
+BENCHMARK_MAIN();
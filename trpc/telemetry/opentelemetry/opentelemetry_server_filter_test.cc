@@ -60,14 +60,16 @@ std::shared_ptr<OpenTelemetryServerFilter> OpenTelemetryServerFilterTest::filter
 TEST_F(OpenTelemetryServerFilterTest, GetFilterPoint) {
 #ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
   auto points = filter_->GetFilterPoint();
-  ASSERT_EQ(4, points.size());
+  ASSERT_EQ(5, points.size());
   ASSERT_TRUE(std::find(points.begin(), points.end(), FilterPoint::SERVER_PRE_RPC_INVOKE) != points.end());
   ASSERT_TRUE(std::find(points.begin(), points.end(), FilterPoint::SERVER_POST_RPC_INVOKE) != points.end());
   ASSERT_TRUE(std::find(points.begin(), points.end(), FilterPoint::SERVER_POST_RECV_MSG) != points.end());
   ASSERT_TRUE(std::find(points.begin(), points.end(), FilterPoint::SERVER_PRE_SEND_MSG) != points.end());
+  ASSERT_TRUE(std::find(points.begin(), points.end(), FilterPoint::SERVER_POST_SEND_MSG) != points.end());
 #else
   auto points = filter_->GetFilterPoint();
-  ASSERT_EQ(2, points.size());
+  ASSERT_EQ(3, points.size());
+  ASSERT_TRUE(std::find(points.begin(), points.end(), FilterPoint::SERVER_POST_RECV_MSG) != points.end());
   ASSERT_TRUE(std::find(points.begin(), points.end(), FilterPoint::SERVER_PRE_RPC_INVOKE) != points.end());
   ASSERT_TRUE(std::find(points.begin(), points.end(), FilterPoint::SERVER_POST_RPC_INVOKE) != points.end());
 #endif
@@ -86,11 +88,12 @@ TEST_F(OpenTelemetryServerFilterTest, DoFilter) {
   ServerContextPtr context = MakeTestServerContext("trpc", trpc_service.get(), std::move(req_bin_data));
 
   FilterStatus status;
+  (*filter_)(status, FilterPoint::SERVER_POST_RECV_MSG, context);
   (*filter_)(status, FilterPoint::SERVER_PRE_RPC_INVOKE, context);
   (*filter_)(status, FilterPoint::SERVER_POST_RPC_INVOKE, context);
 #ifdef TRPC_BUILD_INCLUDE_PROMETHEUS
-  (*filter_)(status, FilterPoint::SERVER_POST_RECV_MSG, context);
   (*filter_)(status, FilterPoint::SERVER_PRE_SEND_MSG, context);
+  (*filter_)(status, FilterPoint::SERVER_POST_SEND_MSG, context);
 #endif
 }
 
@@ -81,6 +81,13 @@ int OpenTelemetryTelemetry::InitLog() {
         TRPC_LOG_ERROR("Init of logging fail! ret:" << log_ret);
         return -1;
       }
+      if (config_.logs_config.tail_buffer_enabled) {
+        // the buffered logs of a request are flushed or discarded when deferred sampling decides on its span
+        tracing_->SetDeferredSampleListener(
+            [log = log_](const ::opentelemetry::trace::TraceId& trace_id,
+                         const ::opentelemetry::trace::SpanId& span_id,
+                         bool sampled) { log->OnDeferredSampled(trace_id, span_id, sampled); });
+      }
 
       DefaultLog::Logger logger;
       logger.config.min_level = GetLogLevel(config_.logs_config.level);
@@ -15,6 +15,7 @@
 
 #include "trpc/telemetry/opentelemetry/metrics/opentelemetry_metrics_api.h"
 #include "trpc/telemetry/opentelemetry/tracing/opentelemetry_tracing_api.h"
+#include "trpc/telemetry/opentelemetry/tracing/scoped_span.h"
 
 /// @brief OpenTelemetry plugin interfaces for user programing
 namespace trpc::opentelemetry {
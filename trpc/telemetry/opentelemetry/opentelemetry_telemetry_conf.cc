@@ -36,6 +36,18 @@ void OpenTelemetryMetricsCode::Display() const {
   TRPC_LOG_DEBUG("");
 }
 
+void OpenTelemetryMetricsSlo::Display() const {
+  TRPC_LOG_DEBUG("--------------------------------");
+
+  TRPC_FMT_DEBUG("name: {}", name);
+  TRPC_FMT_DEBUG("service: {}", service);
+  TRPC_FMT_DEBUG("method: {}", method);
+  TRPC_FMT_DEBUG("target: {}", target);
+  TRPC_FMT_DEBUG("latency_threshold: {}", latency_threshold);
+
+  TRPC_LOG_DEBUG("");
+}
+
 void OpenTelemetryMetricsConfig::Display() const {
   TRPC_LOG_DEBUG("--------------------------------");
 
@@ -51,11 +63,58 @@ void OpenTelemetryMetricsConfig::Display() const {
     TRPC_FMT_DEBUG("{} : {}", i, server_histogram_buckets[i]);
   }
 
+  TRPC_LOG_DEBUG("payload_histogram_buckets:");
+  for (size_t i = 0; i < payload_histogram_buckets.size(); i++) {
+    TRPC_FMT_DEBUG("{} : {}", i, payload_histogram_buckets[i]);
+  }
+
   TRPC_LOG_DEBUG("codes:");
   for (auto code : codes) {
     code.Display();
   }
 
+  TRPC_FMT_DEBUG("max_series_per_family: {}", max_series_per_family);
+  TRPC_LOG_DEBUG("family_max_series:");
+  for (auto& [family, max_series] : family_max_series) {
+    TRPC_FMT_DEBUG("{} : {}", family, max_series);
+  }
+  TRPC_FMT_DEBUG("series_ttl: {}", series_ttl);
+  TRPC_LOG_DEBUG("server_labels:");
+  for (auto& label : server_labels) {
+    TRPC_FMT_DEBUG("{}", label);
+  }
+  TRPC_LOG_DEBUG("client_labels:");
+  for (auto& label : client_labels) {
+    TRPC_FMT_DEBUG("{}", label);
+  }
+  TRPC_LOG_DEBUG("family_labels:");
+  for (auto& [family, labels] : family_labels) {
+    for (auto& label : labels) {
+      TRPC_FMT_DEBUG("{} : {}", family, label);
+    }
+  }
+  TRPC_FMT_DEBUG("enable_peer_metrics: {}", enable_peer_metrics);
+  TRPC_FMT_DEBUG("max_peers: {}", max_peers);
+  TRPC_LOG_DEBUG("slos:");
+  for (auto& slo : slos) {
+    slo.Display();
+  }
+  TRPC_LOG_DEBUG("slo_windows:");
+  for (size_t i = 0; i < slo_windows.size(); i++) {
+    TRPC_FMT_DEBUG("{} : {}", i, slo_windows[i]);
+  }
+  TRPC_FMT_DEBUG("enable_exemplar: {}", enable_exemplar);
+  TRPC_FMT_DEBUG("exemplar_interval: {}", exemplar_interval);
+  TRPC_FMT_DEBUG("collect_min_interval: {}", collect_min_interval);
+  TRPC_FMT_DEBUG("export_enabled: {}", export_enabled);
+  TRPC_FMT_DEBUG("export_interval: {}", export_interval);
+  TRPC_FMT_DEBUG("export_temporality: {}", export_temporality);
+  TRPC_FMT_DEBUG("export_batch_size: {}", export_batch_size);
+  TRPC_FMT_DEBUG("shm_export_enabled: {}", shm_export_enabled);
+  TRPC_FMT_DEBUG("shm_export_dir: {}", shm_export_dir);
+  TRPC_FMT_DEBUG("shm_export_interval: {}", shm_export_interval);
+  TRPC_FMT_DEBUG("shm_max_records: {}", shm_max_records);
+
   TRPC_LOG_DEBUG("");
 }
 
@@ -70,6 +129,19 @@ void OpenTelemetryLogsConfig::Display() const {
   for (auto resource : resources) {
     TRPC_LOG_DEBUG(resource.first << ":" << resource.second);
   }
+  TRPC_FMT_DEBUG("staging_enabled: {}", staging_enabled);
+  TRPC_FMT_DEBUG("staging_ring_size: {}", staging_ring_size);
+  TRPC_FMT_DEBUG("staging_drain_interval: {}", staging_drain_interval);
+  TRPC_FMT_DEBUG("staging_overflow_policy: {}", staging_overflow_policy);
+  TRPC_FMT_DEBUG("staging_sample_interval: {}", staging_sample_interval);
+  TRPC_FMT_DEBUG("tail_buffer_enabled: {}", tail_buffer_enabled);
+  TRPC_FMT_DEBUG("tail_buffer_max_bytes: {}", tail_buffer_max_bytes);
+  TRPC_FMT_DEBUG("tail_buffer_max_requests: {}", tail_buffer_max_requests);
+  TRPC_FMT_DEBUG("tail_buffer_ttl: {}", tail_buffer_ttl);
+  TRPC_FMT_DEBUG("rate_limit_enabled: {}", rate_limit_enabled);
+  TRPC_FMT_DEBUG("rate_limit_per_second: {}", rate_limit_per_second);
+  TRPC_FMT_DEBUG("rate_limit_burst: {}", rate_limit_burst);
+  TRPC_FMT_DEBUG("rate_limit_summary_interval: {}", rate_limit_summary_interval);
 
   TRPC_LOG_DEBUG("");
 }
@@ -82,6 +154,7 @@ void OpenTelemetryTracesConfig::Display() const {
   TRPC_FMT_DEBUG("deferred_sample_error: {}", deferred_sample_error);
   TRPC_FMT_DEBUG("deferred_sample_slow_duration: {}", deferred_sample_slow_duration);
   TRPC_FMT_DEBUG("disable_parent_sampling: {}", disable_parent_sampling);
+  TRPC_FMT_DEBUG("time_prefixed_trace_id: {}", time_prefixed_trace_id);
   TRPC_LOG_DEBUG("resources:");
   for (auto resource : resources) {
     TRPC_LOG_DEBUG(resource.first << ":" << resource.second);
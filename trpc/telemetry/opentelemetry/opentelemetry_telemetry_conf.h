@@ -37,11 +37,79 @@ struct OpenTelemetryMetricsCode {
   void Display() const;
 };
 
+/// @brief The service level objective of the server-side RPCs of a method.
+struct OpenTelemetryMetricsSlo {
+  /// The unique name of the objective
+  std::string name;
+  std::string service;
+  /// Empty means all the methods of the service
+  std::string method;
+  /// The expected ratio of good calls, such as 0.999
+  double target = 0.999;
+  /// Calls slower than this threshold are bad even if they succeed, 0 means only the call result is considered.
+  /// The unit of latency_threshold is milliseconds
+  uint32_t latency_threshold = 0;
+
+  void Display() const;
+};
+
 struct OpenTelemetryMetricsConfig {
   bool enabled = false;
   std::vector<double> client_histogram_buckets = {0.005, 0.01, 0.1, 0.5, 1, 5};
   std::vector<double> server_histogram_buckets = {0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 5};
+  /// The buckets of the request and response size histograms, which grow exponentially from 64B to 16MB by default.
+  /// The unit of payload_histogram_buckets is bytes
+  std::vector<double> payload_histogram_buckets = {64,     256,     1024,    4096,    16384,
+                                                   65536,  262144,  1048576, 4194304, 16777216};
   std::vector<OpenTelemetryMetricsCode> codes;
+  /// The maximum number of series in each metrics family, 0 means unlimited
+  uint32_t max_series_per_family = 0;
+  /// The maximum number of series for specific metrics families, which overrides max_series_per_family.
+  /// key: family name, value: the maximum number of series
+  std::map<std::string, uint32_t> family_max_series;
+  /// Series that have not been updated within this duration will be evicted, 0 means never evicting.
+  /// The unit of series_ttl is minutes
+  uint32_t series_ttl = 0;
+  /// The labels kept in the server-side RPC metrics, empty means keeping all the labels
+  std::vector<std::string> server_labels;
+  /// The labels kept in the client-side RPC metrics, empty means keeping all the labels
+  std::vector<std::string> client_labels;
+  /// The labels kept in specific RPC metrics families, which overrides server_labels and client_labels.
+  /// key: family name, value: the labels to keep
+  std::map<std::string, std::vector<std::string>> family_labels;
+  /// Whether to report the latency and failures of the client calls to each peer
+  bool enable_peer_metrics = false;
+  /// The maximum number of peers tracked by the peer metrics, the calls to the other peers are aggregated together
+  uint32_t max_peers = 50;
+  /// The service level objectives evaluated in process
+  std::vector<OpenTelemetryMetricsSlo> slos;
+  /// The sliding windows over which the burn rates of the objectives are evaluated.
+  /// The unit of slo_windows is seconds
+  std::vector<uint32_t> slo_windows = {60, 300, 3600};
+  /// Whether to attach the trace ids of the sampled spans to the latency histograms as exemplars
+  bool enable_exemplar = false;
+  /// The minimum interval between two exemplars of a histogram series.
+  /// The unit of exemplar_interval is milliseconds
+  uint32_t exemplar_interval = 1000;
+  /// The minimum interval between two serializations of the metrics by CollectOpenMetrics, the collections within the
+  /// interval get the cached text. The unit of collect_min_interval is milliseconds, 0 means serializing every time
+  uint32_t collect_min_interval = 0;
+  /// Whether to push the metrics to the collector of addr through protocol, besides exposing them to prometheus
+  bool export_enabled = false;
+  /// The unit of export_interval is milliseconds
+  uint32_t export_interval = 10000;
+  /// The aggregation temporality of the pushed counters and histograms, "delta" or "cumulative"
+  std::string export_temporality = "delta";
+  /// The maximum number of data points in each export request, 0 means unlimited
+  uint32_t export_batch_size = 1000;
+  /// Whether to publish the metrics into a shared memory file, from which a local agent can read them
+  bool shm_export_enabled = false;
+  /// The directory of the file, which is named trpc_metrics.<pid>
+  std::string shm_export_dir = "/dev/shm";
+  /// The unit of shm_export_interval is milliseconds
+  uint32_t shm_export_interval = 1000;
+  /// The maximum number of series in the file, the series beyond it are not published
+  uint32_t shm_max_records = 16384;
 
   void Display() const;
 };
@@ -52,6 +120,34 @@ struct OpenTelemetryLogsConfig {
   bool enable_sampler = false;
   bool enable_sampler_error = false;
   std::map<std::string, std::string> resources;
+  /// Whether to stage the log records in the rings of the logging threads, which are emitted by a drainer thread
+  bool staging_enabled = false;
+  /// The capacity of the ring of each logging thread, which is rounded up to a power of 2
+  uint32_t staging_ring_size = 4096;
+  /// The unit of drain interval is milliseconds
+  uint32_t staging_drain_interval = 100;
+  /// What to do when a ring fills up: "drop" drops the records when it is full, "sample" keeps one of every
+  /// staging_sample_interval records once it is half full
+  std::string staging_overflow_policy = "drop";
+  uint32_t staging_sample_interval = 10;
+  /// Whether to buffer the logs of the requests not sampled yet, which are reported if deferred sampling keeps the
+  /// request at last. It only works when enable_sampler and traces:enable_deferred_sample are true
+  bool tail_buffer_enabled = false;
+  /// The maximum bytes of the buffered logs of a request
+  uint32_t tail_buffer_max_bytes = 65536;
+  /// The maximum number of requests whose logs are buffered at the same time
+  uint32_t tail_buffer_max_requests = 10000;
+  /// The buffered logs of a request are discarded if the request is not decided within this duration, such as the logs
+  /// written after the local root span ends. The unit of ttl is milliseconds
+  uint32_t tail_buffer_ttl = 60000;
+  /// Whether to limit the rate of the logs of each call site, the suppressed logs are reported in summaries
+  bool rate_limit_enabled = false;
+  /// The logs allowed per second of each call site
+  uint32_t rate_limit_per_second = 100;
+  /// The logs allowed in a burst of each call site
+  uint32_t rate_limit_burst = 100;
+  /// The unit of summary interval is milliseconds
+  uint32_t rate_limit_summary_interval = 10000;
 
   void Display() const;
 };
@@ -63,6 +159,9 @@ struct OpenTelemetryTracesConfig {
   /// The unit of timeout is milliseconds
   int deferred_sample_slow_duration = 500;
   bool disable_parent_sampling = false;
+  /// Whether to put the unix seconds in the first 4 bytes of the trace ids, which gives the trace stores keyed by the
+  /// trace ids insertion locality
+  bool time_prefixed_trace_id = false;
   std::map<std::string, std::string> resources;
 
   void Display() const;
@@ -134,6 +134,41 @@ struct convert<trpc::OpenTelemetryMetricsCode> {
   }
 };
 
+template <>
+struct convert<trpc::OpenTelemetryMetricsSlo> {
+  static YAML::Node encode(const trpc::OpenTelemetryMetricsSlo& config) {
+    YAML::Node node;
+
+    node["name"] = config.name;
+    node["service"] = config.service;
+    node["method"] = config.method;
+    node["target"] = config.target;
+    node["latency_threshold"] = config.latency_threshold;
+
+    return node;
+  }
+
+  static bool decode(const YAML::Node& node, trpc::OpenTelemetryMetricsSlo& config) {
+    if (node["name"]) {
+      config.name = node["name"].as<std::string>();
+    }
+    if (node["service"]) {
+      config.service = node["service"].as<std::string>();
+    }
+    if (node["method"]) {
+      config.method = node["method"].as<std::string>();
+    }
+    if (node["target"]) {
+      config.target = node["target"].as<double>();
+    }
+    if (node["latency_threshold"]) {
+      config.latency_threshold = node["latency_threshold"].as<uint32_t>();
+    }
+
+    return true;
+  }
+};
+
 template <>
 struct convert<trpc::OpenTelemetryMetricsConfig> {
   static YAML::Node encode(const trpc::OpenTelemetryMetricsConfig& config) {
@@ -142,7 +177,29 @@ struct convert<trpc::OpenTelemetryMetricsConfig> {
     node["enabled"] = config.enabled;
     node["client_histogram_buckets"] = config.client_histogram_buckets;
     node["server_histogram_buckets"] = config.server_histogram_buckets;
+    node["payload_histogram_buckets"] = config.payload_histogram_buckets;
     node["codes"] = config.codes;
+    node["max_series_per_family"] = config.max_series_per_family;
+    node["family_max_series"] = config.family_max_series;
+    node["series_ttl"] = config.series_ttl;
+    node["server_labels"] = config.server_labels;
+    node["client_labels"] = config.client_labels;
+    node["family_labels"] = config.family_labels;
+    node["enable_peer_metrics"] = config.enable_peer_metrics;
+    node["max_peers"] = config.max_peers;
+    node["slos"] = config.slos;
+    node["slo_windows"] = config.slo_windows;
+    node["enable_exemplar"] = config.enable_exemplar;
+    node["exemplar_interval"] = config.exemplar_interval;
+    node["collect_min_interval"] = config.collect_min_interval;
+    node["export_enabled"] = config.export_enabled;
+    node["export_interval"] = config.export_interval;
+    node["export_temporality"] = config.export_temporality;
+    node["export_batch_size"] = config.export_batch_size;
+    node["shm_export_enabled"] = config.shm_export_enabled;
+    node["shm_export_dir"] = config.shm_export_dir;
+    node["shm_export_interval"] = config.shm_export_interval;
+    node["shm_max_records"] = config.shm_max_records;
 
     return node;
   }
@@ -163,6 +220,94 @@ struct convert<trpc::OpenTelemetryMetricsConfig> {
       config.server_histogram_buckets = node["server_histogram_buckets"].as<std::vector<double>>();
     }
 
+    if (node["payload_histogram_buckets"]) {
+      config.payload_histogram_buckets = node["payload_histogram_buckets"].as<std::vector<double>>();
+    }
+
+    if (node["max_series_per_family"]) {
+      config.max_series_per_family = node["max_series_per_family"].as<uint32_t>();
+    }
+
+    if (node["family_max_series"]) {
+      config.family_max_series = node["family_max_series"].as<std::map<std::string, uint32_t>>();
+    }
+
+    if (node["series_ttl"]) {
+      config.series_ttl = node["series_ttl"].as<uint32_t>();
+    }
+
+    if (node["server_labels"]) {
+      config.server_labels = node["server_labels"].as<std::vector<std::string>>();
+    }
+
+    if (node["client_labels"]) {
+      config.client_labels = node["client_labels"].as<std::vector<std::string>>();
+    }
+
+    if (node["family_labels"]) {
+      config.family_labels = node["family_labels"].as<std::map<std::string, std::vector<std::string>>>();
+    }
+
+    if (node["enable_peer_metrics"]) {
+      config.enable_peer_metrics = node["enable_peer_metrics"].as<bool>();
+    }
+
+    if (node["max_peers"]) {
+      config.max_peers = node["max_peers"].as<uint32_t>();
+    }
+
+    if (node["slos"]) {
+      config.slos = node["slos"].as<std::vector<trpc::OpenTelemetryMetricsSlo>>();
+    }
+
+    if (node["slo_windows"]) {
+      config.slo_windows = node["slo_windows"].as<std::vector<uint32_t>>();
+    }
+
+    if (node["enable_exemplar"]) {
+      config.enable_exemplar = node["enable_exemplar"].as<bool>();
+    }
+
+    if (node["exemplar_interval"]) {
+      config.exemplar_interval = node["exemplar_interval"].as<uint32_t>();
+    }
+
+    if (node["collect_min_interval"]) {
+      config.collect_min_interval = node["collect_min_interval"].as<uint32_t>();
+    }
+
+    if (node["export_enabled"]) {
+      config.export_enabled = node["export_enabled"].as<bool>();
+    }
+
+    if (node["export_interval"]) {
+      config.export_interval = node["export_interval"].as<uint32_t>();
+    }
+
+    if (node["export_temporality"]) {
+      config.export_temporality = node["export_temporality"].as<std::string>();
+    }
+
+    if (node["export_batch_size"]) {
+      config.export_batch_size = node["export_batch_size"].as<uint32_t>();
+    }
+
+    if (node["shm_export_enabled"]) {
+      config.shm_export_enabled = node["shm_export_enabled"].as<bool>();
+    }
+
+    if (node["shm_export_dir"]) {
+      config.shm_export_dir = node["shm_export_dir"].as<std::string>();
+    }
+
+    if (node["shm_export_interval"]) {
+      config.shm_export_interval = node["shm_export_interval"].as<uint32_t>();
+    }
+
+    if (node["shm_max_records"]) {
+      config.shm_max_records = node["shm_max_records"].as<uint32_t>();
+    }
+
     return true;
   }
 };
@@ -182,6 +327,32 @@ struct convert<trpc::OpenTelemetryLogsConfig> {
 
     node["resources"] = config.resources;
 
+    node["staging_enabled"] = config.staging_enabled;
+
+    node["staging_ring_size"] = config.staging_ring_size;
+
+    node["staging_drain_interval"] = config.staging_drain_interval;
+
+    node["staging_overflow_policy"] = config.staging_overflow_policy;
+
+    node["staging_sample_interval"] = config.staging_sample_interval;
+
+    node["tail_buffer_enabled"] = config.tail_buffer_enabled;
+
+    node["tail_buffer_max_bytes"] = config.tail_buffer_max_bytes;
+
+    node["tail_buffer_max_requests"] = config.tail_buffer_max_requests;
+
+    node["tail_buffer_ttl"] = config.tail_buffer_ttl;
+
+    node["rate_limit_enabled"] = config.rate_limit_enabled;
+
+    node["rate_limit_per_second"] = config.rate_limit_per_second;
+
+    node["rate_limit_burst"] = config.rate_limit_burst;
+
+    node["rate_limit_summary_interval"] = config.rate_limit_summary_interval;
+
     return node;
   }
 
@@ -206,6 +377,58 @@ struct convert<trpc::OpenTelemetryLogsConfig> {
       config.resources = node["resources"].as<std::map<std::string, std::string>>();
     }
 
+    if (node["staging_enabled"]) {
+      config.staging_enabled = node["staging_enabled"].as<bool>();
+    }
+
+    if (node["staging_ring_size"]) {
+      config.staging_ring_size = node["staging_ring_size"].as<uint32_t>();
+    }
+
+    if (node["staging_drain_interval"]) {
+      config.staging_drain_interval = node["staging_drain_interval"].as<uint32_t>();
+    }
+
+    if (node["staging_overflow_policy"]) {
+      config.staging_overflow_policy = node["staging_overflow_policy"].as<std::string>();
+    }
+
+    if (node["staging_sample_interval"]) {
+      config.staging_sample_interval = node["staging_sample_interval"].as<uint32_t>();
+    }
+
+    if (node["tail_buffer_enabled"]) {
+      config.tail_buffer_enabled = node["tail_buffer_enabled"].as<bool>();
+    }
+
+    if (node["tail_buffer_max_bytes"]) {
+      config.tail_buffer_max_bytes = node["tail_buffer_max_bytes"].as<uint32_t>();
+    }
+
+    if (node["tail_buffer_max_requests"]) {
+      config.tail_buffer_max_requests = node["tail_buffer_max_requests"].as<uint32_t>();
+    }
+
+    if (node["tail_buffer_ttl"]) {
+      config.tail_buffer_ttl = node["tail_buffer_ttl"].as<uint32_t>();
+    }
+
+    if (node["rate_limit_enabled"]) {
+      config.rate_limit_enabled = node["rate_limit_enabled"].as<bool>();
+    }
+
+    if (node["rate_limit_per_second"]) {
+      config.rate_limit_per_second = node["rate_limit_per_second"].as<uint32_t>();
+    }
+
+    if (node["rate_limit_burst"]) {
+      config.rate_limit_burst = node["rate_limit_burst"].as<uint32_t>();
+    }
+
+    if (node["rate_limit_summary_interval"]) {
+      config.rate_limit_summary_interval = node["rate_limit_summary_interval"].as<uint32_t>();
+    }
+
     return true;
   }
 };
@@ -225,6 +448,8 @@ struct convert<trpc::OpenTelemetryTracesConfig> {
 
     node["disable_parent_sampling"] = config.disable_parent_sampling;
 
+    node["time_prefixed_trace_id"] = config.time_prefixed_trace_id;
+
     node["resources"] = config.resources;
 
     return node;
@@ -251,6 +476,10 @@ struct convert<trpc::OpenTelemetryTracesConfig> {
       config.disable_parent_sampling = node["disable_parent_sampling"].as<bool>();
     }
 
+    if (node["time_prefixed_trace_id"]) {
+      config.time_prefixed_trace_id = node["time_prefixed_trace_id"].as<bool>();
+    }
+
     if (node["resources"]) {
       config.resources = node["resources"].as<std::map<std::string, std::string>>();
     }
@@ -31,6 +31,7 @@ TEST(OpenTelemetryConfigTest, ConfCodec) {
   config.metrics_config.enabled = true;
   config.metrics_config.client_histogram_buckets = {1, 2, 3, 4};
   config.metrics_config.server_histogram_buckets = {1, 2, 3, 4};
+  config.metrics_config.payload_histogram_buckets = {1, 2, 3, 4};
   OpenTelemetryMetricsCode metric_code;
   metric_code.code = 0;
   metric_code.type = "success";
@@ -38,18 +39,59 @@ TEST(OpenTelemetryConfigTest, ConfCodec) {
   metric_code.service = "service";
   metric_code.method = "method";
   config.metrics_config.codes.push_back(metric_code);
+  config.metrics_config.max_series_per_family = 1000;
+  config.metrics_config.family_max_series["rpc_client_handled_total"] = 100;
+  config.metrics_config.series_ttl = 10;
+  config.metrics_config.server_labels = {"caller_service", "callee_service", "callee_method", "code", "code_type"};
+  config.metrics_config.client_labels = {"callee_service", "callee_method", "code"};
+  config.metrics_config.family_labels["rpc_server_started_total"] = {"callee_service"};
+  config.metrics_config.enable_peer_metrics = true;
+  config.metrics_config.max_peers = 10;
+  OpenTelemetryMetricsSlo slo;
+  slo.name = "slo";
+  slo.service = "service";
+  slo.method = "method";
+  slo.target = 0.99;
+  slo.latency_threshold = 100;
+  config.metrics_config.slos.push_back(slo);
+  config.metrics_config.slo_windows = {10, 60};
+  config.metrics_config.enable_exemplar = true;
+  config.metrics_config.exemplar_interval = 500;
+  config.metrics_config.collect_min_interval = 1000;
+  config.metrics_config.export_enabled = true;
+  config.metrics_config.export_interval = 5000;
+  config.metrics_config.export_temporality = "cumulative";
+  config.metrics_config.export_batch_size = 100;
+  config.metrics_config.shm_export_enabled = true;
+  config.metrics_config.shm_export_dir = "/tmp";
+  config.metrics_config.shm_export_interval = 500;
+  config.metrics_config.shm_max_records = 1024;
 
   config.logs_config.enabled = true;
   config.logs_config.level = "info";
   config.logs_config.enable_sampler = true;
   config.logs_config.enable_sampler_error = true;
   config.logs_config.resources["tenant.id"] = "default";
+  config.logs_config.staging_enabled = true;
+  config.logs_config.staging_ring_size = 1024;
+  config.logs_config.staging_drain_interval = 50;
+  config.logs_config.staging_overflow_policy = "sample";
+  config.logs_config.staging_sample_interval = 5;
+  config.logs_config.tail_buffer_enabled = true;
+  config.logs_config.tail_buffer_max_bytes = 4096;
+  config.logs_config.tail_buffer_max_requests = 100;
+  config.logs_config.tail_buffer_ttl = 1000;
+  config.logs_config.rate_limit_enabled = true;
+  config.logs_config.rate_limit_per_second = 10;
+  config.logs_config.rate_limit_burst = 20;
+  config.logs_config.rate_limit_summary_interval = 5000;
 
   config.traces_config.disable_trace_body = true;
   config.traces_config.enable_deferred_sample = false;
   config.traces_config.deferred_sample_error = false;
   config.traces_config.deferred_sample_slow_duration = 10000;
   config.traces_config.disable_parent_sampling = false;
+  config.traces_config.time_prefixed_trace_id = true;
   config.traces_config.resources["tenant.id"] = "default";
 
   config.Display();
@@ -72,12 +114,53 @@ TEST(OpenTelemetryConfigTest, ConfCodec) {
             copy_config.metrics_config.client_histogram_buckets.size());
   ASSERT_EQ(config.metrics_config.server_histogram_buckets.size(),
             copy_config.metrics_config.server_histogram_buckets.size());
+  ASSERT_EQ(config.metrics_config.payload_histogram_buckets.size(),
+            copy_config.metrics_config.payload_histogram_buckets.size());
+  ASSERT_EQ(config.metrics_config.max_series_per_family, copy_config.metrics_config.max_series_per_family);
+  ASSERT_EQ(config.metrics_config.family_max_series, copy_config.metrics_config.family_max_series);
+  ASSERT_EQ(config.metrics_config.series_ttl, copy_config.metrics_config.series_ttl);
+  ASSERT_EQ(config.metrics_config.server_labels, copy_config.metrics_config.server_labels);
+  ASSERT_EQ(config.metrics_config.client_labels, copy_config.metrics_config.client_labels);
+  ASSERT_EQ(config.metrics_config.family_labels, copy_config.metrics_config.family_labels);
+  ASSERT_EQ(config.metrics_config.enable_peer_metrics, copy_config.metrics_config.enable_peer_metrics);
+  ASSERT_EQ(config.metrics_config.max_peers, copy_config.metrics_config.max_peers);
+  ASSERT_EQ(1, copy_config.metrics_config.slos.size());
+  ASSERT_EQ(slo.name, copy_config.metrics_config.slos[0].name);
+  ASSERT_EQ(slo.service, copy_config.metrics_config.slos[0].service);
+  ASSERT_EQ(slo.method, copy_config.metrics_config.slos[0].method);
+  ASSERT_EQ(slo.target, copy_config.metrics_config.slos[0].target);
+  ASSERT_EQ(slo.latency_threshold, copy_config.metrics_config.slos[0].latency_threshold);
+  ASSERT_EQ(config.metrics_config.slo_windows, copy_config.metrics_config.slo_windows);
+  ASSERT_EQ(config.metrics_config.enable_exemplar, copy_config.metrics_config.enable_exemplar);
+  ASSERT_EQ(config.metrics_config.exemplar_interval, copy_config.metrics_config.exemplar_interval);
+  ASSERT_EQ(config.metrics_config.collect_min_interval, copy_config.metrics_config.collect_min_interval);
+  ASSERT_EQ(config.metrics_config.export_enabled, copy_config.metrics_config.export_enabled);
+  ASSERT_EQ(config.metrics_config.export_interval, copy_config.metrics_config.export_interval);
+  ASSERT_EQ(config.metrics_config.export_temporality, copy_config.metrics_config.export_temporality);
+  ASSERT_EQ(config.metrics_config.export_batch_size, copy_config.metrics_config.export_batch_size);
+  ASSERT_EQ(config.metrics_config.shm_export_enabled, copy_config.metrics_config.shm_export_enabled);
+  ASSERT_EQ(config.metrics_config.shm_export_dir, copy_config.metrics_config.shm_export_dir);
+  ASSERT_EQ(config.metrics_config.shm_export_interval, copy_config.metrics_config.shm_export_interval);
+  ASSERT_EQ(config.metrics_config.shm_max_records, copy_config.metrics_config.shm_max_records);
 
   ASSERT_EQ(config.logs_config.enabled, copy_config.logs_config.enabled);
   ASSERT_EQ(config.logs_config.level, copy_config.logs_config.level);
   ASSERT_EQ(config.logs_config.enable_sampler, copy_config.logs_config.enable_sampler);
   ASSERT_EQ(config.logs_config.enable_sampler_error, copy_config.logs_config.enable_sampler_error);
   ASSERT_EQ(config.logs_config.resources, copy_config.logs_config.resources);
+  ASSERT_EQ(config.logs_config.staging_enabled, copy_config.logs_config.staging_enabled);
+  ASSERT_EQ(config.logs_config.staging_ring_size, copy_config.logs_config.staging_ring_size);
+  ASSERT_EQ(config.logs_config.staging_drain_interval, copy_config.logs_config.staging_drain_interval);
+  ASSERT_EQ(config.logs_config.staging_overflow_policy, copy_config.logs_config.staging_overflow_policy);
+  ASSERT_EQ(config.logs_config.staging_sample_interval, copy_config.logs_config.staging_sample_interval);
+  ASSERT_EQ(config.logs_config.tail_buffer_enabled, copy_config.logs_config.tail_buffer_enabled);
+  ASSERT_EQ(config.logs_config.tail_buffer_max_bytes, copy_config.logs_config.tail_buffer_max_bytes);
+  ASSERT_EQ(config.logs_config.tail_buffer_max_requests, copy_config.logs_config.tail_buffer_max_requests);
+  ASSERT_EQ(config.logs_config.tail_buffer_ttl, copy_config.logs_config.tail_buffer_ttl);
+  ASSERT_EQ(config.logs_config.rate_limit_enabled, copy_config.logs_config.rate_limit_enabled);
+  ASSERT_EQ(config.logs_config.rate_limit_per_second, copy_config.logs_config.rate_limit_per_second);
+  ASSERT_EQ(config.logs_config.rate_limit_burst, copy_config.logs_config.rate_limit_burst);
+  ASSERT_EQ(config.logs_config.rate_limit_summary_interval, copy_config.logs_config.rate_limit_summary_interval);
 
   ASSERT_EQ(config.traces_config.disable_trace_body, copy_config.traces_config.disable_trace_body);
   ASSERT_EQ(config.traces_config.enable_deferred_sample, copy_config.traces_config.enable_deferred_sample);
@@ -85,6 +168,7 @@ TEST(OpenTelemetryConfigTest, ConfCodec) {
   ASSERT_EQ(config.traces_config.deferred_sample_slow_duration,
             copy_config.traces_config.deferred_sample_slow_duration);
   ASSERT_EQ(config.traces_config.disable_parent_sampling, copy_config.traces_config.disable_parent_sampling);
+  ASSERT_EQ(config.traces_config.time_prefixed_trace_id, copy_config.traces_config.time_prefixed_trace_id);
   ASSERT_EQ(config.traces_config.resources, copy_config.traces_config.resources);
 }
 
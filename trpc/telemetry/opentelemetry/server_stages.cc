@@ -0,0 +1,78 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+
+#include "trpc/telemetry/opentelemetry/server_stages.h"
+
+#include <algorithm>
+
+#include "trpc/filter/filter_id_counter.h"
+#include "trpc/util/time.h"
+
+namespace trpc::opentelemetry {
+
+namespace {
+
+// the index of the filter data where the ServerStageTimestamps of a RPC is stored
+uint16_t GetServerStagesIndex() {
+  static const uint16_t index = trpc::GetNextFilterID();
+  return index;
+}
+
+}  // namespace
+
+ServerStageTimestamps& GetServerStages(const ServerContextPtr& context) {
+  auto* stages = context->GetFilterData<ServerStageTimestamps>(GetServerStagesIndex());
+  if (stages) {
+    return *stages;
+  }
+
+  // the receive timestamp of the context is taken from the system clock by the transport, so the time elapsed since
+  // then is moved onto the monotonic clock, which includes the time the request waits in the queue
+  uint64_t now_us = trpc::time::GetSteadyMicroSeconds();
+  uint64_t system_now_us = trpc::time::GetMicroSeconds();
+  uint64_t recv_timestamp_us = context->GetRecvTimestampUs();
+  uint64_t elapsed_us = 0;
+  if (recv_timestamp_us != 0 && system_now_us > recv_timestamp_us) {
+    elapsed_us = std::min(system_now_us - recv_timestamp_us, now_us);
+  }
+  ServerStageTimestamps new_stages;
+  new_stages.recv_us = now_us - elapsed_us;
+  context->SetFilterData(GetServerStagesIndex(), new_stages);
+  return *context->GetFilterData<ServerStageTimestamps>(GetServerStagesIndex());
+}
+
+ServerStageTimestamps* FindServerStages(const ServerContextPtr& context) {
+  return context->GetFilterData<ServerStageTimestamps>(GetServerStagesIndex());
+}
+
+ServerStageTimestamps* MarkServerDispatched(const ServerContextPtr& context) {
+  auto* stages = FindServerStages(context);
+  if (stages && stages->dispatch_us == 0) {
+    stages->dispatch_us = trpc::time::GetSteadyMicroSeconds();
+  }
+  return stages;
+}
+
+ServerStageTimestamps* MarkServerHandled(const ServerContextPtr& context) {
+  auto* stages = FindServerStages(context);
+  if (!stages || stages->dispatch_us == 0) {
+    return nullptr;
+  }
+  if (stages->handled_us == 0) {
+    stages->handled_us = trpc::time::GetSteadyMicroSeconds();
+  }
+  return stages;
+}
+
+}  // namespace trpc::opentelemetry
@@ -0,0 +1,45 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+
+#pragma once
+
+#include "trpc/server/server_context.h"
+
+#include "trpc/telemetry/opentelemetry/opentelemetry_common.h"
+
+namespace trpc::opentelemetry {
+
+/// @brief Gets the stage timestamps of the server-side RPC, which are created at the first call. The timestamps are
+///        stored in the filter data once and are shared by the server-side filters of metrics and tracing, so whichever
+///        filter runs first creates them.
+/// @param context ServerContext
+/// @return Return the stage timestamps of the RPC
+ServerStageTimestamps& GetServerStages(const ServerContextPtr& context);
+
+/// @brief Finds the stage timestamps of the server-side RPC.
+/// @param context ServerContext
+/// @return Return the stage timestamps, nullptr if the RPC does not go through SERVER_POST_RECV_MSG
+ServerStageTimestamps* FindServerStages(const ServerContextPtr& context);
+
+/// @brief Captures the time when the request is dispatched to the handler, which is only captured by the first filter.
+/// @param context ServerContext
+/// @return Return the stage timestamps, nullptr if the RPC does not go through SERVER_POST_RECV_MSG
+ServerStageTimestamps* MarkServerDispatched(const ServerContextPtr& context);
+
+/// @brief Captures the time when the handler returns, which is only captured by the first filter.
+/// @param context ServerContext
+/// @return Return the stage timestamps, nullptr if the request has not been dispatched
+ServerStageTimestamps* MarkServerHandled(const ServerContextPtr& context);
+
+}  // namespace trpc::opentelemetry
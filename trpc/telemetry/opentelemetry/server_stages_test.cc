@@ -0,0 +1,67 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+
+#include "trpc/telemetry/opentelemetry/server_stages.h"
+
+#include "gtest/gtest.h"
+#include "trpc/util/time.h"
+
+namespace trpc::testing {
+
+TEST(ServerStagesTest, QueueWaitFromRecvTimestamp) {
+  ServerContextPtr context = MakeRefCounted<ServerContext>();
+  ASSERT_EQ(nullptr, trpc::opentelemetry::FindServerStages(context));
+  // the request is not dispatched or handled before it is received
+  ASSERT_EQ(nullptr, trpc::opentelemetry::MarkServerDispatched(context));
+  ASSERT_EQ(nullptr, trpc::opentelemetry::MarkServerHandled(context));
+
+  // the request has waited in the queue for 5ms since the transport received it
+  context->SetRecvTimestampUs(trpc::time::GetMicroSeconds() - 5000);
+  auto& stages = trpc::opentelemetry::GetServerStages(context);
+  ASSERT_EQ(&stages, trpc::opentelemetry::FindServerStages(context));
+  ASSERT_NE(0, stages.recv_us);
+
+  auto* dispatched_stages = trpc::opentelemetry::MarkServerDispatched(context);
+  ASSERT_EQ(&stages, dispatched_stages);
+  ASSERT_GE(stages.dispatch_us - stages.recv_us, 5000);
+}
+
+TEST(ServerStagesTest, SharedByFilters) {
+  ServerContextPtr context = MakeRefCounted<ServerContext>();
+  context->SetRecvTimestampUs(trpc::time::GetMicroSeconds());
+
+  // the stages are created by the first filter and reused by the others
+  auto& stages = trpc::opentelemetry::GetServerStages(context);
+  uint64_t recv_us = stages.recv_us;
+  ASSERT_EQ(&stages, &trpc::opentelemetry::GetServerStages(context));
+  ASSERT_EQ(recv_us, stages.recv_us);
+
+  // the request is not handled before it is dispatched
+  ASSERT_EQ(nullptr, trpc::opentelemetry::MarkServerHandled(context));
+
+  // each stage is only captured by the first filter
+  trpc::opentelemetry::MarkServerDispatched(context);
+  uint64_t dispatch_us = stages.dispatch_us;
+  ASSERT_GE(dispatch_us, recv_us);
+  trpc::opentelemetry::MarkServerDispatched(context);
+  ASSERT_EQ(dispatch_us, stages.dispatch_us);
+
+  trpc::opentelemetry::MarkServerHandled(context);
+  uint64_t handled_us = stages.handled_us;
+  ASSERT_GE(handled_us, dispatch_us);
+  ASSERT_EQ(&stages, trpc::opentelemetry::MarkServerHandled(context));
+  ASSERT_EQ(handled_us, stages.handled_us);
+}
+
+}  // namespace trpc::testing
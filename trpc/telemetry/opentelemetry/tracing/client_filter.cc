@@ -15,6 +15,8 @@
 
 #include <unordered_map>
 
+#include "opentelemetry/context/runtime_context.h"
+#include "opentelemetry/trace/context.h"
 #include "opentelemetry/trace/propagation/http_trace_context.h"
 #include "opentelemetry/trace/tracer.h"
 #include "trpc/codec/http/http_protocol.h"
@@ -105,6 +107,16 @@ void OpenTelemetryTracingClientFilter::operator()(FilterStatus& status, FilterPo
   }
 
   if (point == FilterPoint::CLIENT_PRE_RPC_INVOKE) {
+    if (!client_span->parent_span.has_value()) {
+      // the calls out of the server contexts, such as the ones of the background tasks, take the current span as the
+      // parent, which is also kept in the context for the later filters
+      auto current_span = ::opentelemetry::trace::GetSpan(::opentelemetry::context::RuntimeContext::GetCurrent());
+      if (current_span && current_span->GetContext().IsValid()) {
+        client_span->parent_span = trpc::opentelemetry::OpenTelemetryTracingSpanPtr(std::move(current_span));
+      }
+    }
+    // the client span is not made current, as the end of an asynchronous call runs in another fiber and would leave
+    // it current in the calling fiber for the later logs and calls
     client_span->span = std::move(NewSpan(context, client_span->parent_span));
   } else if (point == FilterPoint::CLIENT_POST_RPC_INVOKE) {
     FinishSpan(client_span->span, context);
@@ -14,11 +14,15 @@
 #include "trpc/telemetry/opentelemetry/tracing/client_filter.h"
 
 #include "gtest/gtest.h"
+#include "opentelemetry/trace/scope.h"
 #include "opentelemetry/trace/tracer.h"
 #include "trpc/client/testing/service_proxy_testing.h"
 #include "trpc/codec/http/http_client_codec.h"
 #include "trpc/codec/trpc/trpc_client_codec.h"
 #include "trpc/common/config/trpc_config.h"
+#include "trpc/coroutine/fiber.h"
+#include "trpc/coroutine/fiber_latch.h"
+#include "trpc/coroutine/testing/fiber_runtime.h"
 #include "trpc/telemetry/telemetry_factory.h"
 
 #include "trpc/telemetry/opentelemetry/testing/mock_telemetry.h"
@@ -185,4 +189,77 @@ TEST_F(TracingClientFilterTest, TraceWithParentSpan) {
   ASSERT_FALSE(span->IsRecording());
 }
 
+TEST_F(TracingClientFilterTest, TraceWithCurrentSpan) {
+  ClientContextPtr context = GetTestTrpcClientContext();
+  context->SetFilterData(tracing_->GetPluginID(), ClientTracingSpan());
+  std::string err_msg;
+  auto opentelemetry_tracer = tracing_->MakeTracer(context->GetCallerName().c_str(), err_msg);
+  ASSERT_TRUE(opentelemetry_tracer);
+  // the span of a background task, which is not saved in any context
+  auto current_span =
+      opentelemetry_tracer->StartSpan(context->GetFuncName(), {}, ::opentelemetry::trace::StartSpanOptions{});
+  ::opentelemetry::trace::Scope scope(current_span);
+
+  FilterStatus status;
+  client_filter_->operator()(status, FilterPoint::CLIENT_PRE_RPC_INVOKE, context);
+  ASSERT_EQ(FilterStatus::CONTINUE, status);
+  ClientTracingSpan* ptr = context->GetFilterData<ClientTracingSpan>(tracing_->GetPluginID());
+  ASSERT_NE(nullptr, ptr);
+  // the current span is taken as the parent span
+  ASSERT_EQ(typeid(trpc::opentelemetry::OpenTelemetryTracingSpanPtr), ptr->parent_span.type());
+  auto& parent_span = std::any_cast<trpc::opentelemetry::OpenTelemetryTracingSpanPtr&>(ptr->parent_span);
+  ASSERT_EQ(current_span.get(), parent_span.get());
+  auto& span = std::any_cast<trpc::opentelemetry::OpenTelemetryTracingSpanPtr&>(ptr->span);
+  ASSERT_NE(nullptr, span.get());
+  ASSERT_EQ(current_span->GetContext().trace_id(), span->GetContext().trace_id());
+  ASSERT_NE(current_span->GetContext().span_id(), span->GetContext().span_id());
+
+  client_filter_->operator()(status, FilterPoint::CLIENT_POST_RPC_INVOKE, context);
+  ASSERT_FALSE(span->IsRecording());
+}
+
+TEST_F(TracingClientFilterTest, AsyncCallNotCurrent) {
+  RunAsFiber([]() {
+    ClientContextPtr first_context = GetTestTrpcClientContext();
+    std::string err_msg;
+    auto opentelemetry_tracer = tracing_->MakeTracer(first_context->GetCallerName().c_str(), err_msg);
+    ASSERT_TRUE(opentelemetry_tracer);
+    auto current_span =
+        opentelemetry_tracer->StartSpan(first_context->GetFuncName(), {}, ::opentelemetry::trace::StartSpanOptions{});
+    ::opentelemetry::trace::Scope scope(current_span);
+
+    // starts an asynchronous call, which ends in another fiber
+    FilterStatus status;
+    client_filter_->operator()(status, FilterPoint::CLIENT_PRE_RPC_INVOKE, first_context);
+    ClientTracingSpan* first_ptr = first_context->GetFilterData<ClientTracingSpan>(tracing_->GetPluginID());
+    ASSERT_NE(nullptr, first_ptr);
+    auto& first_span = std::any_cast<trpc::opentelemetry::OpenTelemetryTracingSpanPtr&>(first_ptr->span);
+    ASSERT_NE(nullptr, first_span.get());
+
+    // the logs printed during the call are linked to the current span rather than the client span
+    auto log_span = ::opentelemetry::trace::GetSpan(::opentelemetry::context::RuntimeContext::GetCurrent());
+    ASSERT_EQ(current_span.get(), log_span.get());
+
+    // the second call takes the current span as its parent rather than the client span of the first call
+    ClientContextPtr second_context = GetTestTrpcClientContext();
+    client_filter_->operator()(status, FilterPoint::CLIENT_PRE_RPC_INVOKE, second_context);
+    ClientTracingSpan* second_ptr = second_context->GetFilterData<ClientTracingSpan>(tracing_->GetPluginID());
+    ASSERT_NE(nullptr, second_ptr);
+    auto& parent_span = std::any_cast<trpc::opentelemetry::OpenTelemetryTracingSpanPtr&>(second_ptr->parent_span);
+    ASSERT_EQ(current_span.get(), parent_span.get());
+    client_filter_->operator()(status, FilterPoint::CLIENT_POST_RPC_INVOKE, second_context);
+
+    FiberLatch latch(1);
+    StartFiberDetached([&]() {
+      FilterStatus async_status;
+      client_filter_->operator()(async_status, FilterPoint::CLIENT_POST_RPC_INVOKE, first_context);
+      latch.CountDown();
+    });
+    latch.Wait();
+    ASSERT_FALSE(first_span->IsRecording());
+    ASSERT_EQ(current_span.get(),
+              ::opentelemetry::trace::GetSpan(::opentelemetry::context::RuntimeContext::GetCurrent()).get());
+  });
+}
+
 }  // namespace trpc::testing
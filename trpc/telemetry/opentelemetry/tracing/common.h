@@ -43,6 +43,12 @@ constexpr char kTraceFrameworkRetCode[] = "trpc.framework_ret";
 constexpr char kTraceFuncRetCode[] = "trpc.func_ret";
 constexpr char kTraceErrMsg[] = "trpc.err_msg";
 
+/// @brief The events of the stages of a server-side RPC and their attributes, the durations are in microseconds.
+constexpr char kTraceDispatchedEvent[] = "dispatched";
+constexpr char kTraceHandledEvent[] = "handled";
+constexpr char kTraceQueueWaitUs[] = "trpc.queue_wait_us";
+constexpr char kTraceHandlerUs[] = "trpc.handler_us";
+
 /// @brief The service name of the internal trace exporter
 constexpr char kGrpcTraceExporterServiceName[] = "trpc.opentelemetry.trace.grpc_exporter";
 
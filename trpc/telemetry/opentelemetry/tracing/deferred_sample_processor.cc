@@ -31,6 +31,8 @@ std::unique_ptr<Recordable> DeferredRecordable::GetRecordable() { return std::mo
 void DeferredRecordable::SetIdentity(const ::opentelemetry::trace::SpanContext& span_context,
                                      ::opentelemetry::trace::SpanId parent_span_id) noexcept {
   sampled_ = span_context.IsSampled();
+  trace_id_ = span_context.trace_id();
+  span_id_ = span_context.span_id();
   inner_recordable_->SetIdentity(span_context, parent_span_id);
 }
 
@@ -90,6 +92,10 @@ std::unique_ptr<Recordable> DeferredSampleProcessor::MakeRecordable() noexcept {
 
 void DeferredSampleProcessor::OnStart(Recordable& span,
                                       const ::opentelemetry::trace::SpanContext& parent_context) noexcept {
+  if (auto* recordable = dynamic_cast<DeferredRecordable*>(&span)) {
+    // the remote parent is in another process, so the span is the root of the local part of the trace
+    recordable->SetLocalRoot(!parent_context.IsValid() || parent_context.IsRemote());
+  }
   return inner_processor_->OnStart(span, parent_context);
 }
 
@@ -98,7 +104,11 @@ void DeferredSampleProcessor::OnEnd(std::unique_ptr<Recordable>&& span) noexcept
   if (recordable == nullptr) {
     return;
   }
-  if (ShouldDeferredSampler(recordable)) {
+  bool sampled = ShouldDeferredSampler(recordable);
+  if (!recordable->IsSampled() && recordable->IsLocalRoot() && sample_options_.decision_func) {
+    sample_options_.decision_func(recordable->GetTraceId(), recordable->GetSpanId(), sampled);
+  }
+  if (sampled) {
     inner_processor_->OnEnd(std::move(recordable->GetRecordable()));
   }
   return;
@@ -14,6 +14,7 @@
 #pragma once
 
 #include <chrono>
+#include <functional>
 
 #include "opentelemetry/sdk/trace/processor.h"
 #include "opentelemetry/sdk/trace/span_data.h"
@@ -37,6 +38,18 @@ class DeferredRecordable : public ::opentelemetry::sdk::trace::Recordable {
   /// @brief Gets the duration.
   std::chrono::nanoseconds GetDuration();
 
+  /// @brief Gets the trace id.
+  const ::opentelemetry::trace::TraceId& GetTraceId() { return trace_id_; }
+
+  /// @brief Gets the span id.
+  const ::opentelemetry::trace::SpanId& GetSpanId() { return span_id_; }
+
+  /// @brief Checks if the span is the local root, whose parent is remote or absent.
+  bool IsLocalRoot() const { return local_root_; }
+
+  /// @brief Sets whether the span is the local root, which is called when the span starts.
+  void SetLocalRoot(bool local_root) { local_root_ = local_root; }
+
   /// @brief Gets the inner recordable.
   std::unique_ptr<::opentelemetry::sdk::trace::Recordable> GetRecordable();
 
@@ -72,20 +85,30 @@ class DeferredRecordable : public ::opentelemetry::sdk::trace::Recordable {
   std::unique_ptr<Recordable> inner_recordable_;
 
   bool sampled_ = false;
+  bool local_root_ = true;
   ::opentelemetry::trace::StatusCode code_;
   std::chrono::nanoseconds duration_;
+  ::opentelemetry::trace::TraceId trace_id_;
+  ::opentelemetry::trace::SpanId span_id_;
 };
 
 /// @brief Implementation of the deferred sample processor, which allows further making sample decisions based on
 ///        deferred sample Options, such as errors and high latency.
 class DeferredSampleProcessor : public ::opentelemetry::sdk::trace::SpanProcessor {
  public:
+  /// @brief The function called with the final decision of a local root span which was not sampled when it started,
+  ///        which decides for the data of the whole local part of the trace, such as the logs of its child spans.
+  using DecisionFunc = std::function<void(const ::opentelemetry::trace::TraceId& trace_id,
+                                          const ::opentelemetry::trace::SpanId& span_id, bool sampled)>;
+
   /// Options for DeferredSample
   struct Options {
     /// Whether to sample spans that encounter errors
     bool enable_sample_error = false;
     /// The sampled threshold for high latency spans.
     std::chrono::microseconds sample_slow_duration = (std::chrono::microseconds::max)();
+    /// Called when the local root span ends, such as flushing the logs buffered for the trace, which may be empty
+    DecisionFunc decision_func;
   };
 
  public:
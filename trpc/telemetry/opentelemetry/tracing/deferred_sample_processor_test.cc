@@ -13,6 +13,8 @@
 
 #include "trpc/telemetry/opentelemetry/tracing/deferred_sample_processor.h"
 
+#include <vector>
+
 #include "gtest/gtest.h"
 
 #include "opentelemetry/exporters/ostream/span_exporter.h"
@@ -124,4 +126,59 @@ TEST(DeferredSampleProcessorTest, Report) {
   processor.Shutdown(std::chrono::microseconds(50));
 }
 
+TEST(DeferredSampleProcessorTest, DecisionFunc) {
+  std::vector<bool> decisions;
+  trpc::opentelemetry::DeferredSampleProcessor::Options options;
+  options.sample_slow_duration = std::chrono::microseconds(100);
+  options.decision_func = [&decisions](const ::opentelemetry::trace::TraceId& trace_id,
+                                       const ::opentelemetry::trace::SpanId& span_id,
+                                       bool sampled) { decisions.push_back(sampled); };
+  trpc::opentelemetry::DeferredSampleProcessor processor(std::make_unique<MockProcessor>(), std::move(options));
+
+  // not called for the spans sampled when they started
+  auto sampled_recordable = processor.MakeRecordable();
+  sampled_recordable->SetIdentity(::opentelemetry::trace::SpanContext(true, false), ::opentelemetry::trace::SpanId());
+  processor.OnEnd(std::move(sampled_recordable));
+  ASSERT_TRUE(decisions.empty());
+
+  // called with the decision of the slow span
+  auto slow_recordable = processor.MakeRecordable();
+  slow_recordable->SetIdentity(::opentelemetry::trace::SpanContext(false, false), ::opentelemetry::trace::SpanId());
+  slow_recordable->SetDuration(std::chrono::microseconds(200));
+  processor.OnEnd(std::move(slow_recordable));
+
+  // called with the decision of the fast span
+  auto fast_recordable = processor.MakeRecordable();
+  fast_recordable->SetIdentity(::opentelemetry::trace::SpanContext(false, false), ::opentelemetry::trace::SpanId());
+  fast_recordable->SetStatus(::opentelemetry::trace::StatusCode::kOk, "");
+  fast_recordable->SetDuration(std::chrono::microseconds(50));
+  processor.OnEnd(std::move(fast_recordable));
+
+  ASSERT_EQ((std::vector<bool>{true, false}), decisions);
+
+  // not called for the child spans, whose data are decided by the local root span
+  constexpr uint8_t buf_span[] = {1, 2, 3, 4, 5, 6, 7, 8};
+  constexpr uint8_t buf_trace[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+  ::opentelemetry::trace::SpanContext local_parent(::opentelemetry::trace::TraceId(buf_trace),
+                                                   ::opentelemetry::trace::SpanId(buf_span),
+                                                   ::opentelemetry::trace::TraceFlags(false), false);
+  auto child_recordable = processor.MakeRecordable();
+  processor.OnStart(*child_recordable, local_parent);
+  child_recordable->SetIdentity(::opentelemetry::trace::SpanContext(false, false), ::opentelemetry::trace::SpanId());
+  child_recordable->SetDuration(std::chrono::microseconds(200));
+  processor.OnEnd(std::move(child_recordable));
+  ASSERT_EQ(2, decisions.size());
+
+  // called for the spans whose parent is remote
+  ::opentelemetry::trace::SpanContext remote_parent(::opentelemetry::trace::TraceId(buf_trace),
+                                                    ::opentelemetry::trace::SpanId(buf_span),
+                                                    ::opentelemetry::trace::TraceFlags(false), true);
+  auto server_recordable = processor.MakeRecordable();
+  processor.OnStart(*server_recordable, remote_parent);
+  server_recordable->SetIdentity(::opentelemetry::trace::SpanContext(false, false), ::opentelemetry::trace::SpanId());
+  server_recordable->SetDuration(std::chrono::microseconds(200));
+  processor.OnEnd(std::move(server_recordable));
+  ASSERT_EQ((std::vector<bool>{true, false, true}), decisions);
+}
+
 }  // namespace trpc::testing
@@ -0,0 +1,115 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#include "trpc/telemetry/opentelemetry/tracing/fiber_context_storage.h"
+
+#include "opentelemetry/trace/span_metadata.h"
+#include "trpc/coroutine/fiber.h"
+
+namespace trpc::opentelemetry {
+
+void FiberContextStorage::ContextStack::PopFrom(size_t index) noexcept {
+  for (size_t i = index; i < size; ++i) {
+    entries[i] = Entry();
+  }
+  size = index;
+  // the overflowed attachments were above the popped entries
+  overflow = 0;
+}
+
+FiberContextStorage::ContextStack& FiberContextStorage::GetStack() noexcept {
+  if (trpc::IsRunningInFiberWorker()) {
+    return *fiber_stack_;
+  }
+  thread_local ContextStack thread_stack;
+  return thread_stack;
+}
+
+::opentelemetry::context::Context FiberContextStorage::GetCurrent() noexcept {
+  auto& stack = GetStack();
+  if (stack.size == 0) {
+    return ::opentelemetry::context::Context();
+  }
+  return stack.entries[stack.size - 1].context;
+}
+
+::opentelemetry::nostd::unique_ptr<::opentelemetry::context::Token> FiberContextStorage::Attach(
+    const ::opentelemetry::context::Context& context) noexcept {
+  auto& stack = GetStack();
+  if (stack.size < kMaxDepth) {
+    stack.entries[stack.size++].context = context;
+  } else {
+    ++stack.overflow;
+  }
+  return CreateToken(context);
+}
+
+bool FiberContextStorage::Detach(::opentelemetry::context::Token& token) noexcept {
+  auto& stack = GetStack();
+  // the token of an overflowed attachment is not in the stack, and must not match an equal context below
+  if (stack.overflow > 0) {
+    --stack.overflow;
+    return false;
+  }
+  // the token is on the top unless some scopes are destroyed out of order
+  for (size_t i = stack.size; i > 0; --i) {
+    const auto& entry = stack.entries[i - 1];
+    if (entry.owner == nullptr && token == entry.context) {
+      stack.PopFrom(i - 1);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool FiberContextStorage::Push(const ::opentelemetry::context::Context& context, const void* owner) noexcept {
+  auto& stack = GetStack();
+  if (stack.size >= kMaxDepth) {
+    return false;
+  }
+  auto& entry = stack.entries[stack.size++];
+  entry.context = context;
+  entry.owner = owner;
+  return true;
+}
+
+bool FiberContextStorage::Pop(const void* owner) noexcept {
+  auto& stack = GetStack();
+  for (size_t i = stack.size; i > 0; --i) {
+    if (stack.entries[i - 1].owner == owner) {
+      stack.PopFrom(i - 1);
+      return true;
+    }
+  }
+  return false;
+}
+
+bool FiberContextStorage::PushSpan(
+    const ::opentelemetry::nostd::shared_ptr<::opentelemetry::trace::Span>& span) noexcept {
+  if (!span || !trpc::IsRunningInFiberWorker()) {
+    return false;
+  }
+  return Push(::opentelemetry::context::Context(::opentelemetry::trace::kSpanKey, span), span.get());
+}
+
+bool FiberContextStorage::PopSpan(
+    const ::opentelemetry::nostd::shared_ptr<::opentelemetry::trace::Span>& span) noexcept {
+  if (!span || !trpc::IsRunningInFiberWorker()) {
+    return false;
+  }
+  return Pop(span.get());
+}
+
+size_t FiberContextStorage::Size() noexcept { return GetStack().size; }
+
+}  // namespace trpc::opentelemetry
@@ -0,0 +1,102 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "opentelemetry/context/runtime_context.h"
+#include "opentelemetry/trace/span.h"
+#include "trpc/coroutine/fiber_local.h"
+
+namespace trpc::opentelemetry {
+
+/// @brief Implementation of the runtime context storage of OpenTelemetry backed by the fiber local storage, so that the
+///        current span follows the fiber rather than the worker thread which runs it. The threads out of the fiber
+///        runtime use a thread local stack instead.
+/// @note Each fiber has a stack of at most kMaxDepth contexts, which is allocated on its first use. Pushing and popping
+///       the contexts only copy them into and out of the stack. The OpenTelemetry API still allocates the tokens
+///       returned by Attach, and the data of each new Context, such as the one built by PushSpan. The thread local
+///       stack is shared by all the instances, as only one of them is installed.
+class FiberContextStorage : public ::opentelemetry::context::RuntimeContextStorage {
+ public:
+  /// the maximum number of the nested contexts of a fiber
+  static constexpr size_t kMaxDepth = 16;
+
+  ::opentelemetry::context::Context GetCurrent() noexcept override;
+
+  /// @brief Makes the context current. The context is not attached if the stack is full, and the returned token does
+  ///        nothing when it is detached, as the overflowed attachments are counted and consumed first by Detach.
+  ::opentelemetry::nostd::unique_ptr<::opentelemetry::context::Token> Attach(
+      const ::opentelemetry::context::Context& context) noexcept override;
+
+  /// @brief Restores the context before the token is attached. The contexts attached after the token and not detached
+  ///        yet are detached together.
+  /// @note The tokens are expected to be detached in the reverse order of the attachments, so the token of an
+  ///       overflowed attachment is the first one detached after it.
+  bool Detach(::opentelemetry::context::Token& token) noexcept override;
+
+  /// @brief Pushes the context without creating a token.
+  /// @param context the context
+  /// @param owner the identity of the context used by Pop, such as the span of the context, which must not be null
+  /// @return Return false if the stack is full, and the context is not pushed.
+  bool Push(const ::opentelemetry::context::Context& context, const void* owner) noexcept;
+
+  /// @brief Pops the context pushed with the owner, together with the contexts pushed after it and not popped yet.
+  /// @param owner the identity of the context
+  /// @return Return false if the context is not in the stack of the running fiber.
+  bool Pop(const void* owner) noexcept;
+
+  /// @brief Makes the span current in the running fiber until PopSpan, which is used by the server filter to update
+  ///        the current span when the handler starts and ends. The Context holding the span is allocated by the
+  ///        OpenTelemetry API.
+  /// @param span the span
+  /// @return Return true if the span is pushed.
+  /// @note It does nothing out of the fiber runtime. There the end of an asynchronous call may run in another thread,
+  ///       which would leave the span current in the thread for the later calls. In a fiber, such a span is released
+  ///       with the stack when the fiber exits.
+  bool PushSpan(const ::opentelemetry::nostd::shared_ptr<::opentelemetry::trace::Span>& span) noexcept;
+
+  /// @brief Pops the span pushed by PushSpan.
+  /// @param span the span
+  /// @return Return true if the span is popped.
+  bool PopSpan(const ::opentelemetry::nostd::shared_ptr<::opentelemetry::trace::Span>& span) noexcept;
+
+  /// @brief Gets the number of the contexts of the running fiber.
+  size_t Size() noexcept;
+
+ private:
+  struct Entry {
+    ::opentelemetry::context::Context context;
+    // null for the contexts attached with tokens
+    const void* owner = nullptr;
+  };
+
+  struct ContextStack {
+    std::array<Entry, kMaxDepth> entries;
+    size_t size = 0;
+    // the number of the attachments beyond kMaxDepth not detached yet, whose tokens are detached before the others
+    size_t overflow = 0;
+
+    // Pops the entry at the index and the ones above it
+    void PopFrom(size_t index) noexcept;
+  };
+
+  ContextStack& GetStack() noexcept;
+
+ private:
+  FiberLocal<ContextStack> fiber_stack_;
+};
+
+}  // namespace trpc::opentelemetry
@@ -0,0 +1,195 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#include "trpc/telemetry/opentelemetry/tracing/fiber_context_storage.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "opentelemetry/trace/context.h"
+#include "opentelemetry/trace/default_span.h"
+#include "opentelemetry/trace/scope.h"
+#include "trpc/coroutine/fiber.h"
+#include "trpc/coroutine/fiber_latch.h"
+#include "trpc/coroutine/testing/fiber_runtime.h"
+
+namespace trpc::testing {
+
+namespace {
+
+::opentelemetry::nostd::shared_ptr<::opentelemetry::trace::Span> MakeSpan(uint8_t id) {
+  const uint8_t trace_id[16] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, id};
+  const uint8_t span_id[8] = {1, 2, 3, 4, 5, 6, 7, id};
+  ::opentelemetry::trace::SpanContext span_context(::opentelemetry::trace::TraceId(trace_id),
+                                                   ::opentelemetry::trace::SpanId(span_id),
+                                                   ::opentelemetry::trace::TraceFlags(true), false);
+  return ::opentelemetry::nostd::shared_ptr<::opentelemetry::trace::Span>(
+      new ::opentelemetry::trace::DefaultSpan(span_context));
+}
+
+::opentelemetry::context::Context MakeContext(
+    const ::opentelemetry::nostd::shared_ptr<::opentelemetry::trace::Span>& span) {
+  return ::opentelemetry::context::Context(::opentelemetry::trace::kSpanKey, span);
+}
+
+const ::opentelemetry::trace::Span* GetCurrentSpan(trpc::opentelemetry::FiberContextStorage& storage) {
+  return ::opentelemetry::trace::GetSpan(storage.GetCurrent()).get();
+}
+
+}  // namespace
+
+TEST(FiberContextStorageTest, AttachAndDetach) {
+  trpc::opentelemetry::FiberContextStorage storage;
+  auto outer_span = MakeSpan(1);
+  auto inner_span = MakeSpan(2);
+  ASSERT_EQ(0, storage.Size());
+  ASSERT_FALSE(::opentelemetry::trace::GetSpan(storage.GetCurrent())->GetContext().IsValid());
+
+  auto outer_token = storage.Attach(MakeContext(outer_span));
+  ASSERT_EQ(outer_span.get(), GetCurrentSpan(storage));
+  auto inner_token = storage.Attach(MakeContext(inner_span));
+  ASSERT_EQ(inner_span.get(), GetCurrentSpan(storage));
+  ASSERT_EQ(2, storage.Size());
+
+  ASSERT_TRUE(storage.Detach(*inner_token));
+  ASSERT_EQ(outer_span.get(), GetCurrentSpan(storage));
+  ASSERT_TRUE(storage.Detach(*outer_token));
+  ASSERT_EQ(0, storage.Size());
+  // the token is detached already
+  ASSERT_FALSE(storage.Detach(*outer_token));
+}
+
+TEST(FiberContextStorageTest, DetachOutOfOrder) {
+  trpc::opentelemetry::FiberContextStorage storage;
+  auto outer_span = MakeSpan(1);
+  auto inner_span = MakeSpan(2);
+  auto outer_token = storage.Attach(MakeContext(outer_span));
+  auto inner_token = storage.Attach(MakeContext(inner_span));
+
+  // the inner context is detached together with the outer one
+  ASSERT_TRUE(storage.Detach(*outer_token));
+  ASSERT_EQ(0, storage.Size());
+  ASSERT_FALSE(storage.Detach(*inner_token));
+}
+
+TEST(FiberContextStorageTest, Overflow) {
+  trpc::opentelemetry::FiberContextStorage storage;
+  auto span = MakeSpan(1);
+  int owners[trpc::opentelemetry::FiberContextStorage::kMaxDepth];
+  for (size_t i = 0; i < trpc::opentelemetry::FiberContextStorage::kMaxDepth; ++i) {
+    ASSERT_TRUE(storage.Push(MakeContext(span), &owners[i]));
+  }
+  ASSERT_FALSE(storage.Push(MakeContext(span), &span));
+
+  // the context beyond the depth is not attached, and its token does nothing
+  auto overflow_span = MakeSpan(2);
+  auto token = storage.Attach(MakeContext(overflow_span));
+  ASSERT_EQ(span.get(), GetCurrentSpan(storage));
+  ASSERT_FALSE(storage.Detach(*token));
+  ASSERT_EQ(trpc::opentelemetry::FiberContextStorage::kMaxDepth, storage.Size());
+
+  ASSERT_TRUE(storage.Pop(&owners[0]));
+  ASSERT_EQ(0, storage.Size());
+}
+
+TEST(FiberContextStorageTest, OverflowSameContext) {
+  trpc::opentelemetry::FiberContextStorage storage;
+  auto span = MakeSpan(1);
+  auto outer_token = storage.Attach(MakeContext(span));
+  std::vector<::opentelemetry::nostd::unique_ptr<::opentelemetry::context::Token>> tokens;
+  for (size_t i = 1; i < trpc::opentelemetry::FiberContextStorage::kMaxDepth; ++i) {
+    tokens.push_back(storage.Attach(MakeContext(MakeSpan(2))));
+  }
+
+  // re-attaches the outer context beyond the depth, whose token equals the outer entry
+  auto overflow_token = storage.Attach(storage.GetCurrent());
+  auto outer_again_token = storage.Attach(storage.GetCurrent());
+  ASSERT_EQ(trpc::opentelemetry::FiberContextStorage::kMaxDepth, storage.Size());
+
+  // detaching the overflowed tokens pops nothing
+  ASSERT_FALSE(storage.Detach(*outer_again_token));
+  ASSERT_FALSE(storage.Detach(*overflow_token));
+  ASSERT_EQ(trpc::opentelemetry::FiberContextStorage::kMaxDepth, storage.Size());
+
+  for (size_t i = tokens.size(); i > 0; --i) {
+    ASSERT_TRUE(storage.Detach(*tokens[i - 1]));
+  }
+  ASSERT_EQ(span.get(), GetCurrentSpan(storage));
+  ASSERT_TRUE(storage.Detach(*outer_token));
+  ASSERT_EQ(0, storage.Size());
+}
+
+TEST(FiberContextStorageTest, PushAndPop) {
+  trpc::opentelemetry::FiberContextStorage storage;
+  auto server_span = MakeSpan(1);
+  auto client_span = MakeSpan(2);
+  ASSERT_TRUE(storage.Push(MakeContext(server_span), server_span.get()));
+  ASSERT_TRUE(storage.Push(MakeContext(client_span), client_span.get()));
+  ASSERT_EQ(client_span.get(), GetCurrentSpan(storage));
+
+  ASSERT_TRUE(storage.Pop(client_span.get()));
+  ASSERT_EQ(server_span.get(), GetCurrentSpan(storage));
+  ASSERT_FALSE(storage.Pop(client_span.get()));
+  ASSERT_TRUE(storage.Pop(server_span.get()));
+  ASSERT_EQ(0, storage.Size());
+}
+
+TEST(FiberContextStorageTest, PushSpanOutOfFiber) {
+  trpc::opentelemetry::FiberContextStorage storage;
+  auto span = MakeSpan(1);
+  // the spans of the filters are not pushed out of the fiber runtime
+  ASSERT_FALSE(storage.PushSpan(span));
+  ASSERT_EQ(0, storage.Size());
+  ASSERT_FALSE(storage.PopSpan(span));
+}
+
+TEST(FiberContextStorageTest, PushSpanInFiber) {
+  trpc::opentelemetry::FiberContextStorage storage;
+  RunAsFiber([&storage]() {
+    auto span = MakeSpan(1);
+    ASSERT_TRUE(storage.PushSpan(span));
+    ASSERT_EQ(span.get(), GetCurrentSpan(storage));
+
+    // the current span is not seen by another fiber, even if it runs in the same worker thread
+    bool other_fiber_empty = false;
+    FiberLatch latch(1);
+    StartFiberDetached([&]() {
+      other_fiber_empty = storage.Size() == 0;
+      latch.CountDown();
+    });
+    latch.Wait();
+    ASSERT_TRUE(other_fiber_empty);
+
+    ASSERT_TRUE(storage.PopSpan(span));
+    ASSERT_EQ(0, storage.Size());
+  });
+}
+
+TEST(FiberContextStorageTest, RuntimeContext) {
+  auto storage = ::opentelemetry::nostd::shared_ptr<::opentelemetry::context::RuntimeContextStorage>(
+      new trpc::opentelemetry::FiberContextStorage());
+  ::opentelemetry::context::RuntimeContext::SetRuntimeContextStorage(storage);
+
+  auto span = MakeSpan(1);
+  {
+    ::opentelemetry::trace::Scope scope(span);
+    ASSERT_EQ(span.get(),
+              ::opentelemetry::trace::GetSpan(::opentelemetry::context::RuntimeContext::GetCurrent()).get());
+  }
+  ASSERT_FALSE(::opentelemetry::trace::GetSpan(::opentelemetry::context::RuntimeContext::GetCurrent())
+                   ->GetContext()
+                   .IsValid());
+}
+
+}  // namespace trpc::testing
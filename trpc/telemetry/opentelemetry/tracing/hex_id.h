@@ -0,0 +1,75 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "fmt/format.h"
+
+namespace trpc::opentelemetry {
+
+/// @brief A trace id or span id in lower-case hex, which is stored inline so that getting and printing it does not
+///        allocate. It can be printed by fmt directly, such as `TRPC_FMT_INFO("trace id: {}", id)`.
+/// @tparam N the number of hex digits
+template <size_t N>
+class HexId {
+ public:
+  /// @brief Creates an empty id, which means there is no valid span.
+  HexId() = default;
+
+  /// @brief Creates the id from the binary id of opentelemetry.
+  /// @tparam BinaryId ::opentelemetry::trace::TraceId or ::opentelemetry::trace::SpanId
+  template <typename BinaryId>
+  explicit HexId(const BinaryId& id) : size_(N) {
+    id.ToLowerBase16(data_);
+  }
+
+  bool Empty() const { return size_ == 0; }
+
+  /// @brief Gets the digits, which are not null-terminated.
+  const char* Data() const { return data_; }
+
+  /// @brief Gets the number of digits, which is N or 0 if the id is empty.
+  size_t Size() const { return size_; }
+
+  std::string_view View() const { return std::string_view(data_, size_); }
+
+  std::string ToString() const { return std::string(data_, size_); }
+
+  bool operator==(const HexId& other) const { return View() == other.View(); }
+
+  bool operator!=(const HexId& other) const { return View() != other.View(); }
+
+ private:
+  char data_[N] = {};
+  size_t size_ = 0;
+};
+
+/// @brief The trace id of 32 hex digits.
+using TraceIdHex = HexId<32>;
+
+/// @brief The span id of 16 hex digits.
+using SpanIdHex = HexId<16>;
+
+}  // namespace trpc::opentelemetry
+
+template <size_t N>
+struct fmt::formatter<trpc::opentelemetry::HexId<N>> : fmt::formatter<fmt::string_view> {
+  template <typename FormatContext>
+  auto format(const trpc::opentelemetry::HexId<N>& id, FormatContext& ctx) const -> decltype(ctx.out()) {
+    return fmt::formatter<fmt::string_view>::format(fmt::string_view(id.Data(), id.Size()), ctx);
+  }
+};
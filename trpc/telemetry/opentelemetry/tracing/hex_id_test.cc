@@ -0,0 +1,51 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#include "trpc/telemetry/opentelemetry/tracing/hex_id.h"
+
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "opentelemetry/trace/span_id.h"
+#include "opentelemetry/trace/trace_id.h"
+
+namespace trpc::testing {
+
+TEST(HexIdTest, Empty) {
+  trpc::opentelemetry::TraceIdHex trace_id;
+  ASSERT_TRUE(trace_id.Empty());
+  ASSERT_EQ(0, trace_id.Size());
+  ASSERT_EQ("", trace_id.ToString());
+  ASSERT_EQ("[]", fmt::format("[{}]", trace_id));
+}
+
+TEST(HexIdTest, FromBinaryId) {
+  constexpr uint8_t buf_trace[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 0xff};
+  constexpr uint8_t buf_span[] = {0xa1, 2, 3, 4, 5, 6, 7, 8};
+  trpc::opentelemetry::TraceIdHex trace_id(::opentelemetry::trace::TraceId{buf_trace});
+  trpc::opentelemetry::SpanIdHex span_id(::opentelemetry::trace::SpanId{buf_span});
+
+  ASSERT_FALSE(trace_id.Empty());
+  ASSERT_EQ(32, trace_id.Size());
+  ASSERT_EQ("0102030405060708090a0b0c0d0e0fff", trace_id.View());
+  ASSERT_EQ("a102030405060708", span_id.ToString());
+  ASSERT_EQ("trace_id: 0102030405060708090a0b0c0d0e0fff, span_id: a102030405060708",
+            fmt::format("trace_id: {}, span_id: {}", trace_id, span_id));
+  // the format specs of strings are supported
+  ASSERT_EQ("a102030405060708  ", fmt::format("{:18}", span_id));
+
+  ASSERT_EQ(trace_id, trpc::opentelemetry::TraceIdHex(::opentelemetry::trace::TraceId{buf_trace}));
+  ASSERT_NE(trace_id, trpc::opentelemetry::TraceIdHex());
+}
+
+}  // namespace trpc::testing
@@ -0,0 +1,95 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#include "trpc/telemetry/opentelemetry/tracing/id_generator.h"
+
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <thread>
+
+namespace trpc::opentelemetry {
+
+namespace {
+
+uint64_t SplitMix64(uint64_t& x) noexcept {
+  uint64_t z = (x += 0x9e3779b97f4a7c15);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+  return z ^ (z >> 31);
+}
+
+uint64_t GetThreadSeed() noexcept {
+  uint64_t seed = 0;
+  try {
+    std::random_device device;
+    seed = (static_cast<uint64_t>(device()) << 32) | device();
+  } catch (...) {
+    // falls back to the time and the thread, which differ between the threads and the processes
+  }
+  seed ^= static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+  seed ^= std::hash<std::thread::id>()(std::this_thread::get_id()) << 1;
+  return seed;
+}
+
+Xoshiro256PlusPlus& GetThreadGenerator() noexcept {
+  thread_local Xoshiro256PlusPlus generator(GetThreadSeed());
+  return generator;
+}
+
+// Fills the buffer with the random bytes, which are not all zero as the invalid ids are
+template <size_t N>
+void FillRandomBytes(uint8_t (&buf)[N]) noexcept {
+  static_assert(N % sizeof(uint64_t) == 0, "the size of the ids must be a multiple of 8");
+  auto& generator = GetThreadGenerator();
+  uint64_t words[N / sizeof(uint64_t)];
+  uint64_t any = 0;
+  do {
+    for (auto& word : words) {
+      word = generator();
+      any |= word;
+    }
+  } while (any == 0);
+  std::memcpy(buf, words, N);
+}
+
+}  // namespace
+
+Xoshiro256PlusPlus::Xoshiro256PlusPlus(uint64_t seed) noexcept {
+  for (auto& word : state_) {
+    word = SplitMix64(seed);
+  }
+}
+
+::opentelemetry::trace::SpanId IdGenerator::GenerateSpanId() noexcept {
+  uint8_t span_id[::opentelemetry::trace::SpanId::kSize];
+  FillRandomBytes(span_id);
+  return ::opentelemetry::trace::SpanId(span_id);
+}
+
+::opentelemetry::trace::TraceId IdGenerator::GenerateTraceId() noexcept {
+  uint8_t trace_id[::opentelemetry::trace::TraceId::kSize];
+  FillRandomBytes(trace_id);
+  if (options_.time_prefixed_trace_id) {
+    auto seconds = static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+    trace_id[0] = static_cast<uint8_t>(seconds >> 24);
+    trace_id[1] = static_cast<uint8_t>(seconds >> 16);
+    trace_id[2] = static_cast<uint8_t>(seconds >> 8);
+    trace_id[3] = static_cast<uint8_t>(seconds);
+  }
+  return ::opentelemetry::trace::TraceId(trace_id);
+}
+
+}  // namespace trpc::opentelemetry
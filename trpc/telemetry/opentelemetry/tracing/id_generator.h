@@ -0,0 +1,77 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "opentelemetry/sdk/trace/id_generator.h"
+
+namespace trpc::opentelemetry {
+
+/// @brief The xoshiro256++ generator, which is fast and passes the statistical tests such as BigCrush. It is not
+///        cryptographically secure, which the ids of traces do not require.
+class Xoshiro256PlusPlus {
+ public:
+  /// @brief Seeds the state by splitmix64, as the generator recommends.
+  explicit Xoshiro256PlusPlus(uint64_t seed) noexcept;
+
+  /// @brief Uses the state directly, which must not be all zero.
+  explicit Xoshiro256PlusPlus(const std::array<uint64_t, 4>& state) noexcept : state_(state) {}
+
+  uint64_t operator()() noexcept {
+    uint64_t result = Rotl(state_[0] + state_[3], 23) + state_[0];
+    uint64_t t = state_[1] << 17;
+    state_[2] ^= state_[0];
+    state_[3] ^= state_[1];
+    state_[1] ^= state_[2];
+    state_[0] ^= state_[3];
+    state_[2] ^= t;
+    state_[3] = Rotl(state_[3], 45);
+    return result;
+  }
+
+ private:
+  static uint64_t Rotl(uint64_t x, int k) noexcept { return (x << k) | (x >> (64 - k)); }
+
+ private:
+  std::array<uint64_t, 4> state_;
+};
+
+/// @brief Generates the ids of traces and spans by a xoshiro256++ generator of each thread, which replaces the
+///        RandomIdGenerator of the SDK.
+/// @note The generator of a thread is seeded by std::random_device when the thread generates its first id. A child
+///       process forked after that shares the sequence of its parent, so the ids should not be generated before
+///       forking.
+class IdGenerator : public ::opentelemetry::sdk::trace::IdGenerator {
+ public:
+  struct Options {
+    /// Whether to put the seconds of the unix time in the first 4 bytes of the trace ids (big-endian), so that the
+    /// trace ids generated together are stored together by the trace stores keyed by them. The other 12 bytes are
+    /// random, and the ratio sampling still works as it reads the random bytes 4-7 as the high bits.
+    bool time_prefixed_trace_id = false;
+  };
+
+ public:
+  explicit IdGenerator(Options options) : options_(options) {}
+
+  ::opentelemetry::trace::SpanId GenerateSpanId() noexcept override;
+
+  ::opentelemetry::trace::TraceId GenerateTraceId() noexcept override;
+
+ private:
+  Options options_;
+};
+
+}  // namespace trpc::opentelemetry
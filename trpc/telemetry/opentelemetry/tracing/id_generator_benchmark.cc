@@ -0,0 +1,68 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#include "benchmark/benchmark.h"
+#include "opentelemetry/sdk/trace/random_id_generator.h"
+
+#include "trpc/telemetry/opentelemetry/tracing/id_generator.h"
+
+namespace {
+
+// The default generator of the SDK
+void BM_SdkGenerateSpanId(benchmark::State& state) {
+  ::opentelemetry::sdk::trace::RandomIdGenerator id_generator;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(id_generator.GenerateSpanId());
+  }
+}
+
+void BM_SdkGenerateTraceId(benchmark::State& state) {
+  ::opentelemetry::sdk::trace::RandomIdGenerator id_generator;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(id_generator.GenerateTraceId());
+  }
+}
+
+void BM_GenerateSpanId(benchmark::State& state) {
+  trpc::opentelemetry::IdGenerator id_generator(trpc::opentelemetry::IdGenerator::Options{});
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(id_generator.GenerateSpanId());
+  }
+}
+
+void BM_GenerateTraceId(benchmark::State& state) {
+  trpc::opentelemetry::IdGenerator id_generator(trpc::opentelemetry::IdGenerator::Options{});
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(id_generator.GenerateTraceId());
+  }
+}
+
+// The trace id with the time prefix, which reads the system clock on every call
+void BM_GenerateTimePrefixedTraceId(benchmark::State& state) {
+  trpc::opentelemetry::IdGenerator::Options options;
+  options.time_prefixed_trace_id = true;
+  trpc::opentelemetry::IdGenerator id_generator(options);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(id_generator.GenerateTraceId());
+  }
+}
+
+}  // namespace
+
+BENCHMARK(BM_SdkGenerateSpanId)->ThreadRange(1, 8);
+BENCHMARK(BM_SdkGenerateTraceId)->ThreadRange(1, 8);
+BENCHMARK(BM_GenerateSpanId)->ThreadRange(1, 8);
+BENCHMARK(BM_GenerateTraceId)->ThreadRange(1, 8);
+BENCHMARK(BM_GenerateTimePrefixedTraceId)->ThreadRange(1, 8);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,148 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#include "trpc/telemetry/opentelemetry/tracing/id_generator.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace trpc::testing {
+
+namespace {
+
+uint64_t ToUint64(const ::opentelemetry::trace::SpanId& span_id) {
+  uint8_t buf[::opentelemetry::trace::SpanId::kSize];
+  span_id.CopyBytesTo(buf);
+  uint64_t id = 0;
+  std::memcpy(&id, buf, sizeof(id));
+  return id;
+}
+
+std::array<uint8_t, ::opentelemetry::trace::TraceId::kSize> ToBytes(const ::opentelemetry::trace::TraceId& trace_id) {
+  std::array<uint8_t, ::opentelemetry::trace::TraceId::kSize> bytes;
+  uint8_t buf[::opentelemetry::trace::TraceId::kSize];
+  trace_id.CopyBytesTo(buf);
+  std::memcpy(bytes.data(), buf, bytes.size());
+  return bytes;
+}
+
+}  // namespace
+
+TEST(Xoshiro256PlusPlusTest, ReferenceOutput) {
+  // the outputs of the reference implementation of xoshiro256++
+  trpc::opentelemetry::Xoshiro256PlusPlus generator(std::array<uint64_t, 4>{1, 2, 3, 4});
+  ASSERT_EQ(41943041ull, generator());
+  ASSERT_EQ(58720359ull, generator());
+  ASSERT_EQ(3588806011781223ull, generator());
+}
+
+TEST(Xoshiro256PlusPlusTest, SplitMix64Seed) {
+  // the state is the first outputs of splitmix64 of the seed
+  trpc::opentelemetry::Xoshiro256PlusPlus seeded(0);
+  trpc::opentelemetry::Xoshiro256PlusPlus generator(std::array<uint64_t, 4>{
+      0xe220a8397b1dcdafull, 0x6e789e6aa1b965f4ull, 0x06c45d188009454full, 0xf88bb8a8724c81ecull});
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_EQ(generator(), seeded());
+  }
+}
+
+TEST(IdGeneratorTest, BitFrequency) {
+  trpc::opentelemetry::IdGenerator id_generator(trpc::opentelemetry::IdGenerator::Options{});
+  constexpr int kNum = 1 << 16;
+  std::array<int, 64> ones{};
+  for (int i = 0; i < kNum; ++i) {
+    uint64_t id = ToUint64(id_generator.GenerateSpanId());
+    ASSERT_NE(0, id);
+    for (int bit = 0; bit < 64; ++bit) {
+      ones[bit] += (id >> bit) & 1;
+    }
+  }
+  // each bit is set by half of the ids, the standard deviation is sqrt(kNum) / 2 = 128, and 6 of them are allowed
+  for (int bit = 0; bit < 64; ++bit) {
+    ASSERT_NEAR(kNum / 2, ones[bit], 768) << "bit " << bit;
+  }
+}
+
+TEST(IdGeneratorTest, ByteDistribution) {
+  trpc::opentelemetry::IdGenerator id_generator(trpc::opentelemetry::IdGenerator::Options{});
+  constexpr int kNum = 1 << 15;
+  std::array<int, 256> counts{};
+  for (int i = 0; i < kNum; ++i) {
+    for (uint8_t byte : ToBytes(id_generator.GenerateTraceId())) {
+      ++counts[byte];
+    }
+  }
+  // the chi-squared statistic of 255 degrees of freedom, whose mean is 255 and standard deviation is about 22.6
+  double expected = kNum * 16.0 / 256;
+  double chi_squared = 0;
+  for (int count : counts) {
+    chi_squared += (count - expected) * (count - expected) / expected;
+  }
+  ASSERT_LT(chi_squared, 255 + 6 * 22.6);
+}
+
+TEST(IdGeneratorTest, UniqueAcrossThreads) {
+  trpc::opentelemetry::IdGenerator id_generator(trpc::opentelemetry::IdGenerator::Options{});
+  constexpr int kThreadNum = 4;
+  constexpr int kNum = 25000;
+  std::mutex mutex;
+  std::set<uint64_t> ids;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadNum; ++i) {
+    threads.emplace_back([&]() {
+      std::vector<uint64_t> thread_ids;
+      for (int j = 0; j < kNum; ++j) {
+        thread_ids.push_back(ToUint64(id_generator.GenerateSpanId()));
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      ids.insert(thread_ids.begin(), thread_ids.end());
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  // the threads are seeded differently, and the collision probability of the 64-bit ids is about 1e-10
+  ASSERT_EQ(kThreadNum * kNum, ids.size());
+}
+
+TEST(IdGeneratorTest, TimePrefixedTraceId) {
+  trpc::opentelemetry::IdGenerator::Options options;
+  options.time_prefixed_trace_id = true;
+  trpc::opentelemetry::IdGenerator id_generator(options);
+
+  auto now = [] {
+    return static_cast<uint32_t>(
+        std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+  };
+  uint32_t begin = now();
+  auto first = ToBytes(id_generator.GenerateTraceId());
+  auto second = ToBytes(id_generator.GenerateTraceId());
+  uint32_t end = now();
+
+  uint32_t prefix = (static_cast<uint32_t>(first[0]) << 24) | (static_cast<uint32_t>(first[1]) << 16) |
+                    (static_cast<uint32_t>(first[2]) << 8) | first[3];
+  ASSERT_LE(begin, prefix);
+  ASSERT_GE(end, prefix);
+  // the other bytes are random
+  ASSERT_NE(0, std::memcmp(first.data() + 4, second.data() + 4, first.size() - 4));
+}
+
+}  // namespace trpc::testing
@@ -24,10 +24,21 @@
 #include "trpc/telemetry/opentelemetry/tracing/common.h"
 #include "trpc/telemetry/opentelemetry/tracing/deferred_sample_processor.h"
 #include "trpc/telemetry/opentelemetry/tracing/grpc_trace_exporter.h"
+#include "trpc/telemetry/opentelemetry/tracing/id_generator.h"
 #include "trpc/telemetry/opentelemetry/tracing/sampler.h"
 
 namespace trpc {
 
+OpenTelemetryTracing::~OpenTelemetryTracing() {
+  std::scoped_lock lock(cache_mutex_);
+  // a plugin initialized later keeps its own values
+  if (cache_owner_ == this) {
+    cache_owner_ = nullptr;
+    filter_data_index_.store(0, std::memory_order_relaxed);
+    server_tracer_.store(nullptr, std::memory_order_release);
+  }
+}
+
 int OpenTelemetryTracing::Init() noexcept {
   bool ret = TrpcConfig::GetInstance()->GetPluginConfig("telemetry", trpc::opentelemetry::kOpenTelemetryTelemetryName,
                                                         config_);
@@ -40,6 +51,15 @@ int OpenTelemetryTracing::Init() noexcept {
     TRPC_LOG_ERROR("InitOpenTelemetry failed...");
     return -1;
   }
+
+  const auto& server_config = TrpcConfig::GetInstance()->GetServerConfig();
+  std::string err_msg;
+  server_tracer_holder_ = MakeTracer((server_config.app + "." + server_config.server).c_str(), err_msg);
+
+  std::scoped_lock lock(cache_mutex_);
+  cache_owner_ = this;
+  filter_data_index_.store(GetPluginID(), std::memory_order_relaxed);
+  server_tracer_.store(server_tracer_holder_.get(), std::memory_order_release);
   return 0;
 }
 
@@ -75,6 +95,13 @@ bool OpenTelemetryTracing::InitOpenTelemetry() {
     trpc::opentelemetry::DeferredSampleProcessor::Options deferred_opts;
     deferred_opts.enable_sample_error = config_.traces_config.enable_deferred_sample;
     deferred_opts.sample_slow_duration = std::chrono::milliseconds(config_.traces_config.deferred_sample_slow_duration);
+    deferred_opts.decision_func = [listener = deferred_sample_listener_](
+                                      const ::opentelemetry::trace::TraceId& trace_id,
+                                      const ::opentelemetry::trace::SpanId& span_id, bool sampled) {
+      if (*listener) {
+        (*listener)(trace_id, span_id, sampled);
+      }
+    };
     processor = std::make_unique<trpc::opentelemetry::DeferredSampleProcessor>(
         std::make_unique<::opentelemetry::sdk::trace::BatchSpanProcessor>(std::move(exporter), batch_op),
         std::move(deferred_opts));
@@ -94,10 +121,18 @@ bool OpenTelemetryTracing::InitOpenTelemetry() {
   sample_opts.ratio = config_.sampler_config.fraction;
   sample_opts.disable_parent_sampling = config_.traces_config.disable_parent_sampling;
   sample_opts.enable_deferred_sample = config_.traces_config.enable_deferred_sample;
+  trpc::opentelemetry::IdGenerator::Options id_opts;
+  id_opts.time_prefixed_trace_id = config_.traces_config.time_prefixed_trace_id;
   std::shared_ptr<::opentelemetry::trace::TracerProvider> provider =
       std::make_shared<::opentelemetry::sdk::trace::TracerProvider>(
-          std::move(processor), resource, std::make_unique<trpc::opentelemetry::Sampler>(std::move(sample_opts)));
+          std::move(processor), resource, std::make_unique<trpc::opentelemetry::Sampler>(std::move(sample_opts)),
+          std::make_unique<trpc::opentelemetry::IdGenerator>(id_opts));
   ::opentelemetry::trace::Provider::SetTracerProvider(provider);
+
+  // installs the fiber local storage of the current span before any span is made current
+  context_storage_ = ::opentelemetry::nostd::shared_ptr<::opentelemetry::context::RuntimeContextStorage>(
+      new trpc::opentelemetry::FiberContextStorage());
+  ::opentelemetry::context::RuntimeContext::SetRuntimeContextStorage(context_storage_);
   return true;
 }
 
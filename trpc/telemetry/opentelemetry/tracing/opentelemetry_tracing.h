@@ -13,12 +13,19 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
 
 #include "opentelemetry/sdk/trace/exporter.h"
+#include "opentelemetry/trace/tracer.h"
 
 #include "trpc/telemetry/opentelemetry/opentelemetry_common.h"
 #include "trpc/telemetry/opentelemetry/opentelemetry_telemetry_conf.h"
+#include "trpc/telemetry/opentelemetry/tracing/deferred_sample_processor.h"
+#include "trpc/telemetry/opentelemetry/tracing/fiber_context_storage.h"
 #include "trpc/tracing/tracing.h"
 
 namespace trpc {
@@ -26,6 +33,10 @@ namespace trpc {
 /// @brief The implementation class for tracing capabilities of the OpenTelemetry plugin.
 class OpenTelemetryTracing : public Tracing {
  public:
+  /// @brief Clears the filter data index and the server tracer cached by Init if they still belong to the plugin, so
+  ///        that they do not refer to a destroyed plugin.
+  ~OpenTelemetryTracing() override;
+
   int Init() noexcept override;
 
   std::string Name() const override { return trpc::opentelemetry::kOpenTelemetryTelemetryName; }
@@ -40,6 +51,30 @@ class OpenTelemetryTracing : public Tracing {
   /// @brief Gets the config for OpenTelemetryTracing
   const OpenTelemetryConfig& GetConfig() { return config_; }
 
+  /// @brief Gets the filter data index of the latest initialized plugin, which is cached by Init so that the logging
+  ///        and tracing interfaces do not look up the plugin on every call.
+  /// @return Return the index, or 0 if no plugin has been initialized or the plugin has been destroyed.
+  static uint32_t GetFilterDataIndex() { return filter_data_index_.load(std::memory_order_relaxed); }
+
+  /// @brief Gets the tracer of the server created by the latest initialized plugin, which is cached by Init so that
+  ///        the spans started by the handlers do not look up the tracer.
+  /// @return Return the tracer, or nullptr if no plugin has been initialized or the plugin has been destroyed.
+  static ::opentelemetry::trace::Tracer* GetServerTracer() { return server_tracer_.load(std::memory_order_acquire); }
+
+  /// @brief Sets the listener of the final decisions of deferred sampling, which is called when a span not sampled at
+  ///        start ends. It only works when traces:enable_deferred_sample is true.
+  /// @param listener the listener
+  /// @note It is not thread-safe, and should be called when the plugins are initialized before any span is started.
+  void SetDeferredSampleListener(trpc::opentelemetry::DeferredSampleProcessor::DecisionFunc listener) {
+    *deferred_sample_listener_ = std::move(listener);
+  }
+
+  /// @brief Gets the runtime context storage installed by Init, which keeps the current span of each fiber.
+  /// @return Return the storage, or nullptr before the plugin is initialized.
+  trpc::opentelemetry::FiberContextStorage* GetContextStorage() {
+    return static_cast<trpc::opentelemetry::FiberContextStorage*>(context_storage_.get());
+  }
+
  private:
   std::unique_ptr<::opentelemetry::sdk::trace::SpanExporter> GetExporter();
 
@@ -47,6 +82,26 @@ class OpenTelemetryTracing : public Tracing {
 
  private:
   OpenTelemetryConfig config_;
+
+  // shared with the processor, which may outlive the plugin as the provider is global
+  std::shared_ptr<trpc::opentelemetry::DeferredSampleProcessor::DecisionFunc> deferred_sample_listener_ =
+      std::make_shared<trpc::opentelemetry::DeferredSampleProcessor::DecisionFunc>();
+
+  // a FiberContextStorage shared with the runtime context of OpenTelemetry, which is global
+  ::opentelemetry::nostd::shared_ptr<::opentelemetry::context::RuntimeContextStorage> context_storage_;
+
+  // the tracer pointed by server_tracer_, which is kept alive by the plugin
+  ::opentelemetry::nostd::shared_ptr<::opentelemetry::trace::Tracer> server_tracer_holder_;
+
+  // protects cache_owner_ together with the cached values below, which are updated by Init and the destructor
+  static inline std::mutex cache_mutex_;
+
+  // the plugin whose values are cached
+  static inline const OpenTelemetryTracing* cache_owner_ = nullptr;
+
+  static inline std::atomic<uint32_t> filter_data_index_{0};
+
+  static inline std::atomic<::opentelemetry::trace::Tracer*> server_tracer_{nullptr};
 };
 
 using OpenTelemetryTracingPtr = RefPtr<OpenTelemetryTracing>;
@@ -13,6 +13,9 @@
 
 #include "trpc/telemetry/opentelemetry/tracing/opentelemetry_tracing_api.h"
 
+#include "opentelemetry/context/runtime_context.h"
+#include "opentelemetry/trace/context.h"
+
 #include "trpc/telemetry/opentelemetry/opentelemetry_common.h"
 #include "trpc/telemetry/opentelemetry/tracing/opentelemetry_tracing.h"
 #include "trpc/telemetry/telemetry_factory.h"
@@ -33,9 +36,26 @@ OpenTelemetryTracingPtr GetTracingPlugin() {
   return tracing;
 }
 
+// Gets the span from the filter data of the tracing plugin, which takes a single type check of each std::any
+const OpenTelemetryTracingSpanPtr* GetValidSpan(const ServerTracingSpan* server_tracing_span) {
+  if (!server_tracing_span) {
+    return nullptr;
+  }
+  auto* tracing_span = std::any_cast<OpenTelemetryTracingSpanPtr>(&server_tracing_span->span);
+  if (!tracing_span || tracing_span->get() == nullptr) {
+    return nullptr;
+  }
+  return tracing_span;
+}
+
 }  // namespace
 
 uint32_t GetTracingFilterDataIndex() {
+  uint32_t filter_index = trpc::OpenTelemetryTracing::GetFilterDataIndex();
+  if (filter_index != kInvalidTracingFilterDataIndex) {
+    return filter_index;
+  }
+
   auto tracing = GetTracingPlugin();
   if (tracing) {
     return tracing->GetPluginID();
@@ -43,38 +63,83 @@ uint32_t GetTracingFilterDataIndex() {
   return kInvalidTracingFilterDataIndex;
 }
 
-OpenTelemetryTracingSpanPtr GetTracingSpan(const ServerContextPtr& context) {
+const OpenTelemetryTracingSpanPtr* GetTracingSpanPtr(const ServerContextPtr& context) {
   uint32_t filter_index = GetTracingFilterDataIndex();
-  if (filter_index != kInvalidTracingFilterDataIndex) {
-    auto* server_tracing_span = context->GetFilterData<ServerTracingSpan>(filter_index);
-    if (server_tracing_span) {
-      auto* tracing_span = std::any_cast<OpenTelemetryTracingSpanPtr>(&server_tracing_span->span);
-      if (tracing_span) {
-        return *tracing_span;
-      }
-    }
+  if (filter_index == kInvalidTracingFilterDataIndex) {
+    return nullptr;
+  }
+  return GetValidSpan(context->GetFilterData<ServerTracingSpan>(filter_index));
+}
+
+const OpenTelemetryTracingSpanPtr* GetTracingSpanPtr(const std::unordered_map<uint32_t, std::any>& filter_data) {
+  uint32_t filter_index = GetTracingFilterDataIndex();
+  if (filter_index == kInvalidTracingFilterDataIndex) {
+    return nullptr;
+  }
+  auto it = filter_data.find(filter_index);
+  if (it == filter_data.end()) {
+    return nullptr;
+  }
+  return GetValidSpan(std::any_cast<ServerTracingSpan>(&it->second));
+}
+
+OpenTelemetryTracingSpanPtr GetTracingSpan(const ServerContextPtr& context) {
+  auto* span = GetTracingSpanPtr(context);
+  if (span) {
+    return *span;
   }
   return OpenTelemetryTracingSpanPtr(nullptr);
 }
 
-std::string GetTraceID(const ServerContextPtr& context) {
-  auto span = GetTracingSpan(context);
-  if (span.get() != nullptr) {
-    char trace_id[32];
-    span->GetContext().trace_id().ToLowerBase16(trace_id);
-    return std::string(trace_id, sizeof(trace_id));
+std::string GetTraceID(const ServerContextPtr& context) { return GetTraceIDHex(context).ToString(); }
+
+std::string GetSpanID(const ServerContextPtr& context) { return GetSpanIDHex(context).ToString(); }
+
+TraceIdHex GetTraceIDHex(const ServerContextPtr& context) {
+  auto* span = GetTracingSpanPtr(context);
+  if (span) {
+    return TraceIdHex((*span)->GetContext().trace_id());
+  }
+  return TraceIdHex();
+}
+
+SpanIdHex GetSpanIDHex(const ServerContextPtr& context) {
+  auto* span = GetTracingSpanPtr(context);
+  if (span) {
+    return SpanIdHex((*span)->GetContext().span_id());
   }
-  return "";
+  return SpanIdHex();
 }
 
-std::string GetSpanID(const ServerContextPtr& context) {
-  auto span = GetTracingSpan(context);
-  if (span.get() != nullptr) {
-    char span_id[16];
-    span->GetContext().span_id().ToLowerBase16(span_id);
-    return std::string(span_id, sizeof(span_id));
+bool GetTraceID(const ServerContextPtr& context, char (&trace_id)[32]) {
+  auto* span = GetTracingSpanPtr(context);
+  if (span) {
+    (*span)->GetContext().trace_id().ToLowerBase16(trace_id);
+    return true;
   }
-  return "";
+  return false;
+}
+
+bool GetSpanID(const ServerContextPtr& context, char (&span_id)[16]) {
+  auto* span = GetTracingSpanPtr(context);
+  if (span) {
+    (*span)->GetContext().span_id().ToLowerBase16(span_id);
+    return true;
+  }
+  return false;
+}
+
+OpenTelemetryTracingSpanPtr GetCurrentSpan() {
+  // the span of the runtime context is a default one with the invalid span context when there is no current span
+  auto span = ::opentelemetry::trace::GetSpan(::opentelemetry::context::RuntimeContext::GetCurrent());
+  if (span && span->GetContext().IsValid()) {
+    return span;
+  }
+  return OpenTelemetryTracingSpanPtr(nullptr);
+}
+
+::opentelemetry::trace::Scope WithCurrentSpan(const OpenTelemetryTracingSpanPtr& span) {
+  return ::opentelemetry::trace::Scope(span);
 }
 
 }  // namespace trpc::opentelemetry
@@ -13,12 +13,19 @@
 
 #pragma once
 
+#include <any>
 #include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
 
+#include "opentelemetry/context/runtime_context.h"
+#include "opentelemetry/trace/scope.h"
 #include "trpc/server/server_context.h"
 
 #include "trpc/telemetry/opentelemetry/tracing/client_filter.h"
 #include "trpc/telemetry/opentelemetry/tracing/common.h"
+#include "trpc/telemetry/opentelemetry/tracing/hex_id.h"
 #include "trpc/telemetry/opentelemetry/tracing/server_filter.h"
 
 /// @brief OpenTelemetry tracing interfaces for user programing
@@ -30,8 +37,22 @@ constexpr uint32_t kInvalidTracingFilterDataIndex = 0;
 /// @brief Gets the tracing filter data index of the OpenTelemetry plugin, which can be used to get or set tracing data.
 /// @return Return the tracing filter data index. Note that kInvalidTracingFilterDataIndex will be returned when the
 ///         OpenTelemetry plugin is not registered correctly.
+/// @note The index is cached when the plugin is initialized, and the plugin is only looked up before that.
 uint32_t GetTracingFilterDataIndex();
 
+/// @brief Gets the span saved in the context without copying it, which is cheaper than GetTracingSpan.
+/// @param context server context
+/// @return Return a pointer to the span, which is valid as long as the context. Note that nullptr will be returned when
+///         there is no valid span in the context.
+const OpenTelemetryTracingSpanPtr* GetTracingSpanPtr(const ServerContextPtr& context);
+
+/// @brief Gets the span saved in the filter data of the context without copying it, which is used by the logging
+///        plugins whose log records carry the filter data.
+/// @param filter_data the filter data of the server context
+/// @return Return a pointer to the span, which is valid as long as the filter data. Note that nullptr will be returned
+///         when there is no valid span in the filter data.
+const OpenTelemetryTracingSpanPtr* GetTracingSpanPtr(const std::unordered_map<uint32_t, std::any>& filter_data);
+
 /// @brief Gets the span.
 /// @param context server context
 /// @return Return the span saved in the context. Note that OpenTelemetryTracingSpanPtr(nullptr) will be returned when
@@ -50,4 +71,56 @@ std::string GetTraceID(const ServerContextPtr& context);
 ///         context.
 std::string GetSpanID(const ServerContextPtr& context);
 
+/// @brief Gets the trace id without allocation, which is preferred when printing the trace id of every call.
+/// @param context server context
+/// @return Return the trace id of the context, which can be printed by fmt directly. Note that an empty id will be
+///         returned when there is no valid span in the context.
+TraceIdHex GetTraceIDHex(const ServerContextPtr& context);
+
+/// @brief Gets the span id without allocation.
+/// @param context server context
+/// @return Return the span id of the context, which can be printed by fmt directly. Note that an empty id will be
+///         returned when there is no valid span in the context.
+SpanIdHex GetSpanIDHex(const ServerContextPtr& context);
+
+/// @brief Writes the trace id into the buffer of the caller.
+/// @param context server context
+/// @param [out] trace_id the buffer of the lower-hex trace id, which is not null-terminated
+/// @return Return true if the trace id is written, false when there is no valid span in the context.
+bool GetTraceID(const ServerContextPtr& context, char (&trace_id)[32]);
+
+/// @brief Writes the span id into the buffer of the caller.
+/// @param context server context
+/// @param [out] span_id the buffer of the lower-hex span id, which is not null-terminated
+/// @return Return true if the span id is written, false when there is no valid span in the context.
+bool GetSpanID(const ServerContextPtr& context, char (&span_id)[16]);
+
+/// @brief Gets the current span of the calling fiber, or of the calling thread out of the fiber runtime, which
+///        correlates the logs and the client calls out of the server contexts, such as the ones of the client-only
+///        processes, the background tasks and the timers.
+/// @return Return the current span. Note that OpenTelemetryTracingSpanPtr(nullptr) will be returned when there is no
+///         valid current span.
+OpenTelemetryTracingSpanPtr GetCurrentSpan();
+
+/// @brief Makes the span the current span of the calling thread until the returned scope is destroyed.
+/// @param span the span, which is usually started by the tracer of the plugin
+/// @return Return the scope, which restores the previous current span when it is destroyed.
+/// @note The scope must be destroyed by the thread which creates it, in the reverse order of the creation.
+::opentelemetry::trace::Scope WithCurrentSpan(const OpenTelemetryTracingSpanPtr& span);
+
+/// @brief Binds the current context to the function, which is made current again while the function runs. The current
+///        span is kept per fiber and is not inherited, so the functions run by the new fibers and the asynchronous
+///        continuations should be bound to find the current span of the code starting them.
+/// @param func the function, such as the one passed to StartFiberDetached or Future::Then
+/// @return Return the bound function, which takes the same arguments and returns the same result as func.
+/// @note For example: `trpc::StartFiberDetached(trpc::opentelemetry::BindCurrentContext([]() { ... }));`
+template <typename Func>
+auto BindCurrentContext(Func&& func) {
+  return [context = ::opentelemetry::context::RuntimeContext::GetCurrent(),
+          func = std::forward<Func>(func)](auto&&... args) mutable -> decltype(auto) {
+    auto token = ::opentelemetry::context::RuntimeContext::Attach(context);
+    return func(std::forward<decltype(args)>(args)...);
+  };
+}
+
 }  // namespace trpc::opentelemetry
@@ -0,0 +1,218 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#include <any>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "benchmark/benchmark.h"
+#include "fmt/format.h"
+#include "opentelemetry/trace/default_span.h"
+#include "trpc/common/config/trpc_config.h"
+#include "trpc/server/server_context.h"
+#include "trpc/telemetry/telemetry.h"
+#include "trpc/telemetry/telemetry_factory.h"
+#include "trpc/tracing/tracing_filter_index.h"
+
+#include "trpc/telemetry/opentelemetry/opentelemetry_common.h"
+#include "trpc/telemetry/opentelemetry/tracing/opentelemetry_tracing.h"
+#include "trpc/telemetry/opentelemetry/tracing/opentelemetry_tracing_api.h"
+#include "trpc/telemetry/opentelemetry/tracing/scoped_span.h"
+
+namespace {
+
+class BenchmarkTelemetry : public trpc::Telemetry {
+ public:
+  explicit BenchmarkTelemetry(trpc::TracingPtr tracing) : tracing_(std::move(tracing)) {}
+
+  std::string Name() const override { return trpc::opentelemetry::kOpenTelemetryTelemetryName; }
+
+  trpc::TracingPtr GetTracing() override { return tracing_; }
+
+  trpc::MetricsPtr GetMetrics() override { return nullptr; }
+
+  trpc::LoggingPtr GetLog() override { return nullptr; }
+
+ private:
+  trpc::TracingPtr tracing_;
+};
+
+trpc::OpenTelemetryTracingPtr GetTracing() {
+  static trpc::OpenTelemetryTracingPtr tracing = [] {
+    trpc::TrpcConfig::GetInstance()->Init("./trpc/telemetry/opentelemetry/testing/opentelemetry_telemetry_test.yaml");
+    auto tracing = trpc::MakeRefCounted<trpc::OpenTelemetryTracing>();
+    tracing->Init();
+    trpc::TelemetryFactory::GetInstance()->Register(trpc::MakeRefCounted<BenchmarkTelemetry>(tracing));
+    return tracing;
+  }();
+  return tracing;
+}
+
+trpc::ServerTracingSpan MakeServerTracingSpan() {
+  std::string err_msg;
+  auto tracer = GetTracing()->MakeTracer("benchmark", err_msg);
+  trpc::ServerTracingSpan server_span;
+  server_span.span = trpc::opentelemetry::OpenTelemetryTracingSpanPtr(tracer->StartSpan("benchmark"));
+  return server_span;
+}
+
+trpc::ServerContextPtr MakeServerContext() {
+  auto context = trpc::MakeRefCounted<trpc::ServerContext>();
+  context->SetFilterData(GetTracing()->GetPluginID(), MakeServerTracingSpan());
+  return context;
+}
+
+// The lookup of the plugin which GetTracingFilterDataIndex did on every call before the index was cached.
+void BM_LookupTracingPlugin(benchmark::State& state) {
+  GetTracing();
+  for (auto _ : state) {
+    auto telemetry = trpc::TelemetryFactory::GetInstance()->Get(trpc::opentelemetry::kOpenTelemetryTelemetryName);
+    auto tracing = trpc::dynamic_pointer_cast<trpc::OpenTelemetryTracing>(telemetry->GetTracing());
+    benchmark::DoNotOptimize(tracing->GetPluginID());
+  }
+}
+
+void BM_GetTracingFilterDataIndex(benchmark::State& state) {
+  GetTracing();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(trpc::opentelemetry::GetTracingFilterDataIndex());
+  }
+}
+
+// The span lookup of each log line, which finds the span in the filter data carried by the log record.
+void BM_LogSpanLookup(benchmark::State& state) {
+  std::unordered_map<uint32_t, std::any> filter_data;
+  filter_data[GetTracing()->GetPluginID()] = MakeServerTracingSpan();
+  for (auto _ : state) {
+    const auto* span = trpc::opentelemetry::GetTracingSpanPtr(filter_data);
+    benchmark::DoNotOptimize((*span)->GetContext());
+  }
+}
+
+void BM_GetTracingSpan(benchmark::State& state) {
+  auto context = MakeServerContext();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(trpc::opentelemetry::GetTracingSpan(context));
+  }
+}
+
+void BM_GetTracingSpanPtr(benchmark::State& state) {
+  auto context = MakeServerContext();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(trpc::opentelemetry::GetTracingSpanPtr(context));
+  }
+}
+
+void BM_GetTraceID(benchmark::State& state) {
+  auto context = MakeServerContext();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(trpc::opentelemetry::GetTraceID(context));
+  }
+}
+
+void BM_GetTraceIDHex(benchmark::State& state) {
+  auto context = MakeServerContext();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(trpc::opentelemetry::GetTraceIDHex(context));
+  }
+}
+
+// Formats the trace id into a log line as an access log does, the buffer of the line is reused
+void BM_FormatTraceID(benchmark::State& state) {
+  auto context = MakeServerContext();
+  fmt::memory_buffer line;
+  for (auto _ : state) {
+    line.clear();
+    fmt::format_to(std::back_inserter(line), "trace_id: {}", trpc::opentelemetry::GetTraceIDHex(context));
+    benchmark::DoNotOptimize(line.data());
+  }
+}
+
+// Makes a server context whose span is not sampled
+trpc::ServerContextPtr MakeNotRecordingServerContext() {
+  GetTracing();
+  const uint8_t trace_id[16] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+  const uint8_t span_id[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+  ::opentelemetry::trace::SpanContext span_context(::opentelemetry::trace::TraceId(trace_id),
+                                                   ::opentelemetry::trace::SpanId(span_id),
+                                                   ::opentelemetry::trace::TraceFlags(false), false);
+  trpc::ServerTracingSpan server_span;
+  server_span.span =
+      trpc::opentelemetry::OpenTelemetryTracingSpanPtr(new ::opentelemetry::trace::DefaultSpan(span_context));
+  auto context = trpc::MakeRefCounted<trpc::ServerContext>();
+  context->SetFilterData(GetTracing()->GetPluginID(), std::move(server_span));
+  return context;
+}
+
+// The child span of an unsampled call, which is skipped after checking the parent span. The attributes list is still
+// built by the caller
+void BM_ScopedSpanNotRecording(benchmark::State& state) {
+  auto context = MakeNotRecordingServerContext();
+  for (auto _ : state) {
+    trpc::opentelemetry::ScopedSpan span(context, "child", {{"db.table", "user"}});
+    benchmark::DoNotOptimize(span.IsRecording());
+  }
+}
+
+// The child span of an unsampled call with the attributes set by a function, which is not called
+void BM_ScopedSpanNotRecordingLazy(benchmark::State& state) {
+  auto context = MakeNotRecordingServerContext();
+  for (auto _ : state) {
+    trpc::opentelemetry::ScopedSpan span(context, "child", [](trpc::opentelemetry::ScopedSpan& span) {
+      span.SetAttribute("db.table", "user");
+    });
+    benchmark::DoNotOptimize(span.IsRecording());
+  }
+}
+
+// The child span of a sampled call
+void BM_ScopedSpanRecording(benchmark::State& state) {
+  auto context = MakeServerContext();
+  for (auto _ : state) {
+    trpc::opentelemetry::ScopedSpan span(context, "child", {{"db.table", "user"}});
+    benchmark::DoNotOptimize(span.IsRecording());
+  }
+}
+
+// The child span started by the raw OpenTelemetry API, which looks up the tracer on every call
+void BM_RawChildSpan(benchmark::State& state) {
+  auto context = MakeServerContext();
+  for (auto _ : state) {
+    std::string err_msg;
+    auto tracer = GetTracing()->MakeTracer("benchmark", err_msg);
+    ::opentelemetry::trace::StartSpanOptions op;
+    op.parent = trpc::opentelemetry::GetTracingSpan(context)->GetContext();
+    auto span = tracer->StartSpan("child", {{"db.table", "user"}}, op);
+    span->End();
+  }
+}
+
+}  // namespace
+
+BENCHMARK(BM_LookupTracingPlugin);
+BENCHMARK(BM_GetTracingFilterDataIndex);
+BENCHMARK(BM_LogSpanLookup);
+BENCHMARK(BM_GetTracingSpan);
+BENCHMARK(BM_GetTracingSpanPtr);
+BENCHMARK(BM_GetTraceID);
+BENCHMARK(BM_GetTraceIDHex);
+BENCHMARK(BM_FormatTraceID);
+BENCHMARK(BM_ScopedSpanNotRecording);
+BENCHMARK(BM_ScopedSpanNotRecordingLazy);
+BENCHMARK(BM_ScopedSpanRecording);
+BENCHMARK(BM_RawChildSpan);
+
+BENCHMARK_MAIN();
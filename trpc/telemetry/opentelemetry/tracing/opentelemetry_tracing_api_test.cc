@@ -18,6 +18,9 @@
 #include "trpc/client/testing/service_proxy_testing.h"
 #include "trpc/codec/trpc/testing/trpc_protocol_testing.h"
 #include "trpc/common/config/trpc_config.h"
+#include "trpc/coroutine/fiber.h"
+#include "trpc/coroutine/fiber_latch.h"
+#include "trpc/coroutine/testing/fiber_runtime.h"
 #include "trpc/proto/testing/helloworld.pb.h"
 #include "trpc/server/rpc/rpc_service_impl.h"
 #include "trpc/server/testing/server_context_testing.h"
@@ -88,6 +91,8 @@ TEST_F(OpenTelemetryTracingAPITest, GetTracingFilterDataIndex) {
   uint32_t index = trpc::opentelemetry::GetTracingFilterDataIndex();
   ASSERT_NE(trpc::opentelemetry::kInvalidTracingFilterDataIndex, index);
   ASSERT_EQ(tracing_->GetPluginID(), index);
+  // the index is cached by the initialization of the plugin
+  ASSERT_EQ(tracing_->GetPluginID(), OpenTelemetryTracing::GetFilterDataIndex());
 }
 
 TEST_F(OpenTelemetryTracingAPITest, GetTracingInfo) {
@@ -98,4 +103,119 @@ TEST_F(OpenTelemetryTracingAPITest, GetTracingInfo) {
   ASSERT_EQ(span_id, trpc::opentelemetry::GetSpanID(context));
 }
 
+TEST_F(OpenTelemetryTracingAPITest, GetTracingIDWithoutAllocation) {
+  std::string trace_id, span_id;
+  ServerContextPtr context = GetTestServerContext(trace_id, span_id);
+  ASSERT_EQ(trace_id, trpc::opentelemetry::GetTraceIDHex(context).View());
+  ASSERT_EQ(span_id, trpc::opentelemetry::GetSpanIDHex(context).View());
+  ASSERT_EQ(trace_id + "-" + span_id, fmt::format("{}-{}", trpc::opentelemetry::GetTraceIDHex(context),
+                                                  trpc::opentelemetry::GetSpanIDHex(context)));
+
+  char trace_id_buf[32];
+  char span_id_buf[16];
+  ASSERT_TRUE(trpc::opentelemetry::GetTraceID(context, trace_id_buf));
+  ASSERT_EQ(trace_id, std::string(trace_id_buf, sizeof(trace_id_buf)));
+  ASSERT_TRUE(trpc::opentelemetry::GetSpanID(context, span_id_buf));
+  ASSERT_EQ(span_id, std::string(span_id_buf, sizeof(span_id_buf)));
+
+  // the context without span
+  DummyTrpcProtocol req_data;
+  trpc::test::helloworld::HelloRequest hello_req;
+  NoncontiguousBuffer req_bin_data;
+  PackTrpcRequest(req_data, static_cast<void*>(&hello_req), req_bin_data);
+  ServerContextPtr empty_context = MakeTestServerContext("trpc", trpc_service_.get(), std::move(req_bin_data));
+  ASSERT_TRUE(trpc::opentelemetry::GetTraceIDHex(empty_context).Empty());
+  ASSERT_TRUE(trpc::opentelemetry::GetSpanIDHex(empty_context).Empty());
+  ASSERT_FALSE(trpc::opentelemetry::GetTraceID(empty_context, trace_id_buf));
+  ASSERT_FALSE(trpc::opentelemetry::GetSpanID(empty_context, span_id_buf));
+  ASSERT_EQ("", trpc::opentelemetry::GetTraceID(empty_context));
+}
+
+TEST_F(OpenTelemetryTracingAPITest, GetTracingSpanPtr) {
+  std::string trace_id, span_id;
+  ServerContextPtr context = GetTestServerContext(trace_id, span_id);
+  auto* span = trpc::opentelemetry::GetTracingSpanPtr(context);
+  ASSERT_NE(nullptr, span);
+  ASSERT_EQ(trpc::opentelemetry::GetTracingSpan(context).get(), span->get());
+
+  std::unordered_map<uint32_t, std::any> filter_data;
+  ASSERT_EQ(nullptr, trpc::opentelemetry::GetTracingSpanPtr(filter_data));
+  // the filter data of another type
+  filter_data[tracing_->GetPluginID()] = std::string("test");
+  ASSERT_EQ(nullptr, trpc::opentelemetry::GetTracingSpanPtr(filter_data));
+  // the span of another type
+  ServerTracingSpan invalid_span;
+  invalid_span.span = std::string("test");
+  filter_data[tracing_->GetPluginID()] = invalid_span;
+  ASSERT_EQ(nullptr, trpc::opentelemetry::GetTracingSpanPtr(filter_data));
+  // the null span
+  ServerTracingSpan null_span;
+  null_span.span = trpc::opentelemetry::OpenTelemetryTracingSpanPtr(nullptr);
+  filter_data[tracing_->GetPluginID()] = null_span;
+  ASSERT_EQ(nullptr, trpc::opentelemetry::GetTracingSpanPtr(filter_data));
+
+  ServerTracingSpan valid_span;
+  valid_span.span = *span;
+  filter_data[tracing_->GetPluginID()] = valid_span;
+  auto* filter_data_span = trpc::opentelemetry::GetTracingSpanPtr(filter_data);
+  ASSERT_NE(nullptr, filter_data_span);
+  ASSERT_EQ(span->get(), filter_data_span->get());
+}
+
+TEST_F(OpenTelemetryTracingAPITest, CurrentSpan) {
+  ASSERT_EQ(nullptr, trpc::opentelemetry::GetCurrentSpan().get());
+
+  std::string err_msg;
+  auto tracer = tracing_->MakeTracer("test", err_msg);
+  trpc::opentelemetry::OpenTelemetryTracingSpanPtr outer_span =
+      tracer->StartSpan("outer", {}, ::opentelemetry::trace::StartSpanOptions{});
+  trpc::opentelemetry::OpenTelemetryTracingSpanPtr inner_span =
+      tracer->StartSpan("inner", {}, ::opentelemetry::trace::StartSpanOptions{});
+  {
+    auto outer_scope = trpc::opentelemetry::WithCurrentSpan(outer_span);
+    ASSERT_EQ(outer_span.get(), trpc::opentelemetry::GetCurrentSpan().get());
+    {
+      auto inner_scope = trpc::opentelemetry::WithCurrentSpan(inner_span);
+      ASSERT_EQ(inner_span.get(), trpc::opentelemetry::GetCurrentSpan().get());
+    }
+    // the previous current span is restored
+    ASSERT_EQ(outer_span.get(), trpc::opentelemetry::GetCurrentSpan().get());
+  }
+  ASSERT_EQ(nullptr, trpc::opentelemetry::GetCurrentSpan().get());
+}
+
+TEST_F(OpenTelemetryTracingAPITest, BindCurrentContext) {
+  RunAsFiber([]() {
+    std::string err_msg;
+    auto tracer = tracing_->MakeTracer("test", err_msg);
+    trpc::opentelemetry::OpenTelemetryTracingSpanPtr span =
+        tracer->StartSpan("span", {}, ::opentelemetry::trace::StartSpanOptions{});
+    auto scope = trpc::opentelemetry::WithCurrentSpan(span);
+
+    // the new fiber does not inherit the current span
+    const ::opentelemetry::trace::Span* unbound_span = span.get();
+    const ::opentelemetry::trace::Span* bound_span = nullptr;
+    FiberLatch latch(2);
+    StartFiberDetached([&]() {
+      unbound_span = trpc::opentelemetry::GetCurrentSpan().get();
+      latch.CountDown();
+    });
+    // the bound function finds the current span of the code starting it
+    StartFiberDetached(trpc::opentelemetry::BindCurrentContext([&]() {
+      bound_span = trpc::opentelemetry::GetCurrentSpan().get();
+      latch.CountDown();
+    }));
+    latch.Wait();
+    ASSERT_EQ(nullptr, unbound_span);
+    ASSERT_EQ(span.get(), bound_span);
+
+    // the continuations take the arguments and return the results, and restore the context after running
+    auto continuation = trpc::opentelemetry::BindCurrentContext(
+        [&span](int value) { return trpc::opentelemetry::GetCurrentSpan().get() == span.get() ? value : 0; });
+    ASSERT_EQ(1, continuation(1));
+    ASSERT_EQ(span.get(), trpc::opentelemetry::GetCurrentSpan().get());
+  });
+  ASSERT_EQ(nullptr, trpc::opentelemetry::GetCurrentSpan().get());
+}
+
 }  // namespace trpc::testing
@@ -59,4 +59,23 @@ TEST_F(OpenTelemetryTracingTest, MakeTracer) {
   ASSERT_NE(ser_a_tracer_1, ser_b_tracer);
 }
 
+TEST_F(OpenTelemetryTracingTest, DestroyClearsCache) {
+  int ret = TrpcConfig::GetInstance()->Init("./trpc/telemetry/opentelemetry/testing/opentelemetry_telemetry_test.yaml");
+  ASSERT_EQ(0, ret);
+  {
+    auto tracing = MakeRefCounted<OpenTelemetryTracing>();
+    ASSERT_EQ(0, tracing->Init());
+    ASSERT_NE(nullptr, OpenTelemetryTracing::GetServerTracer());
+    ASSERT_EQ(tracing->GetPluginID(), OpenTelemetryTracing::GetFilterDataIndex());
+  }
+  // the cache does not refer to the destroyed plugin
+  ASSERT_EQ(nullptr, OpenTelemetryTracing::GetServerTracer());
+  ASSERT_EQ(0, OpenTelemetryTracing::GetFilterDataIndex());
+
+  // the plugin initialized later is cached again
+  ASSERT_EQ(0, tracing_->Init());
+  ASSERT_NE(nullptr, OpenTelemetryTracing::GetServerTracer());
+  ASSERT_EQ(tracing_->GetPluginID(), OpenTelemetryTracing::GetFilterDataIndex());
+}
+
 }  // namespace trpc::testing
@@ -0,0 +1,40 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#include "trpc/telemetry/opentelemetry/tracing/scoped_span.h"
+
+#include "trpc/telemetry/opentelemetry/tracing/opentelemetry_tracing.h"
+
+namespace trpc::opentelemetry {
+
+void ScopedSpan::Start(::opentelemetry::trace::Span& parent, ::opentelemetry::nostd::string_view name,
+                       Attributes attributes) {
+  auto* tracer = trpc::OpenTelemetryTracing::GetServerTracer();
+  if (!tracer) {
+    return;
+  }
+
+  ::opentelemetry::trace::StartSpanOptions op;
+  op.parent = parent.GetContext();
+  op.kind = ::opentelemetry::trace::SpanKind::kInternal;
+  span_ = tracer->StartSpan(name, attributes, op);
+  // the logs and the client calls in the scope are linked to the span
+  scope_.emplace(span_);
+}
+
+void ScopedSpan::End() {
+  scope_.reset();
+  span_->End();
+}
+
+}  // namespace trpc::opentelemetry
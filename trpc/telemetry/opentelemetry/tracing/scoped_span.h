@@ -0,0 +1,136 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#pragma once
+
+#include <initializer_list>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "opentelemetry/common/attribute_value.h"
+#include "opentelemetry/trace/scope.h"
+#include "trpc/server/server_context.h"
+
+#include "trpc/telemetry/opentelemetry/tracing/common.h"
+#include "trpc/telemetry/opentelemetry/tracing/opentelemetry_tracing_api.h"
+
+namespace trpc::opentelemetry {
+
+/// @brief Starts a child span of the current call when it is constructed, and ends it when it is destroyed, which is
+///        used to trace a section of the handler, such as a database call.
+/// @note The child span is only started when the parent span is recording, which follows the sampling decision of the
+///       parent. Otherwise it costs a span lookup and a branch, without looking up the tracer or allocating. The
+///       attributes passed as a list are built by the caller before the constructor runs, even if the span is not
+///       started, so the attributes which are costly to compute should be set by a function instead.
+class ScopedSpan {
+ public:
+  using Attributes = std::initializer_list<
+      std::pair<::opentelemetry::nostd::string_view, ::opentelemetry::common::AttributeValue>>;
+
+  /// @brief Starts a child span of the span of the server context.
+  /// @param context server context
+  /// @param name the name of the span
+  /// @param attributes the attributes of the span, which are evaluated whether the span is started or not
+  ScopedSpan(const ServerContextPtr& context, ::opentelemetry::nostd::string_view name, Attributes attributes = {}) {
+    const auto* parent = GetTracingSpanPtr(context);
+    if (parent && (*parent)->IsRecording()) {
+      Start(**parent, name, attributes);
+    }
+  }
+
+  /// @brief Starts a child span of the current span, which is used out of the server contexts.
+  /// @param name the name of the span
+  /// @param attributes the attributes of the span
+  explicit ScopedSpan(::opentelemetry::nostd::string_view name, Attributes attributes = {}) {
+    auto parent = GetCurrentSpan();
+    if (parent && parent->IsRecording()) {
+      Start(*parent, name, attributes);
+    }
+  }
+
+  /// @brief Starts a child span of the span of the server context, and sets its attributes by the function only when
+  ///        the span is started.
+  /// @param context server context
+  /// @param name the name of the span
+  /// @param set_attributes the function called with the ScopedSpan, such as
+  ///        `[&](ScopedSpan& span) { span.SetAttribute("db.rows", CountRows()); }`. The attributes are set after the
+  ///        span is started, so they are not visible to the sampler.
+  template <typename SetAttributes,
+            typename = std::enable_if_t<std::is_invocable_v<SetAttributes&, ScopedSpan&>>>
+  ScopedSpan(const ServerContextPtr& context, ::opentelemetry::nostd::string_view name, SetAttributes&& set_attributes)
+      : ScopedSpan(context, name) {
+    if (span_) {
+      set_attributes(*this);
+    }
+  }
+
+  /// @brief Starts a child span of the current span, and sets its attributes by the function only when the span is
+  ///        started.
+  /// @param name the name of the span
+  /// @param set_attributes the function called with the ScopedSpan
+  template <typename SetAttributes,
+            typename = std::enable_if_t<std::is_invocable_v<SetAttributes&, ScopedSpan&>>>
+  ScopedSpan(::opentelemetry::nostd::string_view name, SetAttributes&& set_attributes) : ScopedSpan(name) {
+    if (span_) {
+      set_attributes(*this);
+    }
+  }
+
+  ~ScopedSpan() {
+    if (span_) {
+      End();
+    }
+  }
+
+  ScopedSpan(const ScopedSpan&) = delete;
+  ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+  /// @brief Checks whether the span is started, the following operations do nothing if not.
+  bool IsRecording() const { return static_cast<bool>(span_); }
+
+  /// @brief Gets the span, which is null if the span is not started.
+  const OpenTelemetryTracingSpanPtr& GetSpan() const { return span_; }
+
+  void SetAttribute(::opentelemetry::nostd::string_view key, const ::opentelemetry::common::AttributeValue& value) {
+    if (span_) {
+      span_->SetAttribute(key, value);
+    }
+  }
+
+  void AddEvent(::opentelemetry::nostd::string_view name) {
+    if (span_) {
+      span_->AddEvent(name);
+    }
+  }
+
+  void SetStatus(::opentelemetry::trace::StatusCode code, ::opentelemetry::nostd::string_view description = "") {
+    if (span_) {
+      span_->SetStatus(code, description);
+    }
+  }
+
+ private:
+  // Starts the span with the cached tracer and makes it current
+  void Start(::opentelemetry::trace::Span& parent, ::opentelemetry::nostd::string_view name, Attributes attributes);
+
+  // Restores the previous current span and ends the span
+  void End();
+
+ private:
+  OpenTelemetryTracingSpanPtr span_;
+
+  std::optional<::opentelemetry::trace::Scope> scope_;
+};
+
+}  // namespace trpc::opentelemetry
@@ -0,0 +1,172 @@
+//
+//
+// Tencent is pleased to support the open source community by making tRPC available.
+//
+// Copyright (C) 2023 THL A29 Limited, a Tencent company.
+// All rights reserved.
+//
+// If you have downloaded a copy of the tRPC source code from Tencent,
+// please note that tRPC source code is licensed under the  Apache 2.0 License,
+// A copy of the Apache 2.0 License is included in this file.
+//
+//
+
+#include "trpc/telemetry/opentelemetry/tracing/scoped_span.h"
+
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "opentelemetry/trace/default_span.h"
+#include "trpc/client/testing/service_proxy_testing.h"
+#include "trpc/common/config/trpc_config.h"
+#include "trpc/server/testing/server_context_testing.h"
+#include "trpc/telemetry/telemetry_factory.h"
+
+#include "trpc/telemetry/opentelemetry/testing/mock_telemetry.h"
+#include "trpc/telemetry/opentelemetry/tracing/opentelemetry_tracing.h"
+
+namespace trpc::testing {
+
+class ScopedSpanTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase() {
+    int ret =
+        TrpcConfig::GetInstance()->Init("./trpc/telemetry/opentelemetry/testing/opentelemetry_telemetry_test.yaml");
+    ASSERT_EQ(0, ret);
+    RegisterPlugins();
+
+    // registers a telemetry plugin to enable successful invocation of tracing api.
+    telemetry_ = MakeRefCounted<MockOpenTelemetryTelemetry>();
+    tracing_ = MakeRefCounted<OpenTelemetryTracing>();
+    ASSERT_EQ(0, tracing_->Init());
+    TelemetryFactory::GetInstance()->Register(telemetry_);
+    EXPECT_CALL(*telemetry_, GetTracing()).WillRepeatedly(::testing::Return(tracing_));
+  }
+
+  static void TearDownTestCase() { UnregisterPlugins(); }
+
+  static ServerContextPtr MakeServerContext(const trpc::opentelemetry::OpenTelemetryTracingSpanPtr& span) {
+    auto context = MakeRefCounted<ServerContext>();
+    ServerTracingSpan server_span;
+    server_span.span = span;
+    context->SetFilterData(tracing_->GetPluginID(), std::move(server_span));
+    return context;
+  }
+
+  static trpc::opentelemetry::OpenTelemetryTracingSpanPtr StartSpan() {
+    std::string err_msg;
+    auto tracer = tracing_->MakeTracer("test", err_msg);
+    return tracer->StartSpan("parent", {}, ::opentelemetry::trace::StartSpanOptions{});
+  }
+
+ protected:
+  static OpenTelemetryTracingPtr tracing_;
+  static RefPtr<MockOpenTelemetryTelemetry> telemetry_;
+};
+
+OpenTelemetryTracingPtr ScopedSpanTest::tracing_;
+RefPtr<MockOpenTelemetryTelemetry> ScopedSpanTest::telemetry_;
+
+TEST_F(ScopedSpanTest, RecordingParent) {
+  auto parent = StartSpan();
+  ASSERT_TRUE(parent->IsRecording());
+  auto context = MakeServerContext(parent);
+
+  trpc::opentelemetry::OpenTelemetryTracingSpanPtr child;
+  {
+    trpc::opentelemetry::ScopedSpan span(context, "child", {{"key", "value"}});
+    ASSERT_TRUE(span.IsRecording());
+    child = span.GetSpan();
+    ASSERT_EQ(parent->GetContext().trace_id(), child->GetContext().trace_id());
+    ASSERT_NE(parent->GetContext().span_id(), child->GetContext().span_id());
+    // the span is current in the scope
+    ASSERT_EQ(child.get(), trpc::opentelemetry::GetCurrentSpan().get());
+
+    span.SetAttribute("rows", 1);
+    span.AddEvent("event");
+    span.SetStatus(::opentelemetry::trace::StatusCode::kOk);
+  }
+  // the span is ended, and the previous current span is restored
+  ASSERT_FALSE(child->IsRecording());
+  ASSERT_EQ(nullptr, trpc::opentelemetry::GetCurrentSpan().get());
+  parent->End();
+}
+
+TEST_F(ScopedSpanTest, NotRecordingParent) {
+  const uint8_t trace_id[16] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+  const uint8_t span_id[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+  ::opentelemetry::trace::SpanContext span_context(::opentelemetry::trace::TraceId(trace_id),
+                                                   ::opentelemetry::trace::SpanId(span_id),
+                                                   ::opentelemetry::trace::TraceFlags(false), false);
+  trpc::opentelemetry::OpenTelemetryTracingSpanPtr parent(new ::opentelemetry::trace::DefaultSpan(span_context));
+  auto context = MakeServerContext(parent);
+
+  trpc::opentelemetry::ScopedSpan span(context, "child");
+  ASSERT_FALSE(span.IsRecording());
+  ASSERT_EQ(nullptr, span.GetSpan().get());
+  // the operations do nothing
+  span.SetAttribute("rows", 1);
+  span.AddEvent("event");
+  span.SetStatus(::opentelemetry::trace::StatusCode::kError);
+}
+
+TEST_F(ScopedSpanTest, LazyAttributes) {
+  int called_num = 0;
+  auto set_attributes = [&called_num](trpc::opentelemetry::ScopedSpan& span) {
+    ++called_num;
+    ASSERT_TRUE(span.IsRecording());
+    span.SetAttribute("key", "value");
+  };
+
+  // the function is not called when the span is not started
+  auto context = MakeRefCounted<ServerContext>();
+  {
+    trpc::opentelemetry::ScopedSpan span(context, "child", set_attributes);
+    ASSERT_FALSE(span.IsRecording());
+    trpc::opentelemetry::ScopedSpan span_without_context("child", set_attributes);
+    ASSERT_FALSE(span_without_context.IsRecording());
+  }
+  ASSERT_EQ(0, called_num);
+
+  auto parent = StartSpan();
+  context = MakeServerContext(parent);
+  {
+    trpc::opentelemetry::ScopedSpan span(context, "child", set_attributes);
+    ASSERT_TRUE(span.IsRecording());
+    ASSERT_EQ(1, called_num);
+
+    trpc::opentelemetry::ScopedSpan nested_span("nested", set_attributes);
+    ASSERT_TRUE(nested_span.IsRecording());
+    ASSERT_EQ(2, called_num);
+  }
+  parent->End();
+}
+
+TEST_F(ScopedSpanTest, NoParent) {
+  auto context = MakeRefCounted<ServerContext>();
+  trpc::opentelemetry::ScopedSpan span(context, "child");
+  ASSERT_FALSE(span.IsRecording());
+
+  trpc::opentelemetry::ScopedSpan span_without_context("child");
+  ASSERT_FALSE(span_without_context.IsRecording());
+}
+
+TEST_F(ScopedSpanTest, CurrentSpanParent) {
+  auto parent = StartSpan();
+  auto scope = trpc::opentelemetry::WithCurrentSpan(parent);
+  {
+    trpc::opentelemetry::ScopedSpan span("child");
+    ASSERT_TRUE(span.IsRecording());
+    ASSERT_EQ(parent->GetContext().trace_id(), span.GetSpan()->GetContext().trace_id());
+
+    // the nested span is the child of the span in the scope
+    trpc::opentelemetry::ScopedSpan nested_span("nested");
+    ASSERT_TRUE(nested_span.IsRecording());
+    ASSERT_EQ(nested_span.GetSpan().get(), trpc::opentelemetry::GetCurrentSpan().get());
+  }
+  ASSERT_EQ(parent.get(), trpc::opentelemetry::GetCurrentSpan().get());
+  parent->End();
+}
+
+}  // namespace trpc::testing
@@ -24,6 +24,7 @@
 #include "trpc/tracing/tracing_filter_index.h"
 
 #include "trpc/telemetry/opentelemetry/opentelemetry_telemetry_conf_parser.h"
+#include "trpc/telemetry/opentelemetry/server_stages.h"
 #include "trpc/telemetry/opentelemetry/tracing/text_map_carrier.h"
 
 namespace trpc {
@@ -81,7 +82,8 @@ int OpenTelemetryTracingServerFilter::Init() {
 }
 
 std::vector<FilterPoint> OpenTelemetryTracingServerFilter::GetFilterPoint() {
-  std::vector<FilterPoint> points = {FilterPoint::SERVER_PRE_RPC_INVOKE, FilterPoint::SERVER_POST_RPC_INVOKE};
+  std::vector<FilterPoint> points = {FilterPoint::SERVER_POST_RECV_MSG, FilterPoint::SERVER_PRE_RPC_INVOKE,
+                                     FilterPoint::SERVER_POST_RPC_INVOKE};
   return points;
 }
 
@@ -92,13 +94,30 @@ void OpenTelemetryTracingServerFilter::operator()(FilterStatus& status, FilterPo
     return;
   }
 
-  if (point == FilterPoint::SERVER_PRE_RPC_INVOKE) {
+  if (point == FilterPoint::SERVER_POST_RECV_MSG) {
+    trpc::opentelemetry::GetServerStages(context);
+  } else if (point == FilterPoint::SERVER_PRE_RPC_INVOKE) {
+    // marks the dispatch before the span is started, so that the queue wait excludes the overhead of tracing and is
+    // measured alike for the sampled and unsampled requests
+    trpc::opentelemetry::MarkServerDispatched(context);
+    auto span = NewSpan(context);
+    // makes the span current in the fiber of the handler, so that the code without the context can find it
+    if (auto* storage = tracer_factory_->GetContextStorage()) {
+      storage->PushSpan(span);
+    }
     ServerTracingSpan svr_span;
-    svr_span.span = std::move(NewSpan(context));
+    svr_span.span = std::move(span);
     context->SetFilterData<ServerTracingSpan>(tracer_factory_->GetPluginID(), std::move(svr_span));
   } else if (point == FilterPoint::SERVER_POST_RPC_INVOKE) {
+    // likewise, the handler time excludes the overhead of finishing the span
+    trpc::opentelemetry::MarkServerHandled(context);
     ServerTracingSpan* ptr = context->GetFilterData<ServerTracingSpan>(tracer_factory_->GetPluginID());
     if (ptr) {
+      auto* span = std::any_cast<trpc::opentelemetry::OpenTelemetryTracingSpanPtr>(&ptr->span);
+      auto* storage = tracer_factory_->GetContextStorage();
+      if (span && storage) {
+        storage->PopSpan(*span);
+      }
       FinishSpan(ptr->span, context);
     }
   }
@@ -152,6 +171,10 @@ trpc::opentelemetry::OpenTelemetryTracingSpanPtr OpenTelemetryTracingServerFilte
     span->SetAttribute(trpc::opentelemetry::kTraceDyeingKey, context->GetDyeingKey());
   }
 
+  if (span->IsRecording()) {
+    AddDispatchedEvent(context, span);
+  }
+
   return span;
 }
 
@@ -166,6 +189,8 @@ void OpenTelemetryTracingServerFilter::FinishSpan(const std::any& any_span, cons
     return;
   }
 
+  AddHandledEvent(context, span);
+
   // reports request and response
   if (NeedReportReqRsp(context, span)) {
     AddRequestEvent(context, span);
@@ -202,6 +227,27 @@ void OpenTelemetryTracingServerFilter::AddRsponseEvent(const ServerContextPtr& c
   }
 }
 
+void OpenTelemetryTracingServerFilter::AddDispatchedEvent(
+    const ServerContextPtr& context, const trpc::opentelemetry::OpenTelemetryTracingSpanPtr& span) {
+  auto* stages = trpc::opentelemetry::FindServerStages(context);
+  if (!stages || stages->dispatch_us == 0) {
+    // the request does not go through SERVER_POST_RECV_MSG
+    return;
+  }
+  span->AddEvent(trpc::opentelemetry::kTraceDispatchedEvent,
+                 {{trpc::opentelemetry::kTraceQueueWaitUs, stages->dispatch_us - stages->recv_us}});
+}
+
+void OpenTelemetryTracingServerFilter::AddHandledEvent(const ServerContextPtr& context,
+                                                       const trpc::opentelemetry::OpenTelemetryTracingSpanPtr& span) {
+  auto* stages = trpc::opentelemetry::FindServerStages(context);
+  if (!stages || stages->handled_us == 0) {
+    return;
+  }
+  span->AddEvent(trpc::opentelemetry::kTraceHandledEvent,
+                 {{trpc::opentelemetry::kTraceHandlerUs, stages->handled_us - stages->dispatch_us}});
+}
+
 bool OpenTelemetryTracingServerFilter::NeedReportReqRsp(const ServerContextPtr& context,
                                                         const trpc::opentelemetry::OpenTelemetryTracingSpanPtr& span) {
   // the reporting switch must be turned on in order to report data
@@ -82,6 +82,13 @@ class OpenTelemetryTracingServerFilter : public trpc::MessageServerFilter {
   /// @brief Determines whether to add an event containing request/response data to span.
   bool NeedReportReqRsp(const ServerContextPtr& context, const trpc::opentelemetry::OpenTelemetryTracingSpanPtr& span);
 
+  // Adds an event containing the time waited in queue before the handler is invoked
+  void AddDispatchedEvent(const ServerContextPtr& context,
+                          const trpc::opentelemetry::OpenTelemetryTracingSpanPtr& span);
+
+  // Adds an event containing the execution time of the handler
+  void AddHandledEvent(const ServerContextPtr& context, const trpc::opentelemetry::OpenTelemetryTracingSpanPtr& span);
+
  protected:
   OpenTelemetryTracingPtr tracer_factory_ = nullptr;
 
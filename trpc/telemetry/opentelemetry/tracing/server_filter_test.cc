@@ -27,6 +27,7 @@
 #include "trpc/telemetry/telemetry_factory.h"
 #include "trpc/tracing/tracing_filter_index.h"
 
+#include "trpc/telemetry/opentelemetry/server_stages.h"
 #include "trpc/telemetry/opentelemetry/testing/mock_telemetry.h"
 
 namespace trpc::testing {
@@ -128,7 +129,8 @@ TEST_F(TracingServerFilterTest, ServerCarrier) {
 TEST_F(TracingServerFilterTest, Init) {
   ASSERT_EQ(trpc::opentelemetry::kOpenTelemetryTelemetryName, server_filter_->Name());
   std::vector<FilterPoint> points = server_filter_->GetFilterPoint();
-  ASSERT_EQ(2, points.size());
+  ASSERT_EQ(3, points.size());
+  ASSERT_TRUE(std::find(points.begin(), points.end(), FilterPoint::SERVER_POST_RECV_MSG) != points.end());
   ASSERT_TRUE(std::find(points.begin(), points.end(), FilterPoint::SERVER_PRE_RPC_INVOKE) != points.end());
   ASSERT_TRUE(std::find(points.begin(), points.end(), FilterPoint::SERVER_POST_RPC_INVOKE) != points.end());
 }
@@ -139,6 +141,9 @@ TEST_F(TracingServerFilterTest, TraceWithoutUpstreamInfo) {
   // 1. tests for SERVER_PRE_RPC_INVOKE filter point
   // There is no tracing information in the context's transinfo.
   ServerContextPtr context = GetTestTrpcServerContext();
+  // the receiving time is captured to add the event of the queue wait time
+  server_filter_->operator()(status, FilterPoint::SERVER_POST_RECV_MSG, context);
+  ASSERT_EQ(status, FilterStatus::CONTINUE);
   server_filter_->operator()(status, FilterPoint::SERVER_PRE_RPC_INVOKE, context);
   ASSERT_EQ(status, FilterStatus::CONTINUE);
   ServerTracingSpan* ptr = context->GetFilterData<ServerTracingSpan>(tracing_->GetPluginID());
@@ -198,4 +203,30 @@ TEST_F(TracingServerFilterTest, TraceWithUpstreamInfo) {
   ASSERT_FALSE(span->IsRecording());
 }
 
+TEST_F(TracingServerFilterTest, StagesExcludeTracing) {
+  FilterStatus status;
+  ServerContextPtr context = GetTestTrpcServerContext();
+  server_filter_->operator()(status, FilterPoint::SERVER_POST_RECV_MSG, context);
+
+  // the dispatch is marked before the span is started, which calls the attributes func
+  uint64_t dispatch_us_in_span = 0;
+  trpc::opentelemetry::SetServerTraceAttrsFunc(
+      [&dispatch_us_in_span](const ServerContextPtr& context, const void* req,
+                             std::unordered_map<std::string, std::string>& attributes) {
+        dispatch_us_in_span = trpc::opentelemetry::FindServerStages(context)->dispatch_us;
+      });
+  server_filter_->operator()(status, FilterPoint::SERVER_PRE_RPC_INVOKE, context);
+  trpc::opentelemetry::SetServerTraceAttrsFunc(
+      [](const ServerContextPtr& context, const void* req, std::unordered_map<std::string, std::string>& attributes) {
+        attributes["testkey"] = "testvalue";
+      });
+  auto* stages = trpc::opentelemetry::FindServerStages(context);
+  ASSERT_NE(nullptr, stages);
+  ASSERT_NE(0, dispatch_us_in_span);
+  ASSERT_EQ(stages->dispatch_us, dispatch_us_in_span);
+
+  server_filter_->operator()(status, FilterPoint::SERVER_POST_RPC_INVOKE, context);
+  ASSERT_GE(stages->handled_us, stages->dispatch_us);
+}
+
 }  // namespace trpc::testing